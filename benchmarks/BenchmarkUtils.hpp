@@ -0,0 +1,45 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace crypto_hft {
+namespace bench {
+
+using Clock = std::chrono::steady_clock;
+
+inline double elapsedNs(Clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+// Keeps the optimizer from discarding a computed value
+template <typename T>
+inline void doNotOptimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+inline void report(const std::string& name, std::size_t ops, double totalNs) {
+    std::printf("%-52s %12.1f ns/op %14.0f ops/s\n",
+                name.c_str(), totalNs / static_cast<double>(ops),
+                static_cast<double>(ops) * 1e9 / totalNs);
+}
+
+// One raw frame per line from benchmarks/corpus
+inline std::vector<std::string> loadCorpus(const std::string& name) {
+    std::ifstream file(std::string(CORPUS_DIR) + "/" + name);
+    std::vector<std::string> frames;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty()) {
+            frames.push_back(line);
+        }
+    }
+    return frames;
+}
+
+} // namespace bench
+} // namespace crypto_hft
@@ -0,0 +1,189 @@
+// Each venue adapter's whole read path on the checked-in corpus: recorded frames are replayed
+// from a mapped file through replayFrames(), the same parse-and-dispatch path as the read loop,
+// into a sink that only counts events. Heap allocations on the replaying thread are counted.
+//
+// The corpus is replayed once untimed so that books, symbol tables and parse buffers reach
+// their steady-state size, then kPasses times timed. Control frames (subscription acks, status)
+// go through json and allocate by design; the "book" rows replay the book frames alone.
+//
+// Usage: adapter_replay_benchmark [recording.jsonl venue]...  Without arguments, every venue's
+// corpus in benchmarks/corpus.
+
+#include "BenchmarkUtils.hpp"
+#include "exchanges/BinanceAdapter.hpp"
+#include "exchanges/CoinbaseAdapter.hpp"
+#include "exchanges/FrameParser.hpp"
+#include "exchanges/KrakenAdapter.hpp"
+#include "exchanges/MappedFile.hpp"
+#include <cstdlib>
+#include <new>
+
+using namespace crypto_hft;
+
+namespace {
+thread_local bool countAllocations = false;
+thread_local std::size_t allocationCount = 0;
+} // namespace
+
+void* operator new(std::size_t size) {
+    if (countAllocations) {
+        ++allocationCount;
+    }
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+void operator delete[](void* p) noexcept {
+    operator delete(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    operator delete(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+    operator delete(p);
+}
+
+namespace {
+
+constexpr int kPasses = 2000;
+
+// Takes every event by reference and keeps only a count, so the adapter's own cost is measured
+struct CountingSink {
+    std::size_t events = 0;
+
+    void onSnapshot(const OrderBookSnapshot& snapshot) {
+        ++events;
+        bench::doNotOptimize(snapshot.bids.size());
+    }
+    void onDelta(const OrderBookDelta& delta) {
+        ++events;
+        bench::doNotOptimize(delta.bidUpdates.size());
+    }
+    void onTopOfBook(const TopOfBookUpdate& quote) {
+        ++events;
+        bench::doNotOptimize(quote.bidPrice);
+    }
+};
+
+// Advanced Trade frames carry several products, which only the batch parser takes
+struct CoinbaseBatchParser {
+    static FrameType parse(std::string_view frame, OrderBookSnapshot&, OrderBookDelta&) {
+        static CoinbaseBookBatch batch;
+        return CoinbaseFrameParser::parse(frame, batch);
+    }
+};
+
+// The steady-state traffic alone: book and heartbeat frames, one per line
+template <typename Parser>
+std::string bookFrames(std::string_view recording) {
+    std::string frames;
+    OrderBookSnapshot snapshot;
+    OrderBookDelta delta;
+    while (!recording.empty()) {
+        const std::size_t end = recording.find('\n');
+        const std::string_view frame = recording.substr(0, end);
+        recording.remove_prefix(end == std::string_view::npos ? recording.size() : end + 1);
+        const FrameType type = Parser::parse(frame, snapshot, delta);
+        if (type == FrameType::BookSnapshot || type == FrameType::BookDelta ||
+            type == FrameType::Heartbeat) {
+            frames.append(frame);
+            frames.push_back('\n');
+        }
+    }
+    return frames;
+}
+
+template <template <typename> class Adapter>
+void replay(const std::string& name, std::string_view frames) {
+    Adapter<CountingSink> adapter;
+    adapter.setFrameCaptureSampling(0);
+    // Each pass restarts the venue's sequence numbers, which the adapter warns about
+    spdlog::apply_all([](const std::shared_ptr<spdlog::logger>& logger) {
+        logger->set_level(spdlog::level::err);
+    });
+    const std::size_t perPass = adapter.replayFrames(frames);
+    if (perPass == 0) {
+        std::printf("%-40s no frames\n", name.c_str());
+        return;
+    }
+
+    allocationCount = 0;
+    countAllocations = true;
+    const auto start = bench::Clock::now();
+    std::size_t replayed = 0;
+    for (int pass = 0; pass < kPasses; ++pass) {
+        replayed += adapter.replayFrames(frames);
+    }
+    const double ns = bench::elapsedNs(start);
+    countAllocations = false;
+
+    std::printf("%-40s %10.1f ns/frame %12.0f frames/s %8.3f allocs/frame %8.2f events/frame\n",
+                name.c_str(), ns / static_cast<double>(replayed),
+                static_cast<double>(replayed) * 1e9 / ns,
+                static_cast<double>(allocationCount) / static_cast<double>(replayed),
+                static_cast<double>(adapter.sink().events) /
+                    static_cast<double>(replayed + perPass));
+}
+
+template <template <typename> class Adapter, typename Parser>
+void benchVenue(const std::string& venue, const std::string& path) {
+    MappedFile recording(path);
+    replay<Adapter>(venue + "/all", recording.contents());
+    replay<Adapter>(venue + "/book", bookFrames<Parser>(recording.contents()));
+}
+
+bool benchRecording(const std::string& path, const std::string& venue) {
+    if (venue == "binance") {
+        benchVenue<BasicBinanceAdapter, BinanceFrameParser>(venue, path);
+    } else if (venue == "coinbase") {
+        benchVenue<BasicCoinbaseAdapter, CoinbaseBatchParser>(venue, path);
+    } else if (venue == "kraken") {
+        benchVenue<BasicKrakenAdapter, KrakenFrameParser>(venue, path);
+    } else {
+        std::fprintf(stderr, "Unknown venue %s\n", venue.c_str());
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    spdlog::set_level(spdlog::level::warn);
+    if (argc > 1) {
+        if (argc % 2 == 0) {
+            std::fprintf(stderr, "Usage: %s [recording.jsonl venue]...\n", argv[0]);
+            return 1;
+        }
+        for (int i = 1; i + 1 < argc; i += 2) {
+            if (!benchRecording(argv[i], argv[i + 1])) {
+                return 1;
+            }
+        }
+        return 0;
+    }
+    const std::string corpus = CORPUS_DIR;
+    benchRecording(corpus + "/binance_book.jsonl", "binance");
+    benchRecording(corpus + "/coinbase_advanced_book.jsonl", "coinbase");
+    benchRecording(corpus + "/kraken_book.jsonl", "kraken");
+    return 0;
+}
@@ -0,0 +1,133 @@
+// Receive-path latency over loopback TCP for different ConnectionProfiles.
+//
+// A venue thread sends each 64-byte message as a header write followed by a body write (Nagle
+// left on, as a venue would) and waits for an 8-byte acknowledgement, like a request/response
+// stream. The client reads through TunedStream, so profile options apply exactly as in the
+// adapters. Reported: venue write -> client handler latency, and with receive timestamps the
+// kernel receive -> handler part of it. SO_BUSY_POLL has no effect on loopback (no NIC queue to
+// poll) and is not exercised here.
+
+#include "BenchmarkUtils.hpp"
+#include "exchanges/ConnectionProfile.hpp"
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+using namespace crypto_hft;
+namespace net = boost::asio;
+using tcp = net::ip::tcp;
+
+namespace {
+
+constexpr std::size_t kHeaderBytes = 8;
+constexpr std::size_t kMessageBytes = 64;
+constexpr int kWarmup = 20;
+
+int64_t steadyNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        bench::Clock::now().time_since_epoch()).count();
+}
+
+int64_t realtimeNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+void venue(tcp::acceptor& acceptor, int rounds) {
+    tcp::socket socket = acceptor.accept();
+    char message[kMessageBytes] = {};
+    char ack[kHeaderBytes];
+    for (int i = 0; i < rounds; ++i) {
+        int64_t sent = steadyNs();
+        std::memcpy(message, &sent, sizeof(sent));
+        net::write(socket, net::buffer(message, kHeaderBytes));
+        net::write(socket, net::buffer(message + kHeaderBytes, kMessageBytes - kHeaderBytes));
+        net::read(socket, net::buffer(ack));
+    }
+}
+
+double percentile(std::vector<int64_t> samples, double p) {
+    if (samples.empty()) {
+        return 0.0;
+    }
+    std::sort(samples.begin(), samples.end());
+    return static_cast<double>(samples[static_cast<std::size_t>(p * (samples.size() - 1))]);
+}
+
+void run(const std::string& name, const ConnectionProfile& profile, int rounds) {
+    net::io_context ioc;
+    tcp::acceptor acceptor(ioc, {net::ip::make_address("127.0.0.1"), 0});
+    std::thread server(venue, std::ref(acceptor), rounds + kWarmup);
+
+    TunedStream stream(ioc.get_executor());
+    stream.lowest_layer().open(tcp::v4());
+    profile.apply(stream.lowest_layer(), *spdlog::default_logger());
+    stream.lowest_layer().connect(acceptor.local_endpoint());
+    stream.setQuickAck(profile.quickAck);
+    stream.setRxTimestamps(profile.rxTimestamps);
+
+    std::vector<int64_t> latency;
+    std::vector<int64_t> kernelToHandler;
+    char message[kMessageBytes];
+    char ack[kHeaderBytes] = {};
+    auto start = bench::Clock::now();
+    for (int i = 0; i < rounds + kWarmup; ++i) {
+        if (i == kWarmup) {
+            start = bench::Clock::now();
+        }
+        net::async_read(stream, net::buffer(message), [&](boost::system::error_code ec, std::size_t) {
+            if (ec) {
+                throw boost::system::system_error(ec);
+            }
+            int64_t now = steadyNs();
+            int64_t rxNs = stream.takeRxTimestamp();
+            if (i < kWarmup) {
+                return;
+            }
+            int64_t sent;
+            std::memcpy(&sent, message, sizeof(sent));
+            latency.push_back(now - sent);
+            if (rxNs != 0) {
+                kernelToHandler.push_back(realtimeNs() - rxNs);
+            }
+        });
+        ioc.restart();
+        ioc.run();
+        net::write(stream.lowest_layer(), net::buffer(ack));
+    }
+    double totalNs = bench::elapsedNs(start);
+    server.join();
+
+    bench::report(name, static_cast<std::size_t>(rounds), totalNs);
+    std::printf("    write->handler p50 %.1f us, p99 %.1f us", percentile(latency, 0.5) / 1e3,
+                percentile(latency, 0.99) / 1e3);
+    if (!kernelToHandler.empty()) {
+        std::printf("; kernel rx->handler p50 %.1f us, p99 %.1f us (%zu samples)",
+                    percentile(kernelToHandler, 0.5) / 1e3,
+                    percentile(kernelToHandler, 0.99) / 1e3, kernelToHandler.size());
+    }
+    std::printf("\n");
+}
+
+} // namespace
+
+int main() {
+    spdlog::set_level(spdlog::level::warn);
+
+    // Kernel defaults: delayed ACKs hold back the venue's second write (Nagle) until the
+    // delayed-ACK timer fires, so rounds are slow; keep the count small
+    ConnectionProfile defaults;
+    defaults.noDelay = false;
+    run("loopback/defaults", defaults, 50);
+
+    ConnectionProfile quickAck;
+    quickAck.quickAck = true;
+    run("loopback/nodelay+quickack", quickAck, 20000);
+
+    ConnectionProfile timestamped = quickAck;
+    timestamped.rxTimestamps = true;
+    run("loopback/nodelay+quickack+rx_timestamps", timestamped, 20000);
+    return 0;
+}
@@ -0,0 +1,181 @@
+#!/usr/bin/env python3
+"""Generates the synthetic market data corpus used by the parser benchmarks and tests.
+
+Each venue file holds one raw websocket frame per line, in that venue's wire format.
+Kraken frames carry valid top-10 CRC32 checksums for the book they describe.
+"""
+import json
+import random
+import zlib
+from pathlib import Path
+
+FRAMES = 300
+OUT = Path(__file__).resolve().parent
+rng = random.Random(42)
+
+
+def dump(obj):
+    return json.dumps(obj, separators=(",", ":"))
+
+
+def binance():
+    lines = [dump({"result": None, "id": 1})]
+    update_id = 1_000_000
+    event_time = 1_700_000_000_000
+    for i in range(FRAMES):
+        symbol = "BTCUSDT" if i % 3 else "ETHUSDT"
+        mid = 43000.0 if symbol == "BTCUSDT" else 2250.0
+        first = update_id + 1
+        update_id += rng.randint(1, 40)
+        event_time += rng.randint(90, 110)
+        bids = [[f"{mid - rng.randint(1, 500) * 0.01:.8f}", f"{rng.random() * 3:.8f}"]
+                for _ in range(rng.randint(1, 20))]
+        asks = [[f"{mid + rng.randint(1, 500) * 0.01:.8f}", f"{rng.random() * 3:.8f}"]
+                for _ in range(rng.randint(1, 20))]
+        lines.append(dump({"e": "depthUpdate", "E": event_time, "s": symbol, "U": first,
+                           "u": update_id, "b": bids, "a": asks}))
+    return lines
+
+
+def coinbase():
+    lines = [dump({"type": "subscriptions", "channels": [{"name": "level2",
+                                                          "product_ids": ["BTC-USD"]}]})]
+    mid = 43000.0
+    lines.append(dump({
+        "type": "snapshot", "product_id": "BTC-USD",
+        "bids": [[f"{mid - i * 0.01:.2f}", f"{rng.random() * 2:.8f}"] for i in range(1, 51)],
+        "asks": [[f"{mid + i * 0.01:.2f}", f"{rng.random() * 2:.8f}"] for i in range(1, 51)],
+    }))
+    for i in range(FRAMES):
+        changes = []
+        for _ in range(rng.randint(1, 5)):
+            side = rng.choice(["buy", "sell"])
+            offset = rng.randint(1, 50) * 0.01
+            price = mid - offset if side == "buy" else mid + offset
+            size = 0.0 if rng.random() < 0.2 else rng.random() * 2
+            changes.append([side, f"{price:.2f}", f"{size:.8f}"])
+        lines.append(dump({"type": "l2update", "product_id": "BTC-USD", "changes": changes,
+                           "time": f"2024-01-01T00:00:{i % 60:02d}.{i:06d}Z"}))
+        if i % 50 == 49:
+            lines.append(dump({"type": "heartbeat", "product_id": "BTC-USD",
+                               "sequence": i, "last_trade_id": i}))
+    return lines
+
+
+def kraken_checksum(bids, asks):
+    def fmt(value):
+        return value.replace(".", "").lstrip("0")
+
+    text = ""
+    for price, (p, q) in sorted(asks.items())[:10]:
+        text += fmt(p) + fmt(q)
+    for price, (p, q) in sorted(bids.items(), reverse=True)[:10]:
+        text += fmt(p) + fmt(q)
+    return str(zlib.crc32(text.encode()))
+
+
+def kraken():
+    lines = [dump({"event": "systemStatus", "status": "online", "version": "1.9.0"})]
+    books = {}
+    pairs = {"XBT/USD": (336, 43000.0), "ETH/USD": (560, 2250.0)}
+    timestamp = 1_700_000_000.0
+    for pair, (channel, mid) in pairs.items():
+        lines.append(dump({"channelID": channel, "channelName": "book-10", "event":
+                           "subscriptionStatus", "pair": pair, "status": "subscribed",
+                           "subscription": {"depth": 10, "name": "book"}}))
+        bids = {round(mid - i * 0.1, 1): (f"{mid - i * 0.1:.5f}", f"{rng.random() * 5:.8f}")
+                for i in range(1, 11)}
+        asks = {round(mid + i * 0.1, 1): (f"{mid + i * 0.1:.5f}", f"{rng.random() * 5:.8f}")
+                for i in range(1, 11)}
+        books[pair] = (bids, asks)
+        ts = f"{timestamp:.6f}"
+        lines.append(dump([channel, {
+            "as": [[p, q, ts] for _, (p, q) in sorted(asks.items())],
+            "bs": [[p, q, ts] for _, (p, q) in sorted(bids.items(), reverse=True)],
+        }, "book-10", pair]))
+
+    for i in range(FRAMES):
+        pair = "XBT/USD" if i % 2 else "ETH/USD"
+        channel, mid = pairs[pair]
+        bids, asks = books[pair]
+        timestamp += 0.05
+        ts = f"{timestamp:.6f}"
+        sides = {}
+        for side in rng.sample(["a", "b"], rng.randint(1, 2)):
+            book = asks if side == "a" else bids
+            updates = []
+            for _ in range(rng.randint(1, 3)):
+                if book and rng.random() < 0.3:
+                    key = rng.choice(list(book))
+                    updates.append([book[key][0], "0.00000000", ts])
+                    del book[key]
+                else:
+                    offset = rng.randint(1, 12) * 0.1
+                    price = mid + offset if side == "a" else mid - offset
+                    key = round(price, 1)
+                    entry = (f"{price:.5f}", f"{rng.random() * 5:.8f}")
+                    book[key] = entry
+                    updates.append([entry[0], entry[1], ts])
+            # Keep only the subscribed depth
+            for key in (sorted(book) if side == "a" else sorted(book, reverse=True))[10:]:
+                del book[key]
+            sides[side] = updates
+        objects = [{side: updates} for side, updates in sides.items()]
+        objects[-1]["c"] = kraken_checksum(bids, asks)
+        lines.append(dump([channel, *objects, "book-10", pair]))
+        if i % 50 == 49:
+            lines.append(dump({"event": "heartbeat"}))
+    return lines
+
+
+def coinbase_advanced():
+    """Advanced Trade level2: l2_data messages batch several events, sometimes for two
+    products, and every message on the connection carries the next sequence_num."""
+    sequence = 0
+    lines = []
+
+    def message(channel, events, second):
+        nonlocal sequence
+        line = dump({"channel": channel, "client_id": "",
+                     "timestamp": f"2024-01-01T00:{second // 60 % 60:02d}:{second % 60:02d}Z",
+                     "sequence_num": sequence, "events": events})
+        sequence += 1
+        return line
+
+    def level(side, price, size, second):
+        return {"side": side, "event_time": f"2024-01-01T00:00:{second % 60:02d}Z",
+                "price_level": f"{price:.2f}", "new_quantity": f"{size:.8f}"}
+
+    products = {"BTC-USD": 43000.0, "ETH-USD": 2250.0}
+    lines.append(message("subscriptions",
+                         [{"subscriptions": {"level2": list(products)}}], 0))
+    for product, mid in products.items():
+        updates = [level("bid", mid - i * 0.01, rng.random() * 2, 0) for i in range(1, 51)]
+        updates += [level("offer", mid + i * 0.01, rng.random() * 2, 0) for i in range(1, 51)]
+        lines.append(message("l2_data", [{"type": "snapshot", "product_id": product,
+                                          "updates": updates}], 0))
+    for i in range(FRAMES):
+        events = []
+        for product in rng.sample(list(products), 2 if rng.random() < 0.2 else 1):
+            mid = products[product]
+            for _ in range(rng.randint(1, 2)):
+                updates = []
+                for _ in range(rng.randint(1, 5)):
+                    side = rng.choice(["bid", "offer"])
+                    offset = rng.randint(1, 50) * 0.01
+                    price = mid - offset if side == "bid" else mid + offset
+                    size = 0.0 if rng.random() < 0.2 else rng.random() * 2
+                    updates.append(level(side, price, size, i))
+                events.append({"type": "update", "product_id": product, "updates": updates})
+        lines.append(message("l2_data", events, i))
+        if i % 50 == 49:
+            lines.append(message("heartbeats", [{"current_time": "2024-01-01T00:00:00Z",
+                                                 "heartbeat_counter": i // 50}], i))
+    return lines
+
+
+if __name__ == "__main__":
+    # New venues go last so the others keep their random streams
+    for name, generate in (("binance", binance), ("coinbase", coinbase), ("kraken", kraken),
+                           ("coinbase_advanced", coinbase_advanced)):
+        (OUT / f"{name}_book.jsonl").write_text("\n".join(generate()) + "\n")
@@ -0,0 +1,84 @@
+// Per-field cost of converting exchange price/size strings, over every decimal field in the corpus.
+//
+// std::stod is what the adapters used before FrameParser (a std::string temporary per field);
+// from_chars is the previous scanner path; parse_decimal and parse_fixed are the inline parsers.
+
+#include "BenchmarkUtils.hpp"
+#include "exchanges/ExchangeUtils.hpp"
+#include <charconv>
+#include <cstdlib>
+#include <string_view>
+
+using namespace crypto_hft;
+
+namespace {
+
+constexpr int kPasses = 50;
+
+// Every quoted "digits.digits" value in the corpus: the prices and sizes of all book levels
+std::vector<std::string> collectFields() {
+    std::vector<std::string> fields;
+    for (const char* venue : {"binance_book.jsonl", "coinbase_book.jsonl", "kraken_book.jsonl"}) {
+        for (const auto& frame : bench::loadCorpus(venue)) {
+            std::size_t pos = 0;
+            while ((pos = frame.find('"', pos)) != std::string::npos) {
+                std::size_t end = frame.find('"', pos + 1);
+                if (end == std::string::npos) {
+                    break;
+                }
+                std::string_view value(frame.data() + pos + 1, end - pos - 1);
+                if (!value.empty() && value.find('.') != std::string_view::npos &&
+                    value.find_first_not_of("-0123456789.") == std::string_view::npos) {
+                    fields.emplace_back(value);
+                }
+                pos = end + 1;
+            }
+        }
+    }
+    return fields;
+}
+
+template <typename Parse>
+void run(const std::string& name, const std::vector<std::string>& fields, Parse parse) {
+    double sum = 0.0;
+    auto start = bench::Clock::now();
+    for (int pass = 0; pass < kPasses; ++pass) {
+        for (const auto& field : fields) {
+            sum += parse(std::string_view(field));
+        }
+    }
+    double ns = bench::elapsedNs(start);
+    bench::doNotOptimize(sum);
+    bench::report(name, fields.size() * kPasses, ns);
+}
+
+} // namespace
+
+int main() {
+    auto fields = collectFields();
+    std::printf("%zu decimal fields\n", fields.size());
+
+    run("std::stod(std::string)", fields, [](std::string_view text) {
+        return std::stod(std::string(text));
+    });
+    run("strtod", fields, [](std::string_view text) {
+        // Fields are quoted in the frame, so the closing quote terminates the number
+        return std::strtod(text.data(), nullptr);
+    });
+    run("std::from_chars", fields, [](std::string_view text) {
+        double value = 0.0;
+        std::from_chars(text.data(), text.data() + text.size(), value);
+        return value;
+    });
+    run("ExchangeUtils::parse_decimal", fields, [](std::string_view text) {
+        double value = 0.0;
+        ExchangeUtils::parse_decimal(text, value);
+        return value;
+    });
+    run("ExchangeUtils::parse_fixed (scale 8)", fields, [](std::string_view text) {
+        int64_t units = 0;
+        ExchangeUtils::parse_fixed(text, 8, units);
+        return static_cast<double>(units);
+    });
+    return 0;
+}
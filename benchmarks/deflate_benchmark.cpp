@@ -0,0 +1,157 @@
+// permessage-deflate cost on the checked-in corpus: raw parse vs inflate + parse per frame.
+//
+// Frames are compressed the way a venue would (RFC 7692): one deflate stream per connection with
+// a sync flush after every message and the trailing 00 00 ff ff removed, with and without context
+// takeover. The inflate side uses beast::zlib, the same inflater the WebSocket stream runs.
+// Reported per venue: compression ratio, ns/frame for both paths, and the link bandwidth below
+// which the serialization time saved outweighs the extra inflate time (break-even). Links slower
+// than break-even gain latency from compression; faster ones only pay CPU.
+
+#include "BenchmarkUtils.hpp"
+#include "exchanges/FrameParser.hpp"
+#include <boost/beast/zlib/deflate_stream.hpp>
+#include <boost/beast/zlib/inflate_stream.hpp>
+#include <stdexcept>
+
+using namespace crypto_hft;
+namespace zlib = boost::beast::zlib;
+
+namespace {
+
+constexpr int kPasses = 200;
+constexpr unsigned char kTail[] = {0x00, 0x00, 0xff, 0xff};
+
+struct Config {
+    const char* name;
+    int windowBits;
+    bool contextTakeover;
+};
+
+std::vector<std::string> compress(const std::vector<std::string>& frames, const Config& config) {
+    zlib::deflate_stream deflater;
+    deflater.reset(6, config.windowBits, 8, zlib::Strategy::normal);
+    std::vector<std::string> compressed;
+    compressed.reserve(frames.size());
+    for (const auto& frame : frames) {
+        if (!config.contextTakeover) {
+            deflater.reset();
+        }
+        std::string out(deflater.upper_bound(frame.size()) + 16, '\0');
+        zlib::z_params zs;
+        zs.next_in = frame.data();
+        zs.avail_in = frame.size();
+        zs.next_out = out.data();
+        zs.avail_out = out.size();
+        boost::system::error_code ec;
+        deflater.write(zs, zlib::Flush::sync, ec);
+        if (ec || zs.avail_in != 0) {
+            throw std::runtime_error("deflate failed: " + ec.message());
+        }
+        out.resize(zs.total_out - sizeof(kTail));
+        compressed.push_back(std::move(out));
+    }
+    return compressed;
+}
+
+template <typename Parser>
+std::size_t parseAll(const std::vector<std::string>& frames, OrderBookSnapshot& snapshot,
+                     OrderBookDelta& delta) {
+    std::size_t levels = 0;
+    for (const auto& frame : frames) {
+        Parser::parse(frame, snapshot, delta);
+        levels += delta.bidUpdates.size() + delta.askUpdates.size();
+    }
+    return levels;
+}
+
+template <typename Parser>
+std::size_t inflateAll(const std::vector<std::string>& compressed, const Config& config,
+                       std::string& scratch, OrderBookSnapshot& snapshot, OrderBookDelta& delta) {
+    zlib::inflate_stream inflater;
+    inflater.reset(config.windowBits);
+    std::size_t levels = 0;
+    for (const auto& message : compressed) {
+        if (!config.contextTakeover) {
+            inflater.reset(config.windowBits);
+        }
+        zlib::z_params zs;
+        zs.next_out = scratch.data();
+        zs.avail_out = scratch.size();
+        boost::system::error_code ec;
+        for (auto input : {std::string_view(message),
+                           std::string_view(reinterpret_cast<const char*>(kTail), sizeof(kTail))}) {
+            zs.next_in = input.data();
+            zs.avail_in = input.size();
+            inflater.write(zs, zlib::Flush::sync, ec);
+            if (ec && ec != zlib::error::need_buffers && ec != zlib::error::end_of_stream) {
+                throw std::runtime_error("inflate failed: " + ec.message());
+            }
+        }
+        Parser::parse(std::string_view(scratch.data(), zs.total_out), snapshot, delta);
+        levels += delta.bidUpdates.size() + delta.askUpdates.size();
+    }
+    return levels;
+}
+
+template <typename Parser>
+void run(const std::string& venue, const std::string& corpus) {
+    auto frames = bench::loadCorpus(corpus);
+    if (frames.empty()) {
+        std::printf("%s: corpus %s not found\n", venue.c_str(), corpus.c_str());
+        return;
+    }
+    std::size_t rawBytes = 0;
+    std::size_t largest = 0;
+    for (const auto& frame : frames) {
+        rawBytes += frame.size();
+        largest = std::max(largest, frame.size());
+    }
+    OrderBookSnapshot snapshot;
+    OrderBookDelta delta;
+    const auto ops = frames.size() * kPasses;
+
+    auto start = bench::Clock::now();
+    for (int pass = 0; pass < kPasses; ++pass) {
+        bench::doNotOptimize(parseAll<Parser>(frames, snapshot, delta));
+    }
+    double rawNs = bench::elapsedNs(start);
+    bench::report(venue + "/raw parse", ops, rawNs);
+
+    std::string scratch(largest, '\0');
+    for (const Config& config : {Config{"window 15, takeover", 15, true},
+                                 Config{"window 15, no takeover", 15, false},
+                                 Config{"window 10, takeover", 10, true}}) {
+        auto compressed = compress(frames, config);
+        std::size_t compressedBytes = 0;
+        for (const auto& message : compressed) {
+            compressedBytes += message.size();
+        }
+        if (inflateAll<Parser>(compressed, config, scratch, snapshot, delta) !=
+            parseAll<Parser>(frames, snapshot, delta)) {
+            throw std::runtime_error("inflated frames differ from the corpus");
+        }
+
+        start = bench::Clock::now();
+        for (int pass = 0; pass < kPasses; ++pass) {
+            bench::doNotOptimize(inflateAll<Parser>(compressed, config, scratch, snapshot, delta));
+        }
+        double inflateNs = bench::elapsedNs(start);
+        bench::report(venue + "/inflate+parse " + config.name, ops, inflateNs);
+
+        double savedBitsPerFrame =
+            8.0 * static_cast<double>(rawBytes - compressedBytes) / frames.size();
+        double extraNsPerFrame = (inflateNs - rawNs) / static_cast<double>(ops);
+        std::printf("    ratio %.2f (%zu -> %zu bytes), +%.0f ns/frame, break-even %.0f Mbit/s\n",
+                    static_cast<double>(rawBytes) / compressedBytes, rawBytes, compressedBytes,
+                    extraNsPerFrame, savedBitsPerFrame / extraNsPerFrame * 1e3);
+    }
+}
+
+} // namespace
+
+int main() {
+    run<BinanceFrameParser>("binance", "binance_book.jsonl");
+    run<CoinbaseFrameParser>("coinbase", "coinbase_book.jsonl");
+    run<KrakenFrameParser>("kraken", "kraken_book.jsonl");
+    return 0;
+}
@@ -0,0 +1,190 @@
+// Per-venue parse cost on the checked-in corpus: nlohmann DOM path vs the schema-specific scanner.
+//
+// The nlohmann path mirrors what the adapters did before FrameParser: json::parse on every frame,
+// then std::stod over temporary strings for every price and size.
+
+#include "BenchmarkUtils.hpp"
+#include "exchanges/FrameParser.hpp"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+
+using namespace crypto_hft;
+using json = nlohmann::json;
+
+namespace {
+
+constexpr int kPasses = 200;
+
+void jsonLevels(const json& array, std::vector<std::pair<double, double>>& out) {
+    for (const auto& level : array) {
+        out.push_back({std::stod(level[0].get<std::string>()),
+                       std::stod(level[1].get<std::string>())});
+    }
+}
+
+std::size_t jsonBinance(const std::string& frame) {
+    json data = json::parse(frame);
+    if (!data.contains("e") || data["e"] != "depthUpdate") {
+        return 0;
+    }
+    OrderBookDelta delta;
+    delta.symbol = data["s"].get<std::string>();
+    delta.sequence = data["u"].get<uint64_t>();
+    jsonLevels(data["b"], delta.bidUpdates);
+    jsonLevels(data["a"], delta.askUpdates);
+    return delta.bidUpdates.size() + delta.askUpdates.size();
+}
+
+std::size_t jsonCoinbase(const std::string& frame) {
+    json data = json::parse(frame);
+    std::string type = data["type"];
+    if (type == "snapshot") {
+        OrderBookSnapshot snapshot;
+        snapshot.symbol = data["product_id"];
+        jsonLevels(data["bids"], snapshot.bids);
+        jsonLevels(data["asks"], snapshot.asks);
+        return snapshot.bids.size() + snapshot.asks.size();
+    }
+    if (type == "l2update") {
+        OrderBookDelta delta;
+        delta.symbol = data["product_id"];
+        for (const auto& change : data["changes"]) {
+            double price = std::stod(change[1].get<std::string>());
+            double size = std::stod(change[2].get<std::string>());
+            (change[0] == "buy" ? delta.bidUpdates : delta.askUpdates).push_back({price, size});
+        }
+        return delta.bidUpdates.size() + delta.askUpdates.size();
+    }
+    return 0;
+}
+
+// One snapshot or delta per product, as the adapter emits them
+std::size_t jsonCoinbaseAdvanced(const std::string& frame) {
+    json data = json::parse(frame);
+    if (data["channel"] != "l2_data") {
+        return 0;
+    }
+    std::vector<OrderBookDelta> deltas;
+    for (const auto& event : data["events"]) {
+        std::string product = event["product_id"];
+        auto it = std::find_if(deltas.begin(), deltas.end(),
+                               [&](const OrderBookDelta& delta) { return delta.symbol == product; });
+        if (it == deltas.end()) {
+            it = deltas.emplace(deltas.end());
+            it->symbol = product;
+            it->sequence = data["sequence_num"].get<uint64_t>();
+        }
+        for (const auto& update : event["updates"]) {
+            double price = std::stod(update["price_level"].get<std::string>());
+            double size = std::stod(update["new_quantity"].get<std::string>());
+            (update["side"] == "bid" ? it->bidUpdates : it->askUpdates).push_back({price, size});
+        }
+    }
+    std::size_t levels = 0;
+    for (const auto& delta : deltas) {
+        levels += delta.bidUpdates.size() + delta.askUpdates.size();
+    }
+    return levels;
+}
+
+std::size_t jsonKraken(const std::string& frame) {
+    json data = json::parse(frame);
+    if (!data.is_array()) {
+        return 0;
+    }
+    OrderBookDelta delta;
+    delta.symbol = data.back().get<std::string>();
+    for (const auto& element : data) {
+        if (!element.is_object()) {
+            continue;
+        }
+        for (const char* key : {"b", "bs"}) {
+            if (element.contains(key)) {
+                jsonLevels(element[key], delta.bidUpdates);
+            }
+        }
+        for (const char* key : {"a", "as"}) {
+            if (element.contains(key)) {
+                jsonLevels(element[key], delta.askUpdates);
+            }
+        }
+    }
+    return delta.bidUpdates.size() + delta.askUpdates.size();
+}
+
+template <typename Parser>
+std::size_t scan(const std::string& frame, OrderBookSnapshot& snapshot, OrderBookDelta& delta) {
+    switch (Parser::parse(frame, snapshot, delta)) {
+        case FrameType::BookSnapshot:
+            return snapshot.bids.size() + snapshot.asks.size();
+        case FrameType::BookDelta:
+            return delta.bidUpdates.size() + delta.askUpdates.size();
+        default:
+            return 0;
+    }
+}
+
+// Advanced Trade batches several products per message, so it goes through the batch overload
+struct CoinbaseAdvancedParser {};
+
+template <>
+std::size_t scan<CoinbaseAdvancedParser>(const std::string& frame, OrderBookSnapshot&,
+                                         OrderBookDelta&) {
+    static CoinbaseBookBatch batch;
+    CoinbaseFrameParser::parse(frame, batch);
+    std::size_t levels = 0;
+    for (std::size_t i = 0; i < batch.snapshotCount; ++i) {
+        levels += batch.snapshots[i].bids.size() + batch.snapshots[i].asks.size();
+    }
+    for (std::size_t i = 0; i < batch.deltaCount; ++i) {
+        levels += batch.deltas[i].bidUpdates.size() + batch.deltas[i].askUpdates.size();
+    }
+    return levels;
+}
+
+template <typename Parser>
+void benchVenue(const std::string& venue, std::size_t (*jsonPath)(const std::string&)) {
+    auto frames = bench::loadCorpus(venue + "_book.jsonl");
+    std::size_t bytes = 0;
+    for (const auto& frame : frames) {
+        bytes += frame.size();
+    }
+    const std::size_t ops = frames.size() * kPasses;
+
+    std::size_t jsonLevelsSeen = 0;
+    auto start = bench::Clock::now();
+    for (int pass = 0; pass < kPasses; ++pass) {
+        for (const auto& frame : frames) {
+            jsonLevelsSeen += jsonPath(frame);
+        }
+    }
+    double jsonNs = bench::elapsedNs(start);
+
+    OrderBookSnapshot snapshot;
+    OrderBookDelta delta;
+    std::size_t scanLevelsSeen = 0;
+    start = bench::Clock::now();
+    for (int pass = 0; pass < kPasses; ++pass) {
+        for (const auto& frame : frames) {
+            scanLevelsSeen += scan<Parser>(frame, snapshot, delta);
+        }
+    }
+    double scanNs = bench::elapsedNs(start);
+
+    bench::report(venue + "/nlohmann", ops, jsonNs);
+    bench::report(venue + "/scanner", ops, scanNs);
+    std::printf("    %.1f MB/s vs %.1f MB/s, speedup %.2fx, levels %zu/%zu\n",
+                static_cast<double>(bytes * kPasses) / jsonNs * 1e3,
+                static_cast<double>(bytes * kPasses) / scanNs * 1e3,
+                jsonNs / scanNs, jsonLevelsSeen, scanLevelsSeen);
+}
+
+} // namespace
+
+int main() {
+    benchVenue<BinanceFrameParser>("binance", jsonBinance);
+    benchVenue<CoinbaseFrameParser>("coinbase", jsonCoinbase);
+    benchVenue<CoinbaseAdvancedParser>("coinbase_advanced", jsonCoinbaseAdvanced);
+    benchVenue<KrakenFrameParser>("kraken", jsonKraken);
+    return 0;
+}
@@ -0,0 +1,151 @@
+// Throughput of MarketDataEngine delivery at 1, 16 and 256 updates per batch.
+//
+// The first section isolates the dispatch mechanism: a pre-filled queue is drained either one
+// std::function call per update or one call per std::span burst. The second section runs the
+// engine end to end, with a producer thread feeding deltas through the adapter callback.
+
+#include "BenchmarkUtils.hpp"
+#include "core/MarketDataEngine.hpp"
+#include <atomic>
+#include <concurrentqueue.h>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace crypto_hft;
+
+namespace {
+
+constexpr std::size_t kUpdates = 1'000'000;
+constexpr std::size_t kBatchSizes[] = {1, 16, 256};
+
+// Adapter that only hands its delta callback to the benchmark
+class FeedAdapter : public IExchangeAdapter {
+public:
+    bool connect() override { return true; }
+    void disconnect() override {}
+    bool isConnected() const override { return true; }
+    bool subscribe(const std::vector<std::string>&) override { return true; }
+    bool unsubscribe(const std::vector<std::string>&) override { return true; }
+    bool requestOrderBookSnapshot(const std::string&) override { return false; }
+    void registerOrderBookCallback(std::function<void(const OrderBookSnapshot&)>) override {}
+    void registerOrderBookDeltaCallback(std::function<void(const OrderBookDelta&)> cb) override {
+        deltaCallback = std::move(cb);
+    }
+    std::string submitOrder(const OrderRequest&) override { return ""; }
+    bool cancelOrder(const std::string&) override { return false; }
+    bool modifyOrder(const std::string&, double, double) override { return false; }
+    void registerExecutionCallback(std::function<void(const OrderResponse&)>) override {}
+    double getBalance(const std::string&) const override { return 0.0; }
+    std::vector<std::pair<std::string, double>> getAllBalances() const override { return {}; }
+    std::string getName() const override { return "bench"; }
+    bool supportsMargin() const override { return false; }
+    double getFeeRate(const std::string&) const override { return 0.0; }
+
+    std::function<void(const OrderBookDelta&)> deltaCallback;
+};
+
+MarketUpdate makeUpdate(std::size_t i) {
+    MarketUpdate update;
+    update.symbol = "BTCUSDT";
+    update.bidPrice = 50000.0 + static_cast<double>(i % 64);
+    update.bidSize = 1.0;
+    update.askPrice = update.bidPrice + 0.5;
+    update.askSize = 1.0;
+    update.timestamp = static_cast<int64_t>(i);
+    update.isSnapshot = false;
+    return update;
+}
+
+void benchDrain(std::size_t batchSize) {
+    moodycamel::ConcurrentQueue<MarketUpdate> queue;
+    for (std::size_t i = 0; i < kUpdates; ++i) {
+        queue.enqueue(makeUpdate(i));
+    }
+
+    double sum = 0.0;
+    std::vector<MarketUpdate> batch(batchSize);
+    std::function<void(const MarketUpdate&)> perUpdate = [&](const MarketUpdate& u) {
+        sum += u.bidPrice;
+    };
+    MarketDataEngine::BatchCallback perBatch = [&](std::span<const MarketUpdate> updates) {
+        for (const auto& u : updates) {
+            sum += u.bidPrice;
+        }
+    };
+
+    // Per-update callbacks on the first half, span callbacks on the second
+    auto start = bench::Clock::now();
+    std::size_t drained = 0;
+    while (drained < kUpdates / 2) {
+        std::size_t n = queue.try_dequeue_bulk(batch.begin(), batchSize);
+        for (std::size_t i = 0; i < n; ++i) {
+            perUpdate(batch[i]);
+        }
+        drained += n;
+    }
+    bench::report("drain/per_update_callback/batch=" + std::to_string(batchSize), drained,
+                  bench::elapsedNs(start));
+
+    start = bench::Clock::now();
+    std::size_t spanned = 0;
+    while (std::size_t n = queue.try_dequeue_bulk(batch.begin(), batchSize)) {
+        perBatch(std::span<const MarketUpdate>(batch.data(), n));
+        spanned += n;
+    }
+    bench::report("drain/span_callback/batch=" + std::to_string(batchSize), spanned,
+                  bench::elapsedNs(start));
+    bench::doNotOptimize(sum);
+}
+
+void benchEngine(std::size_t batchSize) {
+    auto adapter = std::make_shared<FeedAdapter>();
+    MarketDataEngine engine({adapter});
+    engine.setMaxBatchSize(batchSize);
+
+    std::atomic<std::size_t> received{0};
+    std::atomic<std::size_t> wakeups{0};
+    engine.registerBatchCallback([&](std::span<const MarketUpdate> updates) {
+        received.fetch_add(updates.size(), std::memory_order_relaxed);
+        wakeups.fetch_add(1, std::memory_order_relaxed);
+    });
+    engine.initialize({"BTCUSDT"});
+
+    constexpr std::size_t kEngineUpdates = kUpdates / 4;
+    OrderBookDelta delta;
+    delta.symbol = "BTCUSDT";
+    delta.timestamp = 0;
+
+    auto start = bench::Clock::now();
+    std::thread producer([&]() {
+        for (std::size_t i = 0; i < kEngineUpdates; ++i) {
+            double price = 50000.0 + static_cast<double>(i % 64);
+            delta.bidUpdates = {{price, 1.0}};
+            delta.askUpdates = {{price + 100.0, 1.0}};
+            adapter->deltaCallback(delta);
+        }
+    });
+    producer.join();
+    while (received.load(std::memory_order_relaxed) < kEngineUpdates) {
+        std::this_thread::yield();
+    }
+    double ns = bench::elapsedNs(start);
+    engine.stop();
+
+    bench::report("engine/batch=" + std::to_string(batchSize), kEngineUpdates, ns);
+    std::printf("    mean updates per wake-up: %.1f\n",
+                static_cast<double>(kEngineUpdates) / static_cast<double>(wakeups.load()));
+}
+
+} // namespace
+
+int main() {
+    spdlog::set_level(spdlog::level::warn);
+    for (std::size_t batchSize : kBatchSizes) {
+        benchDrain(batchSize);
+    }
+    for (std::size_t batchSize : kBatchSizes) {
+        benchEngine(batchSize);
+    }
+    return 0;
+}
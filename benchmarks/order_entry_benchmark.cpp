@@ -0,0 +1,190 @@
+// Order-to-ack latency of RestOrderEntry over loopback HTTPS and of WsOrderEntry over a loopback
+// websocket, against stand-in venues that ack every order at once, so what is measured is the
+// client: signing, queueing on the strand, TLS and HTTP or websocket framing, correlating and
+// parsing the ack.
+//
+//   rest/cold        a new client per order: TCP connect and TLS handshake on the order's path
+//   rest/warm        one order at a time over a connection opened by warmUp()
+//   rest/pipelined   `window` orders in flight over two warm connections
+//   ws/warm          one order at a time over an open order session
+//   ws/window        `window` orders in flight on the one session
+
+#include "BenchmarkUtils.hpp"
+#include "LocalHttpsServer.hpp"
+#include "LocalWsServer.hpp"
+#include "exchanges/RestOrderEntry.hpp"
+#include "exchanges/WsOrderEntry.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+using namespace crypto_hft;
+namespace net = boost::asio;
+
+namespace {
+
+constexpr int kColdOrders = 50;
+constexpr int kWarmOrders = 5000;
+
+double percentile(std::vector<int64_t> samples, double p) {
+    if (samples.empty()) {
+        return 0.0;
+    }
+    std::sort(samples.begin(), samples.end());
+    return static_cast<double>(samples[static_cast<std::size_t>(p * (samples.size() - 1))]);
+}
+
+void reportLatency(const std::string& name, const std::vector<int64_t>& samples,
+                   double totalNs) {
+    bench::report(name, samples.size(), totalNs);
+    std::printf("    order-to-ack p50 %.1f us, p99 %.1f us, max %.1f us\n",
+                percentile(samples, 0.50) / 1e3, percentile(samples, 0.99) / 1e3,
+                percentile(samples, 1.0) / 1e3);
+}
+
+OrderRequest order(int i) {
+    OrderRequest request;
+    request.symbol = "BTCUSDT";
+    request.side = i % 2 ? OrderRequest::Side::SELL : OrderRequest::Side::BUY;
+    request.type = OrderRequest::Type::LIMIT;
+    request.price = 42000.0 + i % 100;
+    request.size = 0.001;
+    request.clientOrderId = "bench-" + std::to_string(i);
+    return request;
+}
+
+HttpsClient::Options options(const LocalHttpsServer& server, std::size_t connections) {
+    HttpsClient::Options options;
+    options.host = "localhost";
+    options.port = server.port();
+    options.connections = connections;
+    options.warmConnections = connections;
+    options.pipelineDepth = 16;
+    options.verifyPeer = false;
+    return options;
+}
+
+void cold(const LocalHttpsServer& server) {
+    std::vector<int64_t> samples;
+    auto start = bench::Clock::now();
+    for (int i = 0; i < kColdOrders; ++i) {
+        net::io_context ioc;
+        auto work = net::make_work_guard(ioc);
+        std::thread thread([&] { ioc.run(); });
+        auto client = HttpsClient::create(ioc, options(server, 1), nullptr);
+        {
+            BinanceRestOrderEntry entry(client, {"key", "secret"});
+            samples.push_back(entry.submit(order(i)).get().latency.count());
+        }
+        client->shutdown();
+        work.reset();
+        thread.join();
+    }
+    reportLatency("rest/cold", samples, bench::elapsedNs(start));
+}
+
+// Sends kWarmOrders orders through entry with at most window in flight
+template <typename Entry>
+std::vector<int64_t> run(Entry& entry, int window, double& totalNs) {
+    for (int i = 0; i < 100; ++i) {
+        entry.submit(order(i)).get();
+    }
+
+    std::mutex mutex;
+    std::condition_variable done;
+    std::vector<int64_t> samples;
+    samples.reserve(kWarmOrders);
+    int inFlight = 0;
+    auto start = bench::Clock::now();
+    for (int i = 0; i < kWarmOrders; ++i) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            done.wait(lock, [&] { return inFlight < window; });
+            ++inFlight;
+        }
+        entry.submit(order(i), [&](OrderAck ack) {
+            std::lock_guard<std::mutex> lock(mutex);
+            samples.push_back(ack.ok() ? ack.latency.count() : 0);
+            --inFlight;
+            done.notify_one();
+        });
+    }
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [&] { return inFlight == 0; });
+    }
+    totalNs = bench::elapsedNs(start);
+    return samples;
+}
+
+void pipelined(const LocalHttpsServer& server, std::size_t connections, int window) {
+    net::io_context ioc;
+    auto work = net::make_work_guard(ioc);
+    std::thread thread([&] { ioc.run(); });
+    auto client = HttpsClient::create(ioc, options(server, connections), nullptr);
+    client->warmUp();
+    BinanceRestOrderEntry entry(client, {"key", "secret"});
+    double totalNs = 0.0;
+    std::vector<int64_t> samples = run(entry, window, totalNs);
+
+    client->shutdown();
+    work.reset();
+    thread.join();
+    reportLatency(window == 1 ? std::string("rest/warm")
+                              : "rest/pipelined x" + std::to_string(window), samples, totalNs);
+}
+
+void websocket(const LocalWsServer& server, int window) {
+    net::io_context ioc;
+    auto work = net::make_work_guard(ioc);
+    std::thread thread([&] { ioc.run(); });
+    net::ssl::context ctx(net::ssl::context::tls_client);
+    ctx.set_verify_mode(net::ssl::verify_none);
+
+    WsOrderEntry::Options options;
+    options.host = "localhost";
+    options.port = server.port();
+    double totalNs = 0.0;
+    std::vector<int64_t> samples;
+    {
+        BinanceWsOrderEntry entry(ioc, ctx, {"key", "secret"}, options);
+        entry.start();
+        if (!entry.waitForOpen(std::chrono::seconds(5))) {
+            std::fprintf(stderr, "order session did not open\n");
+        }
+        samples = run(entry, window, totalNs);
+    }
+
+    work.reset();
+    thread.join();
+    reportLatency(window == 1 ? std::string("ws/warm")
+                              : "ws/window x" + std::to_string(window), samples, totalNs);
+}
+
+} // namespace
+
+int main() {
+    LocalHttpsServer server([](const LocalHttpsServer::Request& request) {
+        return LocalHttpsServer::reply(request, 200,
+            R"({"symbol":"BTCUSDT","orderId":1,"clientOrderId":"x","transactTime":1})");
+    });
+
+    // Echoes the request id into a fixed ack, as cheaply as the HTTPS stand-in answers
+    LocalWsServer wsServer([](const std::string& message) -> std::vector<std::string> {
+        std::size_t start = message.find("\"id\":") + 5;
+        std::string id = message.substr(start, message.find(',', start) - start);
+        return {R"({"id":)" + id + R"(,"status":200,"result":{"symbol":"BTCUSDT","orderId":1,)"
+                R"("clientOrderId":"x","transactTime":1}})"};
+    });
+
+    cold(server);
+    pipelined(server, 1, 1);
+    pipelined(server, 2, 8);
+    pipelined(server, 2, 32);
+    websocket(wsServer, 1);
+    websocket(wsServer, 8);
+    websocket(wsServer, 32);
+    return 0;
+}
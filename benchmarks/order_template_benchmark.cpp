@@ -0,0 +1,176 @@
+// Per-order cost of serializing websocket order requests: limit, market and cancel, for Binance
+// (signed with HMAC-SHA256 over the sorted parameters) and Kraken (carrying a session token).
+//
+// "json + dump()" builds each request as an nlohmann::json object and dumps it, which allocates
+// for every key and value; the template rows render from BinanceOrderMessages and
+// KrakenOrderMessages into a buffer reused from one order to the next. Binance rows include the
+// signature, which both paths compute with the same HmacSigner.
+
+#include "BenchmarkUtils.hpp"
+#include "exchanges/OrderTemplate.hpp"
+#include <nlohmann/json.hpp>
+#include <charconv>
+#include <string>
+
+using namespace crypto_hft;
+using json = nlohmann::json;
+
+namespace {
+
+constexpr int kIterations = 200000;
+constexpr int64_t kTimestamp = 1700000000000;
+
+const std::string kApiKey = "vmPUZE6mv9SD5VNHk4HlWFsOr6aKE2zvsw0MuIgwCIPy6utIco14y7Ju91duEh8A";
+const std::string kSecret = "NhqPtmdSJYdKjVHjA7PZj4Mge3R5YNiP1e3UZjInClVN65XAbvqqM6A7H5fATj0j";
+const std::string kToken = "1Dwc4lzSwNWOAwkMdqhssNNFhs1ed606d1WcF3XfEMw";
+
+OrderRequest makeOrder(std::string symbol, OrderRequest::Type type) {
+    OrderRequest order;
+    order.symbol = std::move(symbol);
+    order.side = OrderRequest::Side::BUY;
+    order.type = type;
+    order.price = 43000.1;
+    order.size = 0.015;
+    order.clientOrderId = "hft-1700000000000-42";
+    return order;
+}
+
+std::string decimal(double value) {
+    char buffer[64];
+    auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), value,
+                                   std::chars_format::fixed);
+    return ec == std::errc() ? std::string(buffer, end) : std::string("0");
+}
+
+// nlohmann objects keep their keys sorted, which is the order Binance signs them in
+std::string binanceJson(uint64_t id, const char* method, json params,
+                        const ExchangeUtils::HmacSigner& signer) {
+    params["apiKey"] = kApiKey;
+    params["recvWindow"] = 5000;
+    params["timestamp"] = kTimestamp;
+    std::string payload;
+    for (const auto& [key, value] : params.items()) {
+        if (!payload.empty()) {
+            payload += '&';
+        }
+        payload += key;
+        payload += '=';
+        payload += value.is_string() ? value.get<std::string>() : value.dump();
+    }
+    char signature[ExchangeUtils::HmacSigner::kMaxHexSize];
+    params["signature"] = std::string(signature, signer.sign_hex(payload, signature));
+    return json{{"id", id}, {"method", method}, {"params", std::move(params)}}.dump();
+}
+
+json binanceOrderParams(const OrderRequest& order) {
+    json params = {{"symbol", order.symbol},
+                   {"side", "BUY"},
+                   {"quantity", decimal(order.size)},
+                   {"newClientOrderId", order.clientOrderId},
+                   {"newOrderRespType", "ACK"}};
+    if (order.type == OrderRequest::Type::LIMIT) {
+        params["type"] = "LIMIT";
+        params["timeInForce"] = "GTC";
+        params["price"] = decimal(order.price);
+    } else {
+        params["type"] = "MARKET";
+    }
+    return params;
+}
+
+json krakenOrder(uint64_t id, const OrderRequest& order) {
+    json request = {{"event", "addOrder"},
+                    {"token", kToken},
+                    {"reqid", id},
+                    {"ordertype", order.type == OrderRequest::Type::LIMIT ? "limit" : "market"},
+                    {"type", "buy"},
+                    {"pair", order.symbol},
+                    {"volume", decimal(order.size)}};
+    if (order.type == OrderRequest::Type::LIMIT) {
+        request["price"] = decimal(order.price);
+    }
+    return request;
+}
+
+template <typename Serialize>
+void run(const std::string& name, Serialize serialize) {
+    std::size_t total = 0;
+    auto start = bench::Clock::now();
+    for (int i = 0; i < kIterations; ++i) {
+        total += serialize(static_cast<uint64_t>(i));
+    }
+    double ns = bench::elapsedNs(start);
+    bench::doNotOptimize(total);
+    bench::report(name, kIterations, ns);
+}
+
+} // namespace
+
+int main() {
+    const OrderRequest binanceLimit = makeOrder("BTCUSDT", OrderRequest::Type::LIMIT);
+    const OrderRequest binanceMarket = makeOrder("BTCUSDT", OrderRequest::Type::MARKET);
+    const OrderRequest krakenLimit = makeOrder("XBT/USD", OrderRequest::Type::LIMIT);
+    const OrderRequest krakenMarket = makeOrder("XBT/USD", OrderRequest::Type::MARKET);
+    ExchangeUtils::HmacSigner signer(ExchangeUtils::HmacSigner::Digest::SHA256, kSecret);
+    BinanceOrderMessages binance(kApiKey, kSecret);
+    KrakenOrderMessages kraken;
+    std::string buffer;
+
+    std::printf("Binance order.place / order.cancel, signed\n");
+    run("limit: json + dump()", [&](uint64_t id) {
+        return binanceJson(id, "order.place", binanceOrderParams(binanceLimit), signer).size();
+    });
+    run("limit: template", [&](uint64_t id) {
+        buffer.clear();
+        binance.place(id, binanceLimit, kTimestamp, buffer);
+        return buffer.size();
+    });
+    run("market: json + dump()", [&](uint64_t id) {
+        return binanceJson(id, "order.place", binanceOrderParams(binanceMarket), signer).size();
+    });
+    run("market: template", [&](uint64_t id) {
+        buffer.clear();
+        binance.place(id, binanceMarket, kTimestamp, buffer);
+        return buffer.size();
+    });
+    run("cancel: json + dump()", [&](uint64_t id) {
+        json params = {{"symbol", "BTCUSDT"}, {"orderId", 28}};
+        return binanceJson(id, "order.cancel", std::move(params), signer).size();
+    });
+    run("cancel: template", [&](uint64_t id) {
+        buffer.clear();
+        binance.cancel(id, binanceLimit.symbol, "28", kTimestamp, buffer);
+        return buffer.size();
+    });
+
+    std::printf("\nKraken addOrder / cancelOrder\n");
+    run("limit: json + dump()", [&](uint64_t id) {
+        return krakenOrder(id, krakenLimit).dump().size();
+    });
+    run("limit: template", [&](uint64_t id) {
+        buffer.clear();
+        kraken.place(id, krakenLimit, kToken, buffer);
+        return buffer.size();
+    });
+    run("market: json + dump()", [&](uint64_t id) {
+        return krakenOrder(id, krakenMarket).dump().size();
+    });
+    run("market: template", [&](uint64_t id) {
+        buffer.clear();
+        kraken.place(id, krakenMarket, kToken, buffer);
+        return buffer.size();
+    });
+    run("cancel: json + dump()", [&](uint64_t id) {
+        json request = {{"event", "cancelOrder"},
+                        {"token", kToken},
+                        {"reqid", id},
+                        {"txid", json::array({"OUF4EM-FRGI2-MQMWZD"})}};
+        return request.dump().size();
+    });
+    run("cancel: template", [&](uint64_t id) {
+        buffer.clear();
+        kraken.cancel(id, "OUF4EM-FRGI2-MQMWZD", kToken, buffer);
+        return buffer.size();
+    });
+    return 0;
+}
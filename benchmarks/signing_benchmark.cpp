@@ -0,0 +1,144 @@
+// Per-request cost of signing an order, for Binance's HMAC-SHA256 over the query string (hex)
+// and Kraken's HMAC-SHA512 over path + SHA-256(nonce + body) (base64).
+//
+// "HMAC()" is the one-shot call the order entry paths used before, keying a fresh context every
+// time; "EVP_MAC per request" fetches, keys and frees an EVP_MAC_CTX per signature, which is what
+// a signing function taking the key as an argument has to do; HmacSigner keys once and
+// duplicates the keyed context, writing into a stack buffer.
+
+#include "BenchmarkUtils.hpp"
+#include "exchanges/ExchangeUtils.hpp"
+#include <openssl/core_names.h>
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <openssl/sha.h>
+#include <string_view>
+
+using namespace crypto_hft;
+
+namespace {
+
+constexpr int kIterations = 200000;
+
+const std::string kBinanceSecret =
+    "NhqPtmdSJYdKjVHjA7PZj4Mge3R5YNiP1e3UZjInClVN65XAbvqqM6A7H5fATj0j";
+const std::string kBinanceQuery =
+    "symbol=BTCUSDT&side=BUY&type=LIMIT&timeInForce=GTC&quantity=0.01&price=43000.1"
+    "&newClientOrderId=hft-1700000000000-42&recvWindow=5000&timestamp=1700000000000";
+
+// 64 bytes, as Kraken's secrets decode to
+const std::string kKrakenSecret = ExchangeUtils::base64_decode(
+    "kQH5HW/8p1uGOVjbgWA7FunAmGO8lsSUXNsu3eow76sz84Q18fWxnyRzBHCd3pd5nE9qa99HAZtuZuj6F1huXg==");
+const std::string kKrakenPath = "/0/private/AddOrder";
+const std::string kKrakenNonce = "1700000000000000";
+const std::string kKrakenBody =
+    "nonce=1700000000000000&ordertype=limit&type=buy&volume=0.01&pair=XBTUSD&price=43000.1";
+
+template <typename Sign>
+void run(const std::string& name, Sign sign) {
+    std::size_t total = 0;
+    auto start = bench::Clock::now();
+    for (int i = 0; i < kIterations; ++i) {
+        total += sign();
+    }
+    double ns = bench::elapsedNs(start);
+    bench::doNotOptimize(total);
+    bench::report(name, kIterations, ns);
+}
+
+std::string hex(const unsigned char* bytes, std::size_t size) {
+    static constexpr char kHex[] = "0123456789abcdef";
+    std::string out;
+    out.reserve(size * 2);
+    for (std::size_t i = 0; i < size; ++i) {
+        out += kHex[bytes[i] >> 4];
+        out += kHex[bytes[i] & 0xF];
+    }
+    return out;
+}
+
+std::size_t evpMacOnce(const char* digest, const std::string& key,
+                       std::initializer_list<std::string_view> parts, unsigned char* out) {
+    EVP_MAC* mac = EVP_MAC_fetch(nullptr, "HMAC", nullptr);
+    EVP_MAC_CTX* ctx = EVP_MAC_CTX_new(mac);
+    OSSL_PARAM params[] = {
+        OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_DIGEST, const_cast<char*>(digest), 0),
+        OSSL_PARAM_construct_end()};
+    EVP_MAC_init(ctx, reinterpret_cast<const unsigned char*>(key.data()), key.size(), params);
+    for (std::string_view part : parts) {
+        EVP_MAC_update(ctx, reinterpret_cast<const unsigned char*>(part.data()), part.size());
+    }
+    std::size_t length = 0;
+    EVP_MAC_final(ctx, out, &length, EVP_MAX_MD_SIZE);
+    EVP_MAC_CTX_free(ctx);
+    EVP_MAC_free(mac);
+    return length;
+}
+
+// The part of Kraken's signed text that changes per request: SHA-256(nonce + body)
+void krakenDigest(unsigned char* digest) {
+    std::string noncedBody = kKrakenNonce + kKrakenBody;
+    SHA256(reinterpret_cast<const unsigned char*>(noncedBody.data()), noncedBody.size(), digest);
+}
+
+} // namespace
+
+int main() {
+    std::printf("Binance: HMAC-SHA256 of a %zu byte query, hex\n", kBinanceQuery.size());
+    run("HMAC() + std::string hex", [] {
+        unsigned char mac[EVP_MAX_MD_SIZE];
+        unsigned int length = 0;
+        HMAC(EVP_sha256(), kBinanceSecret.data(), static_cast<int>(kBinanceSecret.size()),
+             reinterpret_cast<const unsigned char*>(kBinanceQuery.data()), kBinanceQuery.size(),
+             mac, &length);
+        return hex(mac, length).size();
+    });
+    run("EVP_MAC per request + std::string hex", [] {
+        unsigned char mac[EVP_MAX_MD_SIZE];
+        std::size_t length = evpMacOnce("SHA256", kBinanceSecret, {kBinanceQuery}, mac);
+        return hex(mac, length).size();
+    });
+    run("ExchangeUtils::generate_hmac_sha256", [] {
+        return ExchangeUtils::generate_hmac_sha256(kBinanceSecret, kBinanceQuery).size();
+    });
+    ExchangeUtils::HmacSigner binance(ExchangeUtils::HmacSigner::Digest::SHA256, kBinanceSecret);
+    run("HmacSigner::sign_hex", [&binance] {
+        char out[ExchangeUtils::HmacSigner::kMaxHexSize];
+        return binance.sign_hex(kBinanceQuery, out);
+    });
+
+    std::printf("\nKraken: HMAC-SHA512 of path + SHA-256(nonce + body), base64\n");
+    run("SHA256 + HMAC() + std::string base64", [] {
+        unsigned char digest[SHA256_DIGEST_LENGTH];
+        krakenDigest(digest);
+        std::string signedText = kKrakenPath;
+        signedText.append(reinterpret_cast<const char*>(digest), sizeof(digest));
+        unsigned char mac[EVP_MAX_MD_SIZE];
+        unsigned int length = 0;
+        HMAC(EVP_sha512(), kKrakenSecret.data(), static_cast<int>(kKrakenSecret.size()),
+             reinterpret_cast<const unsigned char*>(signedText.data()), signedText.size(), mac,
+             &length);
+        return ExchangeUtils::base64_encode(std::string(reinterpret_cast<char*>(mac), length))
+            .size();
+    });
+    run("SHA256 + EVP_MAC per request + base64", [] {
+        unsigned char digest[SHA256_DIGEST_LENGTH];
+        krakenDigest(digest);
+        unsigned char mac[EVP_MAX_MD_SIZE];
+        std::size_t length = evpMacOnce(
+            "SHA512", kKrakenSecret,
+            {kKrakenPath, std::string_view(reinterpret_cast<char*>(digest), sizeof(digest))}, mac);
+        char encoded[ExchangeUtils::HmacSigner::kMaxBase64Size + 1];
+        return static_cast<std::size_t>(EVP_EncodeBlock(reinterpret_cast<unsigned char*>(encoded),
+                                                        mac, static_cast<int>(length)));
+    });
+    ExchangeUtils::HmacSigner kraken(ExchangeUtils::HmacSigner::Digest::SHA512, kKrakenSecret);
+    run("SHA256 + HmacSigner::sign_base64", [&kraken] {
+        unsigned char digest[SHA256_DIGEST_LENGTH];
+        krakenDigest(digest);
+        char out[ExchangeUtils::HmacSigner::kMaxBase64Size];
+        return kraken.sign_base64(
+            {kKrakenPath, std::string_view(reinterpret_cast<char*>(digest), sizeof(digest))}, out);
+    });
+    return 0;
+}
@@ -1,4 +1,5 @@
 #include "MarketDataEngine.hpp"
+#include <algorithm>
 #include <spdlog/spdlog.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
 
@@ -6,7 +7,10 @@ namespace crypto_hft {
 
 MarketDataEngine::MarketDataEngine(std::vector<std::shared_ptr<IExchangeAdapter>> adapters) 
     : adapters_(adapters), running_(false) {
-    logger_ = spdlog::stdout_color_mt("market_data_engine");
+    logger_ = spdlog::get("market_data_engine");
+    if (!logger_) {
+        logger_ = spdlog::stdout_color_mt("market_data_engine");
+    }
     logger_->set_level(spdlog::level::debug);
 }
 
@@ -37,6 +41,10 @@ void MarketDataEngine::initialize(const std::vector<std::string>& symbols) {
         adapter->registerOrderBookDeltaCallback([this](const OrderBookDelta& delta) {
             handleOrderBookDelta(delta);
         });
+
+        adapter->registerTopOfBookCallback([this](const TopOfBookUpdate& quote) {
+            handleTopOfBook(quote);
+        });
     }
 
     // Start processing threads
@@ -71,6 +79,14 @@ void MarketDataEngine::registerCallback(std::function<void(const MarketUpdate&)>
     updateCallback_ = std::move(callback);
 }
 
+void MarketDataEngine::registerBatchCallback(BatchCallback callback) {
+    batchCallback_ = std::move(callback);
+}
+
+void MarketDataEngine::setMaxBatchSize(std::size_t maxBatchSize) {
+    maxBatchSize_ = std::clamp<std::size_t>(maxBatchSize, 1, kMaxBatchSize);
+}
+
 std::shared_ptr<OrderBook> MarketDataEngine::getOrderBook(const std::string& symbol) {
     std::lock_guard<std::mutex> lock(orderBooksMutex_);
     auto it = orderBooks_.find(symbol);
@@ -93,12 +109,18 @@ void MarketDataEngine::receiverThread(std::shared_ptr<IExchangeAdapter> adapter)
 void MarketDataEngine::dispatcherThread() {
     logger_->info("Started dispatcher thread");
     
-    MarketUpdate update;
+    // Drain in bursts so consumers pay one indirect call per wake-up, not per update
+    std::vector<MarketUpdate> batch(kMaxBatchSize);
     while (running_) {
-        if (updateQueue_.try_dequeue(update)) {
+        std::size_t count = updateQueue_.try_dequeue_bulk(batch.begin(), maxBatchSize_.load());
+        if (count > 0) {
             // Notify subscribers
-            if (updateCallback_) {
-                updateCallback_(update);
+            if (batchCallback_) {
+                batchCallback_(std::span<const MarketUpdate>(batch.data(), count));
+            } else if (updateCallback_) {
+                for (std::size_t i = 0; i < count; ++i) {
+                    updateCallback_(batch[i]);
+                }
             }
         } else {
             // Avoid busy waiting
@@ -128,11 +150,14 @@ void MarketDataEngine::handleOrderBookSnapshot(const OrderBookSnapshot& snapshot
 
     // Update order book
     orderBook->setSnapshot(bids, asks);
+    orderBook->setUpdateId(snapshot.sequence);
 
     // Create market update
     MarketUpdate update;
     update.symbol = snapshot.symbol;
     update.timestamp = snapshot.timestamp;
+    update.exchangeTimeLocal = snapshot.exchangeTimeLocal;
+    update.receiveTime = snapshot.receiveTime;
     update.isSnapshot = true;
     
     if (!bids.empty()) {
@@ -173,18 +198,49 @@ void MarketDataEngine::handleOrderBookDelta(const OrderBookDelta& delta) {
         }
     }
 
-    // Create market update
+    if (delta.sequence != 0) {
+        orderBook->setUpdateId(delta.sequence);
+    }
+
+    // Create market update; a top-of-book quote newer than this delta still wins
+    auto top = orderBook->getTop();
     MarketUpdate update;
     update.symbol = delta.symbol;
     update.timestamp = delta.timestamp;
+    update.exchangeTimeLocal = delta.exchangeTimeLocal;
+    update.receiveTime = delta.receiveTime;
     update.isSnapshot = false;
-    update.bidPrice = orderBook->getBestBid();
-    update.askPrice = orderBook->getBestAsk();
-    update.bidSize = orderBook->getBidVolume(update.bidPrice);
-    update.askSize = orderBook->getAskVolume(update.askPrice);
+    update.bidPrice = top.bidPrice;
+    update.askPrice = top.askPrice;
+    update.bidSize = top.bidSize;
+    update.askSize = top.askSize;
 
     // Queue update for dispatcher
     updateQueue_.enqueue(update);
 }
 
+void MarketDataEngine::handleTopOfBook(const TopOfBookUpdate& quote) {
+    auto orderBook = getOrderBook(quote.symbol);
+    if (!orderBook) {
+        return;
+    }
+    // Redundant sessions deliver the same quote more than once; only the first is newer
+    if (!orderBook->applyTopOfBook(quote.bidPrice, quote.bidSize, quote.askPrice, quote.askSize,
+                                   quote.sequence)) {
+        return;
+    }
+
+    MarketUpdate update;
+    update.symbol = quote.symbol;
+    update.timestamp = quote.timestamp;
+    update.exchangeTimeLocal = quote.exchangeTimeLocal;
+    update.receiveTime = quote.receiveTime;
+    update.isSnapshot = false;
+    update.bidPrice = quote.bidPrice;
+    update.bidSize = quote.bidSize;
+    update.askPrice = quote.askPrice;
+    update.askSize = quote.askSize;
+    updateQueue_.enqueue(update);
+}
+
 } // namespace crypto_hft 
\ No newline at end of file
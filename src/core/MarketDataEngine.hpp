@@ -6,6 +6,7 @@
 #include <unordered_map>
 #include <atomic>
 #include <functional>
+#include <span>
 #include <thread>
 #include <concurrentqueue.h>
 #include <spdlog/spdlog.h>
@@ -23,16 +24,28 @@ struct MarketUpdate {
     double askSize;
     int64_t timestamp;
     bool isSnapshot;
+    // From the book event: venue event time on the local steady clock (0 until the venue's
+    // clock offset is estimated or if the venue sends none) and local receive time, both ns
+    int64_t exchangeTimeLocal = 0;
+    int64_t receiveTime = 0;
 };
 
 class MarketDataEngine {
 public:
+    using BatchCallback = std::function<void(std::span<const MarketUpdate>)>;
+
+    // Upper bound on updates handed to a batch callback per wake-up
+    static constexpr std::size_t kMaxBatchSize = 256;
+
     explicit MarketDataEngine(std::vector<std::shared_ptr<IExchangeAdapter>> adapters);
     ~MarketDataEngine();
 
     void initialize(const std::vector<std::string>& symbols);
     void stop();
     void registerCallback(std::function<void(const MarketUpdate&)> callback);
+    // Receive every drained burst at once; takes precedence over the per-update callback
+    void registerBatchCallback(BatchCallback callback);
+    void setMaxBatchSize(std::size_t maxBatchSize);
     std::shared_ptr<OrderBook> getOrderBook(const std::string& symbol);
     const std::function<void(const MarketUpdate&)>& getUpdateCallback() const { return updateCallback_; }
 
@@ -42,6 +55,7 @@ private:
     void dispatcherThread();
     void handleOrderBookSnapshot(const OrderBookSnapshot& snapshot);
     void handleOrderBookDelta(const OrderBookDelta& delta);
+    void handleTopOfBook(const TopOfBookUpdate& quote);
 
     // Exchange adapters
     std::vector<std::shared_ptr<IExchangeAdapter>> adapters_;
@@ -52,8 +66,10 @@ private:
     // Lock-free queue for market updates
     moodycamel::ConcurrentQueue<MarketUpdate> updateQueue_;
     
-    // Callback for market updates
+    // Callbacks for market updates
     std::function<void(const MarketUpdate&)> updateCallback_;
+    BatchCallback batchCallback_;
+    std::atomic<std::size_t> maxBatchSize_{kMaxBatchSize};
     
     // Thread management
     std::vector<std::thread> receiverThreads_;
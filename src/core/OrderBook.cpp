@@ -41,15 +41,61 @@ void OrderBook::clear() {
     std::unique_lock<std::shared_mutex> lock(m);
     bids.clear();
     asks.clear();
+    updateId_ = 0;
+    quoteUpdateId_ = 0;
+}
+
+void OrderBook::setUpdateId(uint64_t updateId) {
+    std::unique_lock<std::shared_mutex> lock(m);
+    updateId_ = updateId;
+}
+
+uint64_t OrderBook::getUpdateId() const {
+    std::shared_lock<std::shared_mutex> lock(m);
+    return updateId_;
+}
+
+bool OrderBook::applyTopOfBook(double bidPrice, double bidSize, double askPrice, double askSize,
+                               uint64_t updateId) {
+    std::unique_lock<std::shared_mutex> lock(m);
+    if (updateId <= updateId_ || updateId <= quoteUpdateId_) {
+        return false;
+    }
+    quote_ = Top{bidPrice, bidSize, askPrice, askSize, true};
+    quoteUpdateId_ = updateId;
+    return true;
+}
+
+OrderBook::Top OrderBook::getTop() const {
+    std::shared_lock<std::shared_mutex> lock(m);
+    if (quoteIsAhead()) {
+        return quote_;
+    }
+    Top top;
+    if (!bids.empty()) {
+        top.bidPrice = bids.begin()->first;
+        top.bidSize = bids.begin()->second;
+    }
+    if (!asks.empty()) {
+        top.askPrice = asks.begin()->first;
+        top.askSize = asks.begin()->second;
+    }
+    return top;
 }
 
 double OrderBook::getBestBid() const {
     std::shared_lock<std::shared_mutex> lock(m);
+    if (quoteIsAhead()) {
+        return quote_.bidPrice;
+    }
     return bids.empty() ? 0.0 : bids.begin()->first;
 }
 
 double OrderBook::getBestAsk() const {
     std::shared_lock<std::shared_mutex> lock(m);
+    if (quoteIsAhead()) {
+        return quote_.askPrice;
+    }
     return asks.empty() ? 0.0 : asks.begin()->first;
 }
 
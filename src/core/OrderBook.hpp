@@ -1,6 +1,7 @@
 #pragma once
 
 #include <map>
+#include <cstdint>
 #include <atomic>
 #include <memory>
 #include <string>
@@ -36,6 +37,26 @@ public:
     void clear();
     void setSnapshot(const std::map<double, double>& bids, 
                     const std::map<double, double>& asks);
+
+    // Venue update id of the last depth update or snapshot applied; 0 if the venue has none
+    void setUpdateId(uint64_t updateId);
+    uint64_t getUpdateId() const;
+
+    // Best bid/offer from a top-of-book stream that runs ahead of the depth stream. While its
+    // update id is newer than the levels' it takes precedence in getBestBid()/getBestAsk() and
+    // getTop(); a depth update reaching that id reconciles the book back onto its levels.
+    // Returns false, ignoring the quote, if the book is already as new.
+    bool applyTopOfBook(double bidPrice, double bidSize, double askPrice, double askSize,
+                        uint64_t updateId);
+
+    struct Top {
+        double bidPrice = 0.0;
+        double bidSize = 0.0;
+        double askPrice = 0.0;
+        double askSize = 0.0;
+        bool fromQuote = false;  // Served by the top-of-book stream rather than the levels
+    };
+    Top getTop() const;
     
     std::map<double, double> getBids() const;
     std::map<double, double> getAsks() const;
@@ -46,6 +67,11 @@ private:
     mutable std::shared_mutex m;
     std::map<double, double, std::greater<double>> bids;
     std::map<double, double> asks;
+    uint64_t updateId_ = 0;
+    Top quote_;
+    uint64_t quoteUpdateId_ = 0;
+
+    bool quoteIsAhead() const { return quoteUpdateId_ > updateId_; }
     
     // void atomicUpdate(std::atomic<std::shared_ptr<std::map<double, double, std::greater<double>>>>& book,
     //                  double price, double size, bool isRemove);
@@ -1,11 +1,96 @@
 #include "TradingSystem.hpp"
 #include "exchanges/CoinbaseAdapter.hpp"
+#include "exchanges/HttpsClient.hpp"
+#include "exchanges/RateLimiter.hpp"
+#include "exchanges/RedundantFeedAdapter.hpp"
+#include "exchanges/SymbolSharder.hpp"
+#include "infra/MetricsReporter.hpp"
 // #include "exchanges/KrakenAdapter.hpp"
 // #include "exchanges/BinanceAdapter.hpp"
 #include <spdlog/spdlog.h>
+#include <algorithm>
 
 namespace crypto_hft {
 
+namespace {
+
+// Builds one adapter per configured redundant session; more than one is wrapped in an arbiter
+template <typename Adapter>
+std::shared_ptr<IExchangeAdapter> makeAdapter(const ConfigManager& config, const std::string& venue,
+                                              const std::shared_ptr<AdapterRuntime>& runtime)
+{
+    int sessions = config.getInt("exchanges." + venue + ".redundant_sessions", 1);
+    bool hotStandby = config.getBool("exchanges." + venue + ".hot_standby", false);
+    std::chrono::milliseconds pingInterval(
+        config.getInt("exchanges." + venue + ".health.ping_interval_ms", 5000));
+    std::chrono::milliseconds maxRoundTrip(
+        config.getInt("exchanges." + venue + ".health.max_rtt_ms", 0));
+    auto slowRoundTrips = static_cast<unsigned>(
+        std::max(config.getInt("exchanges." + venue + ".health.slow_rtts", 3), 1));
+    auto profile = ConnectionProfile::fromYaml(config.getNode("exchanges." + venue + ".connection"));
+    auto sharding =
+        SymbolSharder::Config::fromYaml(config.getNode("exchanges." + venue + ".sharding"));
+    // One pooled REST client per venue, shared by its redundant sessions so they draw on the
+    // same request weight budget and keep-alive connections
+    std::shared_ptr<HttpsClient> rest;
+    if constexpr (requires { Adapter::restDefaults(); }) {
+        auto options = HttpsClient::Options::fromYaml(
+            config.getNode("exchanges." + venue + ".rest"), Adapter::restDefaults());
+        options.profile = profile;
+        // The venue's request weight limits replace the client's own weight_per_second budget;
+        // REST order entry on this client spends from the same limiter
+        auto requests =
+            RateLimiter::fromYaml(config.getNode("exchanges." + venue + ".rate_limit"), "requests");
+        if (requests->limited()) {
+            options.limiter = std::move(requests);
+        }
+        rest = HttpsClient::create(runtime->contextFor(venue + "/rest"), std::move(options),
+                                   spdlog::default_logger());
+    }
+    auto make = [&] {
+        auto adapter = std::make_shared<Adapter>(runtime);
+        adapter->setHotStandby(hotStandby);
+        adapter->setPingInterval(pingInterval);
+        adapter->setRoundTripFailover(maxRoundTrip, slowRoundTrips);
+        adapter->setConnectionProfile(profile);
+        // Only venues with multi-connection feeds support sharding
+        if constexpr (requires(Adapter& a) { a.setSharding(sharding); }) {
+            adapter->setSharding(sharding);
+        }
+        if constexpr (requires(Adapter& a) { a.setBookTicker(true); }) {
+            adapter->setDepthStream(
+                config.getString("exchanges." + venue + ".streams.depth", "depth@100ms"));
+            adapter->setBookTicker(
+                config.getBool("exchanges." + venue + ".streams.book_ticker", false));
+        }
+        if constexpr (requires(Adapter& a) { a.setRestClient(rest); }) {
+            adapter->setRestClient(rest);
+            adapter->setSnapshotBootstrap(
+                config.getBool("exchanges." + venue + ".depth_snapshot.enabled", false),
+                config.getInt("exchanges." + venue + ".depth_snapshot.limit", 100));
+        }
+        return adapter;
+    };
+    // The arbiter deduplicates on book update ids; without them only the primary session
+    // could feed the book and the others would be pure load
+    if (sessions > 1 && !Adapter::kSequencedBook) {
+        spdlog::warn("{} books carry no update ids, so redundant_sessions {} cannot be "
+                     "arbitrated; opening one session", venue, sessions);
+        sessions = 1;
+    }
+    if (sessions <= 1) {
+        return make();
+    }
+
+    std::vector<std::shared_ptr<IExchangeAdapter>> group;
+    for (int i = 0; i < sessions; ++i) {
+        group.push_back(make());
+    }
+    return std::make_shared<RedundantFeedAdapter>(std::move(group));
+}
+
+} // namespace
+
 TradingSystem::TradingSystem(std::shared_ptr<ConfigManager> config)
     : config_manager_(std::move(config))
 {
@@ -19,11 +104,13 @@ TradingSystem::~TradingSystem()
 bool TradingSystem::initialize()
 {
     try {
+        initializeMetrics();
         initializeExchanges();
         initializeMarketData();
         initializeRisk();
         initializeExecution();
         initializeStrategy();
+        startMetricsPublisher();
         return true;
     } catch (const std::exception& e) {
         spdlog::error("Failed to initialize trading system: {}", e.what());
@@ -31,16 +118,34 @@ bool TradingSystem::initialize()
     }
 }
 
+void TradingSystem::initializeMetrics()
+{
+    if (!config_manager_->getBool("infra.metrics.enabled", false)) {
+        return;
+    }
+    MetricsReporter::getInstance().initialize(
+        config_manager_->getString("infra.metrics.host", "localhost"),
+        config_manager_->getInt("infra.metrics.port", 9090));
+}
+
 void TradingSystem::initializeExchanges()
 {
+    // All adapters share one set of IO threads, sized and pinned by configuration
+    adapter_runtime_ = std::make_shared<AdapterRuntime>(
+        AdapterRuntime::Config::fromYaml(config_manager_->getNode("infra.io_runtime")));
+    adapter_runtime_->start();
+
     if (config_manager_->getBool("exchanges.coinbase.enabled", false)) {
-        adapters_.push_back(std::make_shared<CoinbaseAdapter>());
+        adapters_.push_back(makeAdapter<CoinbaseAdapter>(*config_manager_, "coinbase",
+                                                         adapter_runtime_));
     }
     // if (config_manager_->getBool("exchanges.kraken.enabled", false)) {
-    //     adapters_.push_back(std::make_shared<KrakenAdapter>());
+    //     adapters_.push_back(makeAdapter<KrakenAdapter>(*config_manager_, "kraken",
+    //                                                    adapter_runtime_));
     // }
     // if (config_manager_->getBool("exchanges.binance.enabled", false)) {
-    //     adapters_.push_back(std::make_shared<BinanceAdapter>());
+    //     adapters_.push_back(makeAdapter<BinanceAdapter>(*config_manager_, "binance",
+    //                                                     adapter_runtime_));
     // }
 }
 
@@ -71,6 +176,48 @@ void TradingSystem::initializeStrategy()
     // TODO: Implement strategy initialization
 }
 
+void TradingSystem::publishMetrics() const
+{
+    for (const auto& adapter : adapters_) {
+        try {
+            adapter->publishMetrics();
+        } catch (const std::exception& e) {
+            spdlog::error("Publishing {} metrics failed: {}", adapter->getName(), e.what());
+        }
+    }
+}
+
+void TradingSystem::startMetricsPublisher()
+{
+    if (!config_manager_->getBool("infra.metrics.enabled", false) || metrics_thread_.joinable()) {
+        return;
+    }
+    // Off the IO threads, which only record the statistics
+    const std::chrono::seconds interval(
+        std::max(config_manager_->getInt("infra.metrics.push_interval", 15), 1));
+    metrics_stopping_ = false;
+    metrics_thread_ = std::thread([this, interval] {
+        std::unique_lock<std::mutex> lock(metrics_mutex_);
+        while (!metrics_wake_.wait_for(lock, interval, [this] { return metrics_stopping_; })) {
+            lock.unlock();
+            publishMetrics();
+            lock.lock();
+        }
+    });
+}
+
+void TradingSystem::stopMetricsPublisher()
+{
+    {
+        std::lock_guard<std::mutex> lock(metrics_mutex_);
+        metrics_stopping_ = true;
+    }
+    metrics_wake_.notify_all();
+    if (metrics_thread_.joinable()) {
+        metrics_thread_.join();
+    }
+}
+
 bool TradingSystem::start()
 {
     try {
@@ -84,6 +231,9 @@ bool TradingSystem::start()
 
 void TradingSystem::stop()
 {
+    // The publisher reads the adapters torn down below
+    stopMetricsPublisher();
+
     // Get the symbols we're subscribed to
     std::vector<std::string> symbols = config_manager_->getStringVector("market_data.symbols");
 
@@ -95,9 +245,13 @@ void TradingSystem::stop()
         }
     }
 
-    // Reset components
+    // Reset components; adapters release their handlers before the IO threads stop
     market_data_engine_.reset();
     execution_engine_.reset();
+    adapters_.clear();
+    if (adapter_runtime_) {
+        adapter_runtime_->stop();
+    }
     // strategy_.reset();
     // risk_manager_.reset();
 }
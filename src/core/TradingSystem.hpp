@@ -1,12 +1,16 @@
 #pragma once
 
+#include <condition_variable>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
 #include <string>
 #include "infra/ConfigManager.hpp"
 #include "core/MarketDataEngine.hpp"
 #include "core/ExecutionEngine.hpp"
 #include "exchanges/IExchangeAdapter.hpp"
+#include "exchanges/AdapterRuntime.hpp"
 
 namespace crypto_hft {
 
@@ -20,18 +24,30 @@ public:
     void stop();
 
     std::shared_ptr<MarketDataEngine> getMarketDataEngine() const { return market_data_engine_; }
+    // Pushes every adapter's statistics to MetricsReporter; with metrics enabled this runs on
+    // a background thread every infra.metrics.push_interval seconds
+    void publishMetrics() const;
 
 private:
+    void initializeMetrics();
     void initializeExchanges();
     void initializeMarketData();
     void initializeRisk();
     void initializeExecution();
     void initializeStrategy();
+    void startMetricsPublisher();
+    void stopMetricsPublisher();
 
     std::shared_ptr<ConfigManager> config_manager_;
+    std::shared_ptr<AdapterRuntime> adapter_runtime_;
     std::vector<std::shared_ptr<IExchangeAdapter>> adapters_;
     std::shared_ptr<MarketDataEngine> market_data_engine_;
     std::shared_ptr<ExecutionEngine> execution_engine_;
+
+    std::thread metrics_thread_;
+    std::mutex metrics_mutex_;
+    std::condition_variable metrics_wake_;
+    bool metrics_stopping_ = false;
     // std::shared_ptr<StrategyEngine> strategy_;
     // std::shared_ptr<RiskManager> risk_manager_;
 };
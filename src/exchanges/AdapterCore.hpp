@@ -0,0 +1,475 @@
+#pragma once
+
+#include "IExchangeAdapter.hpp"
+#include "AdapterRuntime.hpp"
+#include "ClockOffsetEstimator.hpp"
+#include "ConnectionProfile.hpp"
+#include "FrameCapture.hpp"
+#include "MappedFile.hpp"
+#include "ServerTimeProbe.hpp"
+#include "WsConnection.hpp"
+#include "WsOrderEntry.hpp"
+#include "../infra/MetricsReporter.hpp"
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ssl.hpp>
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+#include <spdlog/sinks/stdout_color_sinks.h>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace crypto_hft {
+
+using OrderBookSnapshotHandler = std::function<void(const OrderBookSnapshot&)>;
+using OrderBookDeltaHandler = std::function<void(const OrderBookDelta&)>;
+using TopOfBookHandler = std::function<void(const TopOfBookUpdate&)>;
+using ExecutionHandler = std::function<void(const OrderResponse&)>;
+
+// Where a venue adapter delivers the book events it parses. Any type with these members will
+// do: the adapter holds the sink by value and calls it directly, so a sink known at compile
+// time, e.g. one that applies deltas to a book, costs no std::function or virtual call per
+// event. Calls come from the adapter's IO threads (and, for Binance, its REST callbacks).
+template <typename Sink>
+concept BookEventSink = requires(Sink& sink, const OrderBookSnapshot& snapshot,
+                                 const OrderBookDelta& delta, const TopOfBookUpdate& quote) {
+    sink.onSnapshot(snapshot);
+    sink.onDelta(delta);
+    sink.onTopOfBook(quote);
+};
+
+// The sink behind IExchangeAdapter's register*Callback(): one std::function call per event
+struct CallbackSink {
+    OrderBookSnapshotHandler snapshot;
+    OrderBookDeltaHandler delta;
+    TopOfBookHandler topOfBook;
+
+    void onSnapshot(const OrderBookSnapshot& event) const {
+        if (snapshot) {
+            snapshot(event);
+        }
+    }
+    void onDelta(const OrderBookDelta& event) const {
+        if (delta) {
+            delta(event);
+        }
+    }
+    void onTopOfBook(const TopOfBookUpdate& event) const {
+        if (topOfBook) {
+            topOfBook(event);
+        }
+    }
+};
+
+// What the venue adapters have in common: TLS and IO context setup, a market data session
+// whose subscriptions are replayed onto every new socket, order entry, and delivery of parsed
+// events to a Sink. Derived is the venue adapter (CRTP), and supplies at compile time:
+//
+//   static constexpr const char* kVenue;  // runtime context and logger name, e.g. "kraken"
+//   static constexpr const char* kName;   // getName() and metrics label
+//   static constexpr bool kSequencedBook;  // whether book events carry the venue's update id
+//   WsConnection::Options session_options() const;  // where the market data session goes
+//   std::string make_subscription(const char* method, const std::vector<std::string>&) const;
+//   void on_frame(std::string_view frame);  // parses one frame and emits its events
+//   static ServerTimeProbe::Endpoint server_time_endpoint();  // the venue's REST clock
+//
+// and may replace on_open() (which replays the subscriptions) and before_connect(). A venue
+// with more than one market data session, like Binance's shards, overrides the
+// IExchangeAdapter members that manage it.
+template <typename Derived, BookEventSink Sink>
+class AdapterCore : public IExchangeAdapter {
+public:
+    ~AdapterCore() override { shutdown_session(); }
+
+    AdapterCore(const AdapterCore&) = delete;
+    AdapterCore& operator=(const AdapterCore&) = delete;
+
+    bool connect() override;
+    void disconnect() override;
+    bool isConnected() const override { return connection_ && connection_->isOpen(); }
+    bool subscribe(const std::vector<std::string>& symbols) override;
+    bool unsubscribe(const std::vector<std::string>& symbols) override;
+
+    // Parses one received frame and dispatches its events to the sink. The read loop calls
+    // this on the contents of its receive buffer; it is public so that recorded frames can be
+    // fed through the same path.
+    void handle_frame(std::string_view frame) {
+        capture_.offer(*logger_, frame);
+        derived().on_frame(frame);
+    }
+    // Feeds recorded frames, one per line, through handle_frame() as if each had just been read
+    // off the socket, and returns how many were handled. Each frame is passed as a view into
+    // frames, as the read loop passes its buffer. A frame that throws is logged and skipped, as
+    // the read loop does, and counted in getSkippedReplayFrames(). Not to be mixed with a live
+    // session: the parse state belongs to whichever thread feeds it.
+    std::size_t replayFrames(std::string_view frames) {
+        std::size_t count = 0;
+        std::size_t line = 0;
+        while (!frames.empty()) {
+            const std::size_t end = frames.find('\n');
+            std::string_view frame = frames.substr(0, end);
+            frames.remove_prefix(end == std::string_view::npos ? frames.size() : end + 1);
+            ++line;
+            if (!frame.empty() && frame.back() == '\r') {
+                frame.remove_suffix(1);
+            }
+            if (frame.empty()) {
+                continue;
+            }
+            try {
+                derived().handle_frame(frame);
+                ++count;
+            } catch (const std::exception& e) {
+                logger_->error("Skipping recorded frame on line {}: {}", line, e.what());
+                ++replay_skipped_;
+            }
+        }
+        return count;
+    }
+    // The same for a recording on disk, mapped rather than read; throws std::system_error if
+    // it cannot be
+    std::size_t replayFile(const std::string& path) {
+        MappedFile file(path);
+        return replayFrames(file.contents());
+    }
+    uint64_t getSkippedReplayFrames() const { return replay_skipped_; }
+    void setFrameCaptureSampling(uint32_t sampleEvery) { capture_.setSampleEvery(sampleEvery); }
+    // How often market data sessions ping the venue to time the round trip, which the clock
+    // offset estimate uses; 0 turns timed pings off. Takes effect on the next connect().
+    void setPingInterval(std::chrono::milliseconds interval) { ping_interval_ = interval; }
+    // Promotes the hot standby once slowRoundTrips timed pings in a row take longer than
+    // maxRoundTrip; 0, the default, never does. Takes effect on the next connect().
+    void setRoundTripFailover(std::chrono::milliseconds maxRoundTrip, unsigned slowRoundTrips) {
+        max_round_trip_ = maxRoundTrip;
+        slow_round_trips_ = slowRoundTrips;
+    }
+    // Also polls the venue's REST time endpoint every interval for the clock offset estimate;
+    // 0, the default, leaves it to event times and pings. Takes effect on the next connect().
+    void setServerTimeSync(std::chrono::milliseconds interval) { server_time_interval_ = interval; }
+    // Where the venue's clock stands against ours, shared with the venue's other adapters on
+    // the runtime
+    ClockOffsetEstimator::Estimate getClockEstimate() const { return clock_->estimate(); }
+    // Keeps a second handshaken session ready for failover; takes effect on the next connect()
+    void setHotStandby(bool enabled) { hot_standby_ = enabled; }
+    // Socket tuning for every session; takes effect on the next connect()
+    void setConnectionProfile(const ConnectionProfile& profile) { connection_profile_ = profile; }
+    // Points the market data sessions at host:port instead of the venue, e.g. a loopback
+    // exchange simulator; without verifyPeer any certificate is accepted. Takes effect on the
+    // next connect().
+    void setEndpoint(std::string host, std::string port, bool verifyPeer = true) {
+        endpoint_host_ = std::move(host);
+        endpoint_port_ = std::move(port);
+        ctx_.set_verify_mode(verifyPeer ? boost::asio::ssl::verify_peer
+                                        : boost::asio::ssl::verify_none);
+    }
+    // Order session behind submitOrder(), cancelOrder() and modifyOrder(), e.g. a WsOrderEntry
+    // on the runtime's context for "<venue>/orders". connect() starts it; its owner shuts it
+    // down. Without one those calls fail.
+    void setOrderEntry(std::shared_ptr<WsOrderEntry> entry) {
+        order_entry_ = std::move(entry);
+        if (order_entry_) {
+            order_entry_->setExecutionHandler(execution_callback_);
+        }
+    }
+
+    Sink& sink() { return sink_; }
+
+    // Book callbacks land in a CallbackSink; an adapter built with another sink ignores them
+    void registerOrderBookCallback(OrderBookSnapshotHandler callback) override {
+        if constexpr (std::is_same_v<Sink, CallbackSink>) {
+            sink_.snapshot = std::move(callback);
+        } else {
+            ignore_callback();
+        }
+    }
+    void registerOrderBookDeltaCallback(OrderBookDeltaHandler callback) override {
+        if constexpr (std::is_same_v<Sink, CallbackSink>) {
+            sink_.delta = std::move(callback);
+        } else {
+            ignore_callback();
+        }
+    }
+    void registerTopOfBookCallback(TopOfBookHandler callback) override {
+        if constexpr (std::is_same_v<Sink, CallbackSink>) {
+            sink_.topOfBook = std::move(callback);
+        } else {
+            ignore_callback();
+        }
+    }
+    void registerExecutionCallback(ExecutionHandler callback) override {
+        execution_callback_ = std::move(callback);
+        if (order_entry_) {
+            order_entry_->setExecutionHandler(execution_callback_);
+        }
+    }
+
+    std::string submitOrder(const OrderRequest& request) override {
+        return order_entry_ ? order_entry_->submitOrder(request) : "";
+    }
+    bool cancelOrder(const std::string& orderId) override {
+        return order_entry_ && order_entry_->cancelOrder(orderId);
+    }
+    bool modifyOrder(const std::string& orderId, double newPrice, double newSize) override {
+        return order_entry_ && order_entry_->modifyOrder(orderId, newPrice, newSize);
+    }
+
+    std::string getName() const override { return Derived::kName; }
+    double getBalance(const std::string&) const override { return 0.0; }
+    std::vector<std::pair<std::string, double>> getAllBalances() const override { return {}; }
+
+protected:
+    // IO runs on the runtime's context for Derived::kVenue; without a runtime the adapter gets
+    // a private single-threaded one
+    AdapterCore(std::shared_ptr<AdapterRuntime> runtime, Sink sink)
+        : runtime_(runtime ? std::move(runtime) : AdapterRuntime::dedicated())
+        , ioc_(runtime_->contextFor(Derived::kVenue))
+        , ctx_(boost::asio::ssl::context::tls_client)
+        , sink_(std::move(sink))
+        , clock_(runtime_->clockFor(Derived::kVenue)) {
+        // Redundant sessions share one named logger
+        const std::string name = std::string(Derived::kVenue) + "_adapter";
+        logger_ = spdlog::get(name);
+        if (!logger_) {
+            logger_ = spdlog::stdout_color_mt(name);
+        }
+        logger_->set_level(spdlog::level::debug);
+
+        namespace ssl = boost::asio::ssl;
+        ctx_.set_options(ssl::context::default_workarounds | ssl::context::no_sslv2 |
+                         ssl::context::no_sslv3 | ssl::context::single_dh_use);
+        ctx_.set_verify_mode(ssl::verify_peer);
+        ctx_.set_default_verify_paths();
+    }
+
+    Derived& derived() { return static_cast<Derived&>(*this); }
+    const Derived& derived() const { return static_cast<const Derived&>(*this); }
+
+    // Hooks Derived may replace
+    void before_connect() {}
+    void on_open(WsConnection& connection) { replay_subscriptions(connection); }
+
+    // Stops the session and waits out its handlers. Derived calls this from its destructor,
+    // as the handlers use its members; by the core's destructor they are gone.
+    void shutdown_session() {
+        stop_server_time();
+        if (connection_) {
+            connection_->shutdown();
+            connection_.reset();
+        }
+    }
+
+    // A new session starts with no channels: sends every subscription on it
+    void replay_subscriptions(WsConnection& connection) {
+        std::lock_guard<std::mutex> lock(subscriptions_mutex_);
+        if (!subscriptions_.empty()) {
+            logger_->info("Replaying subscriptions: {}", nlohmann::json(subscriptions_).dump());
+            connection.send(derived().make_subscription("subscribe", subscriptions_));
+        }
+    }
+
+    // Sets an event's receive time (local steady clock) and its venue event time on the local
+    // clock, and lets the venue's clock estimate learn from the pair. Derived reads receivedNs
+    // once per frame, before parsing it.
+    template <typename Event>
+    void stamp(Event& event, int64_t receivedNs) {
+        event.receiveTime = receivedNs;
+        if (event.exchangeTime != 0) {
+            clock_->onEvent(event.exchangeTime, receivedNs);
+            event.exchangeTimeLocal = clock_->toLocal(event.exchangeTime);
+        }
+    }
+
+    void start_server_time() {
+        if (server_time_interval_.count() > 0 && !server_time_) {
+            server_time_ = ServerTimeProbe::create(ioc_, Derived::server_time_endpoint(),
+                                                   server_time_interval_, clock_, logger_);
+            server_time_->start();
+        }
+    }
+    void stop_server_time() {
+        if (server_time_) {
+            server_time_->shutdown();
+            server_time_.reset();
+        }
+    }
+
+    // Derived's session options with the endpoint override and socket settings applied
+    WsConnection::Options make_session_options() const {
+        WsConnection::Options options = derived().session_options();
+        if (!endpoint_host_.empty()) {
+            options.host = endpoint_host_;
+            options.port = endpoint_port_;
+        }
+        options.standby = hot_standby_;
+        options.profile = connection_profile_;
+        options.pingInterval = ping_interval_;
+        options.maxRoundTrip = max_round_trip_;
+        options.slowRoundTrips = slow_round_trips_;
+        return options;
+    }
+
+    std::vector<std::string> subscribed() const {
+        std::lock_guard<std::mutex> lock(subscriptions_mutex_);
+        return subscriptions_;
+    }
+
+    // The caller's labels, such as a redundant session's index, with the venue added
+    static std::unordered_map<std::string, std::string> metric_labels(
+        const std::string& venue, std::unordered_map<std::string, std::string> labels) {
+        labels.insert_or_assign("venue", venue);
+        return labels;
+    }
+
+    // Connection and receive-latency statistics of the market data session, and the venue's
+    // clock offset and latency estimates
+    void publish_connection_metrics(const std::unordered_map<std::string, std::string>& labels) const {
+        const auto venue = metric_labels(Derived::kName, labels);
+        if (connection_) {
+            connection_->publishMetrics(venue);
+        }
+        clock_->publishMetrics(venue);
+    }
+
+    std::shared_ptr<AdapterRuntime> runtime_;
+    boost::asio::io_context& ioc_;
+    boost::asio::ssl::context ctx_;
+    std::shared_ptr<spdlog::logger> logger_;
+    Sink sink_;
+    std::shared_ptr<ClockOffsetEstimator> clock_;
+
+    std::shared_ptr<WsConnection> connection_;
+    bool hot_standby_ = false;
+    ConnectionProfile connection_profile_;
+    std::string endpoint_host_;
+    std::string endpoint_port_;
+    std::chrono::milliseconds ping_interval_{5000};
+    std::chrono::milliseconds max_round_trip_{0};
+    unsigned slow_round_trips_ = 3;
+    std::chrono::milliseconds server_time_interval_{0};
+    std::shared_ptr<ServerTimeProbe> server_time_;
+    FrameCapture capture_;
+    uint64_t replay_skipped_ = 0;  // Written only by the thread replaying
+
+    // Subscribed symbols, replayed onto every new session
+    mutable std::mutex subscriptions_mutex_;
+    std::vector<std::string> subscriptions_;
+
+    ExecutionHandler execution_callback_;
+    std::shared_ptr<WsOrderEntry> order_entry_;
+
+    // How long connect() waits for the first session before leaving it to the background
+    static constexpr std::chrono::seconds kConnectWait{10};
+
+private:
+    void ignore_callback() {
+        logger_->warn("{} adapter delivers to its own sink; callback not registered",
+                      Derived::kName);
+    }
+};
+
+template <typename Derived, BookEventSink Sink>
+bool AdapterCore<Derived, Sink>::connect() {
+    try {
+        derived().before_connect();
+        if (order_entry_) {
+            order_entry_->start();
+        }
+        if (!connection_ || connection_->state() == WsConnection::State::Closed) {
+            connection_ = WsConnection::create(ioc_, ctx_, make_session_options(), logger_);
+            connection_->setFrameHandler(
+                [this](std::string_view frame) { derived().handle_frame(frame); });
+            connection_->setOpenHandler(
+                [this](WsConnection& connection) { derived().on_open(connection); });
+            connection_->setRoundTripHandler(
+                [clock = clock_](int64_t roundTripNs) { clock->onRoundTrip(roundTripNs); });
+            connection_->start();
+        }
+        start_server_time();
+
+        // Reconnects continue in the background if the first session is slow to open
+        if (!connection_->waitForOpen(kConnectWait)) {
+            logger_->warn("{} WebSocket not open yet, still retrying", Derived::kName);
+            return false;
+        }
+        logger_->info("Successfully connected to {} WebSocket", Derived::kName);
+        return true;
+    } catch (const std::exception& e) {
+        logger_->error("Failed to connect: {}", e.what());
+        return false;
+    }
+}
+
+template <typename Derived, BookEventSink Sink>
+void AdapterCore<Derived, Sink>::disconnect() {
+    if (!connection_) {
+        return;
+    }
+    connection_->close();
+    stop_server_time();
+    logger_->info("Disconnected from {} WebSocket", Derived::kName);
+}
+
+template <typename Derived, BookEventSink Sink>
+bool AdapterCore<Derived, Sink>::subscribe(const std::vector<std::string>& symbols) {
+    {
+        std::lock_guard<std::mutex> lock(subscriptions_mutex_);
+        for (const auto& symbol : symbols) {
+            if (std::find(subscriptions_.begin(), subscriptions_.end(), symbol) ==
+                subscriptions_.end()) {
+                subscriptions_.push_back(symbol);
+            }
+        }
+    }
+
+    // Subscriptions made before the session opens are sent by on_open
+    if (!isConnected()) {
+        logger_->info("Queued subscription until connected: {}", nlohmann::json(symbols).dump());
+        return true;
+    }
+
+    try {
+        std::string message = derived().make_subscription("subscribe", symbols);
+        logger_->info("Sending subscription message: {}", message);
+        connection_->send(std::move(message));
+        logger_->info("Subscribed to symbols: {}", nlohmann::json(symbols).dump());
+        return true;
+    } catch (const std::exception& e) {
+        logger_->error("Failed to subscribe: {}", e.what());
+        return false;
+    }
+}
+
+template <typename Derived, BookEventSink Sink>
+bool AdapterCore<Derived, Sink>::unsubscribe(const std::vector<std::string>& symbols) {
+    {
+        std::lock_guard<std::mutex> lock(subscriptions_mutex_);
+        for (const auto& symbol : symbols) {
+            subscriptions_.erase(std::remove(subscriptions_.begin(), subscriptions_.end(), symbol),
+                                 subscriptions_.end());
+        }
+    }
+
+    if (!isConnected()) {
+        logger_->error("Not connected");
+        return false;
+    }
+
+    try {
+        connection_->send(derived().make_subscription("unsubscribe", symbols));
+        logger_->info("Unsubscribed from symbols: {}", nlohmann::json(symbols).dump());
+        return true;
+    } catch (const std::exception& e) {
+        logger_->error("Failed to unsubscribe: {}", e.what());
+        return false;
+    }
+}
+
+} // namespace crypto_hft
@@ -0,0 +1,150 @@
+#include "AdapterRuntime.hpp"
+#include <algorithm>
+#include <spdlog/spdlog.h>
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace crypto_hft {
+
+namespace {
+
+// Pins the calling thread; returns false where unsupported or refused by the OS
+bool pinCurrentThread(int cpu) {
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+} // namespace
+
+AdapterRuntime::Config AdapterRuntime::Config::fromYaml(const YAML::Node& node) {
+    Config config;
+    if (!node.IsDefined() || !node.IsMap()) {
+        return config;
+    }
+    if (node["contexts"]) {
+        config.contexts = node["contexts"].as<std::size_t>();
+    }
+    if (node["cpu_affinity"]) {
+        config.cpus = node["cpu_affinity"].as<std::vector<int>>();
+    }
+    if (node["venues"]) {
+        for (const auto& venue : node["venues"]) {
+            config.venues[venue.first.as<std::string>()] = venue.second.as<std::size_t>();
+        }
+    }
+    return config;
+}
+
+AdapterRuntime::AdapterRuntime()
+    : AdapterRuntime(Config{}) {}
+
+AdapterRuntime::AdapterRuntime(Config config)
+    : config_(std::move(config)) {
+    std::size_t count = config_.contexts;
+    if (count == 0) {
+        count = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    contexts_.reserve(count);
+    workGuards_.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        // Each context is driven by exactly one thread
+        contexts_.push_back(std::make_unique<boost::asio::io_context>(1));
+        workGuards_.push_back(boost::asio::make_work_guard(*contexts_.back()));
+    }
+
+    for (const auto& [venue, index] : config_.venues) {
+        if (index >= count) {
+            spdlog::warn("Venue {} assigned to io_context {} of {}, wrapping", venue, index, count);
+        }
+        venueContexts_[venue] = index % count;
+    }
+}
+
+AdapterRuntime::~AdapterRuntime() {
+    stop();
+}
+
+void AdapterRuntime::start() {
+    if (running_) {
+        return;
+    }
+    running_ = true;
+    threads_.reserve(contexts_.size());
+    for (std::size_t i = 0; i < contexts_.size(); ++i) {
+        threads_.emplace_back([this, i] { run(i); });
+    }
+}
+
+void AdapterRuntime::stop() {
+    if (!running_) {
+        return;
+    }
+    running_ = false;
+
+    // Releasing the guards lets each run() return once its adapters have finished closing
+    for (auto& guard : workGuards_) {
+        guard.reset();
+    }
+    for (auto& thread : threads_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+    threads_.clear();
+}
+
+boost::asio::io_context& AdapterRuntime::contextFor(const std::string& venue) {
+    std::lock_guard<std::mutex> lock(venueMutex_);
+    auto [it, inserted] = venueContexts_.try_emplace(venue, 0);
+    if (inserted) {
+        it->second = nextContext_++ % contexts_.size();
+    }
+    return *contexts_[it->second];
+}
+
+std::shared_ptr<ClockOffsetEstimator> AdapterRuntime::clockFor(const std::string& venue) {
+    std::lock_guard<std::mutex> lock(venueMutex_);
+    auto& clock = clocks_[venue];
+    if (!clock) {
+        clock = std::make_shared<ClockOffsetEstimator>();
+    }
+    return clock;
+}
+
+std::shared_ptr<AdapterRuntime> AdapterRuntime::dedicated() {
+    auto runtime = std::make_shared<AdapterRuntime>();
+    runtime->start();
+    return runtime;
+}
+
+void AdapterRuntime::run(std::size_t index) {
+    if (index < config_.cpus.size() && config_.cpus[index] >= 0) {
+        if (pinCurrentThread(config_.cpus[index])) {
+            spdlog::info("io_context {} pinned to CPU {}", index, config_.cpus[index]);
+        } else {
+            spdlog::warn("Failed to pin io_context {} to CPU {}", index, config_.cpus[index]);
+        }
+    }
+
+    // A handler that throws must not take the whole venue's IO down with it
+    while (true) {
+        try {
+            contexts_[index]->run();
+            break;
+        } catch (const std::exception& e) {
+            spdlog::error("Error in io_context {}: {}", index, e.what());
+        }
+    }
+}
+
+} // namespace crypto_hft
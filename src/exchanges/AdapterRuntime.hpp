@@ -0,0 +1,76 @@
+#pragma once
+
+#include "ClockOffsetEstimator.hpp"
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+#include <atomic>
+#include <yaml-cpp/yaml.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace crypto_hft {
+
+// Owns the io_contexts and IO threads that exchange adapters run on. Adapters are handed a
+// context instead of creating their own, so the number of IO threads is set by configuration
+// rather than by the number of venues, and each thread can be pinned next to the book shard
+// it feeds.
+class AdapterRuntime {
+public:
+    struct Config {
+        std::size_t contexts = 1;  // 0 means one per hardware thread
+        std::vector<int> cpus;     // core for the thread of context i; missing or -1 is unpinned
+        std::unordered_map<std::string, std::size_t> venues;  // venue -> context index
+
+        // Reads {contexts, cpu_affinity, venues}; an undefined node gives the defaults
+        static Config fromYaml(const YAML::Node& node);
+    };
+
+    AdapterRuntime();
+    explicit AdapterRuntime(Config config);
+    ~AdapterRuntime();
+
+    AdapterRuntime(const AdapterRuntime&) = delete;
+    AdapterRuntime& operator=(const AdapterRuntime&) = delete;
+
+    // Starts one thread per context; idempotent
+    void start();
+    // Lets the contexts run out of work, then joins their threads
+    void stop();
+    bool isRunning() const { return running_.load(); }
+
+    std::size_t size() const { return contexts_.size(); }
+    boost::asio::io_context& context(std::size_t index) { return *contexts_[index % size()]; }
+
+    // The context configured for a venue. Unconfigured venues are spread round-robin and keep
+    // their context for the lifetime of the runtime, so redundant sessions of one venue share it.
+    boost::asio::io_context& contextFor(const std::string& venue);
+
+    // The venue's clock offset estimator. Every session and adapter of a venue on this runtime
+    // shares it, as they all read the same venue clock.
+    std::shared_ptr<ClockOffsetEstimator> clockFor(const std::string& venue);
+
+    // A started single-context runtime, for adapters constructed without one
+    static std::shared_ptr<AdapterRuntime> dedicated();
+
+private:
+    using WorkGuard = boost::asio::executor_work_guard<boost::asio::io_context::executor_type>;
+
+    void run(std::size_t index);
+
+    Config config_;
+    std::vector<std::unique_ptr<boost::asio::io_context>> contexts_;
+    std::vector<WorkGuard> workGuards_;
+    std::vector<std::thread> threads_;
+    std::atomic<bool> running_{false};
+
+    std::mutex venueMutex_;
+    std::unordered_map<std::string, std::size_t> venueContexts_;
+    std::unordered_map<std::string, std::shared_ptr<ClockOffsetEstimator>> clocks_;
+    std::size_t nextContext_ = 0;
+};
+
+} // namespace crypto_hft
@@ -1,101 +1,859 @@
 #pragma once
 
-#include "IExchangeAdapter.hpp"
-#include <boost/beast/core.hpp>
-#include <boost/beast/ssl.hpp>
-#include <boost/beast/websocket.hpp>
-#include <boost/asio/strand.hpp>
+#include "AdapterCore.hpp"
+#include "FrameParser.hpp"
+#include "SymbolSharder.hpp"
+#include "TopOfBookTracker.hpp"
+#include "DepthBookSync.hpp"
+#include "FeedArbiter.hpp"
+#include "HttpsClient.hpp"
+#include "../infra/MetricsReporter.hpp"
+#include <boost/asio/post.hpp>
+#include <boost/asio/steady_timer.hpp>
 #include <nlohmann/json.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <future>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
-#include <vector>
-#include <functional>
+#include <string_view>
 #include <unordered_map>
-#include <spdlog/spdlog.h>
-#include <thread>
+#include <vector>
 
-namespace beast = boost::beast;
-namespace websocket = beast::websocket;
 namespace net = boost::asio;
-namespace ssl = boost::asio::ssl;
-using tcp = net::ip::tcp;
 using json = nlohmann::json;
 
 namespace crypto_hft {
 
-// Forward declarations
-struct OrderBookEntry;
-struct OrderBookSnapshot;
-struct OrderBookDelta;
-struct OrderResponse;
-struct OrderRequest;
+// Binance spot depth streams over combined-stream connections, optionally sharded by symbol
+// and bootstrapped from REST snapshots. Book and top-of-book events go to Sink; BinanceAdapter
+// delivers them to the callbacks registered through IExchangeAdapter.
+template <BookEventSink Sink = CallbackSink>
+class BasicBinanceAdapter : public AdapterCore<BasicBinanceAdapter<Sink>, Sink> {
+    using Core = AdapterCore<BasicBinanceAdapter<Sink>, Sink>;
+    friend Core;
 
-// Type aliases for handlers
-using OrderBookSnapshotHandler = std::function<void(const OrderBookSnapshot&)>;
-using OrderBookDeltaHandler = std::function<void(const OrderBookDelta&)>;
-using ExecutionHandler = std::function<void(const OrderResponse&)>;
-
-class BinanceAdapter : public IExchangeAdapter {
 public:
-    BinanceAdapter();
-    ~BinanceAdapter() override;
+    static constexpr const char* kVenue = "binance";
+    static constexpr const char* kName = "Binance";
+    static constexpr bool kSequencedBook = true;  // Deltas carry the final update id u
+
+    // IO runs on the runtime's context for "binance"; without a runtime the adapter gets a
+    // private single-threaded one
+    explicit BasicBinanceAdapter(std::shared_ptr<AdapterRuntime> runtime = nullptr,
+                                 Sink sink = Sink())
+        : Core(std::move(runtime), std::move(sink)) {}
+    ~BasicBinanceAdapter() override;
 
-    // Connection management
+    // One session per shard instead of the core's single one
     bool connect() override;
     void disconnect() override;
     bool isConnected() const override;
-
-    // Subscription management
     bool subscribe(const std::vector<std::string>& symbols) override;
     bool unsubscribe(const std::vector<std::string>& symbols) override;
 
-    // Exchange information
-    std::string getName() const override;
-    bool supportsMargin() const override;
-    double getFeeRate(const std::string& symbol) const override;
-
-    // Account management
-    double getBalance(const std::string& asset) const override;
-    std::vector<std::pair<std::string, double>> getAllBalances() const override;
-
-    // Order management
-    std::string submitOrder(const OrderRequest& request) override;
-    bool cancelOrder(const std::string& orderId) override;
-    bool modifyOrder(const std::string& orderId, double newPrice, double newSize) override;
+    bool supportsMargin() const override { return true; }
+    double getFeeRate(const std::string&) const override { return 0.001; }  // 0.1% maker/taker fee
     bool requestOrderBookSnapshot(const std::string& symbol) override;
 
-    // Callback registration
-    void registerOrderBookCallback(std::function<void(const OrderBookSnapshot&)> callback) override;
-    void registerOrderBookDeltaCallback(std::function<void(const OrderBookDelta&)> callback) override;
-    void registerExecutionCallback(std::function<void(const OrderResponse&)> callback) override;
+    // Shards pick the setting up on the next connect()
+    void setFrameCaptureSampling(uint32_t sampleEvery) {
+        Core::setFrameCaptureSampling(sampleEvery);
+        capture_sample_every_ = sampleEvery;
+    }
+    // Depth stream per symbol, e.g. "depth@100ms", or "depth@0ms" where the account may use it
+    void setDepthStream(std::string stream) { depth_stream_ = std::move(stream); }
+    // Also subscribes <symbol>@bookTicker, whose quotes reach the top-of-book callback ahead of
+    // the depth stream. Both take effect on the next subscription or reconnect.
+    void setBookTicker(bool enabled) { book_ticker_ = enabled; }
+
+    struct TopOfBookStats {
+        uint64_t quotes = 0;       // bookTicker quotes passed on ahead of the depth stream
+        uint64_t staleQuotes = 0;  // Quotes the depth stream had already reached
+        // How long quotes arrived before the depth update covering them
+        uint64_t leadSamples = 0;
+        double meanLeadNs = 0.0;
+        int64_t maxLeadNs = 0;
+    };
+    TopOfBookStats getTopOfBookStats() const;
+    // Spreads symbols over several combined-stream connections by message rate. Connection i
+    // runs on the runtime's context for "binance/<i>" (the first on "binance"), so shards can be
+    // given IO threads of their own. Takes effect on the next connect().
+    void setSharding(const SymbolSharder::Config& config);
+    // Folds the book messages counted since the last call into the symbol rates and moves
+    // symbols off an overloaded connection. Runs every rebalance interval while connected.
+    void rebalanceShards();
+    // Connection index a subscribed symbol is streamed on
+    std::optional<std::size_t> getShardOf(const std::string& symbol) const;
+    // REST client for depth snapshots, normally shared by the venue's redundant sessions.
+    // Without one, connect() opens a private client with restDefaults() when bootstrapping.
+    void setRestClient(std::shared_ptr<HttpsClient> client) { rest_ = std::move(client); }
+    static HttpsClient::Options restDefaults();
+    // Seeds every subscribed book from a REST snapshot of `limit` levels joined to the depth
+    // stream, and fetches a new one after a reconnect or a gap in update ids. Deltas of a symbol
+    // are held back until its snapshot is in. Takes effect on the next subscription or reconnect.
+    void setSnapshotBootstrap(bool enabled, int limit = 100) {
+        bootstrap_ = enabled;
+        snapshot_limit_ = limit;
+    }
+    // Pushes connection, receive-latency, shard load and snapshot statistics to MetricsReporter
+    void publishMetrics(const std::unordered_map<std::string, std::string>& labels = {}) const override;
 
 private:
-    // WebSocket client
-    ssl::context ctx_;
-    net::io_context ioc_;
-    net::executor_work_guard<net::io_context::executor_type> work_guard_;
-    net::strand<net::io_context::executor_type> strand_;
-    std::unique_ptr<websocket::stream<beast::ssl_stream<tcp::socket>>> ws_;
-    beast::flat_buffer buffer_;
-    std::thread io_thread_;
-    std::string host_;
-    bool connected_ = false;
-
-    // Callbacks
-    std::function<void(const OrderBookSnapshot&)> order_book_callback_;
-    std::function<void(const OrderBookDelta&)> order_book_delta_callback_;
-    std::function<void(const OrderResponse&)> execution_callback_;
-
-    // Logger
-    std::shared_ptr<spdlog::logger> logger_;
-
-    // Internal methods
-    void initialize_logger();
-    void do_read();
-    void do_write(const std::string& message);
-    void on_message(beast::error_code ec, std::size_t bytes_transferred);
-    void handle_snapshot_message(const json& data);
-    void handle_l2update_message(const json& data);
+    using Core::runtime_;
+    using Core::ioc_;
+    using Core::ctx_;
+    using Core::logger_;
+    using Core::sink_;
+    using Core::connection_profile_;
+    using Core::subscriptions_mutex_;
+    using Core::order_entry_;
+    using Core::kConnectWait;
+
+    // Symbols whose messages are counted for rebalancing; any beyond keep their estimated rate
+    static constexpr std::size_t kMaxCountedSymbols = 512;
+    static constexpr std::size_t kNoCountSlot = kMaxCountedSymbols;
+
+    struct SymbolState {
+        TopOfBookTracker quotes;
+        std::size_t count_slot = kNoCountSlot;  // Looked up when the shard first sees the symbol
+    };
+
+    // One combined-stream connection and the symbols sharded onto it
+    struct Shard {
+        std::shared_ptr<WsConnection> connection;
+        // Parse outputs, capture and per-symbol state, used only on the shard's IO thread
+        OrderBookSnapshot snapshot;
+        OrderBookDelta delta;
+        TopOfBookUpdate ticker;
+        FrameCapture capture;
+        std::unordered_map<std::string, SymbolState> symbols;
+        // Book messages per count slot since the last rebalance, which takes them
+        std::unique_ptr<std::atomic<uint64_t>[]> counts =
+            std::make_unique<std::atomic<uint64_t>[]>(kMaxCountedSymbols);
+    };
+
+    // Symbol to connection assignment, replayed onto every new session of a shard. Guarded by
+    // the core's subscriptions_mutex_.
+    SymbolSharder sharder_;
+    // Count slot of every symbol ever subscribed, and the symbol in each slot. Guarded by
+    // subscriptions_mutex_; slots are never reused, so the IO threads keep theirs.
+    std::unordered_map<std::string, std::size_t> count_slots_;
+    std::vector<std::string> counted_symbols_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::chrono::steady_clock::time_point last_rebalance_;
+    std::unique_ptr<net::steady_timer> rebalance_timer_;
+
+    // Parse state for frames fed through handle_frame(), which captures them itself
+    Shard direct_;
+    uint32_t capture_sample_every_ = FrameCapture::kDefaultSampleEvery;
+    std::string depth_stream_ = "depth@100ms";
+    bool book_ticker_ = false;
+
+    // Depth snapshots over REST, joined to the depth stream by update id. The mutex is held
+    // while emitting, so a snapshot and its replayed deltas cannot interleave with live ones.
+    std::shared_ptr<HttpsClient> rest_;
+    bool owns_rest_ = false;
+    bool bootstrap_ = false;
+    int snapshot_limit_ = 100;
+    std::mutex book_sync_mutex_;
+    DepthBookSync book_sync_;
+    // Shared with pending REST callbacks, which outlive the adapter when the client is shared
+    struct Liveness {
+        std::mutex mutex;
+        bool alive = true;
+    };
+    std::shared_ptr<Liveness> liveness_ = std::make_shared<Liveness>();
+    std::atomic<uint64_t> snapshots_{0};
+    std::atomic<uint64_t> snapshot_failures_{0};
+
+    // While a symbol moves, its streams arrive on both connections, each on its own IO thread.
+    // Update ids order them: only the first copy of an id goes on, and in id order.
+    FeedArbiter delta_order_{1};
+    FeedArbiter quote_order_{1};
+
+    std::atomic<uint64_t> quotes_{0};
+    std::atomic<uint64_t> stale_quotes_{0};
+    std::atomic<uint64_t> lead_samples_{0};
+    std::atomic<int64_t> lead_total_ns_{0};
+    std::atomic<int64_t> lead_max_ns_{0};
+
+    WsConnection::Options session_options() const;
+    static ServerTimeProbe::Endpoint server_time_endpoint();
+    void on_shard_open(std::size_t shard, WsConnection& connection);
+    void on_frame(std::string_view frame) { on_shard_frame(direct_, frame); }
+    void on_shard_frame(Shard& shard, std::string_view frame);
+    SymbolState& symbol_state(Shard& shard, const std::string& symbol);
+    void assign_count_slots(const std::vector<std::string>& symbols);
+    void emit_delta(const OrderBookDelta& delta);
+    void apply_delta(const OrderBookDelta& delta);
+    void request_snapshots(const std::vector<std::string>& symbols);
+    void on_snapshot(const std::string& symbol, HttpsClient::Response response);
+    void record_lead(int64_t leadNs);
+    void schedule_rebalance();
+    void stop_rebalancing();
+    void shutdown_shards();
+    std::string shard_name(std::size_t shard) const;
+    std::string make_subscription(const char* method, const std::vector<std::string>& symbols) const;
+    void handle_websocket_message(std::string_view message);
+
+    static std::string to_upper(std::string symbol) {
+        std::transform(symbol.begin(), symbol.end(), symbol.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+        return symbol;
+    }
+    static std::string to_lower(std::string symbol) {
+        std::transform(symbol.begin(), symbol.end(), symbol.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return symbol;
+    }
+    // Request weight Binance charges for a depth snapshot of this many levels
+    static double snapshot_weight(int limit) {
+        return limit <= 100 ? 5.0 : limit <= 500 ? 25.0 : limit <= 1000 ? 50.0 : 250.0;
+    }
 };
 
-} // namespace crypto_hft 
\ No newline at end of file
+using BinanceAdapter = BasicBinanceAdapter<>;
+extern template class BasicBinanceAdapter<CallbackSink>;
+
+template <BookEventSink Sink>
+BasicBinanceAdapter<Sink>::~BasicBinanceAdapter() {
+    {
+        std::lock_guard<std::mutex> lock(liveness_->mutex);
+        liveness_->alive = false;
+    }
+    stop_rebalancing();
+    shutdown_shards();
+    if (owns_rest_) {
+        rest_->shutdown();
+    }
+}
+
+template <BookEventSink Sink>
+HttpsClient::Options BasicBinanceAdapter<Sink>::restDefaults() {
+    HttpsClient::Options options;
+    options.host = "api.binance.com";
+    options.connections = 4;
+    options.pipelineDepth = 4;
+    // 6000 request weight per minute per IP, with some room for bursts
+    options.weightPerSecond = 100.0;
+    options.weightBurst = 1000.0;
+    return options;
+}
+
+template <BookEventSink Sink>
+WsConnection::Options BasicBinanceAdapter<Sink>::session_options() const {
+    WsConnection::Options options;
+    options.host = "stream.binance.com";
+    options.port = "9443";
+    options.target = "/stream";
+    return options;
+}
+
+template <BookEventSink Sink>
+ServerTimeProbe::Endpoint BasicBinanceAdapter<Sink>::server_time_endpoint() {
+    ServerTimeProbe::Endpoint endpoint;
+    endpoint.rest.host = restDefaults().host;
+    endpoint.target = "/api/v3/time";
+    endpoint.parse = [](std::string_view body, int64_t& serverTimeNs) {
+        json data = json::parse(body, nullptr, false);
+        if (data.is_discarded() || !data.contains("serverTime")) {
+            return false;
+        }
+        serverTimeNs = data["serverTime"].get<int64_t>() * 1000000;
+        return serverTimeNs > 0;
+    };
+    return endpoint;
+}
+
+template <BookEventSink Sink>
+bool BasicBinanceAdapter<Sink>::connect() {
+    try {
+        if (order_entry_) {
+            order_entry_->start();
+        }
+        if (bootstrap_ && !rest_) {
+            auto options = restDefaults();
+            options.profile = connection_profile_;
+            rest_ = HttpsClient::create(ioc_, options, logger_);
+            owns_rest_ = true;
+        }
+
+        std::size_t count = sharder_.shardCount();
+        if (shards_.size() != count) {
+            stop_rebalancing();
+            shutdown_shards();
+            for (std::size_t i = 0; i < count; ++i) {
+                shards_.push_back(std::make_unique<Shard>());
+                shards_.back()->capture.setSampleEvery(capture_sample_every_);
+            }
+        }
+
+        for (std::size_t i = 0; i < count; ++i) {
+            Shard& shard = *shards_[i];
+            if (shard.connection && shard.connection->state() != WsConnection::State::Closed) {
+                continue;
+            }
+            // Shards beyond the first get a context of their own so they can run on other threads
+            auto& ioc = i == 0 ? ioc_ : runtime_->contextFor(shard_name(i));
+            shard.connection = WsConnection::create(ioc, ctx_, this->make_session_options(),
+                                                    logger_);
+            shard.connection->setFrameHandler([this, &shard](std::string_view frame) {
+                shard.capture.offer(*logger_, frame);
+                on_shard_frame(shard, frame);
+            });
+            shard.connection->setOpenHandler([this, i](WsConnection& connection) {
+                on_shard_open(i, connection);
+            });
+            shard.connection->setRoundTripHandler(
+                [clock = this->clock_](int64_t roundTripNs) { clock->onRoundTrip(roundTripNs); });
+            shard.connection->start();
+        }
+        this->start_server_time();
+
+        if (sharder_.config().rebalanceInterval.count() > 0 && !rebalance_timer_) {
+            last_rebalance_ = std::chrono::steady_clock::now();
+            rebalance_timer_ = std::make_unique<net::steady_timer>(ioc_);
+            schedule_rebalance();
+        }
+
+        // Reconnects continue in the background if the first sessions are slow to open
+        auto deadline = std::chrono::steady_clock::now() + kConnectWait;
+        for (const auto& shard : shards_) {
+            auto remaining = std::max(std::chrono::milliseconds(0),
+                std::chrono::duration_cast<std::chrono::milliseconds>(
+                    deadline - std::chrono::steady_clock::now()));
+            if (!shard->connection->waitForOpen(remaining)) {
+                logger_->warn("Binance WebSocket not open yet, still retrying");
+                return false;
+            }
+        }
+        logger_->info("Successfully connected to Binance WebSocket ({} connections)", count);
+        return true;
+    } catch (const std::exception& e) {
+        logger_->error("Failed to connect: {}", e.what());
+        return false;
+    }
+}
+
+template <BookEventSink Sink>
+void BasicBinanceAdapter<Sink>::disconnect() {
+    if (shards_.empty()) {
+        return;
+    }
+    stop_rebalancing();
+    for (const auto& shard : shards_) {
+        if (shard->connection) {
+            shard->connection->close();
+        }
+    }
+    this->stop_server_time();
+    logger_->info("Disconnected from Binance WebSocket");
+}
+
+template <BookEventSink Sink>
+bool BasicBinanceAdapter<Sink>::isConnected() const {
+    if (shards_.empty()) {
+        return false;
+    }
+    for (const auto& shard : shards_) {
+        if (!shard->connection || !shard->connection->isOpen()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <BookEventSink Sink>
+bool BasicBinanceAdapter<Sink>::subscribe(const std::vector<std::string>& symbols) {
+    std::vector<std::vector<std::string>> byShard;
+    {
+        std::lock_guard<std::mutex> lock(subscriptions_mutex_);
+        std::vector<std::string> canonical;
+        for (const auto& symbol : symbols) {
+            canonical.push_back(to_upper(symbol));
+        }
+        auto assigned = sharder_.assign(canonical);
+        assign_count_slots(canonical);
+        byShard.resize(sharder_.shardCount());
+        for (std::size_t i = 0; i < canonical.size(); ++i) {
+            byShard[assigned[i]].push_back(canonical[i]);
+        }
+    }
+
+    // Subscriptions for connections that are not open yet are sent by on_shard_open
+    if (shards_.size() != byShard.size()) {
+        logger_->info("Queued subscription until connected: {}", json(symbols).dump());
+        return true;
+    }
+
+    try {
+        for (std::size_t i = 0; i < byShard.size(); ++i) {
+            if (byShard[i].empty() || !shards_[i]->connection->isOpen()) {
+                continue;
+            }
+            std::string message = make_subscription("SUBSCRIBE", byShard[i]);
+            logger_->info("Sending subscription message on {}: {}", shard_name(i), message);
+            shards_[i]->connection->send(std::move(message));
+            request_snapshots(byShard[i]);
+        }
+        logger_->info("Subscribed to symbols: {}", json(symbols).dump());
+        return true;
+    } catch (const std::exception& e) {
+        logger_->error("Failed to subscribe: {}", e.what());
+        return false;
+    }
+}
+
+template <BookEventSink Sink>
+bool BasicBinanceAdapter<Sink>::unsubscribe(const std::vector<std::string>& symbols) {
+    std::vector<std::vector<std::string>> byShard;
+    {
+        std::lock_guard<std::mutex> lock(subscriptions_mutex_);
+        byShard.resize(sharder_.shardCount());
+        std::vector<std::string> canonical;
+        for (const auto& symbol : symbols) {
+            canonical.push_back(to_upper(symbol));
+            if (auto shard = sharder_.shardOf(canonical.back())) {
+                byShard[*shard].push_back(canonical.back());
+            }
+        }
+        sharder_.remove(canonical);
+    }
+    {
+        std::lock_guard<std::mutex> lock(book_sync_mutex_);
+        for (const auto& symbols : byShard) {
+            for (const auto& symbol : symbols) {
+                book_sync_.remove(symbol);
+            }
+        }
+    }
+
+    if (!isConnected()) {
+        logger_->error("Not connected");
+        return false;
+    }
+
+    try {
+        for (std::size_t i = 0; i < byShard.size(); ++i) {
+            if (!byShard[i].empty()) {
+                shards_[i]->connection->send(make_subscription("UNSUBSCRIBE", byShard[i]));
+            }
+        }
+        logger_->info("Unsubscribed from symbols: {}", json(symbols).dump());
+        return true;
+    } catch (const std::exception& e) {
+        logger_->error("Failed to unsubscribe: {}", e.what());
+        return false;
+    }
+}
+
+template <BookEventSink Sink>
+void BasicBinanceAdapter<Sink>::setSharding(const SymbolSharder::Config& config) {
+    std::lock_guard<std::mutex> lock(subscriptions_mutex_);
+    auto symbols = sharder_.symbols();
+    sharder_ = SymbolSharder(config);
+    sharder_.assign(symbols);
+}
+
+template <BookEventSink Sink>
+std::optional<std::size_t> BasicBinanceAdapter<Sink>::getShardOf(const std::string& symbol) const {
+    std::lock_guard<std::mutex> lock(subscriptions_mutex_);
+    return sharder_.shardOf(to_upper(symbol));
+}
+
+template <BookEventSink Sink>
+void BasicBinanceAdapter<Sink>::assign_count_slots(const std::vector<std::string>& symbols) {
+    for (const auto& symbol : symbols) {
+        if (count_slots_.contains(symbol)) {
+            continue;
+        }
+        if (counted_symbols_.size() == kMaxCountedSymbols) {
+            logger_->warn("More than {} symbols; {} keeps its estimated rate when rebalancing",
+                          kMaxCountedSymbols, symbol);
+            continue;
+        }
+        count_slots_.emplace(symbol, counted_symbols_.size());
+        counted_symbols_.push_back(symbol);
+    }
+}
+
+template <BookEventSink Sink>
+void BasicBinanceAdapter<Sink>::rebalanceShards() {
+    std::vector<SymbolSharder::Move> moves;
+    {
+        std::lock_guard<std::mutex> lock(subscriptions_mutex_);
+        std::unordered_map<std::string, uint64_t> counts;
+        for (const auto& shard : shards_) {
+            for (std::size_t slot = 0; slot < counted_symbols_.size(); ++slot) {
+                if (uint64_t count = shard->counts[slot].exchange(0, std::memory_order_relaxed)) {
+                    counts[counted_symbols_[slot]] += count;
+                }
+            }
+        }
+        auto now = std::chrono::steady_clock::now();
+        sharder_.observe(counts, now - last_rebalance_);
+        last_rebalance_ = now;
+        moves = sharder_.rebalance();
+    }
+    if (moves.empty() || shards_.size() != sharder_.shardCount()) {
+        return;
+    }
+
+    // Batched per connection: Binance limits how many control messages a connection may send.
+    // The new connection subscribes before the old one leaves, so for a moment both deliver
+    // the symbol from different IO threads; emit_delta and the quote path drop every update id
+    // already passed on, which keeps the book in order with or without snapshots.
+    std::vector<std::vector<std::string>> joining(shards_.size());
+    std::vector<std::vector<std::string>> leaving(shards_.size());
+    for (const auto& move : moves) {
+        logger_->info("Moving {} from {} to {}", move.symbol, shard_name(move.from),
+                      shard_name(move.to));
+        joining[move.to].push_back(move.symbol);
+        leaving[move.from].push_back(move.symbol);
+    }
+    for (std::size_t i = 0; i < shards_.size(); ++i) {
+        if (!joining[i].empty()) {
+            shards_[i]->connection->send(make_subscription("SUBSCRIBE", joining[i]));
+        }
+    }
+    for (std::size_t i = 0; i < shards_.size(); ++i) {
+        if (!leaving[i].empty()) {
+            shards_[i]->connection->send(make_subscription("UNSUBSCRIBE", leaving[i]));
+        }
+    }
+}
+
+template <BookEventSink Sink>
+void BasicBinanceAdapter<Sink>::schedule_rebalance() {
+    rebalance_timer_->expires_after(sharder_.config().rebalanceInterval);
+    rebalance_timer_->async_wait([this](const boost::system::error_code& ec) {
+        if (ec || !rebalance_timer_) {
+            return;
+        }
+        rebalanceShards();
+        schedule_rebalance();
+    });
+}
+
+template <BookEventSink Sink>
+void BasicBinanceAdapter<Sink>::stop_rebalancing() {
+    if (!rebalance_timer_) {
+        return;
+    }
+    // Cancelled on the timer's own thread, so no rebalance is running once this returns
+    auto stop = [this] {
+        rebalance_timer_->cancel();
+        rebalance_timer_.reset();
+    };
+    if (ioc_.get_executor().running_in_this_thread() || ioc_.stopped()) {
+        stop();
+        return;
+    }
+    std::promise<void> done;
+    net::post(ioc_, [&] {
+        stop();
+        done.set_value();
+    });
+    done.get_future().wait();
+}
+
+template <BookEventSink Sink>
+void BasicBinanceAdapter<Sink>::shutdown_shards() {
+    for (const auto& shard : shards_) {
+        if (shard->connection) {
+            shard->connection->shutdown();
+        }
+    }
+    shards_.clear();
+}
+
+template <BookEventSink Sink>
+std::string BasicBinanceAdapter<Sink>::shard_name(std::size_t shard) const {
+    return shard == 0 ? "binance" : "binance/" + std::to_string(shard);
+}
+
+template <BookEventSink Sink>
+void BasicBinanceAdapter<Sink>::publishMetrics(
+    const std::unordered_map<std::string, std::string>& labels) const {
+    auto& reporter = MetricsReporter::getInstance();
+    for (std::size_t i = 0; i < shards_.size(); ++i) {
+        if (shards_[i]->connection) {
+            shards_[i]->connection->publishMetrics(this->metric_labels(shard_name(i), labels));
+        }
+    }
+    auto stats = getTopOfBookStats();
+    const auto venue = this->metric_labels(kName, labels);
+    this->clock_->publishMetrics(venue);
+    reporter.setGauge("top_of_book_quotes", static_cast<double>(stats.quotes), venue);
+    reporter.setGauge("top_of_book_stale_quotes", static_cast<double>(stats.staleQuotes), venue);
+    reporter.setGauge("top_of_book_lead_mean_ns", stats.meanLeadNs, venue);
+    reporter.setGauge("top_of_book_lead_max_ns", static_cast<double>(stats.maxLeadNs), venue);
+    reporter.setGauge("book_snapshots", static_cast<double>(snapshots_.load()), venue);
+    reporter.setGauge("book_snapshot_failures", static_cast<double>(snapshot_failures_.load()),
+                      venue);
+    if (rest_) {
+        auto rest = rest_->getStats();
+        reporter.setGauge("rest_requests", static_cast<double>(rest.requests), venue);
+        reporter.setGauge("rest_retries", static_cast<double>(rest.retries), venue);
+        reporter.setGauge("rest_connections_opened", static_cast<double>(rest.connectionsOpened),
+                          venue);
+        reporter.setGauge("rest_throttled", static_cast<double>(rest.throttled), venue);
+    }
+
+    std::lock_guard<std::mutex> lock(subscriptions_mutex_);
+    for (std::size_t i = 0; i < sharder_.shardCount(); ++i) {
+        reporter.setGauge("symbol_shard_load", sharder_.load(i),
+                          this->metric_labels(shard_name(i), labels));
+    }
+}
+
+template <BookEventSink Sink>
+void BasicBinanceAdapter<Sink>::on_shard_open(std::size_t shard, WsConnection& connection) {
+    // A new session starts with no streams; replay everything assigned to this connection
+    std::vector<std::string> symbols;
+    {
+        std::lock_guard<std::mutex> lock(subscriptions_mutex_);
+        symbols = sharder_.symbolsOn(shard);
+    }
+    if (!symbols.empty()) {
+        logger_->info("Replaying subscriptions on {}: {}", shard_name(shard), json(symbols).dump());
+        connection.send(make_subscription("SUBSCRIBE", symbols));
+        // Updates may have been missed while the connection was down
+        request_snapshots(symbols);
+    }
+}
+
+template <BookEventSink Sink>
+void BasicBinanceAdapter<Sink>::request_snapshots(const std::vector<std::string>& symbols) {
+    if (!bootstrap_) {
+        return;
+    }
+    for (const auto& symbol : symbols) {
+        requestOrderBookSnapshot(symbol);
+    }
+}
+
+template <BookEventSink Sink>
+bool BasicBinanceAdapter<Sink>::requestOrderBookSnapshot(const std::string& symbol) {
+    auto client = rest_;
+    if (!client) {
+        logger_->error("No REST client for a {} depth snapshot", symbol);
+        return false;
+    }
+    std::string canonical = to_upper(symbol);
+    {
+        std::lock_guard<std::mutex> lock(book_sync_mutex_);
+        if (!book_sync_.requestSnapshot(canonical)) {
+            return true;  // Already on its way
+        }
+    }
+
+    std::string target = "/api/v3/depth?symbol=" + canonical +
+                         "&limit=" + std::to_string(snapshot_limit_);
+    client->get(std::move(target),
+        [this, liveness = liveness_, canonical](HttpsClient::Response response) {
+            std::lock_guard<std::mutex> alive(liveness->mutex);
+            if (liveness->alive) {
+                on_snapshot(canonical, std::move(response));
+            }
+        },
+        snapshot_weight(snapshot_limit_));
+    return true;
+}
+
+template <BookEventSink Sink>
+void BasicBinanceAdapter<Sink>::on_snapshot(const std::string& symbol,
+                                            HttpsClient::Response response) {
+    OrderBookSnapshot snapshot;
+    OrderBookDelta unused;
+    if (!response.ok() ||
+        BinanceFrameParser::parse(response.body, snapshot, unused) != FrameType::BookSnapshot) {
+        snapshot_failures_.fetch_add(1, std::memory_order_relaxed);
+        logger_->error("Depth snapshot for {} failed: {}", symbol,
+                       response.error ? response.error.message()
+                                      : std::to_string(response.status) + " " + response.body);
+        std::lock_guard<std::mutex> lock(book_sync_mutex_);
+        book_sync_.snapshotFailed(symbol);
+        return;
+    }
+    snapshot.symbol = symbol;
+    // REST snapshots carry no event time
+    this->stamp(snapshot, ClockOffsetEstimator::steadyNowNs());
+    snapshots_.fetch_add(1, std::memory_order_relaxed);
+
+    std::vector<OrderBookDelta> replay;
+    {
+        std::lock_guard<std::mutex> lock(book_sync_mutex_);
+        switch (book_sync_.onSnapshot(snapshot, replay)) {
+            case DepthBookSync::SnapshotResult::Live:
+                sink_.onSnapshot(snapshot);
+                for (const auto& delta : replay) {
+                    sink_.onDelta(delta);
+                }
+                return;
+            case DepthBookSync::SnapshotResult::Untracked:
+                return;
+            case DepthBookSync::SnapshotResult::Stale:
+                break;
+        }
+    }
+    logger_->info("Depth snapshot for {} at {} is older than the buffered stream; refetching",
+                  symbol, snapshot.sequence);
+    requestOrderBookSnapshot(symbol);
+}
+
+template <BookEventSink Sink>
+void BasicBinanceAdapter<Sink>::emit_delta(const OrderBookDelta& delta) {
+    delta_order_.arbitrate(0, delta.symbol, delta.sequence, delta.receiveTime,
+                           [&] { apply_delta(delta); });
+}
+
+template <BookEventSink Sink>
+void BasicBinanceAdapter<Sink>::apply_delta(const OrderBookDelta& delta) {
+    if (!bootstrap_) {
+        sink_.onDelta(delta);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(book_sync_mutex_);
+        switch (book_sync_.onDelta(delta)) {
+            case DepthBookSync::DeltaAction::Apply:
+                sink_.onDelta(delta);
+                return;
+            case DepthBookSync::DeltaAction::Drop:
+            case DepthBookSync::DeltaAction::Buffer:
+                return;
+            case DepthBookSync::DeltaAction::Gap:
+                break;
+        }
+    }
+    logger_->warn("Gap in the {} depth stream before update {}; fetching a new snapshot",
+                  delta.symbol, delta.firstSequence);
+    requestOrderBookSnapshot(delta.symbol);
+}
+
+template <BookEventSink Sink>
+std::string BasicBinanceAdapter<Sink>::make_subscription(
+    const char* method, const std::vector<std::string>& symbols) const {
+    json message = {
+        {"method", method},
+        {"params", json::array()},
+        {"id", 1}
+    };
+
+    // Stream names are lowercase; symbols are kept as Binance reports them, in uppercase
+    for (const auto& symbol : symbols) {
+        std::string stream = to_lower(symbol);
+        message["params"].push_back(stream + "@" + depth_stream_);
+        if (book_ticker_) {
+            message["params"].push_back(stream + "@bookTicker");
+        }
+    }
+    return message.dump();
+}
+
+template <BookEventSink Sink>
+void BasicBinanceAdapter<Sink>::on_shard_frame(Shard& shard, std::string_view frame) {
+    const int64_t received = ClockOffsetEstimator::steadyNowNs();
+    // Book updates take the schema-specific fast path; everything else goes through json
+    SymbolState* state = nullptr;
+    switch (BinanceFrameParser::parse(frame, shard.snapshot, shard.delta, shard.ticker)) {
+        case FrameType::BookDelta: {
+            this->stamp(shard.delta, received);
+            // Quotes this update catches up with are superseded by the book
+            state = &symbol_state(shard, shard.delta.symbol);
+            state->quotes.onDepth(shard.delta.sequence, received,
+                                  [this](int64_t leadNs) { record_lead(leadNs); });
+            emit_delta(shard.delta);
+            break;
+        }
+        case FrameType::TopOfBook: {
+            this->stamp(shard.ticker, received);
+            // The shard's tracker only sees this connection's depth; a symbol that just moved
+            // here may already be further along on the one it left
+            state = &symbol_state(shard, shard.ticker.symbol);
+            const bool delivered =
+                shard.ticker.sequence > delta_order_.lastDelivered(shard.ticker.symbol) &&
+                state->quotes.onQuote(shard.ticker.sequence, received) &&
+                quote_order_.arbitrate(0, shard.ticker.symbol, shard.ticker.sequence, received,
+                                       [&] { sink_.onTopOfBook(shard.ticker); });
+            (delivered ? quotes_ : stale_quotes_).fetch_add(1, std::memory_order_relaxed);
+            break;
+        }
+        case FrameType::BookSnapshot:
+            this->stamp(shard.snapshot, received);
+            sink_.onSnapshot(shard.snapshot);
+            state = &symbol_state(shard, shard.snapshot.symbol);
+            break;
+        case FrameType::Control:
+            handle_websocket_message(frame);
+            return;
+        case FrameType::Heartbeat:
+            return;
+        case FrameType::Malformed:
+            logger_->warn("Malformed message: {}", frame);
+            return;
+    }
+
+    if (state->count_slot != kNoCountSlot) {
+        shard.counts[state->count_slot].fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+template <BookEventSink Sink>
+auto BasicBinanceAdapter<Sink>::symbol_state(Shard& shard, const std::string& symbol)
+    -> SymbolState& {
+    auto [it, inserted] = shard.symbols.try_emplace(symbol);
+    if (inserted) {
+        std::lock_guard<std::mutex> lock(subscriptions_mutex_);
+        if (auto slot = count_slots_.find(symbol); slot != count_slots_.end()) {
+            it->second.count_slot = slot->second;
+        }
+    }
+    return it->second;
+}
+
+template <BookEventSink Sink>
+void BasicBinanceAdapter<Sink>::record_lead(int64_t leadNs) {
+    lead_samples_.fetch_add(1, std::memory_order_relaxed);
+    lead_total_ns_.fetch_add(leadNs, std::memory_order_relaxed);
+    int64_t max = lead_max_ns_.load(std::memory_order_relaxed);
+    while (leadNs > max && !lead_max_ns_.compare_exchange_weak(max, leadNs,
+                                                               std::memory_order_relaxed)) {
+    }
+}
+
+template <BookEventSink Sink>
+auto BasicBinanceAdapter<Sink>::getTopOfBookStats() const -> TopOfBookStats {
+    TopOfBookStats stats;
+    stats.quotes = quotes_.load(std::memory_order_relaxed);
+    stats.staleQuotes = stale_quotes_.load(std::memory_order_relaxed);
+    stats.leadSamples = lead_samples_.load(std::memory_order_relaxed);
+    if (stats.leadSamples > 0) {
+        stats.meanLeadNs = static_cast<double>(lead_total_ns_.load(std::memory_order_relaxed)) /
+                           static_cast<double>(stats.leadSamples);
+    }
+    stats.maxLeadNs = lead_max_ns_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+template <BookEventSink Sink>
+void BasicBinanceAdapter<Sink>::handle_websocket_message(std::string_view message) {
+    json data = json::parse(message);
+    if (data.contains("result") || data.contains("id")) {
+        // This is a response to our subscription/unsubscription
+        logger_->info("Received response: {}", message);
+        return;
+    }
+    if (data.contains("code") && data.contains("msg")) {
+        logger_->error("Received error message: {}", message);
+        return;
+    }
+    logger_->warn("Unhandled message: {}", message);
+}
+
+} // namespace crypto_hft
@@ -0,0 +1,179 @@
+#include "ClockOffsetEstimator.hpp"
+#include "../infra/MetricsReporter.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <unordered_map>
+
+namespace crypto_hft {
+
+void ClockOffsetEstimator::WindowedMin::offer(int64_t value) {
+    int64_t seen = current.load(std::memory_order_relaxed);
+    while (value < seen &&
+           !current.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {
+    }
+}
+
+int64_t ClockOffsetEstimator::WindowedMin::get() const {
+    return std::min(current.load(std::memory_order_relaxed),
+                    previous.load(std::memory_order_relaxed));
+}
+
+ClockOffsetEstimator::ClockOffsetEstimator()
+    : ClockOffsetEstimator(Options{}) {}
+
+ClockOffsetEstimator::ClockOffsetEstimator(Options options)
+    : options_(options)
+    , halfWindowNs_(std::chrono::duration_cast<std::chrono::nanoseconds>(options.window).count() /
+                    2) {}
+
+void ClockOffsetEstimator::onEvent(int64_t exchangeTimeNs, int64_t receivedNs) {
+    const int64_t delay = receivedNs - exchangeTimeNs;
+    delay_.offer(delay);
+    events_.fetch_add(1, std::memory_order_relaxed);
+
+    if (valid_.load(std::memory_order_acquire)) {
+        // Racing writers may lose each other's step; the average is only reported
+        const int64_t sample = delay + offset_.load(std::memory_order_relaxed);
+        const int64_t latency = latency_.load(std::memory_order_relaxed);
+        latency_.store(latency == 0 ? sample : latency + (sample - latency) / 8,
+                       std::memory_order_relaxed);
+    }
+    maybeUpdate(receivedNs);
+}
+
+void ClockOffsetEstimator::onRoundTrip(int64_t roundTripNs) {
+    roundTrip_.offer(roundTripNs);
+    roundTrips_.fetch_add(1, std::memory_order_relaxed);
+    maybeUpdate(steadyNowNs());
+}
+
+void ClockOffsetEstimator::onServerTime(int64_t serverTimeNs, int64_t sentNs, int64_t receivedNs,
+                                        int64_t resolutionNs) {
+    if (receivedNs < sentNs) {
+        return;
+    }
+    // The venue read its clock somewhere between send and receive, and truncated it
+    ServerSample sample;
+    sample.offsetNs = serverTimeNs + resolutionNs / 2 - (sentNs + (receivedNs - sentNs) / 2);
+    sample.uncertaintyNs = (receivedNs - sentNs) / 2 + resolutionNs / 2;
+    sample.receivedNs = receivedNs;
+    serverTimes_.fetch_add(1, std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    server_[nextServer_] = sample;
+    nextServer_ = (nextServer_ + 1) % kServerSamples;
+    update(receivedNs);
+}
+
+ClockOffsetEstimator::Estimate ClockOffsetEstimator::estimate() const {
+    Estimate estimate;
+    estimate.valid = valid_.load(std::memory_order_acquire);
+    estimate.offsetNs = offset_.load(std::memory_order_relaxed);
+    estimate.uncertaintyNs = uncertainty_.load(std::memory_order_relaxed);
+    const int64_t minRoundTrip = roundTrip_.get();
+    estimate.minRoundTripNs = minRoundTrip == kNone ? 0 : minRoundTrip;
+    estimate.oneWayLatencyNs = latency_.load(std::memory_order_relaxed);
+    const int64_t minDelay = delay_.get();
+    if (estimate.valid && minDelay != kNone) {
+        estimate.minOneWayLatencyNs = minDelay + estimate.offsetNs;
+    }
+    estimate.events = events_.load(std::memory_order_relaxed);
+    estimate.roundTrips = roundTrips_.load(std::memory_order_relaxed);
+    estimate.serverTimes = serverTimes_.load(std::memory_order_relaxed);
+    estimate.steps = steps_.load(std::memory_order_relaxed);
+    return estimate;
+}
+
+void ClockOffsetEstimator::publishMetrics(const std::unordered_map<std::string, std::string>& labels) const {
+    const Estimate estimate = this->estimate();
+    if (!estimate.valid) {
+        return;
+    }
+    auto& reporter = MetricsReporter::getInstance();
+    // Against the local wall clock, which is how a clock offset is usually read
+    const int64_t wallNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    reporter.setGauge("clock_offset_ns",
+                      static_cast<double>(estimate.offsetNs - (wallNs - steadyNowNs())), labels);
+    reporter.setGauge("clock_offset_uncertainty_ns", static_cast<double>(estimate.uncertaintyNs),
+                      labels);
+    reporter.setGauge("clock_offset_steps", static_cast<double>(estimate.steps), labels);
+    reporter.setGauge("clock_min_round_trip_ns", static_cast<double>(estimate.minRoundTripNs),
+                      labels);
+    reporter.setGauge("exchange_latency_ns", static_cast<double>(estimate.oneWayLatencyNs),
+                      labels);
+    reporter.setGauge("exchange_latency_min_ns", static_cast<double>(estimate.minOneWayLatencyNs),
+                      labels);
+}
+
+void ClockOffsetEstimator::maybeUpdate(int64_t nowNs) {
+    if (nowNs < nextUpdateNs_.load(std::memory_order_relaxed)) {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(mutex_, std::try_to_lock);
+    if (lock.owns_lock()) {
+        update(nowNs);
+    }
+}
+
+void ClockOffsetEstimator::update(int64_t nowNs) {
+    nextUpdateNs_.store(nowNs + std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                    options_.updateInterval).count(),
+                        std::memory_order_relaxed);
+    if (nowNs - rotatedNs_ >= halfWindowNs_) {
+        delay_.rotate();
+        roundTrip_.rotate();
+        rotatedNs_ = nowNs;
+    }
+
+    const int64_t minDelay = delay_.get();
+    const int64_t minRoundTrip = roundTrip_.get();
+    int64_t raw = 0;
+    int64_t uncertainty = kNone;
+    bool have = false;
+
+    // The least delayed event, taken to have spent half the least round trip in flight. Event
+    // times truncated to the venue's resolution only add delay, which the minimum filters out.
+    if (minDelay != kNone) {
+        have = true;
+        if (minRoundTrip != kNone) {
+            raw = minRoundTrip / 2 - minDelay;
+            uncertainty = minRoundTrip / 2;
+        } else {
+            raw = -minDelay;
+        }
+    }
+    for (const auto& sample : server_) {
+        if (sample.uncertaintyNs < uncertainty && nowNs - sample.receivedNs <= 2 * halfWindowNs_) {
+            raw = sample.offsetNs;
+            uncertainty = sample.uncertaintyNs;
+            have = true;
+        }
+    }
+    if (!have) {
+        return;
+    }
+    // No message arrives before it was sent
+    if (minDelay != kNone) {
+        raw = std::max(raw, -minDelay);
+    }
+    uncertainty_.store(uncertainty == kNone ? -1 : uncertainty, std::memory_order_relaxed);
+
+    if (!valid_.load(std::memory_order_relaxed)) {
+        offset_.store(raw, std::memory_order_relaxed);
+        valid_.store(true, std::memory_order_release);
+        return;
+    }
+    const int64_t offset = offset_.load(std::memory_order_relaxed);
+    const int64_t error = raw - offset;
+    if (std::llabs(error) > std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                options_.stepThreshold).count()) {
+        steps_.fetch_add(1, std::memory_order_relaxed);
+        offset_.store(raw, std::memory_order_relaxed);
+        return;
+    }
+    offset_.store(offset + static_cast<int64_t>(static_cast<double>(error) * options_.gain),
+                  std::memory_order_relaxed);
+}
+
+} // namespace crypto_hft
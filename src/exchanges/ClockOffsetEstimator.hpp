@@ -0,0 +1,133 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace crypto_hft {
+
+// Where a venue's clock stands against the local steady clock, so that the event times the
+// venue stamps on its messages can be put on the same clock as our own receive times. The
+// offset is venue time (ns since the epoch, as the venue keeps it) minus local steady time;
+// the venue's event time T happened locally at T - offset.
+//
+// Three kinds of observation feed it:
+//  - events: each event time and when it was received. Receive time minus event time is the
+//    one-way latency minus the offset, so its minimum over a window, the least delayed message,
+//    bounds the offset from below and pins it down to within that message's latency;
+//  - round trips of websocket pings: half the smallest recent round trip stands in for that
+//    least latency, assuming the path is symmetric;
+//  - server time probes: a request's send and receive times bracket the venue's answer, which
+//    gives the offset to within half the round trip and the timestamp's resolution.
+// The raw offset is whichever of the event and probe estimates is tighter, never below the
+// event bound, and is smoothed with an EWMA; changes beyond stepThreshold are taken at once.
+//
+// onEvent() and onRoundTrip() are cheap enough for the read path and may be called from any
+// thread; the filter itself runs at most every updateInterval, on whichever caller gets there.
+class ClockOffsetEstimator {
+public:
+    struct Options {
+        // Minima are taken over at least this long and at most twice it
+        std::chrono::seconds window{30};
+        double gain = 0.125;
+        std::chrono::milliseconds stepThreshold{500};
+        std::chrono::milliseconds updateInterval{100};
+    };
+
+    struct Estimate {
+        bool valid = false;         // Nothing else is meaningful until there is an observation
+        int64_t offsetNs = 0;       // Venue clock minus local steady clock
+        int64_t uncertaintyNs = -1; // Bound on the raw offset's error; -1 without RTT or probes
+        int64_t minRoundTripNs = 0;    // Smallest recent ping round trip, 0 without pings
+        int64_t oneWayLatencyNs = 0;   // Smoothed venue event to local receive
+        int64_t minOneWayLatencyNs = 0;
+        uint64_t events = 0;
+        uint64_t roundTrips = 0;
+        uint64_t serverTimes = 0;
+        uint64_t steps = 0;  // Times the filter jumped instead of converging
+    };
+
+    ClockOffsetEstimator();
+    explicit ClockOffsetEstimator(Options options);
+
+    ClockOffsetEstimator(const ClockOffsetEstimator&) = delete;
+    ClockOffsetEstimator& operator=(const ClockOffsetEstimator&) = delete;
+
+    // A venue event stamped exchangeTimeNs (venue clock, ns since the epoch) was received at
+    // receivedNs (local steady clock)
+    void onEvent(int64_t exchangeTimeNs, int64_t receivedNs);
+    void onRoundTrip(int64_t roundTripNs);
+    // A request sent at sentNs and answered at receivedNs (local steady clock) reported the
+    // venue's time as serverTimeNs, truncated to resolutionNs
+    void onServerTime(int64_t serverTimeNs, int64_t sentNs, int64_t receivedNs,
+                      int64_t resolutionNs);
+
+    // exchangeTimeNs on the local steady clock; 0 until there is an estimate
+    int64_t toLocal(int64_t exchangeTimeNs) const {
+        if (!valid_.load(std::memory_order_acquire)) {
+            return 0;
+        }
+        return exchangeTimeNs - offset_.load(std::memory_order_relaxed);
+    }
+    Estimate estimate() const;
+    // Pushes estimate() to MetricsReporter as clock_offset_* and exchange_latency_* gauges with
+    // the given labels
+    void publishMetrics(const std::unordered_map<std::string, std::string>& labels) const;
+
+    static int64_t steadyNowNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+private:
+    static constexpr int64_t kNone = INT64_MAX;
+    static constexpr std::size_t kServerSamples = 8;
+
+    // Minimum over the current and the previous half window; rotated by update()
+    struct WindowedMin {
+        std::atomic<int64_t> current{kNone};
+        std::atomic<int64_t> previous{kNone};
+
+        void offer(int64_t value);
+        int64_t get() const;
+        void rotate() { previous.store(current.exchange(kNone)); }
+    };
+
+    struct ServerSample {
+        int64_t offsetNs = 0;
+        int64_t uncertaintyNs = kNone;
+        int64_t receivedNs = 0;
+    };
+
+    // Runs the filter if updateInterval has passed and no other thread is running it
+    void maybeUpdate(int64_t nowNs);
+    void update(int64_t nowNs);
+
+    const Options options_;
+    const int64_t halfWindowNs_;
+
+    WindowedMin delay_;      // Receive minus event time
+    WindowedMin roundTrip_;
+    std::atomic<int64_t> nextUpdateNs_{0};
+
+    std::atomic<bool> valid_{false};
+    std::atomic<int64_t> offset_{0};
+    std::atomic<int64_t> uncertainty_{-1};
+    std::atomic<int64_t> latency_{0};
+    std::atomic<uint64_t> events_{0};
+    std::atomic<uint64_t> roundTrips_{0};
+    std::atomic<uint64_t> serverTimes_{0};
+    std::atomic<uint64_t> steps_{0};
+
+    // Filter state, under mutex_
+    std::mutex mutex_;
+    int64_t rotatedNs_ = 0;
+    std::array<ServerSample, kServerSamples> server_{};
+    std::size_t nextServer_ = 0;
+};
+
+} // namespace crypto_hft
@@ -1,122 +1,305 @@
 #pragma once
 
-#include "IExchangeAdapter.hpp"
-#include <boost/beast/core.hpp>
-#include <boost/beast/ssl.hpp>
-#include <boost/beast/websocket.hpp>
-#include <boost/beast/websocket/ssl.hpp>
-#include <boost/beast/http.hpp>
+#include "AdapterCore.hpp"
+#include "FrameParser.hpp"
+#include "CoinbaseJwtProvider.hpp"
+#include "../infra/MetricsReporter.hpp"
 #include <nlohmann/json.hpp>
+#include <atomic>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <unordered_set>
 #include <vector>
-#include <thread>
-#include <mutex>
-#include <condition_variable>
-#include <queue>
-#include <atomic>
-#include <functional>
-#include <boost/asio/steady_timer.hpp>
-#include <boost/asio/io_context.hpp>
-#include <boost/asio/strand.hpp>
-#include <spdlog/spdlog.h>
-#include <spdlog/sinks/stdout_color_sinks.h>
-#include <yaml-cpp/yaml.h>
 
 using json = nlohmann::json;
-namespace beast = boost::beast;
-namespace websocket = beast::websocket;
-namespace net = boost::asio;
-namespace ssl = boost::asio::ssl;
-using tcp = boost::asio::ip::tcp;
 
 namespace crypto_hft {
 
-// Forward declarations
-struct OrderBookEntry {
-    double price;
-    double size;
-};
-
-// Message handler types
-using MarketDataHandler = std::function<void(const MarketData&)>;
-using OrderBookSnapshotHandler = std::function<void(const OrderBookSnapshot&)>;
-using OrderBookDeltaHandler = std::function<void(const OrderBookDelta&)>;
-using ExecutionHandler = std::function<void(const OrderResponse&)>;
+// Coinbase Advanced Trade level2 feed. Book events go to Sink; CoinbaseAdapter delivers them
+// to the callbacks registered through IExchangeAdapter.
+template <BookEventSink Sink = CallbackSink>
+class BasicCoinbaseAdapter : public AdapterCore<BasicCoinbaseAdapter<Sink>, Sink> {
+    using Core = AdapterCore<BasicCoinbaseAdapter<Sink>, Sink>;
+    friend Core;
 
-class CoinbaseAdapter : public IExchangeAdapter {
 public:
-    CoinbaseAdapter();
-    ~CoinbaseAdapter() override;
-
-    // Prevent copying
-    CoinbaseAdapter(const CoinbaseAdapter&) = delete;
-    CoinbaseAdapter& operator=(const CoinbaseAdapter&) = delete;
-
-    // IExchangeAdapter interface implementation
-    bool connect() override;
-    void disconnect() override;
-    bool isConnected() const override;
-    bool subscribe(const std::vector<std::string>& symbols) override;
-    bool unsubscribe(const std::vector<std::string>& symbols) override;
-    void set_message_handler(MarketDataHandler handler) { market_data_handler_ = handler; }
-
-    // IExchangeAdapter interface implementation
-    std::string getName() const override;
-    bool supportsMargin() const override;
-    double getFeeRate(const std::string& symbol) const override;
-    double getBalance(const std::string& currency) const override;
-    std::vector<std::pair<std::string, double>> getAllBalances() const override;
-    std::string submitOrder(const OrderRequest& request) override;
-    bool cancelOrder(const std::string& order_id) override;
-    bool modifyOrder(const std::string& order_id, double new_price, double new_size) override;
-    bool requestOrderBookSnapshot(const std::string& symbol) override;
-    void registerOrderBookCallback(OrderBookSnapshotHandler callback) override;
-    void registerOrderBookDeltaCallback(OrderBookDeltaHandler callback) override;
-    void registerExecutionCallback(ExecutionHandler callback) override;
+    static constexpr const char* kVenue = "coinbase";
+    static constexpr const char* kName = "coinbase";
+    // sequence_num numbers a connection's messages, not the book's updates
+    static constexpr bool kSequencedBook = false;
+
+    // IO runs on the runtime's context for "coinbase"; without a runtime the adapter gets a
+    // private single-threaded one
+    explicit BasicCoinbaseAdapter(std::shared_ptr<AdapterRuntime> runtime = nullptr,
+                                  Sink sink = Sink())
+        : Core(std::move(runtime), std::move(sink)) {}
+    ~BasicCoinbaseAdapter() override { this->shutdown_session(); }
+
+    void disconnect() override {
+        Core::disconnect();
+        authenticated_ = false;
+    }
+
+    bool supportsMargin() const override { return false; }
+    double getFeeRate(const std::string&) const override { return 0.005; }  // 0.5% default fee
+    bool requestOrderBookSnapshot(const std::string&) override { return false; }
+
+    // Signs every session's authenticate message, and can be shared with REST order entry.
+    // Without one, connect() loads the key from the environment. Set it before connect().
+    void setJwtProvider(std::shared_ptr<CoinbaseJwtProvider> jwt) { jwt_ = std::move(jwt); }
+    // Breaks in the connection's sequence_num, each of which resubscribed every product
+    uint64_t getSequenceGaps() const { return sequence_gaps_.load(); }
+    // Pushes connection, receive-latency and sequence gap statistics to MetricsReporter
+    void publishMetrics(const std::unordered_map<std::string, std::string>& labels = {}) const override;
 
 private:
-    void on_message(beast::error_code ec, [[maybe_unused]] std::size_t bytes_transferred);
-    void on_connect(beast::error_code ec);
-    void on_close(beast::error_code ec);
-    void on_error(beast::error_code ec);
-    void handle_websocket_message(const std::string& message);
-    void handle_ticker_message(const json& data);
-    void handle_snapshot_message(const json& data);
-    void handle_l2update_message(const json& data);
-    void handle_heartbeat_message(const json& data);
+    using Core::connection_;
+    using Core::logger_;
+    using Core::sink_;
+
+    void before_connect();
+    WsConnection::Options session_options() const;
+    static ServerTimeProbe::Endpoint server_time_endpoint();
+    void on_open(WsConnection& connection);
+    void on_frame(std::string_view frame);
+    void track_sequence(uint64_t sequence);
+    void emit_batch(int64_t received);
+    std::string make_subscription(const char* type, const std::vector<std::string>& products) const;
+    void handle_websocket_message(std::string_view message);
     void handle_error_message(const json& data);
-    void initialize_logger();
-    void load_config(const std::string& config_path);
-    // void validate_config() const;
-    void do_read();
-    void do_write(const std::string& message);
-
-    // WebSocket client
-    net::io_context ioc_;
-    boost::asio::executor_work_guard<boost::asio::io_context::executor_type> work_guard_;
-    net::strand<net::io_context::executor_type> strand_;
-    ssl::context ctx_{ssl::context::tlsv12_client};
-    std::unique_ptr<websocket::stream<beast::ssl_stream<tcp::socket>>> ws_;
-    
-    std::thread io_thread_;
-    std::mutex mutex_;
-    std::condition_variable cv_;
-    std::queue<std::string> message_queue_;
-    MarketDataHandler market_data_handler_;
-    OrderBookSnapshotHandler order_book_callback_;
-    OrderBookDeltaHandler order_book_delta_callback_;
-    ExecutionHandler execution_callback_;
-    std::atomic<bool> running_{false};
-    std::atomic<bool> connected_{false};
+
+    std::shared_ptr<CoinbaseJwtProvider> jwt_;
     std::atomic<bool> authenticated_ = false;  // Track authentication state
-    std::string api_key_;
-    std::string api_secret_;
-    std::string base_url_;
-    YAML::Node config_;
-    std::shared_ptr<spdlog::logger> logger_;
-    beast::flat_buffer buffer_;
-    std::string host_;  // Store the WebSocket host name
+
+    // Parse output, reused across frames
+    CoinbaseBookBatch batch_;
+
+    // Advanced Trade numbers every message of a connection. After a break the books are
+    // resubscribed and each product's updates are dropped until its new snapshot.
+    // Both are only touched from the connection's handlers.
+    std::optional<uint64_t> last_sequence_;
+    std::unordered_set<std::string> awaiting_snapshot_;
+    std::atomic<uint64_t> sequence_gaps_{0};
 };
 
-} // namespace crypto_hft 
\ No newline at end of file
+using CoinbaseAdapter = BasicCoinbaseAdapter<>;
+extern template class BasicCoinbaseAdapter<CallbackSink>;
+
+template <BookEventSink Sink>
+void BasicCoinbaseAdapter<Sink>::before_connect() {
+    if (!jwt_) {
+        jwt_ = CoinbaseJwtProvider::fromEnvironment(CoinbaseJwtProvider::Options(), logger_);
+    }
+}
+
+template <BookEventSink Sink>
+WsConnection::Options BasicCoinbaseAdapter<Sink>::session_options() const {
+    WsConnection::Options options;
+    options.host = "advanced-trade-ws.coinbase.com";
+    return options;
+}
+
+template <BookEventSink Sink>
+ServerTimeProbe::Endpoint BasicCoinbaseAdapter<Sink>::server_time_endpoint() {
+    ServerTimeProbe::Endpoint endpoint;
+    endpoint.rest.host = "api.coinbase.com";
+    endpoint.target = "/api/v3/brokerage/time";
+    endpoint.parse = [](std::string_view body, int64_t& serverTimeNs) {
+        json data = json::parse(body, nullptr, false);
+        if (data.is_discarded() || !data.contains("epochMillis")) {
+            return false;
+        }
+        // Sent as a string
+        const json& millis = data["epochMillis"];
+        serverTimeNs = (millis.is_string() ? std::stoll(millis.get<std::string>())
+                                           : millis.get<int64_t>()) * 1000000;
+        return serverTimeNs > 0;
+    };
+    return endpoint;
+}
+
+template <BookEventSink Sink>
+void BasicCoinbaseAdapter<Sink>::on_open(WsConnection& connection) {
+    // Every session authenticates on its own; the subscriptions follow on the same socket
+    authenticated_ = false;
+    try {
+        json auth_msg = {
+            {"type", "authenticate"},
+            {"token", *jwt_->token()}
+        };
+        connection.send(auth_msg.dump());
+        logger_->info("Sent authentication request to Coinbase");
+
+        // Note: The actual authentication success/failure will be handled in
+        // handle_websocket_message when we receive the authenticate response
+    } catch (const std::exception& e) {
+        logger_->error("Failed to authenticate: {}", e.what());
+        connection.close();
+        return;
+    }
+
+    // The new session numbers its messages from scratch and snapshots every product
+    last_sequence_.reset();
+    awaiting_snapshot_.clear();
+    this->replay_subscriptions(connection);
+}
+
+template <BookEventSink Sink>
+std::string BasicCoinbaseAdapter<Sink>::make_subscription(
+    const char* type, const std::vector<std::string>& products) const {
+    json message = {
+        {"type", type},
+        {"product_ids", products},
+        {"channel", "level2"}
+    };
+    return message.dump();
+}
+
+template <BookEventSink Sink>
+void BasicCoinbaseAdapter<Sink>::on_frame(std::string_view frame) {
+    const int64_t received = ClockOffsetEstimator::steadyNowNs();
+    // Book updates take the schema-specific fast path; everything else goes through json
+    FrameType type = CoinbaseFrameParser::parse(frame, batch_);
+    if (batch_.hasSequence) {
+        track_sequence(batch_.sequence);
+    }
+    switch (type) {
+        case FrameType::BookDelta:
+        case FrameType::BookSnapshot:
+            emit_batch(received);
+            break;
+        case FrameType::Control:
+            handle_websocket_message(frame);
+            break;
+        case FrameType::TopOfBook:  // Not produced by this venue's parser
+        case FrameType::Heartbeat:
+            break;
+        case FrameType::Malformed:
+            logger_->warn("Malformed message: {}", frame);
+            break;
+    }
+}
+
+template <BookEventSink Sink>
+void BasicCoinbaseAdapter<Sink>::track_sequence(uint64_t sequence) {
+    const bool gap = last_sequence_ && sequence != *last_sequence_ + 1;
+    last_sequence_ = sequence;
+    if (!gap) {
+        return;
+    }
+
+    // The numbering spans every channel, so there is no telling which books missed updates
+    sequence_gaps_.fetch_add(1, std::memory_order_relaxed);
+    std::vector<std::string> products = this->subscribed();
+    logger_->warn("Coinbase sequence jumped to {}; resubscribing {}", sequence,
+                  json(products).dump());
+    awaiting_snapshot_.insert(products.begin(), products.end());
+    if (this->isConnected() && !products.empty()) {
+        connection_->send(make_subscription("unsubscribe", products));
+        connection_->send(make_subscription("subscribe", products));
+    }
+}
+
+template <BookEventSink Sink>
+void BasicCoinbaseAdapter<Sink>::emit_batch(int64_t received) {
+    // Snapshots first: a message carrying both has its updates on top of the snapshot
+    for (std::size_t i = 0; i < batch_.snapshotCount; ++i) {
+        OrderBookSnapshot& snapshot = batch_.snapshots[i];
+        this->stamp(snapshot, received);
+        if (!awaiting_snapshot_.empty()) {
+            awaiting_snapshot_.erase(snapshot.symbol);
+        }
+        sink_.onSnapshot(snapshot);
+    }
+    for (std::size_t i = 0; i < batch_.deltaCount; ++i) {
+        OrderBookDelta& delta = batch_.deltas[i];
+        if (!awaiting_snapshot_.empty() && awaiting_snapshot_.count(delta.symbol)) {
+            continue;
+        }
+        this->stamp(delta, received);
+        sink_.onDelta(delta);
+    }
+}
+
+template <BookEventSink Sink>
+void BasicCoinbaseAdapter<Sink>::publishMetrics(
+    const std::unordered_map<std::string, std::string>& labels) const {
+    this->publish_connection_metrics(labels);
+    MetricsReporter::getInstance().setGauge("sequence_gaps",
+                                            static_cast<double>(sequence_gaps_.load()),
+                                            this->metric_labels(kName, labels));
+}
+
+template <BookEventSink Sink>
+void BasicCoinbaseAdapter<Sink>::handle_websocket_message(std::string_view message) {
+    try {
+        json data = json::parse(message);
+
+        // Handle different message types
+        if (data.contains("type")) {
+            std::string type = data["type"];
+
+            if (type == "ticker") {
+                logger_->debug("Received ticker message: {}", message);
+            } else if (type == "heartbeat") {
+                logger_->debug("Received heartbeat for product: {}",
+                               data.value("product_id", ""));
+            } else if (type == "error") {
+                handle_error_message(data);
+                // If authentication failed, disconnect
+                if (data.contains("error") && data["error"].get<std::string>() == "authentication_failed") {
+                    disconnect();
+                }
+            } else if (type == "authenticate") {
+                if (data.contains("success") && data["success"].get<bool>()) {
+                    logger_->info("Successfully authenticated with Coinbase");
+                    authenticated_ = true;
+                } else {
+                    logger_->error("Authentication failed: {}", message);
+                    authenticated_ = false;
+                    disconnect();
+                }
+            } else if (type == "subscriptions") {
+                logger_->info("Received subscription confirmation: {}", message);
+            } else {
+                logger_->warn("Unknown message type: {}", type);
+            }
+        } else if (data.contains("channel")) {
+            // Advanced Trade: book data and heartbeats never get here
+            std::string channel = data["channel"];
+            if (channel == "subscriptions") {
+                logger_->info("Received subscription confirmation: {}", message);
+            } else {
+                logger_->debug("Unhandled {} message: {}", channel, message);
+            }
+        } else {
+            logger_->warn("Message without type field: {}", message);
+        }
+    } catch (const std::exception& e) {
+        logger_->error("Error parsing message: {} - Raw message: {}", e.what(), message);
+    }
+}
+
+template <BookEventSink Sink>
+void BasicCoinbaseAdapter<Sink>::handle_error_message(const json& data) {
+    try {
+        std::string error_message = "Unknown error";
+        if (data.contains("message")) {
+            error_message = data["message"].get<std::string>();
+        }
+        if (data.contains("error")) {
+            error_message = data["error"].get<std::string>();
+        }
+        if (data.contains("details")) {
+            error_message += " - Details: " + data["details"].dump();
+        }
+        logger_->error("Received error from Coinbase: {}", error_message);
+    } catch (const std::exception& e) {
+        logger_->error("Error handling error message: {}", e.what());
+    }
+}
+
+} // namespace crypto_hft
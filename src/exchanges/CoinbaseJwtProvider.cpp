@@ -0,0 +1,250 @@
+#include "CoinbaseJwtProvider.hpp"
+#include "utils.hpp"
+#include <nlohmann/json.hpp>
+#include <openssl/bio.h>
+#include <openssl/bn.h>
+#include <openssl/ecdsa.h>
+#include <openssl/pem.h>
+#include <openssl/rand.h>
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+#include <vector>
+
+namespace crypto_hft {
+
+using json = nlohmann::json;
+
+namespace {
+
+std::string base64Url(const unsigned char* bytes, std::size_t size) {
+    std::string out(4 * ((size + 2) / 3) + 1, '\0');
+    int length = EVP_EncodeBlock(reinterpret_cast<unsigned char*>(out.data()), bytes,
+                                 static_cast<int>(size));
+    out.resize(static_cast<std::size_t>(std::max(length, 0)));
+    while (!out.empty() && out.back() == '=') {
+        out.pop_back();
+    }
+    std::replace(out.begin(), out.end(), '+', '-');
+    std::replace(out.begin(), out.end(), '/', '_');
+    return out;
+}
+
+std::string base64Url(std::string_view text) {
+    return base64Url(reinterpret_cast<const unsigned char*>(text.data()), text.size());
+}
+
+std::string randomHex(std::size_t bytes) {
+    static constexpr char kHex[] = "0123456789abcdef";
+    std::vector<unsigned char> raw(bytes);
+    if (RAND_bytes(raw.data(), static_cast<int>(raw.size())) != 1) {
+        throw std::runtime_error("RAND_bytes failed");
+    }
+    std::string out;
+    out.reserve(bytes * 2);
+    for (unsigned char u : raw) {
+        out += kHex[u >> 4];
+        out += kHex[u & 0xF];
+    }
+    return out;
+}
+
+// JWS ES256 signatures are r || s, 32 bytes each, rather than OpenSSL's DER
+std::string signEs256(EVP_PKEY* key, std::string_view data) {
+    EVP_MD_CTX* md = EVP_MD_CTX_new();
+    std::vector<unsigned char> der;
+    std::size_t derSize = 0;
+    bool ok = md != nullptr &&
+              EVP_DigestSignInit(md, nullptr, EVP_sha256(), nullptr, key) == 1 &&
+              EVP_DigestSign(md, nullptr, &derSize,
+                             reinterpret_cast<const unsigned char*>(data.data()),
+                             data.size()) == 1;
+    if (ok) {
+        der.resize(derSize);
+        ok = EVP_DigestSign(md, der.data(), &derSize,
+                            reinterpret_cast<const unsigned char*>(data.data()),
+                            data.size()) == 1;
+    }
+    EVP_MD_CTX_free(md);
+
+    const unsigned char* p = der.data();
+    ECDSA_SIG* signature = ok ? d2i_ECDSA_SIG(nullptr, &p, static_cast<long>(derSize)) : nullptr;
+    if (signature == nullptr) {
+        throw std::runtime_error("ES256 signing failed");
+    }
+    unsigned char raw[64];
+    const BIGNUM* r = nullptr;
+    const BIGNUM* s = nullptr;
+    ECDSA_SIG_get0(signature, &r, &s);
+    BN_bn2binpad(r, raw, 32);
+    BN_bn2binpad(s, raw + 32, 32);
+    ECDSA_SIG_free(signature);
+    return base64Url(raw, sizeof(raw));
+}
+
+} // namespace
+
+CoinbaseJwtProvider::CoinbaseJwtProvider(std::string keyName, std::string_view privateKeyPem,
+                                         Options options, std::shared_ptr<spdlog::logger> logger)
+    : keyName_(std::move(keyName))
+    , options_(options)
+    , logger_(logger ? std::move(logger) : spdlog::default_logger()) {
+    BIO* bio = BIO_new_mem_buf(privateKeyPem.data(), static_cast<int>(privateKeyPem.size()));
+    key_ = bio ? PEM_read_bio_PrivateKey(bio, nullptr, nullptr, nullptr) : nullptr;
+    BIO_free(bio);
+
+    char group[32] = {};
+    std::size_t groupSize = 0;
+    if (key_ == nullptr || !EVP_PKEY_is_a(key_, "EC") ||
+        EVP_PKEY_get_group_name(key_, group, sizeof(group), &groupSize) != 1 ||
+        std::string_view(group, groupSize) != "prime256v1") {
+        EVP_PKEY_free(key_);
+        throw std::invalid_argument("Coinbase API secret is not a P-256 private key");
+    }
+    // Tokens are issued with second resolution; anything shorter would keep the refresher spinning
+    options_.refreshAfter = std::max(options_.refreshAfter, std::chrono::seconds(1));
+    refresher_ = std::thread([this] { refreshLoop(); });
+}
+
+std::shared_ptr<CoinbaseJwtProvider> CoinbaseJwtProvider::fromEnvironment(
+    Options options, std::shared_ptr<spdlog::logger> logger) {
+    utils::load_env_file();
+    const char* keyName = std::getenv("COINBASE_KEY_NAME");
+    const char* keySecret = std::getenv("COINBASE_KEY_SECRET");
+    if (keyName == nullptr || keySecret == nullptr) {
+        throw std::runtime_error(
+            "Missing required environment variables: COINBASE_KEY_NAME or COINBASE_KEY_SECRET");
+    }
+    // .env files carry the PEM on one line, with literal \n for its line breaks
+    std::string pem = keySecret;
+    std::size_t pos = 0;
+    while ((pos = pem.find("\\n", pos)) != std::string::npos) {
+        pem.replace(pos, 2, "\n");
+    }
+    return std::make_shared<CoinbaseJwtProvider>(keyName, pem, options, std::move(logger));
+}
+
+CoinbaseJwtProvider::~CoinbaseJwtProvider() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_one();
+    refresher_.join();
+    EVP_PKEY_free(key_);
+}
+
+std::shared_ptr<const std::string> CoinbaseJwtProvider::token(std::string_view uri) {
+    if (Slot* slot = find(uri)) {
+        auto current = slot->token.load(std::memory_order_acquire);
+        if (Clock::now() - current->issued < options_.maxAge) {
+            return jwtOf(std::move(current));
+        }
+    }
+    return mintNow(uri);
+}
+
+std::function<std::string(std::string_view, std::string_view)> CoinbaseJwtProvider::tokenSource(
+    std::string host) {
+    return [this, host = std::move(host)](std::string_view method, std::string_view path) {
+        std::string uri;
+        uri.reserve(method.size() + host.size() + path.size() + 1);
+        uri.append(method);
+        uri += ' ';
+        uri += host;
+        uri.append(path);
+        return *token(uri);
+    };
+}
+
+CoinbaseJwtProvider::Slot* CoinbaseJwtProvider::find(std::string_view uri) {
+    std::size_t count = slotCount_.load(std::memory_order_acquire);
+    for (std::size_t i = 0; i < count; ++i) {
+        if (slots_[i].uri == uri) {
+            return &slots_[i];
+        }
+    }
+    return nullptr;
+}
+
+std::shared_ptr<const std::string> CoinbaseJwtProvider::mintNow(std::string_view uri) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Slot* slot = find(uri);
+    if (slot != nullptr) {
+        // Another caller or the refresher may have got here first
+        auto current = slot->token.load(std::memory_order_acquire);
+        if (Clock::now() - current->issued < options_.maxAge) {
+            return jwtOf(std::move(current));
+        }
+        logger_->warn("Coinbase JWT for '{}' was not refreshed in time", uri);
+    }
+
+    auto fresh = mint(uri);
+    if (slot != nullptr) {
+        slot->token.store(fresh, std::memory_order_release);
+        return jwtOf(std::move(fresh));
+    }
+    std::size_t count = slotCount_.load(std::memory_order_relaxed);
+    if (count == kMaxUris) {
+        return jwtOf(std::move(fresh));
+    }
+    slots_[count].uri = std::string(uri);
+    slots_[count].token.store(fresh, std::memory_order_relaxed);
+    slotCount_.store(count + 1, std::memory_order_release);
+    // The refresher schedules the new URI
+    wake_.notify_one();
+    return jwtOf(std::move(fresh));
+}
+
+std::shared_ptr<const CoinbaseJwtProvider::Token> CoinbaseJwtProvider::mint(
+    std::string_view uri) {
+    auto now = Clock::now();
+    auto seconds = std::chrono::duration_cast<std::chrono::seconds>(now.time_since_epoch());
+    json header = {{"alg", "ES256"}, {"typ", "JWT"}, {"kid", keyName_}, {"nonce", randomHex(16)}};
+    json claims = {{"iss", "cdp"},
+                   {"sub", keyName_},
+                   {"nbf", seconds.count()},
+                   {"exp", (seconds + options_.lifetime).count()}};
+    if (!uri.empty()) {
+        claims["uri"] = std::string(uri);
+    }
+
+    std::string jwt = base64Url(header.dump());
+    jwt += '.';
+    jwt += base64Url(claims.dump());
+    std::string signature = signEs256(key_, jwt);
+    jwt += '.';
+    jwt += signature;
+    minted_.fetch_add(1, std::memory_order_relaxed);
+    return std::make_shared<const Token>(Token{std::move(jwt), now});
+}
+
+void CoinbaseJwtProvider::refreshLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+        auto now = Clock::now();
+        auto next = Clock::time_point::max();
+        std::size_t count = slotCount_.load(std::memory_order_relaxed);
+        for (std::size_t i = 0; i < count; ++i) {
+            auto current = slots_[i].token.load(std::memory_order_relaxed);
+            if (now - current->issued >= options_.refreshAfter) {
+                try {
+                    current = mint(slots_[i].uri);
+                    slots_[i].token.store(current, std::memory_order_release);
+                } catch (const std::exception& e) {
+                    logger_->error("Failed to refresh Coinbase JWT: {}", e.what());
+                    next = std::min(next, now + std::chrono::seconds(1));
+                    continue;
+                }
+            }
+            next = std::min(next, current->issued + options_.refreshAfter);
+        }
+        if (next == Clock::time_point::max()) {
+            wake_.wait(lock);
+        } else {
+            wake_.wait_until(lock, next);
+        }
+    }
+}
+
+} // namespace crypto_hft
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <openssl/evp.h>
+#include <spdlog/spdlog.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+namespace crypto_hft {
+
+// ES256 JWTs for Coinbase Advanced Trade, signed with a CDP API key. The EC key is parsed once,
+// tokens are cached per request URI, and a background thread mints each URI's next token before
+// the current one gets old, so token() is an atomic pointer load on the hot path. A token is
+// only minted on the calling thread the first time its URI is asked for, or if the background
+// thread has fallen behind. Thread-safe.
+class CoinbaseJwtProvider {
+public:
+    struct Options {
+        std::chrono::seconds lifetime{120};      // Coinbase accepts at most two minutes
+        std::chrono::seconds refreshAfter{60};   // Tokens are replaced once this old
+        std::chrono::seconds maxAge{100};        // and never handed out once this old
+    };
+    // URIs cached; tokens for further URIs are minted per call
+    static constexpr std::size_t kMaxUris = 16;
+
+    // keyName is "organizations/{org}/apiKeys/{key}"; privateKeyPem is its P-256 key. Throws
+    // std::invalid_argument if the key cannot be read or is not a P-256 key.
+    CoinbaseJwtProvider(std::string keyName, std::string_view privateKeyPem, Options options,
+                        std::shared_ptr<spdlog::logger> logger = nullptr);
+    CoinbaseJwtProvider(std::string keyName, std::string_view privateKeyPem)
+        : CoinbaseJwtProvider(std::move(keyName), privateKeyPem, Options()) {}
+    // COINBASE_KEY_NAME and COINBASE_KEY_SECRET, from the environment or .env; throws
+    // std::runtime_error if either is missing
+    static std::shared_ptr<CoinbaseJwtProvider> fromEnvironment(
+        Options options, std::shared_ptr<spdlog::logger> logger = nullptr);
+    ~CoinbaseJwtProvider();
+
+    CoinbaseJwtProvider(const CoinbaseJwtProvider&) = delete;
+    CoinbaseJwtProvider& operator=(const CoinbaseJwtProvider&) = delete;
+
+    // A token for the websocket authenticate message, which carries no uri claim
+    std::shared_ptr<const std::string> token() { return token(std::string_view()); }
+    // A token for REST requests to uri, e.g. "POST api.coinbase.com/api/v3/brokerage/orders"
+    std::shared_ptr<const std::string> token(std::string_view uri);
+    // For CoinbaseRestOrderEntry: a token for (method, path) on host
+    std::function<std::string(std::string_view method, std::string_view path)> tokenSource(
+        std::string host = "api.coinbase.com");
+
+    // Tokens signed so far, in the background or not
+    uint64_t minted() const { return minted_.load(std::memory_order_relaxed); }
+
+private:
+    using Clock = std::chrono::system_clock;
+
+    struct Token {
+        std::string jwt;
+        Clock::time_point issued;
+    };
+    struct Slot {
+        std::string uri;  // Written before the slot is published
+        std::atomic<std::shared_ptr<const Token>> token;
+    };
+
+    static std::shared_ptr<const std::string> jwtOf(std::shared_ptr<const Token> token) {
+        const std::string* jwt = &token->jwt;
+        return std::shared_ptr<const std::string>(std::move(token), jwt);
+    }
+
+    Slot* find(std::string_view uri);
+    std::shared_ptr<const Token> mint(std::string_view uri);  // Under mutex_
+    std::shared_ptr<const std::string> mintNow(std::string_view uri);
+    void refreshLoop();
+
+    std::string keyName_;
+    EVP_PKEY* key_ = nullptr;
+    Options options_;
+    std::shared_ptr<spdlog::logger> logger_;
+
+    std::array<Slot, kMaxUris> slots_;
+    std::atomic<std::size_t> slotCount_{0};
+    std::atomic<uint64_t> minted_{0};
+
+    std::mutex mutex_;  // Minting and slot creation
+    std::condition_variable wake_;
+    bool stopping_ = false;
+    std::thread refresher_;
+};
+
+} // namespace crypto_hft
@@ -0,0 +1,160 @@
+#include "ConnectionProfile.hpp"
+#include <boost/asio/error.hpp>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#if defined(__linux__)
+#include <linux/errqueue.h>
+#include <linux/net_tstamp.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#endif
+
+namespace crypto_hft {
+
+namespace {
+
+#if defined(__linux__)
+// Raw setsockopt for options asio has no type for; errno is captured before anything else
+// can overwrite it
+boost::system::error_code setIntOption(int fd, int level, int name, int value) {
+    if (::setsockopt(fd, level, name, &value, sizeof(value)) != 0) {
+        return {errno, boost::system::system_category()};
+    }
+    return {};
+}
+#endif
+
+} // namespace
+
+ConnectionProfile ConnectionProfile::fromYaml(const YAML::Node& node) {
+    ConnectionProfile profile;
+    if (!node.IsDefined() || !node.IsMap()) {
+        return profile;
+    }
+    profile.noDelay = node["tcp_nodelay"].as<bool>(profile.noDelay);
+    profile.receiveBufferBytes = node["rcvbuf_bytes"].as<int>(profile.receiveBufferBytes);
+    profile.sendBufferBytes = node["sndbuf_bytes"].as<int>(profile.sendBufferBytes);
+    profile.busyPollMicros = node["busy_poll_us"].as<int>(profile.busyPollMicros);
+    profile.quickAck = node["quickack"].as<bool>(profile.quickAck);
+    profile.rxTimestamps = node["rx_timestamps"].as<bool>(profile.rxTimestamps);
+
+    const YAML::Node deflate = node["permessage_deflate"];
+    if (deflate.IsDefined() && deflate.IsMap()) {
+        auto& compression = profile.compression;
+        compression.enabled = deflate["enabled"].as<bool>(compression.enabled);
+        compression.serverMaxWindowBits = std::clamp(
+            deflate["server_max_window_bits"].as<int>(compression.serverMaxWindowBits), 9, 15);
+        compression.clientMaxWindowBits = std::clamp(
+            deflate["client_max_window_bits"].as<int>(compression.clientMaxWindowBits), 9, 15);
+        compression.serverNoContextTakeover =
+            deflate["server_no_context_takeover"].as<bool>(compression.serverNoContextTakeover);
+        compression.clientNoContextTakeover =
+            deflate["client_no_context_takeover"].as<bool>(compression.clientNoContextTakeover);
+    }
+    return profile;
+}
+
+bool ConnectionProfile::apply(boost::asio::ip::tcp::socket& socket, spdlog::logger& logger) const {
+    bool ok = true;
+    auto check = [&](const boost::system::error_code& error, const char* option) {
+        if (error) {
+            logger.warn("Could not set {}: {}", option, error.message());
+            ok = false;
+        }
+    };
+
+    boost::system::error_code ec;
+    socket.set_option(boost::asio::ip::tcp::no_delay(noDelay), ec);
+    check(ec, "TCP_NODELAY");
+    if (receiveBufferBytes > 0) {
+        socket.set_option(boost::asio::socket_base::receive_buffer_size(receiveBufferBytes), ec);
+        check(ec, "SO_RCVBUF");
+    }
+    if (sendBufferBytes > 0) {
+        socket.set_option(boost::asio::socket_base::send_buffer_size(sendBufferBytes), ec);
+        check(ec, "SO_SNDBUF");
+    }
+
+#if defined(__linux__)
+    const int fd = socket.native_handle();
+    if (busyPollMicros > 0) {
+        // Values above net.core.busy_read need CAP_NET_ADMIN
+        check(setIntOption(fd, SOL_SOCKET, SO_BUSY_POLL, busyPollMicros), "SO_BUSY_POLL");
+    }
+    if (quickAck) {
+        check(setIntOption(fd, IPPROTO_TCP, TCP_QUICKACK, 1), "TCP_QUICKACK");
+    }
+    if (rxTimestamps) {
+        check(setIntOption(fd, SOL_SOCKET, SO_TIMESTAMPING,
+                           SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE),
+              "SO_TIMESTAMPING");
+    }
+#else
+    if (busyPollMicros > 0 || quickAck || rxTimestamps) {
+        logger.warn("Busy polling, quick ACKs and receive timestamps need Linux");
+        ok = false;
+    }
+#endif
+    return ok;
+}
+
+boost::system::error_code TunedStream::receiveChunks(const boost::asio::mutable_buffer* chunks,
+                                                     std::size_t count, std::size_t& n) {
+    n = 0;
+#if defined(__linux__)
+    iovec iov[kMaxChunks];
+    std::size_t total = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        iov[i].iov_base = chunks[i].data();
+        iov[i].iov_len = chunks[i].size();
+        total += chunks[i].size();
+    }
+    if (total == 0) {
+        return {};
+    }
+
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(scm_timestamping))];
+    msghdr msg{};
+    msg.msg_iov = iov;
+    msg.msg_iovlen = count;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    ssize_t received = ::recvmsg(next_.socket().native_handle(), &msg, MSG_DONTWAIT);
+    if (received < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return boost::asio::error::would_block;
+        }
+        return {errno, boost::system::system_category()};
+    }
+    if (received == 0) {
+        return boost::asio::error::eof;
+    }
+    n = static_cast<std::size_t>(received);
+
+    for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPING && rxNs_ == 0) {
+            scm_timestamping stamps;
+            std::memcpy(&stamps, CMSG_DATA(cmsg), sizeof(stamps));
+            rxNs_ = static_cast<int64_t>(stamps.ts[0].tv_sec) * 1'000'000'000 +
+                    stamps.ts[0].tv_nsec;
+        }
+    }
+    return {};
+#else
+    (void)chunks;
+    (void)count;
+    return boost::asio::error::operation_not_supported;
+#endif
+}
+
+void TunedStream::rearmQuickAck() {
+#if defined(__linux__)
+    setIntOption(next_.socket().native_handle(), IPPROTO_TCP, TCP_QUICKACK, 1);
+#endif
+}
+
+} // namespace crypto_hft
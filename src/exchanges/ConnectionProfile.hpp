@@ -0,0 +1,144 @@
+#pragma once
+
+#include <boost/asio/async_result.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/beast/core/tcp_stream.hpp>
+#include <spdlog/spdlog.h>
+#include <yaml-cpp/yaml.h>
+#include <cstdint>
+
+namespace crypto_hft {
+
+// Latency-oriented socket and WebSocket options for one venue connection, read from
+// exchanges.<venue>.connection. Everything except TCP_NODELAY is off by default.
+struct ConnectionProfile {
+    bool noDelay = true;
+    int receiveBufferBytes = 0;  // SO_RCVBUF; 0 keeps the kernel's autotuning
+    int sendBufferBytes = 0;     // SO_SNDBUF; 0 keeps the kernel's autotuning
+    int busyPollMicros = 0;      // SO_BUSY_POLL; 0 disables busy polling on reads
+    bool quickAck = false;       // Re-arm TCP_QUICKACK after every read
+    bool rxTimestamps = false;   // SO_TIMESTAMPING software receive timestamps
+
+    // permessage-deflate offered in the WebSocket handshake. It trades inflate CPU for
+    // bandwidth, so it only pays off on venues whose bursts saturate the link; compare with
+    // deflate_benchmark before enabling. Window bits are clamped to 9..15.
+    struct Compression {
+        bool enabled = false;
+        int serverMaxWindowBits = 15;  // Venue compression window; bounds our inflate memory
+        int clientMaxWindowBits = 15;  // Window for our own, small, outbound messages
+        bool serverNoContextTakeover = false;
+        bool clientNoContextTakeover = false;
+    } compression;
+
+    static ConnectionProfile fromYaml(const YAML::Node& node);
+
+    // Applies the options to an open socket. Call before connecting so buffer sizes shape the
+    // advertised window. Options the kernel refuses are logged and skipped; returns false if
+    // any were.
+    bool apply(boost::asio::ip::tcp::socket& socket, spdlog::logger& logger) const;
+};
+
+// A beast::tcp_stream with the per-read half of a ConnectionProfile: TCP_QUICKACK is re-armed
+// after each read (the kernel drops back to delayed ACKs on its own), and with timestamping
+// enabled reads go through recvmsg so the kernel's receive time of the data can be collected.
+// Sits directly under the TLS layer; get_lowest_layer() still reaches the tcp_stream.
+class TunedStream {
+public:
+    using next_layer_type = boost::beast::tcp_stream;
+    using lowest_layer_type = next_layer_type::socket_type;
+    using executor_type = next_layer_type::executor_type;
+
+    template <typename Executor>
+    explicit TunedStream(Executor&& executor) : next_(std::forward<Executor>(executor)) {}
+
+    executor_type get_executor() noexcept { return next_.get_executor(); }
+    next_layer_type& next_layer() noexcept { return next_; }
+    const next_layer_type& next_layer() const noexcept { return next_; }
+    lowest_layer_type& lowest_layer() noexcept { return next_.socket(); }
+    const lowest_layer_type& lowest_layer() const noexcept { return next_.socket(); }
+
+    // Takes effect on the next read; timestamped reads bypass the tcp_stream's timeouts, so
+    // enable them once the handshakes are done
+    void setQuickAck(bool enabled) { quickAck_ = enabled; }
+    void setRxTimestamps(bool enabled) { rxTimestamps_ = enabled; }
+
+    // Kernel receive time (CLOCK_REALTIME ns) of the oldest data read since the last call, or 0
+    // if none was captured. The TLS layer reads ahead, so frames that arrived in the same read
+    // as an earlier one have no timestamp of their own.
+    int64_t takeRxTimestamp() {
+        int64_t ns = rxNs_;
+        rxNs_ = 0;
+        return ns;
+    }
+
+    template <typename MutableBufferSequence, typename ReadHandler>
+    BOOST_ASIO_INITFN_RESULT_TYPE(ReadHandler, void(boost::system::error_code, std::size_t))
+    async_read_some(const MutableBufferSequence& buffers, ReadHandler&& handler) {
+        return boost::asio::async_initiate<ReadHandler, void(boost::system::error_code, std::size_t)>(
+            [this](auto handler, const MutableBufferSequence& buffers) {
+                if (rxTimestamps_) {
+                    readTimestamped(buffers, std::move(handler));
+                    return;
+                }
+                next_.async_read_some(buffers,
+                    [this, handler = std::move(handler)](boost::system::error_code ec,
+                                                         std::size_t n) mutable {
+                        if (!ec && quickAck_) {
+                            rearmQuickAck();
+                        }
+                        handler(ec, n);
+                    });
+            },
+            handler, buffers);
+    }
+
+    template <typename ConstBufferSequence, typename WriteHandler>
+    BOOST_ASIO_INITFN_RESULT_TYPE(WriteHandler, void(boost::system::error_code, std::size_t))
+    async_write_some(const ConstBufferSequence& buffers, WriteHandler&& handler) {
+        return next_.async_write_some(buffers, std::forward<WriteHandler>(handler));
+    }
+
+private:
+    template <typename MutableBufferSequence, typename Handler>
+    void readTimestamped(const MutableBufferSequence& buffers, Handler handler) {
+        next_.socket().async_wait(boost::asio::ip::tcp::socket::wait_read,
+            [this, buffers, handler = std::move(handler)](boost::system::error_code ec) mutable {
+                std::size_t n = 0;
+                if (!ec) {
+                    ec = receive(buffers, n);
+                    if (ec == boost::asio::error::would_block) {
+                        readTimestamped(buffers, std::move(handler));
+                        return;
+                    }
+                }
+                if (!ec && quickAck_) {
+                    rearmQuickAck();
+                }
+                handler(ec, n);
+            });
+    }
+
+    template <typename MutableBufferSequence>
+    boost::system::error_code receive(const MutableBufferSequence& buffers, std::size_t& n) {
+        boost::asio::mutable_buffer chunks[kMaxChunks];
+        std::size_t count = 0;
+        for (auto it = boost::asio::buffer_sequence_begin(buffers);
+             it != boost::asio::buffer_sequence_end(buffers) && count < kMaxChunks; ++it) {
+            chunks[count++] = *it;
+        }
+        return receiveChunks(chunks, count, n);
+    }
+
+    static constexpr std::size_t kMaxChunks = 16;
+
+    boost::system::error_code receiveChunks(const boost::asio::mutable_buffer* chunks,
+                                            std::size_t count, std::size_t& n);
+    void rearmQuickAck();
+
+    next_layer_type next_;
+    bool quickAck_ = false;
+    bool rxTimestamps_ = false;
+    int64_t rxNs_ = 0;
+};
+
+} // namespace crypto_hft
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#if defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
+
+namespace crypto_hft {
+
+// CRC-32 as zlib computes it (IEEE 802.3, reflected polynomial 0xEDB88320), which is what Kraken
+// book checksums use. ARMv8 has instructions for this polynomial and they are used when the
+// target has them. The SSE4.2 crc32 instruction computes CRC-32C, a different polynomial, so x86
+// falls back to slicing-by-8 tables. update() can be chained over consecutive pieces of input.
+namespace Crc32 {
+
+namespace detail {
+
+constexpr std::array<std::array<uint32_t, 256>, 8> makeTables() {
+    std::array<std::array<uint32_t, 256>, 8> tables{};
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+        }
+        tables[0][i] = crc;
+    }
+    for (std::size_t t = 1; t < 8; ++t) {
+        for (uint32_t i = 0; i < 256; ++i) {
+            tables[t][i] = (tables[t - 1][i] >> 8) ^ tables[0][tables[t - 1][i] & 0xFF];
+        }
+    }
+    return tables;
+}
+
+inline constexpr auto kTables = makeTables();
+
+} // namespace detail
+
+// Continues crc, a value previously returned by update() (0 to start), over n bytes
+inline uint32_t update(uint32_t crc, const char* data, std::size_t n) {
+    const auto* p = reinterpret_cast<const unsigned char*>(data);
+    crc = ~crc;
+#if defined(__ARM_FEATURE_CRC32)
+    for (; n >= 8; n -= 8, p += 8) {
+        uint64_t chunk;
+        std::memcpy(&chunk, p, sizeof(chunk));
+        crc = __crc32d(crc, chunk);
+    }
+    while (n-- > 0) {
+        crc = __crc32b(crc, *p++);
+    }
+#else
+    const auto& t = detail::kTables;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    for (; n >= 8; n -= 8, p += 8) {
+        uint32_t low;
+        uint32_t high;
+        std::memcpy(&low, p, sizeof(low));
+        std::memcpy(&high, p + 4, sizeof(high));
+        low ^= crc;
+        crc = t[7][low & 0xFF] ^ t[6][(low >> 8) & 0xFF] ^ t[5][(low >> 16) & 0xFF] ^
+              t[4][low >> 24] ^ t[3][high & 0xFF] ^ t[2][(high >> 8) & 0xFF] ^
+              t[1][(high >> 16) & 0xFF] ^ t[0][high >> 24];
+    }
+#endif
+    while (n-- > 0) {
+        crc = (crc >> 8) ^ t[0][(crc ^ *p++) & 0xFF];
+    }
+#endif
+    return ~crc;
+}
+
+inline uint32_t compute(std::string_view data) {
+    return update(0, data.data(), data.size());
+}
+
+} // namespace Crc32
+
+} // namespace crypto_hft
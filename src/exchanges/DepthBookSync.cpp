@@ -0,0 +1,99 @@
+#include "DepthBookSync.hpp"
+#include <algorithm>
+
+namespace crypto_hft {
+
+bool DepthBookSync::requestSnapshot(const std::string& symbol) {
+    State& state = states_[symbol];
+    // Whatever was live may have missed updates (this is also how a reconnect resyncs)
+    state.live = false;
+    if (state.snapshotPending) {
+        return false;
+    }
+    state.snapshotPending = true;
+    return true;
+}
+
+void DepthBookSync::snapshotFailed(const std::string& symbol) {
+    auto it = states_.find(symbol);
+    if (it != states_.end()) {
+        it->second.snapshotPending = false;
+    }
+}
+
+void DepthBookSync::remove(const std::string& symbol) {
+    states_.erase(symbol);
+}
+
+DepthBookSync::DeltaAction DepthBookSync::onDelta(const OrderBookDelta& delta) {
+    auto it = states_.find(delta.symbol);
+    if (it == states_.end()) {
+        return DeltaAction::Apply;
+    }
+    State& state = it->second;
+
+    if (state.live) {
+        if (delta.sequence <= state.lastUpdateId) {
+            return DeltaAction::Drop;
+        }
+        if (!continues(delta, state.lastUpdateId)) {
+            ++gaps_;
+            state.live = false;
+            state.buffered.assign(1, delta);
+            return DeltaAction::Gap;
+        }
+        state.lastUpdateId = delta.sequence;
+        return DeltaAction::Apply;
+    }
+
+    if (!state.buffered.empty() && delta.sequence <= state.buffered.back().sequence) {
+        return DeltaAction::Drop;
+    }
+    if (state.buffered.size() == kMaxBuffered) {
+        state.buffered.erase(state.buffered.begin());
+    }
+    state.buffered.push_back(delta);
+    return DeltaAction::Buffer;
+}
+
+DepthBookSync::SnapshotResult DepthBookSync::onSnapshot(const OrderBookSnapshot& snapshot,
+                                                        std::vector<OrderBookDelta>& replay) {
+    replay.clear();
+    auto it = states_.find(snapshot.symbol);
+    if (it == states_.end()) {
+        return SnapshotResult::Untracked;
+    }
+    State& state = it->second;
+    state.snapshotPending = false;
+
+    auto& buffered = state.buffered;
+    buffered.erase(std::remove_if(buffered.begin(), buffered.end(),
+                                  [&](const OrderBookDelta& delta) {
+                                      return delta.sequence <= snapshot.sequence;
+                                  }),
+                   buffered.end());
+
+    // The buffer has to bridge the snapshot without holes. On a hole, keep what follows it for
+    // the next snapshot.
+    uint64_t lastUpdateId = snapshot.sequence;
+    for (std::size_t i = 0; i < buffered.size(); ++i) {
+        if (!continues(buffered[i], lastUpdateId)) {
+            buffered.erase(buffered.begin(), buffered.begin() + static_cast<std::ptrdiff_t>(i));
+            return SnapshotResult::Stale;
+        }
+        lastUpdateId = buffered[i].sequence;
+    }
+
+    replay.swap(buffered);
+    buffered.clear();
+    state.lastUpdateId = lastUpdateId;
+    state.live = true;
+    return SnapshotResult::Live;
+}
+
+bool DepthBookSync::isLive(const std::string& symbol) const {
+    auto it = states_.find(symbol);
+    return it == states_.end() || it->second.live;
+}
+
+} // namespace crypto_hft
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "IExchangeAdapter.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace crypto_hft {
+
+// Joins a REST depth snapshot to a diff-depth stream the way Binance documents it: deltas are
+// buffered from the moment the stream is subscribed, the snapshot drops every buffered delta
+// it already contains, and the first remaining delta must start at or before lastUpdateId + 1.
+// After that each delta must continue where the previous one ended; a hole means the book is
+// wrong and needs a fresh snapshot. Symbols that were never tracked pass straight through. Not
+// thread-safe; the owning adapter serializes access.
+class DepthBookSync {
+public:
+    enum class DeltaAction {
+        Apply,   // Continues the book
+        Drop,    // Already contained in the book, e.g. a duplicate from a second connection
+        Buffer,  // Held until the symbol's snapshot arrives
+        Gap      // Updates were missed; the symbol is buffering again and needs a new snapshot
+    };
+
+    enum class SnapshotResult {
+        Live,       // The book starts from this snapshot; apply the replayed deltas after it
+        Stale,      // The snapshot is older than the buffered deltas reach back; fetch another
+        Untracked   // The symbol was removed meanwhile
+    };
+
+    static constexpr std::size_t kMaxBuffered = 4096;  // Per symbol; oldest dropped beyond it
+
+    // Starts buffering the symbol's deltas for a snapshot that is about to be requested.
+    // Returns false if one is already being fetched.
+    bool requestSnapshot(const std::string& symbol);
+
+    // Forgets a failed snapshot request so the next requestSnapshot() goes ahead
+    void snapshotFailed(const std::string& symbol);
+
+    void remove(const std::string& symbol);
+
+    DeltaAction onDelta(const OrderBookDelta& delta);
+    SnapshotResult onSnapshot(const OrderBookSnapshot& snapshot,
+                              std::vector<OrderBookDelta>& replay);
+
+    bool isLive(const std::string& symbol) const;
+    uint64_t gaps() const { return gaps_; }
+
+private:
+    struct State {
+        bool live = false;
+        bool snapshotPending = false;
+        uint64_t lastUpdateId = 0;
+        std::vector<OrderBookDelta> buffered;
+    };
+
+    // Whether delta follows an update that ended at lastUpdateId without a hole
+    static bool continues(const OrderBookDelta& delta, uint64_t lastUpdateId) {
+        return delta.firstSequence == 0 || delta.firstSequence <= lastUpdateId + 1;
+    }
+
+    std::unordered_map<std::string, State> states_;
+    uint64_t gaps_ = 0;
+};
+
+} // namespace crypto_hft
@@ -0,0 +1,145 @@
+#include "ExchangeUtils.hpp"
+#include <openssl/core_names.h>
+#include <openssl/params.h>
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace crypto_hft {
+
+namespace ExchangeUtils {
+
+// Signature generation
+
+HmacSigner::HmacSigner(Digest digest, std::string_view key) {
+    EVP_MAC* mac = EVP_MAC_fetch(nullptr, "HMAC", nullptr);
+    if (mac == nullptr) {
+        throw std::runtime_error("HMAC is not available from OpenSSL");
+    }
+    ctx_ = EVP_MAC_CTX_new(mac);
+    EVP_MAC_free(mac);  // The context holds its own reference
+
+    std::string name = digest == Digest::SHA256 ? "SHA256" : "SHA512";
+    OSSL_PARAM params[] = {
+        OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_DIGEST, name.data(), 0),
+        OSSL_PARAM_construct_end()};
+    // An empty key still needs a non-null pointer
+    const auto* keyBytes = reinterpret_cast<const unsigned char*>(key.empty() ? "" : key.data());
+    if (ctx_ == nullptr || EVP_MAC_init(ctx_, keyBytes, key.size(), params) != 1) {
+        EVP_MAC_CTX_free(ctx_);
+        throw std::runtime_error("Failed to key HMAC context");
+    }
+    size_ = EVP_MAC_CTX_get_mac_size(ctx_);
+}
+
+HmacSigner::~HmacSigner() {
+    EVP_MAC_CTX_free(ctx_);
+}
+
+HmacSigner::HmacSigner(HmacSigner&& other) noexcept
+    : ctx_(std::exchange(other.ctx_, nullptr))
+    , size_(std::exchange(other.size_, 0)) {}
+
+HmacSigner& HmacSigner::operator=(HmacSigner&& other) noexcept {
+    if (this != &other) {
+        EVP_MAC_CTX_free(ctx_);
+        ctx_ = std::exchange(other.ctx_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+    }
+    return *this;
+}
+
+std::size_t HmacSigner::sign(std::initializer_list<std::string_view> parts,
+                             unsigned char* out) const {
+    // Duplicating only reads the keyed context, which is what makes signing thread-safe
+    EVP_MAC_CTX* ctx = EVP_MAC_CTX_dup(ctx_);
+    bool ok = ctx != nullptr;
+    for (std::string_view part : parts) {
+        ok = ok && EVP_MAC_update(ctx, reinterpret_cast<const unsigned char*>(part.data()),
+                                  part.size()) == 1;
+    }
+    std::size_t length = 0;
+    ok = ok && EVP_MAC_final(ctx, out, &length, size_) == 1;
+    EVP_MAC_CTX_free(ctx);
+    if (!ok) {
+        throw std::runtime_error("HMAC signing failed");
+    }
+    return length;
+}
+
+std::size_t HmacSigner::sign_hex(std::initializer_list<std::string_view> parts,
+                                 char* out) const {
+    static constexpr char kHex[] = "0123456789abcdef";
+    unsigned char mac[kMaxSize];
+    std::size_t length = sign(parts, mac);
+    for (std::size_t i = 0; i < length; ++i) {
+        out[2 * i] = kHex[mac[i] >> 4];
+        out[2 * i + 1] = kHex[mac[i] & 0xF];
+    }
+    return 2 * length;
+}
+
+std::size_t HmacSigner::sign_base64(std::initializer_list<std::string_view> parts,
+                                    char* out) const {
+    unsigned char mac[kMaxSize];
+    std::size_t length = sign(parts, mac);
+    // EVP_EncodeBlock writes a terminator the caller's buffer need not have room for
+    unsigned char encoded[kMaxBase64Size + 1];
+    int encodedLength = EVP_EncodeBlock(encoded, mac, static_cast<int>(length));
+    std::copy_n(encoded, encodedLength, out);
+    return static_cast<std::size_t>(encodedLength);
+}
+
+std::string generate_hmac_sha256(const std::string& key, const std::string& data) {
+    char out[HmacSigner::kMaxHexSize];
+    return std::string(out, HmacSigner(HmacSigner::Digest::SHA256, key).sign_hex(data, out));
+}
+
+std::string generate_hmac_sha512(const std::string& key, const std::string& data) {
+    char out[HmacSigner::kMaxHexSize];
+    return std::string(out, HmacSigner(HmacSigner::Digest::SHA512, key).sign_hex(data, out));
+}
+
+std::string generate_signature(const std::string& secret, const std::string& data,
+                               const std::string& algorithm) {
+    if (algorithm == "sha256") {
+        return generate_hmac_sha256(secret, data);
+    }
+    if (algorithm == "sha512") {
+        return generate_hmac_sha512(secret, data);
+    }
+    throw std::invalid_argument("Unsupported signature algorithm: " + algorithm);
+}
+
+// Base64 encoding/decoding
+
+std::string base64_encode(const std::string& input) {
+    // One more for the terminator EVP_EncodeBlock appends
+    std::string out(4 * ((input.size() + 2) / 3) + 1, '\0');
+    int length = EVP_EncodeBlock(reinterpret_cast<unsigned char*>(out.data()),
+                                 reinterpret_cast<const unsigned char*>(input.data()),
+                                 static_cast<int>(input.size()));
+    out.resize(static_cast<std::size_t>(std::max(length, 0)));
+    return out;
+}
+
+std::string base64_decode(const std::string& input) {
+    std::string out(3 * (input.size() / 4), '\0');
+    int length = EVP_DecodeBlock(reinterpret_cast<unsigned char*>(out.data()),
+                                 reinterpret_cast<const unsigned char*>(input.data()),
+                                 static_cast<int>(input.size()));
+    if (length < 0) {
+        throw std::invalid_argument("Invalid base64 input");
+    }
+    // EVP_DecodeBlock counts the padding as zero bytes
+    std::size_t padding = 0;
+    for (auto it = input.rbegin(); it != input.rend() && *it == '='; ++it) {
+        ++padding;
+    }
+    out.resize(static_cast<std::size_t>(length) - std::min<std::size_t>(padding, 2));
+    return out;
+}
+
+} // namespace ExchangeUtils
+
+} // namespace crypto_hft
@@ -1,9 +1,17 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <unordered_map>
 #include <chrono>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 #include <openssl/hmac.h>
 #include <openssl/sha.h>
 #include <openssl/evp.h>
@@ -25,6 +33,46 @@ std::string generate_hmac_sha256(const std::string& key, const std::string& data
 std::string generate_hmac_sha512(const std::string& key, const std::string& data);
 std::string generate_signature(const std::string& secret, const std::string& data, const std::string& algorithm = "sha256");
 
+// HMAC keyed once with an API secret. The keyed context is kept and every signature starts from
+// a copy of it, so the key is not hashed into fresh inner and outer pads per request. Output goes
+// to a caller buffer: size() raw bytes, hex_size() or base64_size() characters. Signing is
+// thread-safe; the constructor throws std::runtime_error if OpenSSL cannot provide the MAC.
+class HmacSigner {
+public:
+    enum class Digest { SHA256, SHA512 };
+
+    static constexpr std::size_t kMaxSize = 64;
+    static constexpr std::size_t kMaxHexSize = 2 * kMaxSize;
+    static constexpr std::size_t kMaxBase64Size = 4 * ((kMaxSize + 2) / 3);
+
+    HmacSigner(Digest digest, std::string_view key);
+    ~HmacSigner();
+    HmacSigner(HmacSigner&& other) noexcept;
+    HmacSigner& operator=(HmacSigner&& other) noexcept;
+    HmacSigner(const HmacSigner&) = delete;
+    HmacSigner& operator=(const HmacSigner&) = delete;
+
+    std::size_t size() const { return size_; }
+    std::size_t hex_size() const { return 2 * size_; }
+    std::size_t base64_size() const { return 4 * ((size_ + 2) / 3); }
+
+    // MAC of data, or of parts as if concatenated; each returns the length written
+    std::size_t sign(std::string_view data, unsigned char* out) const { return sign({data}, out); }
+    std::size_t sign(std::initializer_list<std::string_view> parts, unsigned char* out) const;
+    // Lowercase hex
+    std::size_t sign_hex(std::string_view data, char* out) const { return sign_hex({data}, out); }
+    std::size_t sign_hex(std::initializer_list<std::string_view> parts, char* out) const;
+    // Standard alphabet with padding, no terminator
+    std::size_t sign_base64(std::string_view data, char* out) const {
+        return sign_base64({data}, out);
+    }
+    std::size_t sign_base64(std::initializer_list<std::string_view> parts, char* out) const;
+
+private:
+    EVP_MAC_CTX* ctx_ = nullptr;
+    std::size_t size_ = 0;
+};
+
 // Base64 encoding/decoding
 std::string base64_encode(const std::string& input);
 std::string base64_decode(const std::string& input);
@@ -51,17 +99,183 @@ public:
     explicit ExchangeError(const std::string& message) : std::runtime_error(message) {}
 };
 
-// Rate limiting
-class RateLimiter {
-public:
-    RateLimiter(int max_requests, std::chrono::milliseconds time_window);
-    bool try_acquire();
+// Decimal string parsing for price and size fields, straight from frame bytes.
+// Neither function allocates or depends on the locale.
+namespace detail {
 
-private:
-    int max_requests_;
-    std::chrono::milliseconds time_window_;
-    std::vector<std::chrono::steady_clock::time_point> request_times_;
-};
+// Length of the run of ASCII digits starting at p, 16 bytes at a time where possible
+inline std::size_t digit_run(const char* p, const char* end) {
+    const char* start = p;
+#if defined(__SSE2__)
+    const __m128i zero = _mm_set1_epi8('0');
+    const __m128i nine = _mm_set1_epi8(9);
+    while (end - p >= 16) {
+        __m128i shifted = _mm_sub_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), zero);
+        __m128i isDigit = _mm_cmpeq_epi8(_mm_min_epu8(shifted, nine), shifted);
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(isDigit));
+        if (mask != 0xFFFF) {
+            return static_cast<std::size_t>(p - start) + __builtin_ctz(~mask);
+        }
+        p += 16;
+    }
+#endif
+    while (p < end && static_cast<unsigned char>(*p - '0') < 10) {
+        ++p;
+    }
+    return static_cast<std::size_t>(p - start);
+}
+
+inline uint64_t eight_digits_value(const char* p) {
+    uint64_t chunk;
+    std::memcpy(&chunk, p, sizeof(chunk));
+    chunk -= 0x3030303030303030ULL;
+    chunk = (chunk * 10) + (chunk >> 8);
+    return (((chunk & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32))) +
+            (((chunk >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32)))) >> 32;
+}
+
+inline bool is_eight_digits(const char* p) {
+    uint64_t chunk;
+    std::memcpy(&chunk, p, sizeof(chunk));
+    return (((chunk + 0x4646464646464646ULL) | (chunk - 0x3030303030303030ULL)) &
+            0x8080808080808080ULL) == 0;
+}
+
+// Appends n known-digit characters to m, eight at a time with SWAR on little-endian targets
+inline uint64_t accumulate_digits(const char* p, std::size_t n, uint64_t m) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    for (; n >= 8; n -= 8, p += 8) {
+        m = m * 100000000ULL + eight_digits_value(p);
+    }
+#endif
+    while (n-- > 0) {
+        m = m * 10 + static_cast<uint64_t>(*p++ - '0');
+    }
+    return m;
+}
+
+// Scans and converts the digit run at p in one pass, appending to m; returns the end of the run.
+// Runs with 16 bytes of input behind them are measured with SSE2 first, shorter ones are
+// checked eight bytes at a time. m wraps if the run has more than 19 digits.
+inline const char* consume_digits(const char* p, const char* end, uint64_t& m) {
+#if defined(__SSE2__)
+    if (end - p >= 16) {
+        std::size_t n = digit_run(p, end);
+        m = accumulate_digits(p, n, m);
+        return p + n;
+    }
+#endif
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    while (end - p >= 8 && is_eight_digits(p)) {
+        m = m * 100000000ULL + eight_digits_value(p);
+        p += 8;
+    }
+#endif
+    while (p < end && static_cast<unsigned char>(*p - '0') < 10) {
+        m = m * 10 + static_cast<uint64_t>(*p++ - '0');
+    }
+    return p;
+}
+
+inline bool from_chars_double(std::string_view text, double& out) {
+    auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), out);
+    return ec == std::errc() && ptr == text.data() + text.size();
+}
+
+} // namespace detail
+
+// Parses "[-]digits[.digits]" into a correctly rounded double. Up to 19 digits with at most
+// 22 after the point, and a mantissa no larger than 2^53, need just one IEEE division of two
+// exactly representable values (Clinger's fast path). Everything else, including exponent
+// notation, falls back to std::from_chars.
+inline bool parse_decimal(std::string_view text, double& out) {
+    static constexpr double kPow10[] = {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+    const char* p = text.data();
+    const char* end = p + text.size();
+    const bool negative = p < end && *p == '-';
+    if (negative) {
+        ++p;
+    }
+
+    // Leading and trailing zeros are accumulated too: they only cost digits of headroom
+    uint64_t mantissa = 0;
+    const char* intStart = p;
+    p = detail::consume_digits(p, end, mantissa);
+    const std::size_t intLen = static_cast<std::size_t>(p - intStart);
+    std::size_t fracLen = 0;
+    if (p < end && *p == '.') {
+        const char* fracStart = ++p;
+        p = detail::consume_digits(p, end, mantissa);
+        fracLen = static_cast<std::size_t>(p - fracStart);
+    }
+    if (intLen + fracLen == 0) {
+        return false;
+    }
+    if (p != end) {
+        return (*p == 'e' || *p == 'E') && detail::from_chars_double(text, out);
+    }
+    if (intLen + fracLen > 19 || fracLen > 22 || mantissa > (uint64_t{1} << 53)) {
+        return detail::from_chars_double(text, out);
+    }
+
+    double value = static_cast<double>(mantissa) / kPow10[fracLen];
+    out = negative ? -value : value;
+    return true;
+}
+
+// Parses a decimal string into an integer count of 10^-scale units, e.g. "0.0105" at scale 8
+// gives 1050000. Fails rather than rounds if the value has non-zero digits beyond the scale.
+inline bool parse_fixed(std::string_view text, int scale, int64_t& out) {
+    static constexpr uint64_t kPow10[] = {
+        1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL,
+        100000000ULL, 1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL,
+        10000000000000ULL, 100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+        100000000000000000ULL, 1000000000000000000ULL};
+    if (scale < 0 || scale > 18) {
+        return false;
+    }
+
+    const char* p = text.data();
+    const char* end = p + text.size();
+    const bool negative = p < end && *p == '-';
+    if (negative) {
+        ++p;
+    }
+    while (end - p > 1 && p[0] == '0' && p[1] != '.') {
+        ++p;
+    }
+
+    uint64_t units = 0;
+    const char* intStart = p;
+    p = detail::consume_digits(p, end, units);
+    const std::size_t intLen = static_cast<std::size_t>(p - intStart);
+    if (intLen + static_cast<std::size_t>(scale) > 18) {
+        return false;
+    }
+
+    std::size_t fracLen = 0;
+    if (p < end && *p == '.') {
+        const char* fracStart = ++p;
+        const char* fracEnd = end - p > scale ? p + scale : end;
+        p = detail::consume_digits(p, fracEnd, units);
+        fracLen = static_cast<std::size_t>(p - fracStart);
+        if (p == fracEnd) {
+            while (p < end && *p == '0') {
+                ++p;
+            }
+        }
+    }
+    if (p != end || intLen + fracLen == 0) {
+        return false;
+    }
+
+    units *= kPow10[static_cast<std::size_t>(scale) - fracLen];
+    out = negative ? -static_cast<int64_t>(units) : static_cast<int64_t>(units);
+    return true;
+}
 
 } // namespace ExchangeUtils
 
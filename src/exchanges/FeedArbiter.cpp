@@ -0,0 +1,123 @@
+#include "FeedArbiter.hpp"
+#include "../infra/MetricsReporter.hpp"
+#include <functional>
+#include <stdexcept>
+
+namespace crypto_hft {
+
+FeedArbiter::FeedArbiter(std::size_t sessionCount, std::size_t primarySession)
+    : sessionCount_(sessionCount)
+    , primarySession_(primarySession)
+    , slots_(std::make_unique<SymbolSlot[]>(kMaxSymbols))
+    , sessions_(std::make_unique<SessionCounters[]>(sessionCount)) {
+    if (sessionCount == 0 || primarySession >= sessionCount) {
+        throw std::invalid_argument("FeedArbiter requires a primary session within session count");
+    }
+}
+
+uint64_t FeedArbiter::slotKey(std::string_view symbol) {
+    uint64_t key = std::hash<std::string_view>{}(symbol);
+    return key == 0 ? 1 : key;  // 0 marks an empty slot
+}
+
+FeedArbiter::SymbolSlot* FeedArbiter::findSlot(std::string_view symbol) {
+    const uint64_t key = slotKey(symbol);
+    for (std::size_t probe = 0; probe < kMaxSymbols; ++probe) {
+        SymbolSlot& slot = slots_[(key + probe) % kMaxSymbols];
+        uint64_t current = slot.key.load(std::memory_order_acquire);
+        if (current == key) {
+            return &slot;
+        }
+        if (current == 0 &&
+            (slot.key.compare_exchange_strong(current, key, std::memory_order_acq_rel) ||
+             current == key)) {
+            return &slot;
+        }
+    }
+    return nullptr;  // Table full; caller falls back to primary-only delivery
+}
+
+uint64_t FeedArbiter::lastDelivered(std::string_view symbol) const {
+    const uint64_t key = slotKey(symbol);
+    for (std::size_t probe = 0; probe < kMaxSymbols; ++probe) {
+        const SymbolSlot& slot = slots_[(key + probe) % kMaxSymbols];
+        const uint64_t current = slot.key.load(std::memory_order_acquire);
+        if (current == key) {
+            return slot.delivered.load(std::memory_order_acquire);
+        }
+        if (current == 0) {
+            break;
+        }
+    }
+    return 0;
+}
+
+void FeedArbiter::recordDuplicate(std::size_t session, const SymbolSlot* slot,
+                                  uint64_t sequence, int64_t receiveNs) {
+    SessionCounters& counters = sessions_[session];
+    counters.duplicates.fetch_add(1, std::memory_order_relaxed);
+    if (!slot) {
+        return;
+    }
+
+    const std::size_t index = sequence % kLagRing;
+    if (slot->arrivalSeq[index].load(std::memory_order_acquire) != sequence) {
+        return;  // Winner's arrival time already overwritten
+    }
+    const int64_t firstSeenNs = slot->arrivalNs[index].load(std::memory_order_relaxed);
+    if (slot->arrivalSeq[index].load(std::memory_order_acquire) != sequence) {
+        return;
+    }
+
+    const int64_t lag = receiveNs - firstSeenNs;
+    if (lag < 0) {
+        return;
+    }
+    counters.lagSamples.fetch_add(1, std::memory_order_relaxed);
+    counters.totalLagNs.fetch_add(lag, std::memory_order_relaxed);
+    int64_t currentMax = counters.maxLagNs.load(std::memory_order_relaxed);
+    while (lag > currentMax &&
+           !counters.maxLagNs.compare_exchange_weak(currentMax, lag, std::memory_order_relaxed)) {
+    }
+}
+
+FeedArbiter::SessionStats FeedArbiter::getSessionStats(std::size_t session) const {
+    SessionStats stats;
+    if (session >= sessionCount_) {
+        return stats;
+    }
+
+    const SessionCounters& counters = sessions_[session];
+    stats.wins = counters.wins.load(std::memory_order_relaxed);
+    stats.duplicates = counters.duplicates.load(std::memory_order_relaxed);
+    stats.maxLagNs = counters.maxLagNs.load(std::memory_order_relaxed);
+
+    const uint64_t offered = stats.wins + stats.duplicates;
+    if (offered > 0) {
+        stats.winRate = static_cast<double>(stats.wins) / static_cast<double>(offered);
+    }
+    const uint64_t samples = counters.lagSamples.load(std::memory_order_relaxed);
+    if (samples > 0) {
+        stats.meanLagNs = static_cast<double>(counters.totalLagNs.load(std::memory_order_relaxed)) /
+                          static_cast<double>(samples);
+    }
+    return stats;
+}
+
+void FeedArbiter::publishMetrics(const std::string& venue) const {
+    auto& reporter = MetricsReporter::getInstance();
+    for (std::size_t session = 0; session < sessionCount_; ++session) {
+        const SessionStats stats = getSessionStats(session);
+        const std::unordered_map<std::string, std::string> labels = {
+            {"venue", venue},
+            {"session", std::to_string(session)}
+        };
+        reporter.setGauge("feed_arbiter_wins", static_cast<double>(stats.wins), labels);
+        reporter.setGauge("feed_arbiter_duplicates", static_cast<double>(stats.duplicates), labels);
+        reporter.setGauge("feed_arbiter_win_rate", stats.winRate, labels);
+        reporter.setGauge("feed_arbiter_mean_lag_ns", stats.meanLagNs, labels);
+        reporter.setGauge("feed_arbiter_max_lag_ns", static_cast<double>(stats.maxLagNs), labels);
+    }
+}
+
+} // namespace crypto_hft
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+
+namespace crypto_hft {
+
+// Picks the first arrival of every sequenced update across redundant sessions of one stream.
+// Each symbol owns a slot in a fixed open-addressed table; winning a sequence is a single CAS
+// on that slot, so the hot path takes no locks and allocates nothing.
+class FeedArbiter {
+public:
+    static constexpr std::size_t kMaxSymbols = 512;
+    static constexpr std::size_t kLagRing = 32;
+
+    struct SessionStats {
+        uint64_t wins = 0;
+        uint64_t duplicates = 0;
+        double winRate = 0.0;    // wins / (wins + duplicates)
+        double meanLagNs = 0.0;  // mean delay behind the winning session, over duplicates
+        int64_t maxLagNs = 0;
+    };
+
+    explicit FeedArbiter(std::size_t sessionCount, std::size_t primarySession = 0);
+
+    FeedArbiter(const FeedArbiter&) = delete;
+    FeedArbiter& operator=(const FeedArbiter&) = delete;
+
+    // Calls deliver() if this session is the first to offer `sequence` for `symbol`.
+    // Winners are handed downstream in sequence order even when sessions run on different
+    // threads. Unsequenced updates (sequence == 0) are only accepted from the primary session.
+    template <typename Deliver>
+    bool arbitrate(std::size_t session, std::string_view symbol, uint64_t sequence,
+                   int64_t receiveNs, Deliver&& deliver);
+
+    // Highest sequence handed downstream for `symbol`, or 0 if none has been
+    uint64_t lastDelivered(std::string_view symbol) const;
+
+    SessionStats getSessionStats(std::size_t session) const;
+    std::size_t getSessionCount() const { return sessionCount_; }
+    std::size_t getPrimarySession() const { return primarySession_; }
+
+    // Push per-session win-rate and lag gauges to MetricsReporter
+    void publishMetrics(const std::string& venue) const;
+
+    static int64_t nowNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+private:
+    struct alignas(64) SymbolSlot {
+        std::atomic<uint64_t> key{0};
+        std::atomic<uint64_t> claimed{0};
+        std::atomic<uint64_t> delivered{0};
+        std::array<std::atomic<uint64_t>, kLagRing> arrivalSeq{};
+        std::array<std::atomic<int64_t>, kLagRing> arrivalNs{};
+    };
+
+    struct alignas(64) SessionCounters {
+        std::atomic<uint64_t> wins{0};
+        std::atomic<uint64_t> duplicates{0};
+        std::atomic<uint64_t> lagSamples{0};
+        std::atomic<int64_t> totalLagNs{0};
+        std::atomic<int64_t> maxLagNs{0};
+    };
+
+    static uint64_t slotKey(std::string_view symbol);
+    SymbolSlot* findSlot(std::string_view symbol);
+    void recordDuplicate(std::size_t session, const SymbolSlot* slot, uint64_t sequence,
+                         int64_t receiveNs);
+
+    std::size_t sessionCount_;
+    std::size_t primarySession_;
+    std::unique_ptr<SymbolSlot[]> slots_;
+    std::unique_ptr<SessionCounters[]> sessions_;
+};
+
+template <typename Deliver>
+bool FeedArbiter::arbitrate(std::size_t session, std::string_view symbol, uint64_t sequence,
+                            int64_t receiveNs, Deliver&& deliver) {
+    SymbolSlot* slot = sequence != 0 ? findSlot(symbol) : nullptr;
+    if (!slot) {
+        // Nothing to deduplicate on, so only one session may feed downstream
+        if (session != primarySession_) {
+            recordDuplicate(session, nullptr, sequence, receiveNs);
+            return false;
+        }
+        deliver();
+        sessions_[session].wins.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    uint64_t previous = slot->claimed.load(std::memory_order_acquire);
+    do {
+        if (sequence <= previous) {
+            recordDuplicate(session, slot, sequence, receiveNs);
+            return false;
+        }
+    } while (!slot->claimed.compare_exchange_weak(previous, sequence,
+                                                  std::memory_order_acq_rel,
+                                                  std::memory_order_acquire));
+
+    // Remember when the winner saw this sequence so late sessions can measure their lag
+    const std::size_t index = sequence % kLagRing;
+    slot->arrivalNs[index].store(receiveNs, std::memory_order_relaxed);
+    slot->arrivalSeq[index].store(sequence, std::memory_order_release);
+
+    // Hand off in order: wait until the previous winner has finished delivering
+    while (slot->delivered.load(std::memory_order_acquire) != previous) {
+        std::this_thread::yield();
+    }
+
+    struct PublishOnExit {
+        SymbolSlot* slot;
+        uint64_t sequence;
+        ~PublishOnExit() { slot->delivered.store(sequence, std::memory_order_release); }
+    } publish{slot, sequence};
+
+    deliver();
+    sessions_[session].wins.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+} // namespace crypto_hft
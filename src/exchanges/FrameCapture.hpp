@@ -0,0 +1,42 @@
+#pragma once
+
+#include <spdlog/spdlog.h>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+
+namespace crypto_hft {
+
+// Sampled debug capture of raw frames for the read path. Formatting every frame into a log line
+// copies it on the hot path even when the line is then dropped; this formats one frame in every
+// sampleEvery, and only when the logger would actually emit it. Not thread-safe: each adapter
+// offers frames from its own IO thread.
+class FrameCapture {
+public:
+    static constexpr uint32_t kDefaultSampleEvery = 1000;
+
+    explicit FrameCapture(uint32_t sampleEvery = kDefaultSampleEvery)
+        : sampleEvery_(sampleEvery) {}
+
+    // 0 disables capture, 1 captures every frame
+    void setSampleEvery(uint32_t sampleEvery) {
+        sampleEvery_ = sampleEvery;
+        seen_ = 0;
+    }
+
+    void offer(spdlog::logger& logger, std::string_view frame) {
+        if (sampleEvery_ == 0 || ++seen_ < sampleEvery_) {
+            return;
+        }
+        seen_ = 0;
+        if (logger.should_log(spdlog::level::debug)) {
+            logger.debug("Sampled frame ({} bytes): {}", frame.size(), frame);
+        }
+    }
+
+private:
+    uint32_t sampleEvery_;
+    uint32_t seen_ = 0;
+};
+
+} // namespace crypto_hft
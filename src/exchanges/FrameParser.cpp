@@ -0,0 +1,683 @@
+#include "FrameParser.hpp"
+#include "JsonScan.hpp"
+#include <charconv>
+#include <chrono>
+
+namespace crypto_hft {
+
+namespace {
+
+using JsonScan::ArrayReader;
+using JsonScan::ObjectReader;
+using Levels = std::vector<std::pair<double, double>>;
+
+int64_t nowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// count decimal digits at text[pos] as a number, or -1
+int64_t readDigits(std::string_view text, std::size_t pos, std::size_t count) {
+    int64_t value = 0;
+    for (std::size_t i = pos; i < pos + count; ++i) {
+        if (i >= text.size() || text[i] < '0' || text[i] > '9') {
+            return -1;
+        }
+        value = value * 10 + (text[i] - '0');
+    }
+    return value;
+}
+
+// Up to nine digits after a decimal point as nanoseconds; further digits are dropped
+std::size_t readFractionNs(std::string_view text, std::size_t pos, int64_t& ns) {
+    ns = 0;
+    int64_t scale = 100000000;
+    while (pos < text.size() && text[pos] >= '0' && text[pos] <= '9') {
+        ns += (text[pos] - '0') * scale;
+        scale /= 10;
+        ++pos;
+    }
+    return pos;
+}
+
+// "2024-01-01T00:00:00.123456789Z" as ns since the epoch. The venues send UTC only.
+bool readIsoTime(std::string_view value, int64_t& ns) {
+    const std::string_view text = JsonScan::unquote(value);
+    if (text.size() < 19 || text[4] != '-' || text[7] != '-' || text[10] != 'T' ||
+        text[13] != ':' || text[16] != ':') {
+        return false;
+    }
+    const int64_t year = readDigits(text, 0, 4);
+    const int64_t month = readDigits(text, 5, 2);
+    const int64_t day = readDigits(text, 8, 2);
+    const int64_t hour = readDigits(text, 11, 2);
+    const int64_t minute = readDigits(text, 14, 2);
+    const int64_t second = readDigits(text, 17, 2);
+    if (year < 0 || month < 1 || day < 1 || hour < 0 || minute < 0 || second < 0) {
+        return false;
+    }
+    std::size_t pos = 19;
+    int64_t fraction = 0;
+    if (pos < text.size() && text[pos] == '.') {
+        pos = readFractionNs(text, pos + 1, fraction);
+    }
+    if (pos < text.size() && text[pos] == 'Z') {
+        ++pos;
+    }
+    const std::chrono::year_month_day date{std::chrono::year(static_cast<int>(year)),
+                                           std::chrono::month(static_cast<unsigned>(month)),
+                                           std::chrono::day(static_cast<unsigned>(day))};
+    if (pos != text.size() || !date.ok()) {
+        return false;
+    }
+    const int64_t days = std::chrono::sys_days(date).time_since_epoch().count();
+    ns = ((days * 24 + hour) * 3600 + minute * 60 + second) * 1000000000 + fraction;
+    return true;
+}
+
+// "1534614248.123678", seconds since the epoch, as ns
+bool readEpochSeconds(std::string_view value, int64_t& ns) {
+    const std::string_view text = JsonScan::unquote(value);
+    int64_t seconds = 0;
+    auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), seconds);
+    if (ec != std::errc()) {
+        return false;
+    }
+    std::size_t pos = static_cast<std::size_t>(end - text.data());
+    int64_t fraction = 0;
+    if (pos < text.size() && text[pos] == '.') {
+        pos = readFractionNs(text, pos + 1, fraction);
+    }
+    ns = seconds * 1000000000 + fraction;
+    return pos == text.size();
+}
+
+// Reads [[price, size, ...], ...] appending (price, size) pairs, the unquoted price and size
+// text to text if given, and the latest level timestamp (Kraken's third field) to latestNs if
+// given
+bool readLevels(std::string_view array, Levels& out,
+                std::vector<KrakenBookFrame::LevelText>* text = nullptr,
+                int64_t* latestNs = nullptr) {
+    ArrayReader levels(array);
+    std::string_view level;
+    while (levels.next(level)) {
+        ArrayReader fields(level);
+        std::string_view price;
+        std::string_view size;
+        double p = 0.0;
+        double q = 0.0;
+        if (!fields.next(price) || !fields.next(size) ||
+            !JsonScan::toDouble(price, p) || !JsonScan::toDouble(size, q)) {
+            return false;
+        }
+        out.emplace_back(p, q);
+        if (text) {
+            text->emplace_back(JsonScan::unquote(price), JsonScan::unquote(size));
+        }
+        std::string_view time;
+        int64_t ns = 0;
+        if (latestNs && fields.next(time) && readEpochSeconds(time, ns) && ns > *latestNs) {
+            *latestNs = ns;
+        }
+    }
+    return !levels.failed();
+}
+
+void resetSnapshot(OrderBookSnapshot& snapshot) {
+    snapshot.bids.clear();
+    snapshot.asks.clear();
+    snapshot.timestamp = 0;
+    snapshot.sequence = 0;
+    snapshot.exchangeTime = 0;
+    snapshot.exchangeTimeLocal = 0;
+    snapshot.receiveTime = 0;
+}
+
+void resetDelta(OrderBookDelta& delta) {
+    delta.bidUpdates.clear();
+    delta.askUpdates.clear();
+    delta.timestamp = 0;
+    delta.sequence = 0;
+    delta.firstSequence = 0;
+    delta.exchangeTime = 0;
+    delta.exchangeTimeLocal = 0;
+    delta.receiveTime = 0;
+}
+
+} // namespace
+
+FrameType BinanceFrameParser::parse(std::string_view frame, OrderBookSnapshot& snapshot,
+                                    OrderBookDelta& delta) {
+    TopOfBookUpdate ignored;
+    FrameType type = parse(frame, snapshot, delta, ignored);
+    return type == FrameType::TopOfBook ? FrameType::Control : type;
+}
+
+FrameType BinanceFrameParser::parse(std::string_view frame, OrderBookSnapshot& snapshot,
+                                    OrderBookDelta& delta, TopOfBookUpdate& ticker) {
+    std::string_view eventType;
+    std::string_view symbol;
+    std::string_view bids;
+    std::string_view asks;
+    std::string_view bidSize;
+    std::string_view askSize;
+    uint64_t firstUpdateId = 0;
+    uint64_t finalUpdateId = 0;
+    uint64_t lastUpdateId = 0;
+    uint64_t eventTimeMs = 0;
+    bool hasLastUpdateId = false;
+
+    ObjectReader message(frame);
+    std::string_view key;
+    std::string_view value;
+    while (message.next(key, value)) {
+        if (key == "data") {
+            // Combined stream wrapper: {"stream": "...", "data": {...}}
+            return parse(value, snapshot, delta, ticker);
+        } else if (key == "e") {
+            eventType = JsonScan::unquote(value);
+        } else if (key == "E") {
+            JsonScan::toUint(value, eventTimeMs);
+        } else if (key == "s" || key == "symbol") {
+            symbol = JsonScan::unquote(value);
+        } else if (key == "U") {
+            JsonScan::toUint(value, firstUpdateId);
+        } else if (key == "u") {
+            JsonScan::toUint(value, finalUpdateId);
+        } else if (key == "lastUpdateId") {
+            hasLastUpdateId = JsonScan::toUint(value, lastUpdateId);
+        } else if (key == "b" || key == "bids") {
+            bids = value;
+        } else if (key == "a" || key == "asks") {
+            asks = value;
+        } else if (key == "B") {
+            bidSize = value;
+        } else if (key == "A") {
+            askSize = value;
+        }
+    }
+    if (message.failed()) {
+        return FrameType::Malformed;
+    }
+
+    if (eventType == "depthUpdate") {
+        resetDelta(delta);
+        delta.symbol.assign(symbol);
+        delta.timestamp = static_cast<int64_t>(finalUpdateId);
+        delta.sequence = finalUpdateId;
+        delta.firstSequence = firstUpdateId;
+        delta.exchangeTime = static_cast<int64_t>(eventTimeMs) * 1000000;
+        if (!readLevels(bids, delta.bidUpdates) || !readLevels(asks, delta.askUpdates)) {
+            return FrameType::Malformed;
+        }
+        return FrameType::BookDelta;
+    }
+
+    // Spot bookTicker has no event type; futures sends "bookTicker"
+    if ((eventType.empty() || eventType == "bookTicker") && !bidSize.empty() && !askSize.empty()) {
+        ticker.symbol.assign(symbol);
+        ticker.sequence = finalUpdateId;
+        ticker.timestamp = static_cast<int64_t>(finalUpdateId);
+        // Spot bookTicker carries no event time; futures does
+        ticker.exchangeTime = static_cast<int64_t>(eventTimeMs) * 1000000;
+        ticker.exchangeTimeLocal = 0;
+        ticker.receiveTime = 0;
+        if (!JsonScan::toDouble(bids, ticker.bidPrice) ||
+            !JsonScan::toDouble(bidSize, ticker.bidSize) ||
+            !JsonScan::toDouble(asks, ticker.askPrice) ||
+            !JsonScan::toDouble(askSize, ticker.askSize)) {
+            return FrameType::Malformed;
+        }
+        return FrameType::TopOfBook;
+    }
+
+    if (hasLastUpdateId && !bids.empty()) {
+        resetSnapshot(snapshot);
+        snapshot.symbol.assign(symbol);
+        snapshot.timestamp = static_cast<int64_t>(lastUpdateId);
+        snapshot.sequence = lastUpdateId;
+        if (!readLevels(bids, snapshot.bids) || !readLevels(asks, snapshot.asks)) {
+            return FrameType::Malformed;
+        }
+        return FrameType::BookSnapshot;
+    }
+
+    return FrameType::Control;
+}
+
+namespace {
+
+// Where parseCoinbase writes each product's levels. SingleProduct fills the caller's snapshot and
+// delta and refuses a second product; Batch gives each product its own entry.
+class SingleProduct {
+public:
+    SingleProduct(OrderBookSnapshot& snapshot, OrderBookDelta& delta)
+        : snapshot_(snapshot), delta_(delta) {}
+
+    OrderBookSnapshot* snapshotFor(std::string_view product) {
+        if (hasDelta_ || (hasSnapshot_ && snapshot_.symbol != product)) {
+            return nullptr;
+        }
+        if (!hasSnapshot_) {
+            resetSnapshot(snapshot_);
+            snapshot_.symbol.assign(product);
+            hasSnapshot_ = true;
+        }
+        return &snapshot_;
+    }
+
+    OrderBookDelta* deltaFor(std::string_view product) {
+        if (hasSnapshot_ || (hasDelta_ && delta_.symbol != product)) {
+            return nullptr;
+        }
+        if (!hasDelta_) {
+            resetDelta(delta_);
+            delta_.symbol.assign(product);
+            hasDelta_ = true;
+        }
+        return &delta_;
+    }
+
+    void setSequence(uint64_t) {}
+    bool hasSnapshot() const { return hasSnapshot_; }
+    bool hasDelta() const { return hasDelta_; }
+
+private:
+    OrderBookSnapshot& snapshot_;
+    OrderBookDelta& delta_;
+    bool hasSnapshot_ = false;
+    bool hasDelta_ = false;
+};
+
+class Batch {
+public:
+    explicit Batch(CoinbaseBookBatch& batch) : batch_(batch) {
+        batch_.snapshotCount = 0;
+        batch_.deltaCount = 0;
+        batch_.sequence = 0;
+        batch_.hasSequence = false;
+    }
+
+    OrderBookSnapshot* snapshotFor(std::string_view product) {
+        return &entryFor(batch_.snapshots, batch_.snapshotCount, product, resetSnapshot);
+    }
+
+    OrderBookDelta* deltaFor(std::string_view product) {
+        return &entryFor(batch_.deltas, batch_.deltaCount, product, resetDelta);
+    }
+
+    void setSequence(uint64_t sequence) {
+        batch_.sequence = sequence;
+        batch_.hasSequence = true;
+    }
+    bool hasSnapshot() const { return batch_.snapshotCount > 0; }
+    bool hasDelta() const { return batch_.deltaCount > 0; }
+
+private:
+    // The product's entry among the first count, or the next spare one reset for it
+    template <typename Entry>
+    static Entry& entryFor(std::vector<Entry>& entries, std::size_t& count,
+                           std::string_view product, void (*reset)(Entry&)) {
+        for (std::size_t i = 0; i < count; ++i) {
+            if (entries[i].symbol == product) {
+                return entries[i];
+            }
+        }
+        if (count == entries.size()) {
+            entries.emplace_back();
+        }
+        Entry& entry = entries[count++];
+        reset(entry);
+        entry.symbol.assign(product);
+        return entry;
+    }
+
+    CoinbaseBookBatch& batch_;
+};
+
+// Advanced Trade l2_data: every event is {type, product_id, updates: [{side, event_time,
+// price_level, new_quantity}]}. All of a product's updates in one message land in one entry.
+// The message's sequence_num counts messages on the connection, not book updates, so events
+// carry no sequence of their own.
+template <typename Sink>
+FrameType readCoinbaseEvents(std::string_view events, int64_t exchangeTime, Sink& sink) {
+    const int64_t timestamp = nowMs();
+    ArrayReader eventReader(events);
+    std::string_view event;
+    while (eventReader.next(event)) {
+        std::string_view type;
+        std::string_view productId;
+        std::string_view updates;
+        ObjectReader fields(event);
+        std::string_view key;
+        std::string_view value;
+        while (fields.next(key, value)) {
+            if (key == "type") {
+                type = JsonScan::unquote(value);
+            } else if (key == "product_id") {
+                productId = JsonScan::unquote(value);
+            } else if (key == "updates") {
+                updates = value;
+            }
+        }
+        if (fields.failed()) {
+            return FrameType::Malformed;
+        }
+
+        Levels* bids = nullptr;
+        Levels* asks = nullptr;
+        if (type == "snapshot") {
+            OrderBookSnapshot* snapshot = sink.snapshotFor(productId);
+            if (!snapshot) {
+                return FrameType::Malformed;
+            }
+            snapshot->timestamp = timestamp;
+            snapshot->sequence = 0;
+            snapshot->exchangeTime = exchangeTime;
+            bids = &snapshot->bids;
+            asks = &snapshot->asks;
+        } else if (type == "update") {
+            OrderBookDelta* delta = sink.deltaFor(productId);
+            if (!delta) {
+                return FrameType::Malformed;
+            }
+            delta->timestamp = timestamp;
+            delta->sequence = 0;
+            delta->exchangeTime = exchangeTime;
+            bids = &delta->bidUpdates;
+            asks = &delta->askUpdates;
+        } else {
+            continue;
+        }
+
+        ArrayReader updateReader(updates);
+        std::string_view update;
+        while (updateReader.next(update)) {
+            std::string_view side;
+            std::string_view price;
+            std::string_view quantity;
+            ObjectReader level(update);
+            while (level.next(key, value)) {
+                if (key == "side") {
+                    side = JsonScan::unquote(value);
+                } else if (key == "price_level") {
+                    price = value;
+                } else if (key == "new_quantity") {
+                    quantity = value;
+                }
+            }
+            double p = 0.0;
+            double q = 0.0;
+            if (level.failed() || !JsonScan::toDouble(price, p) ||
+                !JsonScan::toDouble(quantity, q)) {
+                return FrameType::Malformed;
+            }
+            if (side == "bid") {
+                bids->emplace_back(p, q);
+            } else if (side == "offer") {
+                asks->emplace_back(p, q);
+            }
+        }
+        if (updateReader.failed()) {
+            return FrameType::Malformed;
+        }
+    }
+    if (eventReader.failed()) {
+        return FrameType::Malformed;
+    }
+
+    if (sink.hasSnapshot()) {
+        return FrameType::BookSnapshot;
+    }
+    return sink.hasDelta() ? FrameType::BookDelta : FrameType::Heartbeat;
+}
+
+template <typename Sink>
+FrameType parseCoinbase(std::string_view frame, Sink& sink) {
+    std::string_view type;
+    std::string_view channel;
+    std::string_view productId;
+    std::string_view bids;
+    std::string_view asks;
+    std::string_view changes;
+    std::string_view events;
+    std::string_view sequenceNum;
+    std::string_view time;
+
+    ObjectReader message(frame);
+    std::string_view key;
+    std::string_view value;
+    while (message.next(key, value)) {
+        if (key == "type") {
+            type = JsonScan::unquote(value);
+        } else if (key == "channel") {
+            channel = JsonScan::unquote(value);
+        } else if (key == "product_id") {
+            productId = JsonScan::unquote(value);
+        } else if (key == "bids") {
+            bids = value;
+        } else if (key == "asks") {
+            asks = value;
+        } else if (key == "changes") {
+            changes = value;
+        } else if (key == "events") {
+            events = value;
+        } else if (key == "sequence_num") {
+            sequenceNum = value;
+        } else if (key == "timestamp" || key == "time") {
+            time = value;  // Advanced Trade, legacy feed
+        }
+    }
+    if (message.failed()) {
+        return FrameType::Malformed;
+    }
+
+    // Advanced Trade numbers every message on a connection, whatever its channel, starting
+    // again on each connection; it is kept for gap detection only
+    if (!sequenceNum.empty()) {
+        uint64_t sequence = 0;
+        if (!JsonScan::toUint(sequenceNum, sequence)) {
+            return FrameType::Malformed;
+        }
+        sink.setSequence(sequence);
+    }
+
+    // When the venue published the message; a time that does not parse is simply not reported
+    int64_t exchangeTime = 0;
+    if (!time.empty() && !readIsoTime(time, exchangeTime)) {
+        exchangeTime = 0;
+    }
+
+    if (channel == "l2_data") {
+        return readCoinbaseEvents(events, exchangeTime, sink);
+    }
+    if (channel == "heartbeats") {
+        return FrameType::Heartbeat;
+    }
+
+    if (type == "snapshot") {
+        OrderBookSnapshot* snapshot = sink.snapshotFor(productId);
+        snapshot->timestamp = nowMs();
+        snapshot->exchangeTime = exchangeTime;
+        if (!readLevels(bids, snapshot->bids) || !readLevels(asks, snapshot->asks)) {
+            return FrameType::Malformed;
+        }
+        return FrameType::BookSnapshot;
+    }
+
+    if (type == "l2update") {
+        OrderBookDelta* delta = sink.deltaFor(productId);
+        delta->timestamp = nowMs();
+        delta->exchangeTime = exchangeTime;
+
+        // Each change is [side, price, size]
+        ArrayReader entries(changes);
+        std::string_view change;
+        while (entries.next(change)) {
+            ArrayReader fields(change);
+            std::string_view side;
+            std::string_view price;
+            std::string_view size;
+            double p = 0.0;
+            double q = 0.0;
+            if (!fields.next(side) || !fields.next(price) || !fields.next(size) ||
+                !JsonScan::toDouble(price, p) || !JsonScan::toDouble(size, q)) {
+                return FrameType::Malformed;
+            }
+            side = JsonScan::unquote(side);
+            if (side == "buy") {
+                delta->bidUpdates.emplace_back(p, q);
+            } else if (side == "sell") {
+                delta->askUpdates.emplace_back(p, q);
+            }
+        }
+        return entries.failed() ? FrameType::Malformed : FrameType::BookDelta;
+    }
+
+    if (type == "heartbeat") {
+        return FrameType::Heartbeat;
+    }
+
+    return FrameType::Control;
+}
+
+} // namespace
+
+FrameType CoinbaseFrameParser::parse(std::string_view frame, OrderBookSnapshot& snapshot,
+                                     OrderBookDelta& delta) {
+    SingleProduct sink(snapshot, delta);
+    return parseCoinbase(frame, sink);
+}
+
+FrameType CoinbaseFrameParser::parse(std::string_view frame, CoinbaseBookBatch& batch) {
+    Batch sink(batch);
+    return parseCoinbase(frame, sink);
+}
+
+namespace {
+
+// book collects the Kraken-specific extras when given
+FrameType parseKraken(std::string_view frame, OrderBookSnapshot& snapshot,
+                      OrderBookDelta& delta, KrakenBookFrame* book) {
+    // Book messages are [channelID, {book}, ({book},) "book-N", "PAIR"]; events are objects
+    std::size_t start = JsonScan::skipWhitespace(frame, 0);
+    if (start >= frame.size() || frame[start] != '[') {
+        ObjectReader event(frame);
+        std::string_view key;
+        std::string_view value;
+        while (event.next(key, value)) {
+            if (key == "event") {
+                return JsonScan::unquote(value) == "heartbeat" ? FrameType::Heartbeat
+                                                                : FrameType::Control;
+            }
+        }
+        return FrameType::Control;
+    }
+
+    std::string_view channel;
+    std::string_view books[2];
+    std::size_t bookCount = 0;
+    std::string_view pair;
+
+    ArrayReader elements(frame);
+    std::string_view element;
+    while (elements.next(element)) {
+        if (element.front() == '{') {
+            if (bookCount < 2) {
+                books[bookCount++] = element;
+            }
+        } else if (element.front() == '"') {
+            pair = JsonScan::unquote(element);  // Channel name, then pair last
+        } else if (channel.empty()) {
+            channel = element;
+        }
+    }
+    if (elements.failed() || bookCount == 0) {
+        return FrameType::Malformed;
+    }
+
+    bool isSnapshot = false;
+    for (std::size_t i = 0; i < bookCount; ++i) {
+        ObjectReader reader(books[i]);
+        std::string_view key;
+        std::string_view value;
+        while (reader.next(key, value)) {
+            if (key == "as" || key == "bs") {
+                isSnapshot = true;
+            }
+        }
+    }
+
+    if (isSnapshot) {
+        resetSnapshot(snapshot);
+        snapshot.symbol.assign(pair);
+        snapshot.timestamp = nowMs();
+    } else {
+        resetDelta(delta);
+        delta.symbol.assign(pair);
+        delta.timestamp = nowMs();
+    }
+    if (book) {
+        book->bids.clear();
+        book->asks.clear();
+        book->hasChecksum = false;
+        book->checksum = 0;
+        if (!JsonScan::toUint(channel, book->channelId)) {
+            return FrameType::Malformed;
+        }
+    }
+
+    // Every level carries the time it last changed. In an update the latest is the update's
+    // event time; a snapshot's levels may be of any age, so it reports none.
+    int64_t exchangeTime = 0;
+    for (std::size_t i = 0; i < bookCount; ++i) {
+        ObjectReader reader(books[i]);
+        std::string_view key;
+        std::string_view value;
+        while (reader.next(key, value)) {
+            bool ok = true;
+            if (key == "bs") {
+                ok = readLevels(value, snapshot.bids, book ? &book->bids : nullptr);
+            } else if (key == "as") {
+                ok = readLevels(value, snapshot.asks, book ? &book->asks : nullptr);
+            } else if (key == "b") {
+                ok = readLevels(value, delta.bidUpdates, book ? &book->bids : nullptr,
+                                &exchangeTime);
+            } else if (key == "a") {
+                ok = readLevels(value, delta.askUpdates, book ? &book->asks : nullptr,
+                                &exchangeTime);
+            } else if (key == "c" && book) {
+                uint64_t checksum = 0;
+                ok = JsonScan::toUint(value, checksum) && checksum <= UINT32_MAX;
+                book->checksum = static_cast<uint32_t>(checksum);
+                book->hasChecksum = true;
+            }
+            if (!ok) {
+                return FrameType::Malformed;
+            }
+        }
+        if (reader.failed()) {
+            return FrameType::Malformed;
+        }
+    }
+
+    if (isSnapshot) {
+        return FrameType::BookSnapshot;
+    }
+    delta.exchangeTime = exchangeTime;
+    return FrameType::BookDelta;
+}
+
+} // namespace
+
+FrameType KrakenFrameParser::parse(std::string_view frame, OrderBookSnapshot& snapshot,
+                                   OrderBookDelta& delta) {
+    return parseKraken(frame, snapshot, delta, nullptr);
+}
+
+FrameType KrakenFrameParser::parse(std::string_view frame, OrderBookSnapshot& snapshot,
+                                   OrderBookDelta& delta, KrakenBookFrame& book) {
+    return parseKraken(frame, snapshot, delta, &book);
+}
+
+} // namespace crypto_hft
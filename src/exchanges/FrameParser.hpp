@@ -0,0 +1,81 @@
+#pragma once
+
+#include "IExchangeAdapter.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace crypto_hft {
+
+enum class FrameType {
+    BookSnapshot,
+    BookDelta,
+    TopOfBook,  // Best bid/offer quote (Binance bookTicker)
+    Heartbeat,  // Recognized keep-alive, nothing to do
+    Control,    // Acks, errors, status: left to the adapter's slow path
+    Malformed
+};
+
+// Schema-specific parsers for each venue's order book messages. They walk the raw frame once
+// with JsonScan and write normalized output directly, without building a DOM. The output
+// structs are cleared and refilled, so callers that reuse them keep the level vectors' capacity.
+
+struct BinanceFrameParser {
+    // bookTicker frames are reported as Control
+    static FrameType parse(std::string_view frame, OrderBookSnapshot& snapshot,
+                           OrderBookDelta& delta);
+    // Also parses bookTicker frames into ticker
+    static FrameType parse(std::string_view frame, OrderBookSnapshot& snapshot,
+                           OrderBookDelta& delta, TopOfBookUpdate& ticker);
+};
+
+// A Coinbase message's book content with one entry per product. Advanced Trade sends l2_data
+// events in batches; all of a product's updates in one message become a single delta, applied
+// as one transaction. Entries past the counts are spare, kept for their capacity.
+struct CoinbaseBookBatch {
+    // The message's sequence_num. It counts messages on one connection and restarts with each,
+    // so it only detects gaps; the entries' own sequence is 0, as Coinbase has no book ids.
+    uint64_t sequence = 0;
+    bool hasSequence = false;  // Advanced Trade messages carry one, the legacy feed does not
+    std::size_t snapshotCount = 0;
+    std::size_t deltaCount = 0;
+    std::vector<OrderBookSnapshot> snapshots;
+    std::vector<OrderBookDelta> deltas;
+};
+
+// Reads both the Advanced Trade schema (channel/events) and the legacy Exchange feed
+// (snapshot/l2update).
+struct CoinbaseFrameParser {
+    // Messages with book data for more than one product, or both a snapshot and updates, are
+    // Malformed here; the batch overload takes them
+    static FrameType parse(std::string_view frame, OrderBookSnapshot& snapshot,
+                           OrderBookDelta& delta);
+    // BookSnapshot if the batch holds any snapshot, BookDelta if it holds only deltas. Sequence
+    // numbers are reported for every Advanced Trade message, Control and Heartbeat included.
+    static FrameType parse(std::string_view frame, CoinbaseBookBatch& batch);
+};
+
+// What a Kraken book message carries besides its levels: the subscription's channel id, the
+// checksum of the book after an update, and every level's price and volume text exactly as sent,
+// which the checksum is computed over. The text slices point into the frame and are parallel to
+// the snapshot's or delta's level vectors.
+struct KrakenBookFrame {
+    using LevelText = std::pair<std::string_view, std::string_view>;
+
+    uint64_t channelId = 0;
+    uint32_t checksum = 0;
+    bool hasChecksum = false;
+    std::vector<LevelText> bids;
+    std::vector<LevelText> asks;
+};
+
+struct KrakenFrameParser {
+    static FrameType parse(std::string_view frame, OrderBookSnapshot& snapshot,
+                           OrderBookDelta& delta);
+    static FrameType parse(std::string_view frame, OrderBookSnapshot& snapshot,
+                           OrderBookDelta& delta, KrakenBookFrame& book);
+};
+
+} // namespace crypto_hft
@@ -0,0 +1,536 @@
+#include "HttpsClient.hpp"
+#include <boost/asio/post.hpp>
+#include <boost/beast/version.hpp>
+#include <algorithm>
+#include <future>
+#include <iterator>
+
+namespace crypto_hft {
+
+namespace beast = boost::beast;
+namespace http = beast::http;
+namespace net = boost::asio;
+namespace ssl = boost::asio::ssl;
+using tcp = net::ip::tcp;
+
+namespace {
+
+constexpr auto kMinReconnectBackoff = std::chrono::milliseconds(100);
+constexpr auto kMaxReconnectBackoff = std::chrono::milliseconds(5000);
+
+// Retry-After in seconds; venues do not send the HTTP-date form
+std::chrono::seconds retryAfter(beast::string_view value) {
+    try {
+        return std::chrono::seconds(std::max(1L, std::stol(std::string(value))));
+    } catch (const std::exception&) {
+        return std::chrono::seconds(1);
+    }
+}
+
+} // namespace
+
+HttpsClient::Options HttpsClient::Options::fromYaml(const YAML::Node& node, Options defaults) {
+    Options options = std::move(defaults);
+    if (!node.IsDefined() || !node.IsMap()) {
+        return options;
+    }
+    options.host = node["host"].as<std::string>(options.host);
+    options.port = node["port"].as<std::string>(options.port);
+    options.connections =
+        std::max<std::size_t>(1, node["connections"].as<std::size_t>(options.connections));
+    options.pipelineDepth =
+        std::max<std::size_t>(1, node["pipeline_depth"].as<std::size_t>(options.pipelineDepth));
+    options.timeout = std::chrono::seconds(
+        node["timeout_s"].as<int>(static_cast<int>(options.timeout.count())));
+    options.weightPerSecond = node["weight_per_second"].as<double>(options.weightPerSecond);
+    options.weightBurst = node["weight_burst"].as<double>(options.weightBurst);
+    options.warmConnections = std::min(
+        options.connections, node["warm_connections"].as<std::size_t>(options.warmConnections));
+    options.maxIdle = std::chrono::seconds(
+        node["max_idle_s"].as<int>(static_cast<int>(options.maxIdle.count())));
+    return options;
+}
+
+std::shared_ptr<HttpsClient> HttpsClient::create(net::io_context& ioc, Options options,
+                                                 std::shared_ptr<spdlog::logger> logger) {
+    return std::shared_ptr<HttpsClient>(
+        new HttpsClient(ioc, std::move(options), std::move(logger)));
+}
+
+HttpsClient::HttpsClient(net::io_context& ioc, Options options,
+                         std::shared_ptr<spdlog::logger> logger)
+    : ioc_(ioc)
+    , ctx_(ssl::context::tls_client)
+    , options_(std::move(options))
+    , logger_(logger ? std::move(logger) : spdlog::default_logger())
+    , strand_(net::make_strand(ioc))
+    , resolver_(strand_)
+    , wakeTimer_(strand_)
+    , idleTimer_(strand_)
+    , connections_(std::max<std::size_t>(1, options_.connections))
+    , limiter_(options_.limiter ? options_.limiter
+                                : std::make_shared<RateLimiter>(options_.weightPerSecond,
+                                                                options_.weightBurst)) {
+    ctx_.set_options(ssl::context::default_workarounds | ssl::context::no_sslv2 |
+                     ssl::context::no_sslv3);
+    if (options_.verifyPeer) {
+        ctx_.set_verify_mode(ssl::verify_peer);
+        ctx_.set_default_verify_paths();
+    } else {
+        ctx_.set_verify_mode(ssl::verify_none);
+    }
+    options_.pipelineDepth = std::max<std::size_t>(1, options_.pipelineDepth);
+}
+
+void HttpsClient::get(std::string target, Callback callback, double weight) {
+    send(Message{http::verb::get, target, 11}, std::move(callback), weight, true);
+}
+
+void HttpsClient::send(Message message, Callback callback, double weight, bool idempotent) {
+    auto request = std::make_shared<Request>();
+    request->message = std::move(message);
+    request->message.version(11);
+    request->message.set(http::field::host, options_.host);
+    request->message.set(http::field::user_agent, BOOST_BEAST_VERSION_STRING);
+    request->message.keep_alive(true);
+    if (!request->message.body().empty() || request->message.method() != http::verb::get) {
+        request->message.prepare_payload();
+    }
+    request->callback = std::move(callback);
+    request->weight = weight;
+    request->idempotent = idempotent;
+    requests_.fetch_add(1, std::memory_order_relaxed);
+
+    net::post(strand_, [self = shared_from_this(), request] {
+        if (self->closed_) {
+            self->finish(request, Response{net::error::operation_aborted, 0, {}});
+            return;
+        }
+        self->pending_.push_back(request);
+        self->dispatch();
+    });
+}
+
+void HttpsClient::warmUp() {
+    net::post(strand_, [self = shared_from_this()] {
+        if (self->closed_ || self->warm_) {
+            return;
+        }
+        self->warm_ = true;
+        self->keepWarm();
+        if (self->options_.maxIdle.count() > 0) {
+            self->recycleIdle();
+        }
+    });
+}
+
+void HttpsClient::shutdown() {
+    // With one thread per context, being on it means no handler can run concurrently
+    if (ioc_.get_executor().running_in_this_thread() || ioc_.stopped()) {
+        doShutdown();
+        return;
+    }
+    std::promise<void> done;
+    net::post(strand_, [this, &done] {
+        doShutdown();
+        done.set_value();
+    });
+    done.get_future().wait();
+}
+
+HttpsClient::Stats HttpsClient::getStats() const {
+    Stats stats;
+    stats.requests = requests_.load(std::memory_order_relaxed);
+    stats.responses = responses_.load(std::memory_order_relaxed);
+    stats.retries = retries_.load(std::memory_order_relaxed);
+    stats.connectionsOpened = connectionsOpened_.load(std::memory_order_relaxed);
+    stats.resumedHandshakes = resumedHandshakes_.load(std::memory_order_relaxed);
+    stats.throttled = throttled_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void HttpsClient::dispatch() {
+    if (warm_ && !closed_) {
+        keepWarm();
+    }
+    while (!closed_ && !pending_.empty()) {
+        auto now = Clock::now();
+        const double weight = pending_.front()->weight;
+        auto delay = limiter_->timeUntilAvailable(weight, now);
+        ConnectionPtr connection;
+        if (delay == Clock::duration::zero()) {
+            connection = pickConnection();
+            if (!connection) {
+                return;  // Every connection is full; the next response dispatches again
+            }
+            // The limiter may be shared with other senders, so the weight can be gone by now
+            delay = limiter_->tryAcquire(weight, now);
+        }
+        if (delay > Clock::duration::zero()) {
+            if (wakeAt(now + delay)) {
+                throttled_.fetch_add(1, std::memory_order_relaxed);
+            }
+            return;
+        }
+
+        auto request = std::move(pending_.front());
+        pending_.pop_front();
+        connection->unsent.push_back(std::move(request));
+        writeLoop(connection);
+    }
+}
+
+HttpsClient::ConnectionPtr HttpsClient::pickConnection() {
+    ConnectionPtr best;
+    ConnectionPtr* free = nullptr;
+    for (auto& slot : connections_) {
+        if (!slot) {
+            free = free ? free : &slot;
+        } else if (slot->load() < options_.pipelineDepth &&
+                   (!best || slot->load() < best->load())) {
+            best = slot;
+        }
+    }
+
+    // Open another connection rather than queue behind a busy one
+    if (free && (!best || best->load() > 0)) {
+        if (Clock::now() >= reconnectAfter_) {
+            return open(*free);
+        }
+        if (!best) {
+            wakeAt(reconnectAfter_);
+        }
+    }
+    return best;
+}
+
+HttpsClient::ConnectionPtr HttpsClient::open(ConnectionPtr& slot) {
+    slot = std::make_shared<Connection>(strand_, ctx_);
+    connect(slot);
+    return slot;
+}
+
+void HttpsClient::keepWarm() {
+    std::size_t open = static_cast<std::size_t>(
+        std::count_if(connections_.begin(), connections_.end(),
+                      [](const ConnectionPtr& slot) { return slot != nullptr; }));
+    for (auto& slot : connections_) {
+        if (open >= options_.warmConnections) {
+            return;
+        }
+        if (slot) {
+            continue;
+        }
+        if (Clock::now() < reconnectAfter_) {
+            wakeAt(reconnectAfter_);
+            return;
+        }
+        this->open(slot);
+        ++open;
+    }
+}
+
+void HttpsClient::recycleIdle() {
+    auto now = Clock::now();
+    // drop() empties the slot and keepWarm() refills it with a fresh connection
+    auto snapshot = connections_;
+    for (const auto& connection : snapshot) {
+        if (connection && connection->ready && connection->load() == 0 &&
+            now - connection->lastActive >= options_.maxIdle) {
+            drop(connection, false, {});
+        }
+    }
+
+    idleTimer_.expires_after(std::max<Clock::duration>(options_.maxIdle / 2,
+                                                       std::chrono::seconds(1)));
+    idleTimer_.async_wait([self = shared_from_this()](beast::error_code ec) {
+        if (ec || self->closed_) {
+            return;
+        }
+        self->recycleIdle();
+    });
+}
+
+void HttpsClient::connect(const ConnectionPtr& connection) {
+    auto self = shared_from_this();
+    if (endpoints_.empty()) {
+        resolver_.async_resolve(options_.host, options_.port,
+            [self, connection](beast::error_code ec, tcp::resolver::results_type results) {
+                if (self->closed_ || connection->dropped) {
+                    return;
+                }
+                if (ec) {
+                    self->onConnectionFailed(connection, "resolve", ec);
+                    return;
+                }
+                self->endpoints_ = std::move(results);
+                self->connect(connection);
+            });
+        return;
+    }
+
+    connectionsOpened_.fetch_add(1, std::memory_order_relaxed);
+    SSL* ssl = connection->stream.native_handle();
+    SSL_set_tlsext_host_name(ssl, options_.host.c_str());
+    if (options_.verifyPeer) {
+        SSL_set1_host(ssl, options_.host.c_str());
+    }
+    if (tlsSession_) {
+        SSL_set_session(ssl, tlsSession_.get());
+    }
+
+    beast::get_lowest_layer(connection->stream).expires_after(options_.timeout);
+    connectEndpoint(connection, endpoints_.begin());
+}
+
+void HttpsClient::connectEndpoint(const ConnectionPtr& connection,
+                                  tcp::resolver::results_type::const_iterator endpoint) {
+    // One endpoint at a time so the profile is applied before each connect, as in WsConnection
+    auto& tcpStream = beast::get_lowest_layer(connection->stream);
+    beast::error_code ec;
+    tcpStream.socket().open(endpoint->endpoint().protocol(), ec);
+    if (ec) {
+        onConnectionFailed(connection, "socket open", ec);
+        return;
+    }
+    options_.profile.apply(tcpStream.socket(), *logger_);
+
+    tcpStream.async_connect(endpoint->endpoint(),
+        [self = shared_from_this(), connection, endpoint](beast::error_code ec) {
+            if (self->closed_ || connection->dropped) {
+                return;
+            }
+            if (!ec) {
+                self->handshake(connection);
+                return;
+            }
+            auto next = std::next(endpoint);
+            if (next != self->endpoints_.end() && ec != beast::error::timeout) {
+                beast::error_code ignored;
+                beast::get_lowest_layer(connection->stream).socket().close(ignored);
+                self->connectEndpoint(connection, next);
+                return;
+            }
+            self->endpoints_ = {};  // Possibly stale; resolve again on the next attempt
+            self->onConnectionFailed(connection, "connect", ec);
+        });
+}
+
+void HttpsClient::handshake(const ConnectionPtr& connection) {
+    connection->stream.async_handshake(ssl::stream_base::client,
+        [self = shared_from_this(), connection](beast::error_code ec) {
+            if (self->closed_ || connection->dropped) {
+                return;
+            }
+            if (ec) {
+                self->onConnectionFailed(connection, "TLS handshake", ec);
+                return;
+            }
+            if (SSL_session_reused(connection->stream.native_handle())) {
+                self->resumedHandshakes_.fetch_add(1, std::memory_order_relaxed);
+            }
+            self->cacheTlsSession(*connection);
+            self->reconnectBackoff_ = std::chrono::milliseconds(0);
+            connection->lastActive = Clock::now();
+            connection->ready = true;
+            self->writeLoop(connection);
+        });
+}
+
+void HttpsClient::writeLoop(const ConnectionPtr& connection) {
+    if (!connection->ready || connection->writing || connection->unsent.empty()) {
+        return;
+    }
+    connection->writing = true;
+    auto request = connection->unsent.front();
+    connection->unsent.pop_front();
+    connection->awaiting.push_back(request);
+
+    beast::get_lowest_layer(connection->stream).expires_after(options_.timeout);
+    http::async_write(connection->stream, request->message,
+        [self = shared_from_this(), connection, request](beast::error_code ec, std::size_t) {
+            connection->writing = false;
+            if (self->closed_ || connection->dropped) {
+                return;
+            }
+            if (ec) {
+                self->onConnectionFailed(connection, "write", ec);
+                return;
+            }
+            self->readLoop(connection);
+            self->writeLoop(connection);
+        });
+}
+
+void HttpsClient::readLoop(const ConnectionPtr& connection) {
+    if (connection->reading || connection->awaiting.empty()) {
+        return;
+    }
+    connection->reading = true;
+    connection->parser.emplace();
+    connection->parser->body_limit(kMaxBodyBytes);
+
+    beast::get_lowest_layer(connection->stream).expires_after(options_.timeout);
+    http::async_read(connection->stream, connection->buffer, *connection->parser,
+        [self = shared_from_this(), connection](beast::error_code ec, std::size_t) {
+            connection->reading = false;
+            if (self->closed_ || connection->dropped) {
+                return;
+            }
+            if (ec) {
+                self->onConnectionFailed(connection, "read", ec);
+                return;
+            }
+            self->onResponse(connection);
+        });
+}
+
+void HttpsClient::onResponse(const ConnectionPtr& connection) {
+    // Responses come back in request order on a connection
+    auto request = connection->awaiting.front();
+    connection->awaiting.pop_front();
+    auto message = connection->parser->release();
+    connection->parser.reset();
+    connection->lastActive = Clock::now();
+    const bool keepAlive = message.keep_alive();
+    const unsigned status = message.result_int();
+
+    if ((status == 429 || status == 418) && request->attempts + 1 < kMaxAttempts) {
+        auto pause = retryAfter(message[http::field::retry_after]);
+        logger_->warn("{} answered {} to {}; pausing requests for {}s", options_.host, status,
+                      std::string(request->message.target()), pause.count());
+        limiter_->pauseUntil(Clock::now() + pause);
+        ++request->attempts;
+        retries_.fetch_add(1, std::memory_order_relaxed);
+        pending_.push_front(std::move(request));
+    } else {
+        finish(request, Response{{}, status, std::move(message.body())});
+    }
+
+    if (closed_) {
+        return;  // The callback shut the client down
+    }
+    if (!keepAlive) {
+        // The server answers nothing more on this connection; what is left goes elsewhere
+        drop(connection, false, {});
+        return;
+    }
+    readLoop(connection);
+    dispatch();
+}
+
+void HttpsClient::onConnectionFailed(const ConnectionPtr& connection, const char* stage,
+                                     const beast::error_code& ec) {
+    logger_->warn("HTTPS connection to {} failed at {}: {}", options_.host, stage,
+                  ec.message());
+    if (!connection->ready) {
+        // Back off before opening another connection to a host that refuses them
+        reconnectBackoff_ = std::clamp(reconnectBackoff_ * 2,
+                                       std::chrono::milliseconds(kMinReconnectBackoff),
+                                       std::chrono::milliseconds(kMaxReconnectBackoff));
+        reconnectAfter_ = Clock::now() + reconnectBackoff_;
+    }
+    drop(connection, true, ec);
+}
+
+void HttpsClient::drop(const ConnectionPtr& connection, bool countAttempt,
+                       const beast::error_code& ec) {
+    connection->dropped = true;
+    cacheTlsSession(*connection);
+    beast::error_code ignored;
+    beast::get_lowest_layer(connection->stream).socket().close(ignored);
+    auto slot = std::find(connections_.begin(), connections_.end(), connection);
+    if (slot != connections_.end()) {
+        slot->reset();
+    }
+
+    // Requests written on the connection may have reached the venue; only idempotent ones can
+    // go again
+    for (const auto& request : connection->awaiting) {
+        if (!request->idempotent) {
+            finish(request, Response{ec ? ec : net::error::connection_aborted, 0, {}});
+        }
+    }
+
+    // Requeue the rest at the front in the original order; a request that never reached the
+    // wire or was cut off by the server closing cleanly does not use up an attempt
+    std::vector<RequestPtr> orphans;
+    std::copy_if(connection->awaiting.begin(), connection->awaiting.end(),
+                 std::back_inserter(orphans), [](const RequestPtr& r) { return r->idempotent; });
+    orphans.insert(orphans.end(), connection->unsent.begin(), connection->unsent.end());
+    connection->awaiting.clear();
+    connection->unsent.clear();
+    for (auto it = orphans.rbegin(); it != orphans.rend(); ++it) {
+        if (countAttempt && ++(*it)->attempts >= kMaxAttempts) {
+            finish(*it, Response{ec, 0, {}});
+        } else {
+            retries_.fetch_add(1, std::memory_order_relaxed);
+            pending_.push_front(*it);
+        }
+    }
+    dispatch();
+}
+
+void HttpsClient::finish(const RequestPtr& request, Response response) {
+    responses_.fetch_add(1, std::memory_order_relaxed);
+    if (request->callback) {
+        request->callback(std::move(response));
+    }
+}
+
+bool HttpsClient::wakeAt(Clock::time_point when) {
+    if (wakeAt_ != Clock::time_point{} && wakeAt_ <= when) {
+        return false;  // Already waking up no later than that
+    }
+    wakeAt_ = when;
+    wakeTimer_.expires_at(when);
+    wakeTimer_.async_wait([self = shared_from_this()](beast::error_code ec) {
+        if (ec || self->closed_) {
+            return;
+        }
+        self->wakeAt_ = {};
+        self->dispatch();
+    });
+    return true;
+}
+
+void HttpsClient::cacheTlsSession(Connection& connection) {
+    // A copy, for the same reason as in WsConnection: the original stops being resumable when
+    // a connection without a clean TLS shutdown is freed
+    SSL_SESSION* tls = SSL_get0_session(connection.stream.native_handle());
+    if (tls && SSL_SESSION_is_resumable(tls)) {
+        if (SSL_SESSION* copy = SSL_SESSION_dup(tls)) {
+            tlsSession_.reset(copy, SSL_SESSION_free);
+        }
+    }
+}
+
+void HttpsClient::doShutdown() {
+    if (closed_) {
+        return;
+    }
+    closed_ = true;
+    resolver_.cancel();
+    wakeTimer_.cancel();
+    idleTimer_.cancel();
+
+    std::vector<RequestPtr> aborted;
+    for (auto& connection : connections_) {
+        if (!connection) {
+            continue;
+        }
+        connection->dropped = true;
+        beast::error_code ignored;
+        beast::get_lowest_layer(connection->stream).socket().close(ignored);
+        aborted.insert(aborted.end(), connection->awaiting.begin(), connection->awaiting.end());
+        aborted.insert(aborted.end(), connection->unsent.begin(), connection->unsent.end());
+        connection.reset();
+    }
+    aborted.insert(aborted.end(), pending_.begin(), pending_.end());
+    pending_.clear();
+    for (const auto& request : aborted) {
+        finish(request, Response{net::error::operation_aborted, 0, {}});
+    }
+}
+
+} // namespace crypto_hft
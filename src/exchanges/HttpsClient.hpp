@@ -0,0 +1,193 @@
+#pragma once
+
+#include "ConnectionProfile.hpp"
+#include "RateLimiter.hpp"
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/ssl.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/strand.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <boost/beast/ssl.hpp>
+#include <openssl/ssl.h>
+#include <spdlog/spdlog.h>
+#include <yaml-cpp/yaml.h>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace crypto_hft {
+
+// Pooled keep-alive HTTPS client for one venue's REST host, meant to be shared by all of the
+// venue's adapters. Requests queue on the client's strand and go out over up to `connections`
+// persistent TLS connections, opened on demand and resumed from a cached TLS session. Each
+// connection pipelines up to `pipelineDepth` requests ahead of their responses. Request weights
+// are charged against the venue's limit before sending, and 429/418 answers pause the whole
+// client for the venue's Retry-After. Idempotent requests that fail in transit are retried on
+// another connection; the others fail once they have been written, since the venue may have
+// acted on them. warmUp() keeps connections open ahead of the first request for order entry.
+class HttpsClient : public std::enable_shared_from_this<HttpsClient> {
+public:
+    struct Options {
+        std::string host;
+        std::string port = "443";
+        std::size_t connections = 4;
+        std::size_t pipelineDepth = 4;
+        std::chrono::seconds timeout{10};  // Connect + handshake, and each response
+        double weightPerSecond = 0.0;      // Venue request weight budget; 0 is unlimited
+        double weightBurst = 0.0;
+        // Shared with the venue's other senders, e.g. RateLimiter::fromYaml(); when null the
+        // client limits itself to weightPerSecond
+        std::shared_ptr<RateLimiter> limiter;
+        bool verifyPeer = true;
+        std::size_t warmConnections = 0;   // Held open from warmUp() on, busy or not
+        // Idle warm connections are replaced after this long, before the venue's keep-alive
+        // timeout can close one under a request; 0 keeps them as long as the venue does
+        std::chrono::seconds maxIdle{0};
+        ConnectionProfile profile;
+
+        // Reads {host, port, connections, pipeline_depth, timeout_s, weight_per_second,
+        // weight_burst, warm_connections, max_idle_s} over the given defaults
+        static Options fromYaml(const YAML::Node& node, Options defaults);
+    };
+
+    struct Response {
+        boost::beast::error_code error;  // Transport failure once retries are exhausted
+        unsigned status = 0;
+        std::string body;
+
+        bool ok() const { return !error && status >= 200 && status < 300; }
+    };
+    using Callback = std::function<void(Response)>;
+    using Message = boost::beast::http::request<boost::beast::http::string_body>;
+
+    struct Stats {
+        uint64_t requests = 0;
+        uint64_t responses = 0;
+        uint64_t retries = 0;            // Requests re-sent after a lost connection or a 429
+        uint64_t connectionsOpened = 0;
+        uint64_t resumedHandshakes = 0;
+        uint64_t throttled = 0;          // Times dispatch waited for the rate limit
+    };
+
+    static std::shared_ptr<HttpsClient> create(boost::asio::io_context& ioc, Options options,
+                                               std::shared_ptr<spdlog::logger> logger);
+
+    HttpsClient(const HttpsClient&) = delete;
+    HttpsClient& operator=(const HttpsClient&) = delete;
+
+    const Options& options() const { return options_; }
+
+    // Queues a GET of target (path and query). Thread-safe. The callback runs on the client's
+    // strand; responses to different requests complete in no particular order.
+    void get(std::string target, Callback callback, double weight = 1.0);
+
+    // Queues any request, as get() does. Host, User-Agent, keep-alive and Content-Length are
+    // filled in. A request that is not idempotent is never sent twice: if its connection is
+    // lost after it was written, it completes with the transport error.
+    void send(Message message, Callback callback, double weight = 1.0, bool idempotent = true);
+
+    // Opens warmConnections now and keeps that many open until shutdown(). Thread-safe.
+    void warmUp();
+
+    // Fails everything queued or in flight with operation_aborted and closes the connections,
+    // returning once no callback will run any more.
+    void shutdown();
+
+    Stats getStats() const;
+
+private:
+    using Stream = boost::beast::ssl_stream<boost::beast::tcp_stream>;
+    using Strand = boost::asio::strand<boost::asio::io_context::executor_type>;
+    using Clock = std::chrono::steady_clock;
+
+    struct Request {
+        Message message;
+        Callback callback;
+        double weight = 1.0;
+        unsigned attempts = 0;
+        bool idempotent = true;
+    };
+    using RequestPtr = std::shared_ptr<Request>;
+
+    struct Connection {
+        Connection(const Strand& strand, boost::asio::ssl::context& ctx) : stream(strand, ctx) {}
+
+        std::size_t load() const { return unsent.size() + awaiting.size(); }
+
+        Stream stream;
+        boost::beast::flat_buffer buffer;
+        std::optional<boost::beast::http::response_parser<boost::beast::http::string_body>> parser;
+        std::deque<RequestPtr> unsent;
+        std::deque<RequestPtr> awaiting;  // Written, response not read yet
+        std::chrono::steady_clock::time_point lastActive{};  // Handshake or last response
+        bool ready = false;
+        bool writing = false;
+        bool reading = false;
+        bool dropped = false;
+    };
+    using ConnectionPtr = std::shared_ptr<Connection>;
+
+    HttpsClient(boost::asio::io_context& ioc, Options options,
+                std::shared_ptr<spdlog::logger> logger);
+
+    void dispatch();
+    ConnectionPtr pickConnection();
+    ConnectionPtr open(ConnectionPtr& slot);
+    void keepWarm();
+    void recycleIdle();
+    void connect(const ConnectionPtr& connection);
+    void connectEndpoint(const ConnectionPtr& connection,
+                         boost::asio::ip::tcp::resolver::results_type::const_iterator endpoint);
+    void handshake(const ConnectionPtr& connection);
+    void writeLoop(const ConnectionPtr& connection);
+    void readLoop(const ConnectionPtr& connection);
+    void onResponse(const ConnectionPtr& connection);
+    void onConnectionFailed(const ConnectionPtr& connection, const char* stage,
+                            const boost::beast::error_code& ec);
+    void drop(const ConnectionPtr& connection, bool countAttempt,
+              const boost::beast::error_code& ec);
+    void finish(const RequestPtr& request, Response response);
+    bool wakeAt(Clock::time_point when);
+    void cacheTlsSession(Connection& connection);
+    void doShutdown();
+
+    static constexpr unsigned kMaxAttempts = 3;
+    static constexpr std::uint64_t kMaxBodyBytes = 64 * 1024 * 1024;
+
+    boost::asio::io_context& ioc_;
+    boost::asio::ssl::context ctx_;
+    Options options_;
+    std::shared_ptr<spdlog::logger> logger_;
+    Strand strand_;
+    boost::asio::ip::tcp::resolver resolver_;
+    boost::asio::steady_timer wakeTimer_;
+    boost::asio::steady_timer idleTimer_;
+
+    // Strand-only state
+    boost::asio::ip::tcp::resolver::results_type endpoints_;
+    std::vector<ConnectionPtr> connections_;  // One slot per allowed connection
+    std::deque<RequestPtr> pending_;
+    std::shared_ptr<RateLimiter> limiter_;
+    std::shared_ptr<SSL_SESSION> tlsSession_;
+    Clock::time_point reconnectAfter_{};
+    std::chrono::milliseconds reconnectBackoff_{0};
+    Clock::time_point wakeAt_{};
+    bool warm_ = false;
+    bool closed_ = false;
+
+    std::atomic<uint64_t> requests_{0};
+    std::atomic<uint64_t> responses_{0};
+    std::atomic<uint64_t> retries_{0};
+    std::atomic<uint64_t> connectionsOpened_{0};
+    std::atomic<uint64_t> resumedHandshakes_{0};
+    std::atomic<uint64_t> throttled_{0};
+};
+
+} // namespace crypto_hft
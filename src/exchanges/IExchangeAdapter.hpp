@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <functional>
 #include <memory>
@@ -22,6 +23,12 @@ struct OrderBookSnapshot {
     std::vector<std::pair<double, double>> bids;  // price, size
     std::vector<std::pair<double, double>> asks;  // price, size
     int64_t timestamp;
+    uint64_t sequence = 0;  // venue book update id, 0 if the venue does not sequence
+    // Venue event time, ns since the epoch on the venue's clock; 0 if the venue sends none
+    int64_t exchangeTime = 0;
+    // exchangeTime on the local steady clock, 0 until the venue's clock offset is estimated
+    int64_t exchangeTimeLocal = 0;
+    int64_t receiveTime = 0;  // Local steady clock, ns, when the frame was read
 };
 
 struct OrderBookDelta {
@@ -29,6 +36,30 @@ struct OrderBookDelta {
     std::vector<std::pair<double, double>> bidUpdates;  // price, size (0 for removal)
     std::vector<std::pair<double, double>> askUpdates;  // price, size (0 for removal)
     int64_t timestamp;
+    uint64_t sequence = 0;  // venue book update id, 0 if the venue does not sequence
+    uint64_t firstSequence = 0;  // first update id folded into this delta, 0 if not reported
+    // Venue event time, ns since the epoch on the venue's clock; 0 if the venue sends none
+    int64_t exchangeTime = 0;
+    // exchangeTime on the local steady clock, 0 until the venue's clock offset is estimated
+    int64_t exchangeTimeLocal = 0;
+    int64_t receiveTime = 0;  // Local steady clock, ns, when the frame was read
+};
+
+// Best bid and offer from a venue's dedicated top-of-book stream, which is published ahead of
+// (and more often than) its depth stream
+struct TopOfBookUpdate {
+    std::string symbol;
+    double bidPrice = 0.0;
+    double bidSize = 0.0;
+    double askPrice = 0.0;
+    double askSize = 0.0;
+    int64_t timestamp = 0;
+    uint64_t sequence = 0;  // venue book update id the quote reflects
+    // Venue event time, ns since the epoch on the venue's clock; 0 if the venue sends none
+    int64_t exchangeTime = 0;
+    // exchangeTime on the local steady clock, 0 until the venue's clock offset is estimated
+    int64_t exchangeTimeLocal = 0;
+    int64_t receiveTime = 0;  // Local steady clock, ns, when the frame was read
 };
 
 struct OrderRequest {
@@ -68,6 +99,9 @@ public:
         std::function<void(const OrderBookSnapshot&)> callback) = 0;
     virtual void registerOrderBookDeltaCallback(
         std::function<void(const OrderBookDelta&)> callback) = 0;
+    // Venues without a top-of-book stream never call it
+    virtual void registerTopOfBookCallback(
+        [[maybe_unused]] std::function<void(const TopOfBookUpdate&)> callback) {}
 
     // Order management
     virtual std::string submitOrder(const OrderRequest& request) = 0;
@@ -88,6 +122,13 @@ public:
     virtual std::string getName() const = 0;
     virtual bool supportsMargin() const = 0;
     virtual double getFeeRate(const std::string& symbol) const = 0;
+
+    // Pushes the adapter's connection and feed statistics to MetricsReporter. Called
+    // periodically off the IO threads; adapters without statistics publish nothing. The
+    // labels are added to the adapter's own venue label, so that several sessions to one venue
+    // publish distinct series.
+    virtual void publishMetrics(
+        const std::unordered_map<std::string, std::string>& /*labels*/ = {}) const {}
 };
 
 } // namespace crypto_hft 
\ No newline at end of file
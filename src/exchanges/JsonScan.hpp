@@ -0,0 +1,182 @@
+#pragma once
+
+#include "ExchangeUtils.hpp"
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace crypto_hft {
+
+// Forward-only readers over raw JSON text. Values come back as slices of the original frame:
+// nothing is unescaped, copied or allocated. Intended for the known, flat shapes of exchange
+// market data messages, not as a general purpose parser.
+namespace JsonScan {
+
+constexpr std::size_t npos = std::string_view::npos;
+
+inline std::size_t skipWhitespace(std::string_view s, std::size_t pos) {
+    while (pos < s.size() && (s[pos] == ' ' || s[pos] == '\n' || s[pos] == '\r' || s[pos] == '\t')) {
+        ++pos;
+    }
+    return pos;
+}
+
+// Index one past the end of the value starting at pos, or npos if the text is malformed
+inline std::size_t skipValue(std::string_view s, std::size_t pos) {
+    if (pos >= s.size()) {
+        return npos;
+    }
+
+    const char c = s[pos];
+    if (c == '"') {
+        for (std::size_t i = pos + 1; i < s.size(); ++i) {
+            if (s[i] == '\\') {
+                ++i;
+            } else if (s[i] == '"') {
+                return i + 1;
+            }
+        }
+        return npos;
+    }
+
+    if (c == '{' || c == '[') {
+        int depth = 0;
+        for (std::size_t i = pos; i < s.size(); ++i) {
+            const char ch = s[i];
+            if (ch == '"') {
+                i = skipValue(s, i);
+                if (i == npos) {
+                    return npos;
+                }
+                --i;
+            } else if (ch == '{' || ch == '[') {
+                ++depth;
+            } else if (ch == '}' || ch == ']') {
+                if (--depth == 0) {
+                    return i + 1;
+                }
+            }
+        }
+        return npos;
+    }
+
+    // Number, true, false or null
+    std::size_t i = pos;
+    while (i < s.size() && s[i] != ',' && s[i] != '}' && s[i] != ']' && s[i] != ' ' &&
+           s[i] != '\n' && s[i] != '\r' && s[i] != '\t') {
+        ++i;
+    }
+    return i == pos ? npos : i;
+}
+
+// Strips the quotes from a string value; other values are returned unchanged
+inline std::string_view unquote(std::string_view value) {
+    if (value.size() >= 2 && value.front() == '"' && value.back() == '"') {
+        return value.substr(1, value.size() - 2);
+    }
+    return value;
+}
+
+class ArrayReader {
+public:
+    explicit ArrayReader(std::string_view array) : text_(array) {
+        pos_ = skipWhitespace(text_, 0);
+        if (pos_ >= text_.size() || text_[pos_] != '[') {
+            failed_ = true;
+            return;
+        }
+        pos_ = skipWhitespace(text_, pos_ + 1);
+    }
+
+    // Advances to the next element; false at the end of the array or on malformed input
+    bool next(std::string_view& value) {
+        if (failed_ || pos_ >= text_.size() || text_[pos_] == ']') {
+            return false;
+        }
+        std::size_t end = skipValue(text_, pos_);
+        if (end == npos) {
+            failed_ = true;
+            return false;
+        }
+        value = text_.substr(pos_, end - pos_);
+        pos_ = skipWhitespace(text_, end);
+        if (pos_ < text_.size() && text_[pos_] == ',') {
+            pos_ = skipWhitespace(text_, pos_ + 1);
+        }
+        return true;
+    }
+
+    bool failed() const { return failed_; }
+
+private:
+    std::string_view text_;
+    std::size_t pos_ = 0;
+    bool failed_ = false;
+};
+
+class ObjectReader {
+public:
+    explicit ObjectReader(std::string_view object) : text_(object) {
+        pos_ = skipWhitespace(text_, 0);
+        if (pos_ >= text_.size() || text_[pos_] != '{') {
+            failed_ = true;
+            return;
+        }
+        pos_ = skipWhitespace(text_, pos_ + 1);
+    }
+
+    // Advances to the next member; key is returned without quotes
+    bool next(std::string_view& key, std::string_view& value) {
+        if (failed_ || pos_ >= text_.size() || text_[pos_] == '}') {
+            return false;
+        }
+        std::size_t keyEnd = skipValue(text_, pos_);
+        if (keyEnd == npos || text_[pos_] != '"') {
+            failed_ = true;
+            return false;
+        }
+        key = text_.substr(pos_ + 1, keyEnd - pos_ - 2);
+
+        std::size_t colon = skipWhitespace(text_, keyEnd);
+        if (colon >= text_.size() || text_[colon] != ':') {
+            failed_ = true;
+            return false;
+        }
+        std::size_t valueStart = skipWhitespace(text_, colon + 1);
+        std::size_t valueEnd = skipValue(text_, valueStart);
+        if (valueEnd == npos) {
+            failed_ = true;
+            return false;
+        }
+        value = text_.substr(valueStart, valueEnd - valueStart);
+
+        pos_ = skipWhitespace(text_, valueEnd);
+        if (pos_ < text_.size() && text_[pos_] == ',') {
+            pos_ = skipWhitespace(text_, pos_ + 1);
+        }
+        return true;
+    }
+
+    bool failed() const { return failed_; }
+
+private:
+    std::string_view text_;
+    std::size_t pos_ = 0;
+    bool failed_ = false;
+};
+
+// Numeric conversions accept both bare and quoted numbers
+inline bool toUint(std::string_view value, uint64_t& out) {
+    value = unquote(value);
+    auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), out);
+    return ec == std::errc() && ptr == value.data() + value.size();
+}
+
+inline bool toDouble(std::string_view value, double& out) {
+    return ExchangeUtils::parse_decimal(unquote(value), out);
+}
+
+} // namespace JsonScan
+
+} // namespace crypto_hft
@@ -1,121 +1,297 @@
 #pragma once
 
-#include "IExchangeAdapter.hpp"
-#include <boost/beast/core.hpp>
-#include <boost/beast/ssl.hpp>
-#include <boost/beast/websocket.hpp>
-#include <boost/beast/websocket/ssl.hpp>
-#include <boost/beast/http.hpp>
+#include "AdapterCore.hpp"
+#include "FrameParser.hpp"
+#include "KrakenBook.hpp"
+#include "../infra/MetricsReporter.hpp"
 #include <nlohmann/json.hpp>
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
-#include <thread>
-#include <mutex>
-#include <condition_variable>
-#include <queue>
-#include <atomic>
-#include <functional>
-#include <boost/asio/steady_timer.hpp>
-#include <boost/asio/io_context.hpp>
-#include <boost/asio/strand.hpp>
-#include <spdlog/spdlog.h>
-#include <spdlog/sinks/stdout_color_sinks.h>
-#include <yaml-cpp/yaml.h>
 
 using json = nlohmann::json;
-namespace beast = boost::beast;
-namespace websocket = beast::websocket;
-namespace net = boost::asio;
-namespace ssl = boost::asio::ssl;
-using tcp = boost::asio::ip::tcp;
 
 namespace crypto_hft {
 
-// Forward declarations
-struct OrderBookEntry {
-    double price;
-    double size;
-};
-
-// Message handler types
-using MarketDataHandler = std::function<void(const MarketData&)>;
-using OrderBookSnapshotHandler = std::function<void(const OrderBookSnapshot&)>;
-using OrderBookDeltaHandler = std::function<void(const OrderBookDelta&)>;
-using ExecutionHandler = std::function<void(const OrderResponse&)>;
+// Kraken websocket v1 book feed, checked against each update's checksum. Book events go to
+// Sink; KrakenAdapter delivers them to the callbacks registered through IExchangeAdapter.
+template <BookEventSink Sink = CallbackSink>
+class BasicKrakenAdapter : public AdapterCore<BasicKrakenAdapter<Sink>, Sink> {
+    using Core = AdapterCore<BasicKrakenAdapter<Sink>, Sink>;
+    friend Core;
 
-class KrakenAdapter : public IExchangeAdapter {
 public:
-    KrakenAdapter();
-    ~KrakenAdapter() override;
-
-    // Prevent copying
-    KrakenAdapter(const KrakenAdapter&) = delete;
-    KrakenAdapter& operator=(const KrakenAdapter&) = delete;
-
-    // IExchangeAdapter interface implementation
-    bool connect() override;
-    void disconnect() override;
-    bool isConnected() const override;
-    bool subscribe(const std::vector<std::string>& symbols) override;
-    bool unsubscribe(const std::vector<std::string>& symbols) override;
-    void set_message_handler(MarketDataHandler handler) { market_data_handler_ = handler; }
-
-    // IExchangeAdapter interface implementation
-    std::string getName() const override;
-    bool supportsMargin() const override;
-    double getFeeRate(const std::string& symbol) const override;
-    double getBalance(const std::string& currency) const override;
-    std::vector<std::pair<std::string, double>> getAllBalances() const override;
-    std::string submitOrder(const OrderRequest& request) override;
-    bool cancelOrder(const std::string& order_id) override;
-    bool modifyOrder(const std::string& order_id, double new_price, double new_size) override;
-    bool requestOrderBookSnapshot(const std::string& symbol) override;
-    void registerOrderBookCallback(OrderBookSnapshotHandler callback) override;
-    void registerOrderBookDeltaCallback(OrderBookDeltaHandler callback) override;
-    void registerExecutionCallback(ExecutionHandler callback) override;
+    static constexpr const char* kVenue = "kraken";
+    static constexpr const char* kName = "Kraken";
+    // Books are checked by checksum; updates carry no id
+    static constexpr bool kSequencedBook = false;
+
+    // IO runs on the runtime's context for "kraken"; without a runtime the adapter gets a
+    // private single-threaded one
+    explicit BasicKrakenAdapter(std::shared_ptr<AdapterRuntime> runtime = nullptr,
+                                Sink sink = Sink())
+        : Core(std::move(runtime), std::move(sink)) {}
+    ~BasicKrakenAdapter() override { this->shutdown_session(); }
+
+    bool supportsMargin() const override { return true; }
+    double getFeeRate(const std::string&) const override { return 0.0026; }  // 0.26% maker/taker fee
+    bool requestOrderBookSnapshot(const std::string& symbol) override {
+        std::lock_guard<std::mutex> lock(books_mutex_);
+        resync(symbol_id(symbol));
+        return this->isConnected();
+    }
+
+    // Book updates whose checksum did not match the local book, each of which resubscribed
+    // the symbol for a fresh snapshot
+    uint64_t getChecksumFailures() const { return checksum_failures_.load(); }
+    // Pushes connection, receive-latency and checksum statistics to MetricsReporter
+    void publishMetrics(const std::unordered_map<std::string, std::string>& labels = {}) const override;
 
 private:
-    void on_message(beast::error_code ec, [[maybe_unused]] std::size_t bytes_transferred);
-    void on_connect(beast::error_code ec);
-    void on_close(beast::error_code ec);
-    void on_error(beast::error_code ec);
-    void handle_websocket_message(const std::string& message);
-    void handle_ticker_message(const json& data);
-    void handle_snapshot_message(const json& data);
-    void handle_l2update_message(const json& data);
-    void handle_heartbeat_message(const json& data);
-    void handle_error_message(const json& data);
-    void initialize_logger();
-    void load_config(const std::string& config_path);
-    void do_read();
-    void do_write(const std::string& message);
-
-    // WebSocket client
-    net::io_context ioc_;
-    boost::asio::executor_work_guard<boost::asio::io_context::executor_type> work_guard_;
-    net::strand<net::io_context::executor_type> strand_;
-    ssl::context ctx_{ssl::context::tlsv12_client};
-    std::unique_ptr<websocket::stream<beast::ssl_stream<tcp::socket>>> ws_;
-    
-    std::thread io_thread_;
-    std::mutex mutex_;
-    std::condition_variable cv_;
-    std::queue<std::string> message_queue_;
-    MarketDataHandler market_data_handler_;
-    OrderBookSnapshotHandler order_book_callback_;
-    OrderBookDeltaHandler order_book_delta_callback_;
-    ExecutionHandler execution_callback_;
-    std::atomic<bool> running_{false};
-    std::atomic<bool> connected_{false};
-    std::string api_key_;
-    std::string api_secret_;
-    std::string base_url_;
-    YAML::Node config_;
-    std::shared_ptr<spdlog::logger> logger_;
-    beast::flat_buffer buffer_;
-    std::string host_;  // Store the WebSocket host name
-    std::unordered_map<std::string, std::string> ws_subscriptions_;
+    using Core::connection_;
+    using Core::logger_;
+    using Core::sink_;
+
+    // Index into books_, assigned to each pair the first time it is seen
+    using SymbolId = uint32_t;
+
+    struct SymbolBook {
+        std::string pair;
+        KrakenBook book;
+        bool resyncing = false;  // Updates are dropped until the next snapshot
+    };
+
+    WsConnection::Options session_options() const;
+    static ServerTimeProbe::Endpoint server_time_endpoint();
+    void on_open(WsConnection& connection);
+    void on_frame(std::string_view frame);
+    SymbolId symbol_id(std::string_view pair);
+    SymbolId channel_symbol(uint64_t channelId, std::string_view pair);
+    void on_book_snapshot(SymbolId id);
+    void on_book_delta(SymbolId id);
+    void resync(SymbolId id);
+    void on_subscription_status(const json& data);
+    std::string make_subscription(const char* event, const std::vector<std::string>& pairs) const;
+    void handle_websocket_message(std::string_view message);
+
+    // Books by symbol, and the dispatch table from each subscription's channel id to its
+    // symbol, filled from subscription acks so book messages never look up the pair name. The
+    // mutex is held while emitting, as resyncs can be requested from other threads.
+    std::mutex books_mutex_;
+    std::vector<SymbolBook> books_;
+    std::unordered_map<std::string, SymbolId> symbol_ids_;
+    std::unordered_map<uint64_t, SymbolId> channels_;
+    std::atomic<uint64_t> checksum_failures_{0};
+
+    // Parse outputs, reused across frames
+    OrderBookSnapshot snapshot_;
+    OrderBookDelta delta_;
+    KrakenBookFrame book_frame_;
+
+    static constexpr int kBookDepth = 10;
 };
 
-} // namespace crypto_hft 
\ No newline at end of file
+using KrakenAdapter = BasicKrakenAdapter<>;
+extern template class BasicKrakenAdapter<CallbackSink>;
+
+template <BookEventSink Sink>
+WsConnection::Options BasicKrakenAdapter<Sink>::session_options() const {
+    WsConnection::Options options;
+    options.host = "ws.kraken.com";
+    return options;
+}
+
+template <BookEventSink Sink>
+ServerTimeProbe::Endpoint BasicKrakenAdapter<Sink>::server_time_endpoint() {
+    ServerTimeProbe::Endpoint endpoint;
+    endpoint.rest.host = "api.kraken.com";
+    endpoint.target = "/0/public/Time";
+    endpoint.resolutionNs = 1000000000;  // Whole seconds
+    endpoint.parse = [](std::string_view body, int64_t& serverTimeNs) {
+        json data = json::parse(body, nullptr, false);
+        if (data.is_discarded() || !data.contains("result")) {
+            return false;
+        }
+        serverTimeNs = data["result"].value("unixtime", int64_t{0}) * 1000000000;
+        return serverTimeNs > 0;
+    };
+    return endpoint;
+}
+
+template <BookEventSink Sink>
+std::string BasicKrakenAdapter<Sink>::make_subscription(
+    const char* event, const std::vector<std::string>& pairs) const {
+    json message = {
+        {"event", event},
+        {"pair", pairs},
+        {"subscription", {
+            {"name", "book"},
+            {"depth", kBookDepth}
+        }}
+    };
+    return message.dump();
+}
+
+template <BookEventSink Sink>
+void BasicKrakenAdapter<Sink>::on_open(WsConnection& connection) {
+    {
+        // Channel ids belong to the old session; the new one acks each subscription with its own
+        std::lock_guard<std::mutex> lock(books_mutex_);
+        channels_.clear();
+    }
+
+    // A new session starts with no channels; the snapshot that follows resets each book
+    this->replay_subscriptions(connection);
+}
+
+template <BookEventSink Sink>
+void BasicKrakenAdapter<Sink>::on_frame(std::string_view frame) {
+    const int64_t received = ClockOffsetEstimator::steadyNowNs();
+    // Book updates take the schema-specific fast path; everything else goes through json
+    switch (KrakenFrameParser::parse(frame, snapshot_, delta_, book_frame_)) {
+        case FrameType::BookDelta: {
+            this->stamp(delta_, received);
+            std::lock_guard<std::mutex> lock(books_mutex_);
+            on_book_delta(channel_symbol(book_frame_.channelId, delta_.symbol));
+            break;
+        }
+        case FrameType::BookSnapshot: {
+            this->stamp(snapshot_, received);
+            std::lock_guard<std::mutex> lock(books_mutex_);
+            on_book_snapshot(channel_symbol(book_frame_.channelId, snapshot_.symbol));
+            break;
+        }
+        case FrameType::Control:
+            handle_websocket_message(frame);
+            break;
+        case FrameType::TopOfBook:  // Not produced by this venue's parser
+        case FrameType::Heartbeat:
+            break;
+        case FrameType::Malformed:
+            logger_->warn("Malformed message: {}", frame);
+            break;
+    }
+}
+
+template <BookEventSink Sink>
+auto BasicKrakenAdapter<Sink>::symbol_id(std::string_view pair) -> SymbolId {
+    auto it = symbol_ids_.find(std::string(pair));
+    if (it != symbol_ids_.end()) {
+        return it->second;
+    }
+    auto id = static_cast<SymbolId>(books_.size());
+    books_.push_back(SymbolBook{std::string(pair), KrakenBook(kBookDepth), false});
+    symbol_ids_.emplace(std::string(pair), id);
+    return id;
+}
+
+template <BookEventSink Sink>
+auto BasicKrakenAdapter<Sink>::channel_symbol(uint64_t channelId, std::string_view pair)
+    -> SymbolId {
+    auto it = channels_.find(channelId);
+    if (it != channels_.end()) {
+        return it->second;
+    }
+    // Book data ahead of its subscription ack, e.g. replayed frames: learn the channel from it
+    SymbolId id = symbol_id(pair);
+    channels_.emplace(channelId, id);
+    return id;
+}
+
+template <BookEventSink Sink>
+void BasicKrakenAdapter<Sink>::on_book_snapshot(SymbolId id) {
+    SymbolBook& entry = books_[id];
+    if (!entry.book.applySnapshot(snapshot_, book_frame_)) {
+        // Cannot be checked, so its updates cannot be trusted either
+        logger_->error("{} book levels are too long to checksum; ignoring its updates", entry.pair);
+        entry.resyncing = true;
+        return;
+    }
+    entry.resyncing = false;
+    sink_.onSnapshot(snapshot_);
+}
+
+template <BookEventSink Sink>
+void BasicKrakenAdapter<Sink>::on_book_delta(SymbolId id) {
+    SymbolBook& entry = books_[id];
+    if (entry.resyncing) {
+        return;
+    }
+    if (!entry.book.applyDelta(delta_, book_frame_) ||
+        (book_frame_.hasChecksum && entry.book.checksum() != book_frame_.checksum)) {
+        checksum_failures_.fetch_add(1, std::memory_order_relaxed);
+        logger_->warn("{} book checksum mismatch (expected {}, have {}); resubscribing",
+                      entry.pair, book_frame_.checksum, entry.book.checksum());
+        resync(id);
+        return;
+    }
+    sink_.onDelta(delta_);
+}
+
+template <BookEventSink Sink>
+void BasicKrakenAdapter<Sink>::resync(SymbolId id) {
+    // Kraken has no book request on this API; resubscribing the one pair sends a new snapshot
+    SymbolBook& entry = books_[id];
+    entry.resyncing = true;
+    if (!this->isConnected()) {
+        return;  // The next session's subscriptions bring a snapshot anyway
+    }
+    connection_->send(make_subscription("unsubscribe", {entry.pair}));
+    connection_->send(make_subscription("subscribe", {entry.pair}));
+}
+
+template <BookEventSink Sink>
+void BasicKrakenAdapter<Sink>::on_subscription_status(const json& data) {
+    const std::string channelName = data.value("channelName", "");
+    if (channelName.rfind("book", 0) != 0 || !data.contains("channelID") ||
+        !data.contains("pair")) {
+        return;
+    }
+    const auto channelId = data["channelID"].get<uint64_t>();
+    const std::string status = data.value("status", "");
+    std::lock_guard<std::mutex> lock(books_mutex_);
+    if (status == "subscribed") {
+        channels_[channelId] = symbol_id(data["pair"].get<std::string>());
+    } else if (status == "unsubscribed") {
+        channels_.erase(channelId);
+    }
+}
+
+template <BookEventSink Sink>
+void BasicKrakenAdapter<Sink>::publishMetrics(
+    const std::unordered_map<std::string, std::string>& labels) const {
+    this->publish_connection_metrics(labels);
+    MetricsReporter::getInstance().setGauge("book_checksum_failures",
+                                            static_cast<double>(checksum_failures_.load()),
+                                            this->metric_labels(kName, labels));
+}
+
+template <BookEventSink Sink>
+void BasicKrakenAdapter<Sink>::handle_websocket_message(std::string_view message) {
+    json data = json::parse(message);
+    if (!data.contains("event")) {
+        logger_->warn("Unhandled message: {}", message);
+        return;
+    }
+
+    std::string event = data["event"];
+    if (event == "heartbeat") {
+        return;
+    }
+    if (event == "systemStatus") {
+        logger_->info("System status: {}", message);
+    } else if (event == "subscriptionStatus") {
+        logger_->info("Subscription status: {}", message);
+        on_subscription_status(data);
+    } else if (event == "error") {
+        logger_->error("Received error message: {}", message);
+    } else {
+        logger_->warn("Unknown event: {}", event);
+    }
+}
+
+} // namespace crypto_hft
@@ -0,0 +1,128 @@
+#include "KrakenBook.hpp"
+#include "Crc32.hpp"
+#include <algorithm>
+
+namespace crypto_hft {
+
+namespace {
+
+// Appends the digits of a decimal string without its point, skipping leading zeros
+bool appendDigits(std::string_view value, char* out, std::size_t& length, std::size_t capacity) {
+    bool leading = true;
+    for (char c : value) {
+        if (c == '.') {
+            continue;
+        }
+        if (leading && c == '0') {
+            continue;
+        }
+        leading = false;
+        if (length == capacity) {
+            return false;
+        }
+        out[length++] = c;
+    }
+    return true;
+}
+
+} // namespace
+
+KrakenBook::KrakenBook(std::size_t depth) : depth_(std::max<std::size_t>(depth, 1)) {
+    // Room for the levels a message inserts before the book is trimmed again
+    bids_.reserve(depth_ + kChecksumLevels);
+    asks_.reserve(depth_ + kChecksumLevels);
+}
+
+bool KrakenBook::encode(const KrakenBookFrame::LevelText& text, Level& level) {
+    std::size_t length = 0;
+    if (!appendDigits(text.first, level.text, length, Level::kMaxText) ||
+        !appendDigits(text.second, level.text, length, Level::kMaxText)) {
+        return false;
+    }
+    level.textLength = static_cast<uint8_t>(length);
+    return true;
+}
+
+bool KrakenBook::applySnapshot(const OrderBookSnapshot& snapshot, const KrakenBookFrame& frame) {
+    bids_.clear();
+    asks_.clear();
+    for (std::size_t i = 0; i < snapshot.bids.size() && i < frame.bids.size(); ++i) {
+        if (!update(bids_, true, snapshot.bids[i].first, snapshot.bids[i].second, frame.bids[i])) {
+            return false;
+        }
+    }
+    for (std::size_t i = 0; i < snapshot.asks.size() && i < frame.asks.size(); ++i) {
+        if (!update(asks_, false, snapshot.asks[i].first, snapshot.asks[i].second, frame.asks[i])) {
+            return false;
+        }
+    }
+    trim();
+    return true;
+}
+
+bool KrakenBook::applyDelta(const OrderBookDelta& delta, const KrakenBookFrame& frame) {
+    for (std::size_t i = 0; i < delta.bidUpdates.size() && i < frame.bids.size(); ++i) {
+        const auto& [price, size] = delta.bidUpdates[i];
+        if (!update(bids_, true, price, size, frame.bids[i])) {
+            return false;
+        }
+    }
+    for (std::size_t i = 0; i < delta.askUpdates.size() && i < frame.asks.size(); ++i) {
+        const auto& [price, size] = delta.askUpdates[i];
+        if (!update(asks_, false, price, size, frame.asks[i])) {
+            return false;
+        }
+    }
+    trim();
+    return true;
+}
+
+bool KrakenBook::update(Side& side, bool descending, double price, double size,
+                        const KrakenBookFrame::LevelText& text) {
+    auto it = std::find_if(side.begin(), side.end(), [&](const Level& level) {
+        return descending ? level.price <= price : level.price >= price;
+    });
+    const bool exists = it != side.end() && it->price == price;
+    if (size == 0.0) {
+        if (exists) {
+            side.erase(it);
+        }
+        return true;
+    }
+
+    Level level;
+    level.price = price;
+    level.size = size;
+    if (!encode(text, level)) {
+        return false;
+    }
+    if (exists) {
+        *it = level;
+        return true;
+    }
+    side.insert(it, level);
+    return true;
+}
+
+void KrakenBook::trim() {
+    // Levels pushed out of the depth are gone; Kraken republishes them if they come back
+    if (bids_.size() > depth_) {
+        bids_.resize(depth_);
+    }
+    if (asks_.size() > depth_) {
+        asks_.resize(depth_);
+    }
+}
+
+uint32_t KrakenBook::checksum() const {
+    uint32_t crc = 0;
+    for (std::size_t i = 0; i < asks_.size() && i < kChecksumLevels; ++i) {
+        crc = Crc32::update(crc, asks_[i].text, asks_[i].textLength);
+    }
+    for (std::size_t i = 0; i < bids_.size() && i < kChecksumLevels; ++i) {
+        crc = Crc32::update(crc, bids_[i].text, bids_[i].textLength);
+    }
+    return crc;
+}
+
+} // namespace crypto_hft
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "FrameParser.hpp"
+#include "IExchangeAdapter.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace crypto_hft {
+
+// One Kraken book kept to its subscribed depth, just far enough to validate the checksum Kraken
+// sends with every update: CRC-32 over the top ten asks, best first, then the top ten bids,
+// each level written as its price and then its volume with the decimal point and leading zeros
+// removed. That text is built once per level as it enters or changes, so checking an update
+// only chains the CRC over twenty short cached strings. Levels live in vectors reserved up
+// front; nothing allocates once they have grown to the largest message seen.
+class KrakenBook {
+public:
+    static constexpr std::size_t kChecksumLevels = 10;
+
+    explicit KrakenBook(std::size_t depth = kChecksumLevels);
+
+    // Replace the book; false if a level's text is too long to checksum
+    bool applySnapshot(const OrderBookSnapshot& snapshot, const KrakenBookFrame& frame);
+    // Applies updates in order (volume 0 removes the level), then trims the book back to its
+    // depth as Kraken expects subscribers to. False if a level's text is too long to checksum.
+    bool applyDelta(const OrderBookDelta& delta, const KrakenBookFrame& frame);
+
+    uint32_t checksum() const;
+    bool empty() const { return bids_.empty() && asks_.empty(); }
+    std::size_t depth() const { return depth_; }
+
+private:
+    struct Level {
+        static constexpr std::size_t kMaxText = 48;
+
+        double price = 0.0;
+        double size = 0.0;
+        uint8_t textLength = 0;
+        char text[kMaxText];  // Checksummed price and volume digits
+    };
+    using Side = std::vector<Level>;
+
+    static bool encode(const KrakenBookFrame::LevelText& text, Level& level);
+    // Inserts, replaces or removes the level at price, keeping the side sorted best first
+    bool update(Side& side, bool descending, double price, double size,
+                const KrakenBookFrame::LevelText& text);
+    void trim();
+
+    std::size_t depth_;
+    Side bids_;  // Highest first
+    Side asks_;  // Lowest first
+};
+
+} // namespace crypto_hft
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <boost/beast/core/error.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace crypto_hft {
+
+// A venue's answer to one order entry request
+struct OrderAck {
+    boost::beast::error_code error;  // Transport failure; the order's fate is then unknown
+    unsigned status = 0;             // HTTP status, or the venue's status code on a websocket
+    bool accepted = false;           // The venue took the request
+    std::string orderId;             // The venue's id for the order, if it sent one
+    std::string clientOrderId;
+    std::string message;             // The venue's reason when it rejected the request
+    std::chrono::nanoseconds latency{0};  // Request queued to ack parsed
+
+    bool ok() const { return !error && accepted; }
+};
+
+// Requests awaiting their response, keyed by ids handed out in sequence by insert(). An id's slot
+// is its value modulo the power-of-two capacity, so correlating a response is one array index
+// and a compare, with no hashing and no allocation after construction. Ids whose slots are
+// still held by older requests are skipped, so one request that is never answered costs a
+// slot, not the table; the capacity bounds the requests in flight.
+template <typename Entry>
+class RequestTable {
+public:
+    explicit RequestTable(std::size_t capacity) {
+        std::size_t size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        slots_.resize(size);
+        mask_ = size - 1;
+    }
+
+    // Claims the next id with a free slot for entry; nullopt, leaving entry as it was, when the
+    // table is full
+    std::optional<uint64_t> insert(Entry&& entry) {
+        if (size_ == slots_.size()) {
+            return std::nullopt;
+        }
+        while (slots_[nextId_ & mask_].used) {
+            ++nextId_;
+        }
+        Slot& slot = slots_[nextId_ & mask_];
+        slot.id = nextId_;
+        slot.used = true;
+        slot.entry = std::move(entry);
+        ++size_;
+        return nextId_++;
+    }
+
+    // The entry for id, if it is outstanding
+    Entry* find(uint64_t id) {
+        Slot& slot = slots_[id & mask_];
+        return slot.used && slot.id == id ? &slot.entry : nullptr;
+    }
+
+    // Releases and returns the entry for id, if it is outstanding
+    std::optional<Entry> take(uint64_t id) {
+        Slot& slot = slots_[id & mask_];
+        if (!slot.used || slot.id != id) {
+            return std::nullopt;
+        }
+        slot.used = false;
+        --size_;
+        return std::move(slot.entry);
+    }
+
+    // Releases the outstanding entries the predicate selects and passes them to function, oldest
+    // first
+    template <typename Predicate, typename Function>
+    void drainIf(Predicate&& predicate, Function&& function) {
+        std::vector<std::pair<uint64_t, Entry>> entries;
+        for (auto& slot : slots_) {
+            if (slot.used && predicate(slot.entry)) {
+                slot.used = false;
+                --size_;
+                entries.emplace_back(slot.id, std::move(slot.entry));
+            }
+        }
+        std::sort(entries.begin(), entries.end(),
+                  [](const auto& a, const auto& b) { return a.first < b.first; });
+        for (auto& [id, entry] : entries) {
+            function(id, std::move(entry));
+        }
+    }
+
+    // Releases every outstanding entry, oldest first
+    template <typename Function>
+    void drain(Function&& function) {
+        drainIf([](const Entry&) { return true; }, std::forward<Function>(function));
+    }
+
+    std::size_t size() const { return size_; }
+    std::size_t capacity() const { return slots_.size(); }
+
+private:
+    struct Slot {
+        uint64_t id = 0;
+        bool used = false;
+        Entry entry{};
+    };
+
+    std::vector<Slot> slots_;
+    std::size_t mask_ = 0;
+    std::size_t size_ = 0;
+    uint64_t nextId_ = 1;
+};
+
+} // namespace crypto_hft
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace crypto_hft {
+
+// Request encoding shared by the REST and websocket order entry paths, which both sign with
+// ExchangeUtils::HmacSigner
+namespace OrderSigning {
+
+inline int64_t nowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// Shortest plain decimal that reads back as value; venues reject exponent notation
+inline std::string decimal(double value) {
+    char buffer[64];
+    auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), value,
+                                   std::chars_format::fixed);
+    return ec == std::errc() ? std::string(buffer, end) : std::string("0");
+}
+
+// Appends key=value to a form or query string, percent-encoding the value
+inline void appendParam(std::string& form, std::string_view key, std::string_view value) {
+    static constexpr char kHex[] = "0123456789ABCDEF";
+    if (!form.empty()) {
+        form += '&';
+    }
+    form.append(key);
+    form += '=';
+    for (char c : value) {
+        auto u = static_cast<unsigned char>(c);
+        if (std::isalnum(u) || c == '-' || c == '_' || c == '.' || c == '~') {
+            form += c;
+        } else {
+            form += '%';
+            form += kHex[u >> 4];
+            form += kHex[u & 0xF];
+        }
+    }
+}
+
+} // namespace OrderSigning
+
+} // namespace crypto_hft
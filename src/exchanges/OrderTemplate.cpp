@@ -0,0 +1,411 @@
+#include "OrderTemplate.hpp"
+#include "JsonScan.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <optional>
+
+namespace crypto_hft {
+
+namespace {
+
+using Slot = OrderTemplate::Slot;
+using Format = OrderTemplate::Format;
+
+// Appends value with '"', '\\' and control characters escaped for a JSON string
+void appendEscaped(std::string& out, std::string_view value) {
+    std::size_t clean = 0;
+    for (std::size_t i = 0; i < value.size(); ++i) {
+        char c = value[i];
+        if (c != '"' && c != '\\' && static_cast<unsigned char>(c) >= 0x20) {
+            continue;
+        }
+        out.append(value.substr(clean, i - clean));
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+            out += escaped;
+        }
+        clean = i + 1;
+    }
+    out.append(value.substr(clean));
+}
+
+std::string jsonString(std::string_view value) {
+    std::string out = "\"";
+    appendEscaped(out, value);
+    out += '"';
+    return out;
+}
+
+// Shortest plain decimal that reads back as value, as OrderSigning::decimal()
+std::string_view decimal(char* buffer, std::size_t size, double value) {
+    auto [end, ec] = std::to_chars(buffer, buffer + size, value, std::chars_format::fixed);
+    return ec == std::errc() ? std::string_view(buffer, static_cast<std::size_t>(end - buffer))
+                             : std::string_view("0");
+}
+
+template <typename Integer>
+std::string_view integer(char* buffer, std::size_t size, Integer value) {
+    auto [end, ec] = std::to_chars(buffer, buffer + size, value);
+    return std::string_view(buffer, ec == std::errc() ? static_cast<std::size_t>(end - buffer) : 0);
+}
+
+std::size_t variant(const OrderRequest& order) {
+    return static_cast<std::size_t>(order.side) * 2 + static_cast<std::size_t>(order.type);
+}
+
+std::string_view sideName(std::size_t side) {
+    return static_cast<OrderRequest::Side>(side) == OrderRequest::Side::BUY ? "BUY" : "SELL";
+}
+
+// Binance order ids are numbers; anything else is taken for a client order id
+bool numericOrderId(std::string_view orderId) {
+    uint64_t value = 0;
+    return !orderId.empty() && JsonScan::toUint(orderId, value);
+}
+
+} // namespace
+
+OrderTemplate& OrderTemplate::text(std::string_view literal) {
+    if (parts_.empty() || parts_.back().hasSlot) {
+        auto size = static_cast<uint32_t>(text_.size());
+        parts_.push_back(Part{size, size});
+    }
+    text_.append(literal);
+    parts_.back().end = static_cast<uint32_t>(text_.size());
+    return *this;
+}
+
+OrderTemplate& OrderTemplate::slot(Slot slot, Format format) {
+    if (parts_.empty() || parts_.back().hasSlot) {
+        auto size = static_cast<uint32_t>(text_.size());
+        parts_.push_back(Part{size, size});
+    }
+    Part& part = parts_.back();
+    part.slot = slot;
+    part.format = format;
+    part.hasSlot = true;
+    return *this;
+}
+
+OrderTemplate& OrderTemplate::optional(std::string_view label, Slot slot, Format format) {
+    auto begin = static_cast<uint32_t>(text_.size());
+    text_.append(label);
+    parts_.push_back(
+        Part{begin, static_cast<uint32_t>(text_.size()), slot, format, true, true});
+    return *this;
+}
+
+void OrderTemplate::render(const Values& values, std::string& out) const {
+    char number[64];
+    for (const Part& part : parts_) {
+        std::string_view text(text_.data() + part.begin, part.end - part.begin);
+        if (!part.hasSlot) {
+            out.append(text);
+            continue;
+        }
+
+        std::string_view value;
+        bool escape = false;
+        switch (part.slot) {
+        case Slot::Id:
+            value = integer(number, sizeof(number), values.id);
+            break;
+        case Slot::Timestamp:
+            value = integer(number, sizeof(number), values.timestamp);
+            break;
+        case Slot::Price:
+            value = decimal(number, sizeof(number), values.price);
+            break;
+        case Slot::Quantity:
+            value = decimal(number, sizeof(number), values.quantity);
+            break;
+        case Slot::ClientOrderId:
+            value = values.clientOrderId;
+            escape = true;
+            break;
+        case Slot::OrderId:
+            value = values.orderId;
+            escape = true;
+            break;
+        case Slot::Token:
+            value = values.token;
+            escape = true;
+            break;
+        case Slot::Signature:
+            value = values.signature;
+            break;
+        }
+        if (part.optional && value.empty()) {
+            continue;
+        }
+
+        out.append(text);
+        if (part.format == Format::Raw) {
+            out.append(value);
+            continue;
+        }
+        out += '"';
+        if (escape) {
+            appendEscaped(out, value);
+        } else {
+            out.append(value);
+        }
+        out += '"';
+    }
+}
+
+// Binance
+
+namespace {
+
+struct BinanceParam {
+    std::string key;
+    std::string value;  // When there is no slot
+    std::optional<Slot> slot = std::nullopt;
+    bool number = false;  // Unquoted in the frame
+    bool optional = false;
+};
+
+// The new order's parameters, shared by order.place and order.cancelReplace
+void binanceOrderParams(std::vector<BinanceParam>& params, std::size_t side, bool limit) {
+    params.push_back({"side", std::string(sideName(side))});
+    params.push_back({"type", limit ? "LIMIT" : "MARKET"});
+    if (limit) {
+        params.push_back({"timeInForce", "GTC"});
+        params.push_back({"price", "", Slot::Price});
+    }
+    params.push_back({"quantity", "", Slot::Quantity});
+    params.push_back({"newClientOrderId", "", Slot::ClientOrderId, false, true});
+    params.push_back({"newOrderRespType", "ACK"});
+}
+
+} // namespace
+
+BinanceOrderMessages::BinanceOrderMessages(std::string apiKey, std::string_view secret,
+                                           int recvWindowMs)
+    : apiKey_(std::move(apiKey))
+    , signer_(ExchangeUtils::HmacSigner::Digest::SHA256, secret)
+    , recvWindowMs_(recvWindowMs) {}
+
+const BinanceOrderMessages::Symbol& BinanceOrderMessages::symbol(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = symbols_.find(name);
+    if (it != symbols_.end()) {
+        return *it->second;
+    }
+
+    // {"id":..,"method":..,"params":{...}} with apiKey, recvWindow, timestamp and the
+    // signature of every parameter, in name order, as key=value pairs joined by '&'
+    auto build = [&](std::string_view method, std::vector<BinanceParam> params) {
+        params.push_back({"symbol", name});
+        params.push_back({"apiKey", apiKey_});
+        params.push_back({"recvWindow", std::to_string(recvWindowMs_), std::nullopt, true});
+        params.push_back({"timestamp", "", Slot::Timestamp, true});
+        std::sort(params.begin(), params.end(),
+                  [](const BinanceParam& a, const BinanceParam& b) { return a.key < b.key; });
+
+        Signed message;
+        message.frame.text("{\"id\":")
+            .slot(Slot::Id)
+            .text(",\"method\":\"")
+            .text(method)
+            .text("\",\"params\":{");
+        for (std::size_t i = 0; i < params.size(); ++i) {
+            const BinanceParam& param = params[i];
+            std::string payloadLabel = (i == 0 ? "" : "&") + param.key + "=";
+            std::string frameLabel = (i == 0 ? "\"" : ",\"") + param.key + "\":";
+            Format format = param.number ? Format::Raw : Format::Quoted;
+            if (!param.slot) {
+                message.payload.text(payloadLabel).text(param.value);
+                message.frame.text(frameLabel).text(
+                    param.number ? param.value : jsonString(param.value));
+            } else if (param.optional) {
+                message.payload.optional(payloadLabel, *param.slot);
+                message.frame.optional(frameLabel, *param.slot, format);
+            } else {
+                message.payload.text(payloadLabel).slot(*param.slot);
+                message.frame.text(frameLabel).slot(*param.slot, format);
+            }
+        }
+        message.frame.text(",\"signature\":\"").slot(Slot::Signature).text("\"}}");
+        return message;
+    };
+    auto orderId = [](bool number, const char* idKey, const char* clientIdKey) {
+        return BinanceParam{number ? idKey : clientIdKey, "", Slot::OrderId, number};
+    };
+
+    auto templates = std::make_unique<Symbol>();
+    for (std::size_t side = 0; side < 2; ++side) {
+        for (std::size_t type = 0; type < 2; ++type) {
+            std::vector<BinanceParam> params;
+            binanceOrderParams(params, side,
+                               static_cast<OrderRequest::Type>(type) == OrderRequest::Type::LIMIT);
+            templates->place[side * 2 + type] = build("order.place", std::move(params));
+        }
+        for (std::size_t number = 0; number < 2; ++number) {
+            std::vector<BinanceParam> params;
+            binanceOrderParams(params, side, true);
+            params.push_back({"cancelReplaceMode", "STOP_ON_FAILURE"});
+            params.push_back(orderId(number, "cancelOrderId", "cancelOrigClientOrderId"));
+            templates->replace[side * 2 + number] = build("order.cancelReplace",
+                                                          std::move(params));
+        }
+    }
+    for (std::size_t number = 0; number < 2; ++number) {
+        templates->cancel[number] =
+            build("order.cancel", {orderId(number, "orderId", "origClientOrderId")});
+    }
+    return *symbols_.emplace(name, std::move(templates)).first->second;
+}
+
+void BinanceOrderMessages::render(const Signed& message, OrderTemplate::Values& values,
+                                  std::string& out) const {
+    thread_local std::string payload;
+    payload.clear();
+    message.payload.render(values, payload);
+    char signature[ExchangeUtils::HmacSigner::kMaxHexSize];
+    values.signature = std::string_view(signature, signer_.sign_hex(payload, signature));
+    out.reserve(out.size() + message.frame.textSize() + payload.size());
+    message.frame.render(values, out);
+}
+
+void BinanceOrderMessages::place(uint64_t id, const OrderRequest& order, int64_t timestampMs,
+                                 std::string& out) const {
+    OrderTemplate::Values values;
+    values.id = id;
+    values.timestamp = timestampMs;
+    values.price = order.price;
+    values.quantity = order.size;
+    values.clientOrderId = order.clientOrderId;
+    render(symbol(order.symbol).place[variant(order)], values, out);
+}
+
+void BinanceOrderMessages::cancel(uint64_t id, const std::string& symbolName,
+                                  std::string_view orderId, int64_t timestampMs,
+                                  std::string& out) const {
+    OrderTemplate::Values values;
+    values.id = id;
+    values.timestamp = timestampMs;
+    values.orderId = orderId;
+    render(symbol(symbolName).cancel[numericOrderId(orderId) ? 1 : 0], values, out);
+}
+
+void BinanceOrderMessages::cancelReplace(uint64_t id, std::string_view orderId,
+                                         const OrderRequest& replacement, int64_t timestampMs,
+                                         std::string& out) const {
+    OrderTemplate::Values values;
+    values.id = id;
+    values.timestamp = timestampMs;
+    values.price = replacement.price;
+    values.quantity = replacement.size;
+    values.clientOrderId = replacement.clientOrderId;
+    values.orderId = orderId;
+    std::size_t index = static_cast<std::size_t>(replacement.side) * 2 +
+                        (numericOrderId(orderId) ? 1 : 0);
+    render(symbol(replacement.symbol).replace[index], values, out);
+}
+
+// Kraken
+
+namespace {
+
+// {"event":..,"token":..,"reqid":.., with the caller adding the rest and the closing brace
+OrderTemplate krakenRequest(std::string_view event) {
+    OrderTemplate request;
+    request.text("{\"event\":\"")
+        .text(event)
+        .text("\",\"token\":")
+        .slot(Slot::Token, Format::Quoted)
+        .text(",\"reqid\":")
+        .slot(Slot::Id);
+    return request;
+}
+
+} // namespace
+
+KrakenOrderMessages::KrakenOrderMessages() : cancel_(krakenRequest("cancelOrder")) {
+    cancel_.text(",\"txid\":[").slot(Slot::OrderId, Format::Quoted).text("]}");
+}
+
+const KrakenOrderMessages::Pair& KrakenOrderMessages::pair(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = pairs_.find(name);
+    if (it != pairs_.end()) {
+        return *it->second;
+    }
+
+    const std::string quotedPair = jsonString(name);
+    auto templates = std::make_unique<Pair>();
+    for (std::size_t side = 0; side < 2; ++side) {
+        for (std::size_t type = 0; type < 2; ++type) {
+            bool limit = static_cast<OrderRequest::Type>(type) == OrderRequest::Type::LIMIT;
+            bool buy = static_cast<OrderRequest::Side>(side) == OrderRequest::Side::BUY;
+            OrderTemplate request = krakenRequest("addOrder");
+            request.text(limit ? ",\"ordertype\":\"limit\"" : ",\"ordertype\":\"market\"")
+                .text(buy ? ",\"type\":\"buy\"" : ",\"type\":\"sell\"")
+                .text(",\"pair\":")
+                .text(quotedPair)
+                .text(",\"volume\":")
+                .slot(Slot::Quantity, Format::Quoted);
+            if (limit) {
+                request.text(",\"price\":").slot(Slot::Price, Format::Quoted);
+            }
+            request.text("}");
+            templates->place[side * 2 + type] = std::move(request);
+        }
+    }
+    templates->edit = krakenRequest("editOrder");
+    templates->edit.text(",\"orderid\":")
+        .slot(Slot::OrderId, Format::Quoted)
+        .text(",\"pair\":")
+        .text(quotedPair)
+        .text(",\"price\":")
+        .slot(Slot::Price, Format::Quoted)
+        .text(",\"volume\":")
+        .slot(Slot::Quantity, Format::Quoted)
+        .text("}");
+    return *pairs_.emplace(name, std::move(templates)).first->second;
+}
+
+void KrakenOrderMessages::place(uint64_t id, const OrderRequest& order, std::string_view token,
+                                std::string& out) const {
+    OrderTemplate::Values values;
+    values.id = id;
+    values.price = order.price;
+    values.quantity = order.size;
+    values.token = token;
+    const OrderTemplate& request = pair(order.symbol).place[variant(order)];
+    out.reserve(out.size() + request.textSize() + token.size() + 64);
+    request.render(values, out);
+}
+
+void KrakenOrderMessages::cancel(uint64_t id, std::string_view orderId, std::string_view token,
+                                 std::string& out) const {
+    OrderTemplate::Values values;
+    values.id = id;
+    values.orderId = orderId;
+    values.token = token;
+    out.reserve(out.size() + cancel_.textSize() + token.size() + orderId.size() + 32);
+    cancel_.render(values, out);
+}
+
+void KrakenOrderMessages::edit(uint64_t id, std::string_view orderId,
+                               const OrderRequest& replacement, std::string_view token,
+                               std::string& out) const {
+    OrderTemplate::Values values;
+    values.id = id;
+    values.price = replacement.price;
+    values.quantity = replacement.size;
+    values.orderId = orderId;
+    values.token = token;
+    const OrderTemplate& request = pair(replacement.symbol).edit;
+    out.reserve(out.size() + request.textSize() + token.size() + orderId.size() + 64);
+    request.render(values, out);
+}
+
+} // namespace crypto_hft
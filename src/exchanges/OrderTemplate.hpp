@@ -0,0 +1,139 @@
+#pragma once
+
+#include "ExchangeUtils.hpp"
+#include "IExchangeAdapter.hpp"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace crypto_hft {
+
+// An order message with everything that is the same from one order to the next (method, symbol,
+// side, type, API key, field names and punctuation) rendered once, leaving slots for the values
+// that change. render() copies the text and formats each slot straight into the caller's
+// buffer, so a message costs a few to_chars calls and memcpys and no allocation once the buffer
+// has grown to size.
+class OrderTemplate {
+public:
+    enum class Slot : uint8_t {
+        Id,
+        Timestamp,
+        Price,
+        Quantity,
+        ClientOrderId,
+        OrderId,
+        Token,
+        Signature,
+    };
+    // Quoted writes the value as a JSON string, escaping text slots
+    enum class Format : uint8_t { Raw, Quoted };
+
+    struct Values {
+        uint64_t id = 0;
+        int64_t timestamp = 0;
+        double price = 0.0;
+        double quantity = 0.0;
+        std::string_view clientOrderId;
+        std::string_view orderId;
+        std::string_view token;
+        std::string_view signature;
+    };
+
+    OrderTemplate& text(std::string_view literal);
+    OrderTemplate& slot(Slot slot, Format format = Format::Raw);
+    // A slot left out together with its label when its value is empty, e.g. a client order id
+    // behind "&newClientOrderId="
+    OrderTemplate& optional(std::string_view label, Slot slot, Format format = Format::Raw);
+
+    // Appends the message for values to out
+    void render(const Values& values, std::string& out) const;
+
+    // Bytes of fixed text, for sizing buffers
+    std::size_t textSize() const { return text_.size(); }
+
+private:
+    struct Part {
+        uint32_t begin = 0;  // text_[begin, end) goes ahead of the slot
+        uint32_t end = 0;
+        Slot slot = Slot::Id;
+        Format format = Format::Raw;
+        bool hasSlot = false;
+        bool optional = false;
+    };
+
+    std::string text_;
+    std::vector<Part> parts_;
+};
+
+// Binance WebSocket API order.place, order.cancel and order.cancelReplace requests, signed with
+// HMAC-SHA256 over their parameters in name order. Each symbol's templates are built the first
+// time it is traded; rendering signs into a per-thread scratch buffer. Thread-safe.
+class BinanceOrderMessages {
+public:
+    BinanceOrderMessages(std::string apiKey, std::string_view secret, int recvWindowMs = 5000);
+
+    // Each appends one request frame to out
+    void place(uint64_t id, const OrderRequest& order, int64_t timestampMs,
+               std::string& out) const;
+    // orderId is the venue's order id if it is a number, otherwise a client order id
+    void cancel(uint64_t id, const std::string& symbol, std::string_view orderId,
+                int64_t timestampMs, std::string& out) const;
+    void cancelReplace(uint64_t id, std::string_view orderId, const OrderRequest& replacement,
+                       int64_t timestampMs, std::string& out) const;
+
+private:
+    struct Signed {
+        OrderTemplate payload;  // key=value pairs joined by '&', the text that is signed
+        OrderTemplate frame;
+    };
+    struct Symbol {
+        std::array<Signed, 4> place;    // By side, then type
+        std::array<Signed, 2> cancel;   // By client order id, then by order id
+        std::array<Signed, 4> replace;  // By side, then as cancel
+    };
+
+    const Symbol& symbol(const std::string& name) const;
+    void render(const Signed& message, OrderTemplate::Values& values, std::string& out) const;
+
+    std::string apiKey_;
+    ExchangeUtils::HmacSigner signer_;
+    int recvWindowMs_;
+
+    mutable std::mutex mutex_;  // Guards symbols_; the templates themselves never change
+    mutable std::unordered_map<std::string, std::unique_ptr<const Symbol>> symbols_;
+};
+
+// Kraken websocket addOrder, cancelOrder and editOrder requests, each carrying the session
+// token. Each pair's templates are built the first time it is traded. Thread-safe.
+class KrakenOrderMessages {
+public:
+    KrakenOrderMessages();
+
+    // Each appends one request frame to out
+    void place(uint64_t id, const OrderRequest& order, std::string_view token,
+               std::string& out) const;
+    void cancel(uint64_t id, std::string_view orderId, std::string_view token,
+                std::string& out) const;
+    void edit(uint64_t id, std::string_view orderId, const OrderRequest& replacement,
+              std::string_view token, std::string& out) const;
+
+private:
+    struct Pair {
+        std::array<OrderTemplate, 4> place;  // By side, then type
+        OrderTemplate edit;
+    };
+
+    const Pair& pair(const std::string& name) const;
+
+    OrderTemplate cancel_;
+
+    mutable std::mutex mutex_;  // Guards pairs_; the templates themselves never change
+    mutable std::unordered_map<std::string, std::unique_ptr<const Pair>> pairs_;
+};
+
+} // namespace crypto_hft
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <yaml-cpp/yaml.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <string>
+
+namespace crypto_hft {
+
+// Weighted token buckets for a venue's request limits, shared by every thread that sends to the
+// venue. Each window allows `limit` weight per `period`, refilled continuously, and a request
+// spends its venue weight (Binance charges 5 to 250 for a depth snapshot depending on its size)
+// in all windows at once, e.g. 6000 per minute alongside 160000 per day. A limiter without
+// windows only applies pauseUntil().
+//
+// Lock-free: each window is the time at which it will be full again (GCRA), advanced by CAS. A
+// request that does not fit gives back what it took from the windows it already passed, so a
+// concurrent caller may briefly see less room than there is, never more.
+class RateLimiter {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Window {
+        double limit = 0.0;  // Weight per period, all of which may be spent at once
+        Clock::duration period = std::chrono::seconds(1);
+    };
+    static constexpr std::size_t kMaxWindows = 4;
+
+    RateLimiter() = default;
+    // One window refilling at ratePerSecond with room for burst; a rate of 0 is unlimited
+    RateLimiter(double ratePerSecond, double burst) {
+        if (ratePerSecond > 0.0) {
+            burst = std::max(burst, 1.0);
+            add(1e9 / ratePerSecond, burst * 1e9 / ratePerSecond);
+        }
+    }
+    // Windows with a limit of 0 are skipped; those past kMaxWindows are ignored
+    explicit RateLimiter(std::initializer_list<Window> windows) {
+        for (const Window& window : windows) {
+            addWindow(window);
+        }
+    }
+
+    // Windows from a venue's rate_limit config: <prefix>_per_second, _per_minute and _per_day,
+    // e.g. requests_per_second or max_orders_per_second
+    static std::shared_ptr<RateLimiter> fromYaml(const YAML::Node& node,
+                                                 const std::string& prefix) {
+        auto limiter = std::make_shared<RateLimiter>();
+        if (node.IsDefined() && node.IsMap()) {
+            limiter->addWindow({node[prefix + "_per_second"].as<double>(0.0),
+                                std::chrono::seconds(1)});
+            limiter->addWindow({node[prefix + "_per_minute"].as<double>(0.0),
+                                std::chrono::minutes(1)});
+            limiter->addWindow({node[prefix + "_per_day"].as<double>(0.0),
+                                std::chrono::hours(24)});
+        }
+        return limiter;
+    }
+
+    RateLimiter(const RateLimiter&) = delete;
+    RateLimiter& operator=(const RateLimiter&) = delete;
+
+    bool limited() const { return count_ > 0; }
+
+    // Spends weight in every window and returns zero, or spends nothing and returns how long
+    // until it would fit. Requests heavier than a window's limit pass it once it is full.
+    Clock::duration tryAcquire(double weight, Clock::time_point now = Clock::now()) {
+        const int64_t t = nanos(now);
+        if (pausedUntil_.load(std::memory_order_relaxed) > t) {
+            return timeUntilAvailable(weight, now);
+        }
+        std::array<int64_t, kMaxWindows> costs{};
+        for (std::size_t i = 0; i < count_; ++i) {
+            const Bucket& bucket = buckets_[i];
+            costs[i] = cost(bucket, weight);
+            int64_t full = state_[i].load(std::memory_order_relaxed);
+            int64_t next;
+            do {
+                next = std::max(full, t) + costs[i];
+                if (next - t > bucket.tolerance) {
+                    for (std::size_t j = 0; j < i; ++j) {
+                        state_[j].fetch_sub(costs[j], std::memory_order_relaxed);
+                    }
+                    return timeUntilAvailable(weight, now);
+                }
+            } while (!state_[i].compare_exchange_weak(full, next, std::memory_order_relaxed));
+        }
+        return Clock::duration::zero();
+    }
+
+    // How long until weight would fit in every window; zero if it fits now. Reads only.
+    Clock::duration timeUntilAvailable(double weight, Clock::time_point now = Clock::now()) const {
+        const int64_t t = nanos(now);
+        int64_t wait = std::max<int64_t>(0, pausedUntil_.load(std::memory_order_relaxed) - t);
+        for (std::size_t i = 0; i < count_; ++i) {
+            const Bucket& bucket = buckets_[i];
+            int64_t full = state_[i].load(std::memory_order_relaxed);
+            wait = std::max(wait, std::max(full, t) + cost(bucket, weight) - t - bucket.tolerance);
+        }
+        return std::chrono::duration_cast<Clock::duration>(std::chrono::nanoseconds(wait));
+    }
+
+    // Spends nothing until then, e.g. when the venue answers 429 with Retry-After
+    void pauseUntil(Clock::time_point until) {
+        const int64_t t = nanos(until);
+        int64_t current = pausedUntil_.load(std::memory_order_relaxed);
+        while (current < t &&
+               !pausedUntil_.compare_exchange_weak(current, t, std::memory_order_relaxed)) {
+        }
+    }
+
+private:
+    // GCRA: spending w advances the window's full-again time by w * interval, and a request
+    // fits while that time stays within tolerance (the whole limit's worth) of now
+    struct Bucket {
+        double interval = 0.0;  // Nanoseconds per unit of weight
+        int64_t tolerance = 0;
+    };
+
+    static int64_t nanos(Clock::time_point time) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch())
+            .count();
+    }
+
+    static int64_t cost(const Bucket& bucket, double weight) {
+        auto spent = static_cast<int64_t>(std::llround(std::max(weight, 0.0) * bucket.interval));
+        return std::min(spent, bucket.tolerance);
+    }
+
+    void addWindow(const Window& window) {
+        if (window.limit > 0.0 && window.period > Clock::duration::zero()) {
+            double period = std::chrono::duration<double, std::nano>(window.period).count();
+            add(period / window.limit, period);
+        }
+    }
+
+    void add(double interval, double tolerance) {
+        if (count_ < kMaxWindows) {
+            buckets_[count_++] = Bucket{interval, static_cast<int64_t>(std::llround(tolerance))};
+        }
+    }
+
+    // Fixed after construction
+    std::array<Bucket, kMaxWindows> buckets_{};
+    std::size_t count_ = 0;
+    // Per window, the time at which it is full again, in nanoseconds of Clock
+    std::array<std::atomic<int64_t>, kMaxWindows> state_{};
+    std::atomic<int64_t> pausedUntil_{0};
+};
+
+} // namespace crypto_hft
@@ -0,0 +1,156 @@
+#include "RedundantFeedAdapter.hpp"
+#include <spdlog/spdlog.h>
+#include <stdexcept>
+
+namespace crypto_hft {
+
+namespace {
+
+std::size_t checkedSessionCount(const std::vector<std::shared_ptr<IExchangeAdapter>>& sessions) {
+    if (sessions.empty()) {
+        throw std::invalid_argument("RedundantFeedAdapter requires at least one session");
+    }
+    return sessions.size();
+}
+
+} // namespace
+
+RedundantFeedAdapter::RedundantFeedAdapter(std::vector<std::shared_ptr<IExchangeAdapter>> sessions)
+    : sessions_(std::move(sessions))
+    , arbiter_(checkedSessionCount(sessions_)) {
+}
+
+bool RedundantFeedAdapter::connect() {
+    // Usable as long as at least one session comes up
+    bool any = false;
+    for (std::size_t i = 0; i < sessions_.size(); ++i) {
+        if (sessions_[i]->connect()) {
+            any = true;
+        } else {
+            spdlog::warn("{} redundant session {} failed to connect", getName(), i);
+        }
+    }
+    return any;
+}
+
+void RedundantFeedAdapter::disconnect() {
+    for (auto& session : sessions_) {
+        session->disconnect();
+    }
+}
+
+bool RedundantFeedAdapter::isConnected() const {
+    for (const auto& session : sessions_) {
+        if (session->isConnected()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool RedundantFeedAdapter::subscribe(const std::vector<std::string>& symbols) {
+    bool any = false;
+    for (auto& session : sessions_) {
+        if (session->isConnected() && session->subscribe(symbols)) {
+            any = true;
+        }
+    }
+    return any;
+}
+
+bool RedundantFeedAdapter::unsubscribe(const std::vector<std::string>& symbols) {
+    bool any = false;
+    for (auto& session : sessions_) {
+        if (session->isConnected() && session->unsubscribe(symbols)) {
+            any = true;
+        }
+    }
+    return any;
+}
+
+bool RedundantFeedAdapter::requestOrderBookSnapshot(const std::string& symbol) {
+    return primary().requestOrderBookSnapshot(symbol);
+}
+
+void RedundantFeedAdapter::registerOrderBookCallback(
+    std::function<void(const OrderBookSnapshot&)> callback) {
+    // A snapshot resets the book, so it must come from a single source
+    order_book_callback_ = std::move(callback);
+    primary().registerOrderBookCallback([this](const OrderBookSnapshot& snapshot) {
+        if (order_book_callback_) {
+            order_book_callback_(snapshot);
+        }
+    });
+}
+
+void RedundantFeedAdapter::registerOrderBookDeltaCallback(
+    std::function<void(const OrderBookDelta&)> callback) {
+    order_book_delta_callback_ = std::move(callback);
+    for (std::size_t i = 0; i < sessions_.size(); ++i) {
+        sessions_[i]->registerOrderBookDeltaCallback([this, i](const OrderBookDelta& delta) {
+            arbiter_.arbitrate(i, delta.symbol, delta.sequence, FeedArbiter::nowNs(), [&]() {
+                if (order_book_delta_callback_) {
+                    order_book_delta_callback_(delta);
+                }
+            });
+        });
+    }
+}
+
+void RedundantFeedAdapter::registerTopOfBookCallback(
+    std::function<void(const TopOfBookUpdate&)> callback) {
+    for (auto& session : sessions_) {
+        session->registerTopOfBookCallback(callback);
+    }
+}
+
+std::string RedundantFeedAdapter::submitOrder(const OrderRequest& request) {
+    return primary().submitOrder(request);
+}
+
+bool RedundantFeedAdapter::cancelOrder(const std::string& orderId) {
+    return primary().cancelOrder(orderId);
+}
+
+bool RedundantFeedAdapter::modifyOrder(const std::string& orderId, double newPrice,
+                                       double newSize) {
+    return primary().modifyOrder(orderId, newPrice, newSize);
+}
+
+void RedundantFeedAdapter::registerExecutionCallback(
+    std::function<void(const OrderResponse&)> callback) {
+    primary().registerExecutionCallback(std::move(callback));
+}
+
+double RedundantFeedAdapter::getBalance(const std::string& asset) const {
+    return primary().getBalance(asset);
+}
+
+std::vector<std::pair<std::string, double>> RedundantFeedAdapter::getAllBalances() const {
+    return primary().getAllBalances();
+}
+
+std::string RedundantFeedAdapter::getName() const {
+    return primary().getName();
+}
+
+bool RedundantFeedAdapter::supportsMargin() const {
+    return primary().supportsMargin();
+}
+
+double RedundantFeedAdapter::getFeeRate(const std::string& symbol) const {
+    return primary().getFeeRate(symbol);
+}
+
+void RedundantFeedAdapter::publishMetrics(
+    const std::unordered_map<std::string, std::string>& labels) const {
+    arbiter_.publishMetrics(getName());
+    // Labelled the way the arbiter labels them, so the sessions do not overwrite each other
+    for (std::size_t i = 0; i < sessions_.size(); ++i) {
+        auto sessionLabels = labels;
+        sessionLabels.insert_or_assign("session", std::to_string(i));
+        sessions_[i]->publishMetrics(sessionLabels);
+    }
+}
+
+} // namespace crypto_hft
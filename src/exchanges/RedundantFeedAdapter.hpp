@@ -0,0 +1,77 @@
+#pragma once
+
+#include "IExchangeAdapter.hpp"
+#include "FeedArbiter.hpp"
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace crypto_hft {
+
+// Presents several independent sessions to the same venue stream as one adapter.
+// Order book deltas are passed through a FeedArbiter so each sequence number reaches the
+// registered callback once, from whichever session delivered it first. Snapshots and all
+// order/account calls go through the primary session. Deltas without a sequence number are
+// taken from the primary only, so a venue without book update ids gains nothing from more
+// sessions.
+class RedundantFeedAdapter : public IExchangeAdapter {
+public:
+    explicit RedundantFeedAdapter(std::vector<std::shared_ptr<IExchangeAdapter>> sessions);
+    ~RedundantFeedAdapter() override = default;
+
+    RedundantFeedAdapter(const RedundantFeedAdapter&) = delete;
+    RedundantFeedAdapter& operator=(const RedundantFeedAdapter&) = delete;
+
+    // Connection management
+    bool connect() override;
+    void disconnect() override;
+    bool isConnected() const override;
+
+    // Market data subscription
+    bool subscribe(const std::vector<std::string>& symbols) override;
+    bool unsubscribe(const std::vector<std::string>& symbols) override;
+
+    // Order book management
+    bool requestOrderBookSnapshot(const std::string& symbol) override;
+    void registerOrderBookCallback(
+        std::function<void(const OrderBookSnapshot&)> callback) override;
+    void registerOrderBookDeltaCallback(
+        std::function<void(const OrderBookDelta&)> callback) override;
+    // Quotes from every session are passed through; the order book keeps only newer ones
+    void registerTopOfBookCallback(
+        std::function<void(const TopOfBookUpdate&)> callback) override;
+
+    // Order management
+    std::string submitOrder(const OrderRequest& request) override;
+    bool cancelOrder(const std::string& orderId) override;
+    bool modifyOrder(const std::string& orderId, double newPrice, double newSize) override;
+    void registerExecutionCallback(
+        std::function<void(const OrderResponse&)> callback) override;
+
+    // Account information
+    double getBalance(const std::string& asset) const override;
+    std::vector<std::pair<std::string, double>> getAllBalances() const override;
+
+    // Exchange information
+    std::string getName() const override;
+    bool supportsMargin() const override;
+    double getFeeRate(const std::string& symbol) const override;
+
+    const FeedArbiter& getArbiter() const { return arbiter_; }
+    std::size_t getSessionCount() const { return sessions_.size(); }
+    // The arbiter's per-session win rates and lag, then each session's own statistics labelled
+    // with its index
+    void publishMetrics(const std::unordered_map<std::string, std::string>& labels = {}) const override;
+
+private:
+    IExchangeAdapter& primary() const { return *sessions_[arbiter_.getPrimarySession()]; }
+
+    std::vector<std::shared_ptr<IExchangeAdapter>> sessions_;
+    FeedArbiter arbiter_;
+    std::function<void(const OrderBookSnapshot&)> order_book_callback_;
+    std::function<void(const OrderBookDelta&)> order_book_delta_callback_;
+};
+
+} // namespace crypto_hft
@@ -0,0 +1,391 @@
+#include "RestOrderEntry.hpp"
+#include "OrderSigning.hpp"
+#include <nlohmann/json.hpp>
+#include <openssl/sha.h>
+#include <algorithm>
+#include <stdexcept>
+
+namespace crypto_hft {
+
+namespace http = boost::beast::http;
+using json = nlohmann::json;
+using namespace OrderSigning;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// The id a venue sent as a number or a string
+std::string idText(const json& value) {
+    if (value.is_string()) {
+        return value.get<std::string>();
+    }
+    return value.is_number() ? value.dump() : std::string();
+}
+
+} // namespace
+
+RestOrderEntry::RestOrderEntry(std::shared_ptr<HttpsClient> client)
+    : client_(std::move(client)) {
+    if (!client_) {
+        throw std::invalid_argument("RestOrderEntry needs an HttpsClient");
+    }
+}
+
+void RestOrderEntry::submit(const OrderRequest& order, Callback callback) {
+    send(buildSubmit(order), std::move(callback));
+}
+
+void RestOrderEntry::cancel(const std::string& symbol, const std::string& orderId,
+                            Callback callback) {
+    send(buildCancel(symbol, orderId), std::move(callback));
+}
+
+void RestOrderEntry::modify(const std::string& orderId, const OrderRequest& replacement,
+                            Callback callback) {
+    send(buildModify(orderId, replacement), std::move(callback));
+}
+
+std::future<OrderAck> RestOrderEntry::submit(const OrderRequest& order) {
+    auto promise = std::make_shared<std::promise<OrderAck>>();
+    submit(order, [promise](OrderAck ack) { promise->set_value(std::move(ack)); });
+    return promise->get_future();
+}
+
+std::future<OrderAck> RestOrderEntry::cancel(const std::string& symbol,
+                                             const std::string& orderId) {
+    auto promise = std::make_shared<std::promise<OrderAck>>();
+    cancel(symbol, orderId, [promise](OrderAck ack) { promise->set_value(std::move(ack)); });
+    return promise->get_future();
+}
+
+std::future<OrderAck> RestOrderEntry::modify(const std::string& orderId,
+                                             const OrderRequest& replacement) {
+    auto promise = std::make_shared<std::promise<OrderAck>>();
+    modify(orderId, replacement,
+           [promise](OrderAck ack) { promise->set_value(std::move(ack)); });
+    return promise->get_future();
+}
+
+void RestOrderEntry::send(HttpsClient::Message message, Callback callback) {
+    auto start = Clock::now();
+    client_->send(std::move(message),
+        [this, start, callback = std::move(callback)](HttpsClient::Response response) {
+            OrderAck ack;
+            ack.error = response.error;
+            ack.status = response.status;
+            if (!response.error) {
+                parseAck(response, ack);
+            }
+            ack.latency = Clock::now() - start;
+            if (callback) {
+                callback(std::move(ack));
+            }
+        },
+        1.0, false);
+}
+
+// Binance
+
+BinanceRestOrderEntry::BinanceRestOrderEntry(std::shared_ptr<HttpsClient> client,
+                                             Credentials credentials, int recvWindowMs)
+    : RestOrderEntry(std::move(client))
+    , apiKey_(std::move(credentials.apiKey))
+    , signer_(ExchangeUtils::HmacSigner::Digest::SHA256, credentials.apiSecret)
+    , recvWindow_(std::to_string(recvWindowMs)) {}
+
+std::string BinanceRestOrderEntry::sign(std::string query) const {
+    appendParam(query, "recvWindow", recvWindow_);
+    appendParam(query, "timestamp", std::to_string(nowMs()));
+    char signature[ExchangeUtils::HmacSigner::kMaxHexSize];
+    std::size_t length = signer_.sign_hex(query, signature);
+    appendParam(query, "signature", std::string_view(signature, length));
+    return query;
+}
+
+HttpsClient::Message BinanceRestOrderEntry::buildSubmit(const OrderRequest& order) {
+    std::string form;
+    appendParam(form, "symbol", order.symbol);
+    appendParam(form, "side", order.side == OrderRequest::Side::BUY ? "BUY" : "SELL");
+    if (order.type == OrderRequest::Type::LIMIT) {
+        appendParam(form, "type", "LIMIT");
+        appendParam(form, "timeInForce", "GTC");
+        appendParam(form, "price", decimal(order.price));
+    } else {
+        appendParam(form, "type", "MARKET");
+    }
+    appendParam(form, "quantity", decimal(order.size));
+    if (!order.clientOrderId.empty()) {
+        appendParam(form, "newClientOrderId", order.clientOrderId);
+    }
+    appendParam(form, "newOrderRespType", "ACK");
+
+    HttpsClient::Message message{http::verb::post, "/api/v3/order", 11};
+    message.set("X-MBX-APIKEY", apiKey_);
+    message.set(http::field::content_type, "application/x-www-form-urlencoded");
+    message.body() = sign(std::move(form));
+    return message;
+}
+
+HttpsClient::Message BinanceRestOrderEntry::buildCancel(const std::string& symbol,
+                                                        const std::string& orderId) {
+    std::string query;
+    appendParam(query, "symbol", symbol);
+    appendParam(query, "orderId", orderId);
+
+    HttpsClient::Message message{http::verb::delete_, "/api/v3/order?" + sign(std::move(query)),
+                                 11};
+    message.set("X-MBX-APIKEY", apiKey_);
+    return message;
+}
+
+HttpsClient::Message BinanceRestOrderEntry::buildModify(const std::string& orderId,
+                                                        const OrderRequest& replacement) {
+    std::string form;
+    appendParam(form, "symbol", replacement.symbol);
+    appendParam(form, "side", replacement.side == OrderRequest::Side::BUY ? "BUY" : "SELL");
+    appendParam(form, "type", "LIMIT");
+    appendParam(form, "timeInForce", "GTC");
+    appendParam(form, "cancelReplaceMode", "STOP_ON_FAILURE");
+    appendParam(form, "cancelOrderId", orderId);
+    appendParam(form, "price", decimal(replacement.price));
+    appendParam(form, "quantity", decimal(replacement.size));
+    if (!replacement.clientOrderId.empty()) {
+        appendParam(form, "newClientOrderId", replacement.clientOrderId);
+    }
+    appendParam(form, "newOrderRespType", "ACK");
+
+    HttpsClient::Message message{http::verb::post, "/api/v3/order/cancelReplace", 11};
+    message.set("X-MBX-APIKEY", apiKey_);
+    message.set(http::field::content_type, "application/x-www-form-urlencoded");
+    message.body() = sign(std::move(form));
+    return message;
+}
+
+void BinanceRestOrderEntry::parseAck(const HttpsClient::Response& response,
+                                     OrderAck& ack) const {
+    json data = json::parse(response.body, nullptr, false);
+    if (data.is_discarded() || !data.is_object()) {
+        ack.message = response.body;
+        return;
+    }
+    if (!response.ok()) {
+        ack.message = data.value("msg", response.body);
+        return;
+    }
+    // cancelReplace nests the new order
+    const json& order = data.contains("newOrderResponse") ? data["newOrderResponse"] : data;
+    ack.accepted = true;
+    if (order.contains("orderId")) {
+        ack.orderId = idText(order["orderId"]);
+    }
+    ack.clientOrderId = order.value("clientOrderId", order.value("origClientOrderId", ""));
+}
+
+// Coinbase
+
+CoinbaseRestOrderEntry::CoinbaseRestOrderEntry(std::shared_ptr<HttpsClient> client,
+                                               TokenSource tokens)
+    : RestOrderEntry(std::move(client)), tokens_(std::move(tokens)) {
+    if (!tokens_) {
+        throw std::invalid_argument("CoinbaseRestOrderEntry needs a token source");
+    }
+}
+
+HttpsClient::Message CoinbaseRestOrderEntry::post(const char* path, std::string body) const {
+    HttpsClient::Message message{http::verb::post, path, 11};
+    message.set(http::field::authorization, "Bearer " + tokens_("POST", path));
+    message.set(http::field::content_type, "application/json");
+    message.body() = std::move(body);
+    return message;
+}
+
+HttpsClient::Message CoinbaseRestOrderEntry::buildSubmit(const OrderRequest& order) {
+    json configuration;
+    if (order.type == OrderRequest::Type::LIMIT) {
+        configuration["limit_limit_gtc"] = {{"base_size", decimal(order.size)},
+                                            {"limit_price", decimal(order.price)}};
+    } else {
+        configuration["market_market_ioc"] = {{"base_size", decimal(order.size)}};
+    }
+    json body = {
+        {"client_order_id", order.clientOrderId},
+        {"product_id", order.symbol},
+        {"side", order.side == OrderRequest::Side::BUY ? "BUY" : "SELL"},
+        {"order_configuration", configuration}
+    };
+    return post("/api/v3/brokerage/orders", body.dump());
+}
+
+HttpsClient::Message CoinbaseRestOrderEntry::buildCancel(const std::string&,
+                                                         const std::string& orderId) {
+    json body = {{"order_ids", json::array({orderId})}};
+    return post("/api/v3/brokerage/orders/batch_cancel", body.dump());
+}
+
+HttpsClient::Message CoinbaseRestOrderEntry::buildModify(const std::string& orderId,
+                                                         const OrderRequest& replacement) {
+    json body = {
+        {"order_id", orderId},
+        {"price", decimal(replacement.price)},
+        {"size", decimal(replacement.size)}
+    };
+    return post("/api/v3/brokerage/orders/edit", body.dump());
+}
+
+void CoinbaseRestOrderEntry::parseAck(const HttpsClient::Response& response,
+                                      OrderAck& ack) const {
+    json data = json::parse(response.body, nullptr, false);
+    if (data.is_discarded() || !data.is_object()) {
+        ack.message = response.body;
+        return;
+    }
+    if (!response.ok()) {
+        ack.message = data.value("message", data.value("error", response.body));
+        return;
+    }
+
+    // batch_cancel answers per order
+    const json& result = data.contains("results") && data["results"].is_array() &&
+                                 !data["results"].empty()
+                             ? data["results"][0]
+                             : data;
+    ack.accepted = result.value("success", false);
+    if (result.contains("success_response")) {
+        const json& success = result["success_response"];
+        ack.orderId = success.value("order_id", "");
+        ack.clientOrderId = success.value("client_order_id", "");
+    } else {
+        ack.orderId = result.value("order_id", "");
+    }
+    if (!ack.accepted) {
+        if (result.contains("error_response")) {
+            const json& error = result["error_response"];
+            ack.message = error.value("message", error.value("error", ""));
+        } else if (result.contains("failure_reason")) {
+            ack.message = idText(result["failure_reason"]);
+        } else if (result.contains("errors")) {
+            ack.message = result["errors"].dump();
+        }
+    }
+}
+
+// Kraken
+
+KrakenRestOrderEntry::KrakenRestOrderEntry(std::shared_ptr<HttpsClient> client,
+                                           Credentials credentials)
+    : RestOrderEntry(std::move(client))
+    , apiKey_(std::move(credentials.apiKey))
+    , signer_(ExchangeUtils::HmacSigner::Digest::SHA512,
+              ExchangeUtils::base64_decode(credentials.apiSecret)) {}
+
+uint64_t KrakenRestOrderEntry::nextNonce() {
+    // Strictly increasing across threads, even within one millisecond
+    uint64_t now = static_cast<uint64_t>(nowMs()) * 1000;
+    uint64_t last = lastNonce_.load(std::memory_order_relaxed);
+    uint64_t next;
+    do {
+        next = std::max(now, last + 1);
+    } while (!lastNonce_.compare_exchange_weak(last, next, std::memory_order_relaxed));
+    return next;
+}
+
+HttpsClient::Message KrakenRestOrderEntry::post(const char* path, const std::string& form) {
+    std::string nonce = std::to_string(nextNonce());
+    std::string body;
+    appendParam(body, "nonce", nonce);
+    if (!form.empty()) {
+        body += '&';
+        body += form;
+    }
+
+    unsigned char digest[SHA256_DIGEST_LENGTH];
+    std::string noncedBody = nonce + body;
+    SHA256(reinterpret_cast<const unsigned char*>(noncedBody.data()), noncedBody.size(), digest);
+    char signature[ExchangeUtils::HmacSigner::kMaxBase64Size];
+    std::size_t length = signer_.sign_base64(
+        {path, std::string_view(reinterpret_cast<const char*>(digest), sizeof(digest))},
+        signature);
+
+    HttpsClient::Message message{http::verb::post, path, 11};
+    message.set("API-Key", apiKey_);
+    message.set("API-Sign", boost::beast::string_view(signature, length));
+    message.set(http::field::content_type, "application/x-www-form-urlencoded");
+    message.body() = std::move(body);
+    return message;
+}
+
+void KrakenRestOrderEntry::getWebSocketsToken(std::function<void(std::string)> callback) {
+    client().send(post("/0/private/GetWebSocketsToken", ""),
+        [callback = std::move(callback)](HttpsClient::Response response) {
+            std::string token;
+            if (response.ok()) {
+                json data = json::parse(response.body, nullptr, false);
+                if (!data.is_discarded() && data.contains("result") &&
+                    data["result"].is_object()) {
+                    token = data["result"].value("token", "");
+                }
+            }
+            callback(std::move(token));
+        });
+}
+
+HttpsClient::Message KrakenRestOrderEntry::buildSubmit(const OrderRequest& order) {
+    std::string form;
+    appendParam(form, "ordertype", order.type == OrderRequest::Type::LIMIT ? "limit" : "market");
+    appendParam(form, "type", order.side == OrderRequest::Side::BUY ? "buy" : "sell");
+    appendParam(form, "volume", decimal(order.size));
+    appendParam(form, "pair", order.symbol);
+    if (order.type == OrderRequest::Type::LIMIT) {
+        appendParam(form, "price", decimal(order.price));
+    }
+    if (!order.clientOrderId.empty()) {
+        appendParam(form, "cl_ord_id", order.clientOrderId);
+    }
+    return post("/0/private/AddOrder", form);
+}
+
+HttpsClient::Message KrakenRestOrderEntry::buildCancel(const std::string&,
+                                                       const std::string& orderId) {
+    std::string form;
+    appendParam(form, "txid", orderId);
+    return post("/0/private/CancelOrder", form);
+}
+
+HttpsClient::Message KrakenRestOrderEntry::buildModify(const std::string& orderId,
+                                                       const OrderRequest& replacement) {
+    std::string form;
+    appendParam(form, "txid", orderId);
+    appendParam(form, "pair", replacement.symbol);
+    appendParam(form, "volume", decimal(replacement.size));
+    appendParam(form, "price", decimal(replacement.price));
+    return post("/0/private/EditOrder", form);
+}
+
+void KrakenRestOrderEntry::parseAck(const HttpsClient::Response& response,
+                                    OrderAck& ack) const {
+    json data = json::parse(response.body, nullptr, false);
+    if (data.is_discarded() || !data.is_object()) {
+        ack.message = response.body;
+        return;
+    }
+    // Kraken reports rejections in "error" with a 200
+    if (data.contains("error") && data["error"].is_array() && !data["error"].empty()) {
+        ack.message = data["error"][0].is_string() ? data["error"][0].get<std::string>()
+                                                   : data["error"].dump();
+        return;
+    }
+    if (!response.ok() || !data.contains("result")) {
+        ack.message = response.body;
+        return;
+    }
+
+    const json& result = data["result"];
+    ack.accepted = true;
+    if (result.contains("txid")) {
+        const json& txid = result["txid"];
+        ack.orderId = txid.is_array() && !txid.empty() ? idText(txid[0]) : idText(txid);
+    }
+}
+
+} // namespace crypto_hft
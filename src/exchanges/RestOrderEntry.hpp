@@ -0,0 +1,133 @@
+#pragma once
+
+#include "ExchangeUtils.hpp"
+#include "HttpsClient.hpp"
+#include "IExchangeAdapter.hpp"
+#include "OrderEntry.hpp"
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace crypto_hft {
+
+// Asynchronous order entry over a venue's REST API. Requests are signed as they are built and
+// go out through the venue's pooled HttpsClient, pipelined with whatever else is in flight, as
+// non-idempotent requests: a request lost in transit completes with the transport error rather
+// than being sent twice. Everything that does not change between requests (API key headers,
+// decoded secrets) is prepared once in the constructor. Thread-safe; callbacks run on the
+// HttpsClient's strand and must not block it. Shut the client down before destroying this.
+class RestOrderEntry {
+public:
+    struct Credentials {
+        std::string apiKey;
+        std::string apiSecret;
+    };
+    using Callback = std::function<void(OrderAck)>;
+
+    virtual ~RestOrderEntry() = default;
+
+    RestOrderEntry(const RestOrderEntry&) = delete;
+    RestOrderEntry& operator=(const RestOrderEntry&) = delete;
+
+    void submit(const OrderRequest& order, Callback callback);
+    std::future<OrderAck> submit(const OrderRequest& order);
+    // Binance identifies orders per symbol; the other venues ignore it
+    void cancel(const std::string& symbol, const std::string& orderId, Callback callback);
+    std::future<OrderAck> cancel(const std::string& symbol, const std::string& orderId);
+    // Replaces the order's price and size; replacement carries the order's symbol and side
+    void modify(const std::string& orderId, const OrderRequest& replacement, Callback callback);
+    std::future<OrderAck> modify(const std::string& orderId, const OrderRequest& replacement);
+
+    HttpsClient& client() { return *client_; }
+
+protected:
+    explicit RestOrderEntry(std::shared_ptr<HttpsClient> client);
+
+    virtual HttpsClient::Message buildSubmit(const OrderRequest& order) = 0;
+    virtual HttpsClient::Message buildCancel(const std::string& symbol,
+                                             const std::string& orderId) = 0;
+    virtual HttpsClient::Message buildModify(const std::string& orderId,
+                                             const OrderRequest& replacement) = 0;
+    // Fills accepted, orderId, clientOrderId and message from the venue's response
+    virtual void parseAck(const HttpsClient::Response& response, OrderAck& ack) const = 0;
+
+private:
+    void send(HttpsClient::Message message, Callback callback);
+
+    std::shared_ptr<HttpsClient> client_;
+};
+
+// POST/DELETE /api/v3/order and POST /api/v3/order/cancelReplace, HMAC-SHA256 signed
+class BinanceRestOrderEntry final : public RestOrderEntry {
+public:
+    BinanceRestOrderEntry(std::shared_ptr<HttpsClient> client, Credentials credentials,
+                          int recvWindowMs = 5000);
+
+private:
+    HttpsClient::Message buildSubmit(const OrderRequest& order) override;
+    HttpsClient::Message buildCancel(const std::string& symbol,
+                                     const std::string& orderId) override;
+    HttpsClient::Message buildModify(const std::string& orderId,
+                                     const OrderRequest& replacement) override;
+    void parseAck(const HttpsClient::Response& response, OrderAck& ack) const override;
+
+    // Appends timestamp, recvWindow and the signature of the whole query
+    std::string sign(std::string query) const;
+
+    std::string apiKey_;
+    ExchangeUtils::HmacSigner signer_;
+    std::string recvWindow_;
+};
+
+// POST /api/v3/brokerage/orders, .../batch_cancel and .../edit with a bearer JWT per request
+class CoinbaseRestOrderEntry final : public RestOrderEntry {
+public:
+    // Returns the JWT for one request, e.g. "POST api.coinbase.com/api/v3/brokerage/orders"
+    using TokenSource = std::function<std::string(std::string_view method, std::string_view path)>;
+
+    CoinbaseRestOrderEntry(std::shared_ptr<HttpsClient> client, TokenSource tokens);
+
+private:
+    HttpsClient::Message buildSubmit(const OrderRequest& order) override;
+    HttpsClient::Message buildCancel(const std::string& symbol,
+                                     const std::string& orderId) override;
+    HttpsClient::Message buildModify(const std::string& orderId,
+                                     const OrderRequest& replacement) override;
+    void parseAck(const HttpsClient::Response& response, OrderAck& ack) const override;
+
+    HttpsClient::Message post(const char* path, std::string body) const;
+
+    TokenSource tokens_;
+};
+
+// POST /0/private/AddOrder, CancelOrder and EditOrder, signed with API-Sign
+class KrakenRestOrderEntry final : public RestOrderEntry {
+public:
+    KrakenRestOrderEntry(std::shared_ptr<HttpsClient> client, Credentials credentials);
+
+    // POST /0/private/GetWebSocketsToken: the token authenticating a websocket order session.
+    // The callback gets an empty token if the request failed.
+    void getWebSocketsToken(std::function<void(std::string token)> callback);
+
+private:
+    HttpsClient::Message buildSubmit(const OrderRequest& order) override;
+    HttpsClient::Message buildCancel(const std::string& symbol,
+                                     const std::string& orderId) override;
+    HttpsClient::Message buildModify(const std::string& orderId,
+                                     const OrderRequest& replacement) override;
+    void parseAck(const HttpsClient::Response& response, OrderAck& ack) const override;
+
+    // Prefixes a fresh nonce to the form and signs path + SHA-256(nonce + form)
+    HttpsClient::Message post(const char* path, const std::string& form);
+    uint64_t nextNonce();
+
+    std::string apiKey_;
+    ExchangeUtils::HmacSigner signer_;  // Keyed with the secret decoded from the venue's base64
+    std::atomic<uint64_t> lastNonce_{0};
+};
+
+} // namespace crypto_hft
@@ -0,0 +1,118 @@
+#include "ServerTimeProbe.hpp"
+#include <boost/asio/post.hpp>
+#include <future>
+
+namespace crypto_hft {
+
+namespace net = boost::asio;
+
+std::shared_ptr<ServerTimeProbe> ServerTimeProbe::create(
+    net::io_context& ioc, Endpoint endpoint, std::chrono::milliseconds interval,
+    std::shared_ptr<ClockOffsetEstimator> clock, std::shared_ptr<spdlog::logger> logger) {
+    return std::shared_ptr<ServerTimeProbe>(new ServerTimeProbe(
+        ioc, std::move(endpoint), interval, std::move(clock), std::move(logger)));
+}
+
+ServerTimeProbe::ServerTimeProbe(net::io_context& ioc, Endpoint endpoint,
+                                 std::chrono::milliseconds interval,
+                                 std::shared_ptr<ClockOffsetEstimator> clock,
+                                 std::shared_ptr<spdlog::logger> logger)
+    : ioc_(ioc)
+    , endpoint_(std::move(endpoint))
+    , interval_(interval)
+    , clock_(std::move(clock))
+    , logger_(logger ? std::move(logger) : spdlog::default_logger())
+    , strand_(net::make_strand(ioc))
+    , timer_(strand_) {
+    HttpsClient::Options options = endpoint_.rest;
+    options.connections = 1;
+    options.pipelineDepth = 1;
+    options.warmConnections = 1;
+    client_ = HttpsClient::create(ioc_, std::move(options), logger_);
+}
+
+void ServerTimeProbe::start() {
+    client_->warmUp();
+    net::post(strand_, [self = shared_from_this()] {
+        if (!self->closed_) {
+            self->probe();
+            self->schedule();
+        }
+    });
+}
+
+void ServerTimeProbe::shutdown() {
+    auto stop = [this] {
+        closed_ = true;
+        timer_.cancel();
+    };
+    // With one thread per context, being on it means no handler can run concurrently
+    if (ioc_.get_executor().running_in_this_thread() || ioc_.stopped()) {
+        stop();
+    } else {
+        std::promise<void> done;
+        net::post(strand_, [&] {
+            stop();
+            done.set_value();
+        });
+        done.get_future().wait();
+    }
+    client_->shutdown();
+}
+
+ServerTimeProbe::Stats ServerTimeProbe::getStats() const {
+    Stats stats;
+    stats.samples = samples_.load(std::memory_order_relaxed);
+    stats.failures = failures_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void ServerTimeProbe::schedule() {
+    timer_.expires_after(interval_);
+    timer_.async_wait([self = shared_from_this()](const boost::system::error_code& ec) {
+        if (ec || self->closed_) {
+            return;
+        }
+        self->probe();
+        self->schedule();
+    });
+}
+
+void ServerTimeProbe::probe() {
+    if (inFlight_.exchange(true)) {
+        return;
+    }
+    const int64_t sentNs = ClockOffsetEstimator::steadyNowNs();
+    client_->get(endpoint_.target,
+        [self = shared_from_this(), sentNs](HttpsClient::Response response) {
+            self->onResponse(sentNs, std::move(response));
+        });
+}
+
+void ServerTimeProbe::onResponse(int64_t sentNs, HttpsClient::Response response) {
+    const int64_t receivedNs = ClockOffsetEstimator::steadyNowNs();
+    inFlight_.store(false);
+    if (response.error == net::error::operation_aborted) {
+        return;  // Shut down
+    }
+    int64_t serverTimeNs = 0;
+    bool parsed = false;
+    if (response.ok()) {
+        try {
+            parsed = endpoint_.parse(response.body, serverTimeNs);
+        } catch (const std::exception&) {
+            parsed = false;
+        }
+    }
+    if (!parsed) {
+        failures_.fetch_add(1, std::memory_order_relaxed);
+        logger_->warn("Server time from {}{} failed: {}", endpoint_.rest.host, endpoint_.target,
+                      response.error ? response.error.message()
+                                     : std::to_string(response.status) + " " + response.body);
+        return;
+    }
+    samples_.fetch_add(1, std::memory_order_relaxed);
+    clock_->onServerTime(serverTimeNs, sentNs, receivedNs, endpoint_.resolutionNs);
+}
+
+} // namespace crypto_hft
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "ClockOffsetEstimator.hpp"
+#include "HttpsClient.hpp"
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/strand.hpp>
+#include <spdlog/spdlog.h>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace crypto_hft {
+
+// Asks a venue's REST time endpoint for its clock every interval, and hands each answer with the
+// request's send and receive times to a ClockOffsetEstimator. The probe keeps a warm connection
+// of its own, so a round trip is not stretched by a handshake or by other requests queued ahead
+// of it. One request is in flight at a time; a tick that finds one still out is skipped.
+class ServerTimeProbe : public std::enable_shared_from_this<ServerTimeProbe> {
+public:
+    struct Endpoint {
+        HttpsClient::Options rest;  // Host, port and TLS settings; one warm connection is used
+        std::string target;
+        // Reads the venue's time, ns since the epoch, from a response body
+        std::function<bool(std::string_view body, int64_t& serverTimeNs)> parse;
+        int64_t resolutionNs = 1000000;  // How the venue truncates the time it reports
+    };
+
+    struct Stats {
+        uint64_t samples = 0;   // Answers handed to the estimator
+        uint64_t failures = 0;  // Failed requests and answers that did not parse
+    };
+
+    static std::shared_ptr<ServerTimeProbe> create(boost::asio::io_context& ioc, Endpoint endpoint,
+                                                   std::chrono::milliseconds interval,
+                                                   std::shared_ptr<ClockOffsetEstimator> clock,
+                                                   std::shared_ptr<spdlog::logger> logger);
+
+    ServerTimeProbe(const ServerTimeProbe&) = delete;
+    ServerTimeProbe& operator=(const ServerTimeProbe&) = delete;
+
+    // Sends the first request now, then one per interval until shutdown()
+    void start();
+    // Stops probing and closes the connection, returning once no callback will run any more
+    void shutdown();
+
+    Stats getStats() const;
+
+private:
+    using Strand = boost::asio::strand<boost::asio::io_context::executor_type>;
+
+    ServerTimeProbe(boost::asio::io_context& ioc, Endpoint endpoint,
+                    std::chrono::milliseconds interval,
+                    std::shared_ptr<ClockOffsetEstimator> clock,
+                    std::shared_ptr<spdlog::logger> logger);
+
+    void probe();
+    void schedule();
+    void onResponse(int64_t sentNs, HttpsClient::Response response);
+
+    boost::asio::io_context& ioc_;
+    Endpoint endpoint_;
+    std::chrono::milliseconds interval_;
+    std::shared_ptr<ClockOffsetEstimator> clock_;
+    std::shared_ptr<spdlog::logger> logger_;
+    Strand strand_;
+    boost::asio::steady_timer timer_;
+    std::shared_ptr<HttpsClient> client_;
+
+    // Strand-only state
+    bool closed_ = false;
+
+    std::atomic<bool> inFlight_{false};
+    std::atomic<uint64_t> samples_{0};
+    std::atomic<uint64_t> failures_{0};
+};
+
+} // namespace crypto_hft
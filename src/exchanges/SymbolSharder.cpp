@@ -0,0 +1,179 @@
+#include "SymbolSharder.hpp"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace crypto_hft {
+
+SymbolSharder::Config SymbolSharder::Config::fromYaml(const YAML::Node& node) {
+    Config config;
+    if (!node.IsDefined() || !node.IsMap()) {
+        return config;
+    }
+    config.connections = std::max<std::size_t>(1, node["connections"].as<std::size_t>(1));
+    config.rebalanceInterval = std::chrono::seconds(node["rebalance_interval_s"].as<int>(0));
+    config.tolerance = node["tolerance"].as<double>(config.tolerance);
+    config.defaultRate = node["default_rate"].as<double>(config.defaultRate);
+    if (node["expected_rates"]) {
+        for (const auto& rate : node["expected_rates"]) {
+            config.expectedRates[rate.first.as<std::string>()] = rate.second.as<double>();
+        }
+    }
+    return config;
+}
+
+SymbolSharder::SymbolSharder(Config config)
+    : config_(std::move(config))
+    , loads_(std::max<std::size_t>(1, config_.connections), 0.0) {}
+
+std::vector<std::size_t> SymbolSharder::assign(const std::vector<std::string>& symbols) {
+    std::vector<std::pair<double, const std::string*>> pending;
+    for (const auto& symbol : symbols) {
+        if (entries_.count(symbol) == 0) {
+            auto expected = config_.expectedRates.find(symbol);
+            double rate = expected != config_.expectedRates.end() ? expected->second
+                                                                  : config_.defaultRate;
+            pending.push_back({rate, &symbol});
+        }
+    }
+
+    // Heaviest first keeps the greedy placement close to the best split
+    std::stable_sort(pending.begin(), pending.end(),
+                     [](const auto& a, const auto& b) { return a.first > b.first; });
+    for (const auto& [rate, symbol] : pending) {
+        if (entries_.count(*symbol) != 0) {
+            continue;  // Listed twice
+        }
+        std::size_t shard = leastLoaded();
+        entries_[*symbol] = Entry{shard, rate, nextOrder_++};
+        loads_[shard] += rate;
+    }
+
+    std::vector<std::size_t> shards;
+    shards.reserve(symbols.size());
+    for (const auto& symbol : symbols) {
+        shards.push_back(entries_.at(symbol).shard);
+    }
+    return shards;
+}
+
+void SymbolSharder::remove(const std::vector<std::string>& symbols) {
+    for (const auto& symbol : symbols) {
+        auto it = entries_.find(symbol);
+        if (it != entries_.end()) {
+            loads_[it->second.shard] -= it->second.rate;
+            entries_.erase(it);
+        }
+    }
+}
+
+std::optional<std::size_t> SymbolSharder::shardOf(const std::string& symbol) const {
+    auto it = entries_.find(symbol);
+    if (it == entries_.end()) {
+        return std::nullopt;
+    }
+    return it->second.shard;
+}
+
+std::vector<std::string> SymbolSharder::symbolsOn(std::size_t shard) const {
+    std::vector<std::pair<std::size_t, std::string>> ordered;
+    for (const auto& [symbol, entry] : entries_) {
+        if (entry.shard == shard) {
+            ordered.push_back({entry.order, symbol});
+        }
+    }
+    std::sort(ordered.begin(), ordered.end());
+
+    std::vector<std::string> symbols;
+    symbols.reserve(ordered.size());
+    for (auto& [order, symbol] : ordered) {
+        symbols.push_back(std::move(symbol));
+    }
+    return symbols;
+}
+
+std::vector<std::string> SymbolSharder::symbols() const {
+    std::vector<std::string> all;
+    for (std::size_t shard = 0; shard < shardCount(); ++shard) {
+        auto on = symbolsOn(shard);
+        all.insert(all.end(), on.begin(), on.end());
+    }
+    return all;
+}
+
+double SymbolSharder::rate(const std::string& symbol) const {
+    auto it = entries_.find(symbol);
+    return it == entries_.end() ? 0.0 : it->second.rate;
+}
+
+void SymbolSharder::observe(const std::unordered_map<std::string, uint64_t>& counts,
+                            std::chrono::duration<double> interval) {
+    if (interval.count() <= 0.0) {
+        return;
+    }
+    std::fill(loads_.begin(), loads_.end(), 0.0);
+    for (auto& [symbol, entry] : entries_) {
+        auto count = counts.find(symbol);
+        double observed =
+            count == counts.end() ? 0.0 : static_cast<double>(count->second) / interval.count();
+        entry.rate = kRateSmoothing * observed + (1.0 - kRateSmoothing) * entry.rate;
+        loads_[entry.shard] += entry.rate;
+    }
+}
+
+std::vector<SymbolSharder::Move> SymbolSharder::rebalance() {
+    double mean = std::accumulate(loads_.begin(), loads_.end(), 0.0) / shardCount();
+    std::unordered_map<std::string, std::size_t> original;
+
+    for (std::size_t step = 0; step < entries_.size(); ++step) {
+        auto [low, high] = std::minmax_element(loads_.begin(), loads_.end());
+        std::size_t from = static_cast<std::size_t>(high - loads_.begin());
+        std::size_t to = static_cast<std::size_t>(low - loads_.begin());
+        if (*high <= mean * (1.0 + config_.tolerance) || from == to) {
+            break;
+        }
+
+        // Any symbol lighter than the gap lowers the peak; the one nearest half the gap evens
+        // the pair out best
+        double gap = *high - *low;
+        const std::string* best = nullptr;
+        double bestDistance = gap;
+        for (auto& [symbol, entry] : entries_) {
+            if (entry.shard != from || entry.rate <= 0.0 || entry.rate >= gap) {
+                continue;
+            }
+            double distance = std::abs(entry.rate - gap / 2.0);
+            if (distance < bestDistance) {
+                bestDistance = distance;
+                best = &symbol;
+            }
+        }
+        if (!best) {
+            break;  // The peak is one symbol too hot to share
+        }
+
+        Entry& entry = entries_.at(*best);
+        original.emplace(*best, entry.shard);
+        loads_[from] -= entry.rate;
+        loads_[to] += entry.rate;
+        entry.shard = to;
+    }
+
+    std::vector<Move> moves;
+    for (const auto& [symbol, from] : original) {
+        std::size_t to = entries_.at(symbol).shard;
+        if (to != from) {
+            moves.push_back({symbol, from, to});
+        }
+    }
+    std::sort(moves.begin(), moves.end(),
+              [](const Move& a, const Move& b) { return a.symbol < b.symbol; });
+    return moves;
+}
+
+std::size_t SymbolSharder::leastLoaded() const {
+    return static_cast<std::size_t>(std::min_element(loads_.begin(), loads_.end()) -
+                                    loads_.begin());
+}
+
+} // namespace crypto_hft
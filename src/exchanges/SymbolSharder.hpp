@@ -0,0 +1,81 @@
+#pragma once
+
+#include <yaml-cpp/yaml.h>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace crypto_hft {
+
+// Spreads a venue's symbols across a fixed number of feed connections by message rate, so no
+// single connection (and the IO thread reading it) carries most of the traffic. Rates start from
+// configured estimates and follow observed message counts; rebalance() then moves the fewest
+// symbols needed to even out the load. Not thread-safe; the owning adapter serializes access.
+class SymbolSharder {
+public:
+    struct Config {
+        std::size_t connections = 1;
+        std::chrono::seconds rebalanceInterval{0};  // 0 disables runtime rebalancing
+        double tolerance = 0.2;    // Rebalance once a shard exceeds the mean load by this fraction
+        double defaultRate = 1.0;  // Messages per second assumed for symbols without an estimate
+        std::unordered_map<std::string, double> expectedRates;
+
+        // Reads {connections, rebalance_interval_s, tolerance, default_rate, expected_rates};
+        // an undefined node gives the defaults
+        static Config fromYaml(const YAML::Node& node);
+    };
+
+    struct Move {
+        std::string symbol;
+        std::size_t from;
+        std::size_t to;
+    };
+
+    SymbolSharder() : SymbolSharder(Config{}) {}
+    explicit SymbolSharder(Config config);
+
+    const Config& config() const { return config_; }
+    std::size_t shardCount() const { return loads_.size(); }
+
+    // Places symbols that are not assigned yet, heaviest first, each on the least loaded shard.
+    // Returns the shard of every given symbol, in order.
+    std::vector<std::size_t> assign(const std::vector<std::string>& symbols);
+    void remove(const std::vector<std::string>& symbols);
+
+    std::optional<std::size_t> shardOf(const std::string& symbol) const;
+    std::vector<std::string> symbolsOn(std::size_t shard) const;
+    std::vector<std::string> symbols() const;
+    double load(std::size_t shard) const { return loads_[shard]; }
+    double rate(const std::string& symbol) const;
+
+    // Folds the messages counted per symbol over an interval into the rate estimates. Assigned
+    // symbols missing from counts were silent for the interval.
+    void observe(const std::unordered_map<std::string, uint64_t>& counts,
+                 std::chrono::duration<double> interval);
+
+    // Moves symbols off the most loaded shard while that shard is above tolerance and a move
+    // lowers the peak. Returns one entry per moved symbol, from its old to its new shard.
+    std::vector<Move> rebalance();
+
+private:
+    struct Entry {
+        std::size_t shard;
+        double rate;
+        std::size_t order;  // Assignment order, for a stable symbolsOn()
+    };
+
+    std::size_t leastLoaded() const;
+
+    static constexpr double kRateSmoothing = 0.3;  // Weight of the newest interval
+
+    Config config_;
+    std::unordered_map<std::string, Entry> entries_;
+    std::vector<double> loads_;
+    std::size_t nextOrder_ = 0;
+};
+
+} // namespace crypto_hft
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace crypto_hft {
+
+// Relates one symbol's top-of-book quotes to its depth stream by venue update id. A quote is
+// ahead of the depth stream until a depth update reaching its update id arrives; the time in
+// between is the quote's lead. Quotes the depth stream has already passed are stale. Fixed
+// capacity so the read path never allocates; quotes beyond it are dropped oldest first and
+// counted in overflowed().
+class TopOfBookTracker {
+public:
+    static constexpr std::size_t kCapacity = 64;
+
+    // Returns false for a stale quote, which should not be applied
+    bool onQuote(uint64_t updateId, int64_t arrivalNs) {
+        if (updateId <= depthUpdateId_) {
+            return false;
+        }
+        if (size_ == kCapacity) {
+            head_ = (head_ + 1) % kCapacity;
+            --size_;
+            ++overflowed_;
+        }
+        pending_[(head_ + size_) % kCapacity] = {updateId, arrivalNs};
+        ++size_;
+        return true;
+    }
+
+    // Resolves the quotes covered by a depth update through finalUpdateId, calling
+    // record(leadNs) for each, oldest first
+    template <typename Record>
+    void onDepth(uint64_t finalUpdateId, int64_t arrivalNs, Record&& record) {
+        if (finalUpdateId > depthUpdateId_) {
+            depthUpdateId_ = finalUpdateId;
+        }
+        while (size_ > 0 && pending_[head_].updateId <= depthUpdateId_) {
+            record(arrivalNs - pending_[head_].arrivalNs);
+            head_ = (head_ + 1) % kCapacity;
+            --size_;
+        }
+    }
+
+    uint64_t depthUpdateId() const { return depthUpdateId_; }
+    std::size_t pending() const { return size_; }
+    uint64_t overflowed() const { return overflowed_; }
+
+private:
+    struct Quote {
+        uint64_t updateId;
+        int64_t arrivalNs;
+    };
+
+    std::array<Quote, kCapacity> pending_{};
+    std::size_t head_ = 0;
+    std::size_t size_ = 0;
+    uint64_t depthUpdateId_ = 0;
+    uint64_t overflowed_ = 0;
+};
+
+} // namespace crypto_hft
@@ -0,0 +1,696 @@
+#include "WsConnection.hpp"
+#include "../infra/MetricsReporter.hpp"
+#include <boost/asio/post.hpp>
+#include <algorithm>
+#include <charconv>
+#include <future>
+
+namespace crypto_hft {
+
+namespace beast = boost::beast;
+namespace websocket = beast::websocket;
+namespace net = boost::asio;
+namespace ssl = boost::asio::ssl;
+using tcp = net::ip::tcp;
+
+namespace {
+
+int64_t steadyNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// For counters with a single writer: no locked instruction on the read path
+template <typename T>
+void addRelaxed(std::atomic<T>& counter, T amount) {
+    counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+} // namespace
+
+std::shared_ptr<WsConnection> WsConnection::create(net::io_context& ioc, ssl::context& ctx,
+                                                   Options options,
+                                                   std::shared_ptr<spdlog::logger> logger) {
+    return std::shared_ptr<WsConnection>(
+        new WsConnection(ioc, ctx, std::move(options), std::move(logger)));
+}
+
+WsConnection::WsConnection(net::io_context& ioc, ssl::context& ctx, Options options,
+                           std::shared_ptr<spdlog::logger> logger)
+    : ioc_(ioc)
+    , ctx_(ctx)
+    , options_(std::move(options))
+    , logger_(logger ? std::move(logger) : spdlog::default_logger())
+    , strand_(net::make_strand(ioc))
+    , resolver_(strand_)
+    , reconnectTimer_(strand_)
+    , standbyTimer_(strand_)
+    , pingTimer_(strand_)
+    , rng_(std::random_device{}()) {
+}
+
+void WsConnection::start() {
+    net::post(strand_, [self = shared_from_this()] {
+        if (self->state() != State::Idle) {
+            return;
+        }
+        self->setState(State::Connecting);
+        self->connecting_ = true;
+        self->connectSession(false);
+    });
+}
+
+bool WsConnection::waitForOpen(std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(stateMutex_);
+    stateChanged_.wait_for(lock, timeout, [this] {
+        State current = state();
+        return current == State::Open || current == State::Closed;
+    });
+    return isOpen();
+}
+
+void WsConnection::send(std::string message) {
+    send(std::move(message), nullptr);
+}
+
+void WsConnection::send(std::string message, SendHandler handler) {
+    net::post(strand_, [self = shared_from_this(), message = std::move(message),
+                        handler = std::move(handler)]() mutable {
+        if (!self->active_ || self->closed_) {
+            self->logger_->debug("Dropping message while {} is not open: {}",
+                                 self->options_.host, message);
+            if (handler) {
+                handler(false);
+            }
+            return;
+        }
+        self->active_->writes.push_back(std::move(message));
+        if (!self->active_->writing) {
+            self->writeLoop(self->active_);
+        }
+        if (handler) {
+            handler(true);
+        }
+    });
+}
+
+void WsConnection::close() {
+    net::post(strand_, [self = shared_from_this()] { self->doClose(); });
+}
+
+void WsConnection::shutdown() {
+    // With one thread per context, being on it means no handler can run concurrently
+    if (ioc_.get_executor().running_in_this_thread() || ioc_.stopped()) {
+        doClose();
+        return;
+    }
+    std::promise<void> done;
+    net::post(strand_, [this, &done] {
+        doClose();
+        done.set_value();
+    });
+    done.get_future().wait();
+}
+
+WsConnection::Stats WsConnection::getStats() const {
+    Stats stats;
+    stats.opens = opens_.load(std::memory_order_relaxed);
+    stats.failures = failures_.load(std::memory_order_relaxed);
+    stats.promotions = promotions_.load(std::memory_order_relaxed);
+    stats.resumedHandshakes = resumedHandshakes_.load(std::memory_order_relaxed);
+    stats.resolves = resolves_.load(std::memory_order_relaxed);
+    stats.compressedSessions = compressedSessions_.load(std::memory_order_relaxed);
+    stats.rxSamples = rxSamples_.load(std::memory_order_relaxed);
+    if (stats.rxSamples > 0) {
+        stats.meanRxLatencyNs =
+            static_cast<double>(rxLatencyTotalNs_.load(std::memory_order_relaxed)) /
+            static_cast<double>(stats.rxSamples);
+    }
+    stats.maxRxLatencyNs = rxLatencyMaxNs_.load(std::memory_order_relaxed);
+    stats.pings = pings_.load(std::memory_order_relaxed);
+    stats.pongs = pongs_.load(std::memory_order_relaxed);
+    stats.lastRoundTripNs = lastRoundTripNs_.load(std::memory_order_relaxed);
+    stats.minRoundTripNs = minRoundTripNs_.load(std::memory_order_relaxed);
+    stats.slowFailovers = slowFailovers_.load(std::memory_order_relaxed);
+    stats.frames = frames_.load(std::memory_order_relaxed);
+    stats.bytes = bytes_.load(std::memory_order_relaxed);
+    const int64_t lastFrameNs = lastFrameNs_.load(std::memory_order_relaxed);
+    if (lastFrameNs != 0) {
+        stats.lastFrameAgeNs = std::max<int64_t>(steadyNowNs() - lastFrameNs, 0);
+    }
+    stats.lastLoopLagNs = lastLoopLagNs_.load(std::memory_order_relaxed);
+    stats.maxLoopLagNs = maxLoopLagNs_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void WsConnection::publishMetrics(const std::unordered_map<std::string, std::string>& labels) const {
+    auto& reporter = MetricsReporter::getInstance();
+    const Stats stats = getStats();
+    reporter.setGauge("ws_connection_opens", static_cast<double>(stats.opens), labels);
+    reporter.setGauge("ws_connection_failures", static_cast<double>(stats.failures), labels);
+    reporter.setGauge("ws_connection_promotions", static_cast<double>(stats.promotions), labels);
+    reporter.setGauge("ws_connection_resumed_handshakes",
+                      static_cast<double>(stats.resumedHandshakes), labels);
+    reporter.setGauge("ws_connection_compressed_sessions",
+                      static_cast<double>(stats.compressedSessions), labels);
+    reporter.setGauge("ws_connection_rx_samples", static_cast<double>(stats.rxSamples), labels);
+    reporter.setGauge("ws_connection_rx_latency_mean_ns", stats.meanRxLatencyNs, labels);
+    reporter.setGauge("ws_connection_rx_latency_max_ns",
+                      static_cast<double>(stats.maxRxLatencyNs), labels);
+    reporter.setGauge("ws_connection_pings", static_cast<double>(stats.pings), labels);
+    reporter.setGauge("ws_connection_pongs", static_cast<double>(stats.pongs), labels);
+    reporter.setGauge("ws_connection_rtt_last_ns", static_cast<double>(stats.lastRoundTripNs),
+                      labels);
+    reporter.setGauge("ws_connection_rtt_min_ns", static_cast<double>(stats.minRoundTripNs),
+                      labels);
+    reporter.setGauge("ws_connection_slow_failovers", static_cast<double>(stats.slowFailovers),
+                      labels);
+    reporter.setGauge("ws_connection_frames", static_cast<double>(stats.frames), labels);
+    reporter.setGauge("ws_connection_bytes", static_cast<double>(stats.bytes), labels);
+    reporter.setGauge("ws_connection_last_frame_age_ns",
+                      static_cast<double>(stats.lastFrameAgeNs), labels);
+    reporter.setGauge("ws_connection_loop_lag_last_ns", static_cast<double>(stats.lastLoopLagNs),
+                      labels);
+    reporter.setGauge("ws_connection_loop_lag_max_ns", static_cast<double>(stats.maxLoopLagNs),
+                      labels);
+
+    std::lock_guard<std::mutex> lock(publishMutex_);
+    const int64_t nowNs = steadyNowNs();
+    if (publishedNs_ != 0 && nowNs > publishedNs_) {
+        const double seconds = static_cast<double>(nowNs - publishedNs_) / 1e9;
+        reporter.setGauge("ws_connection_frames_per_second",
+                          static_cast<double>(stats.frames - publishedFrames_) / seconds, labels);
+        reporter.setGauge("ws_connection_bytes_per_second",
+                          static_cast<double>(stats.bytes - publishedBytes_) / seconds, labels);
+    }
+    publishedNs_ = nowNs;
+    publishedFrames_ = stats.frames;
+    publishedBytes_ = stats.bytes;
+
+    // Samples the ring has already overwritten are skipped rather than read torn
+    const uint64_t written = roundTripsWritten_.load(std::memory_order_acquire);
+    uint64_t next = std::max(publishedRoundTrips_,
+                             written > kRoundTripRing ? written - kRoundTripRing : 0);
+    for (; next < written; ++next) {
+        const int64_t roundTripNs =
+            roundTripRing_[next % kRoundTripRing].load(std::memory_order_relaxed);
+        reporter.observeHistogram("ws_connection_rtt_us", static_cast<double>(roundTripNs) / 1e3,
+                                  labels);
+    }
+    publishedRoundTrips_ = written;
+}
+
+void WsConnection::connectSession(bool standby) {
+    auto self = shared_from_this();
+    if (endpoints_.empty()) {
+        resolves_.fetch_add(1, std::memory_order_relaxed);
+        resolver_.async_resolve(options_.host, options_.port,
+            [self, standby](beast::error_code ec, tcp::resolver::results_type results) {
+                if (self->closed_) {
+                    return;
+                }
+                if (ec) {
+                    self->onAttemptFailed(standby, "resolve", ec);
+                    return;
+                }
+                self->endpoints_ = std::move(results);
+                self->connectSession(standby);
+            });
+        return;
+    }
+
+    auto session = std::make_shared<Session>(strand_, ctx_);
+    SSL* ssl = session->ws.next_layer().native_handle();
+    SSL_set_tlsext_host_name(ssl, options_.host.c_str());
+    if (tlsSession_) {
+        SSL_set_session(ssl, tlsSession_.get());
+    }
+
+    beast::get_lowest_layer(session->ws).expires_after(options_.handshakeTimeout);
+    connectEndpoint(session, standby, endpoints_.begin());
+}
+
+void WsConnection::connectEndpoint(const SessionPtr& session, bool standby,
+                                   tcp::resolver::results_type::const_iterator endpoint) {
+    // Endpoints are tried one at a time so the profile is applied to each socket before it
+    // connects; range connect would reopen the socket without it
+    auto& tcpStream = beast::get_lowest_layer(session->ws);
+    beast::error_code ec;
+    tcpStream.socket().open(endpoint->endpoint().protocol(), ec);
+    if (ec) {
+        onAttemptFailed(standby, "socket open", ec);
+        return;
+    }
+    options_.profile.apply(tcpStream.socket(), *logger_);
+
+    tcpStream.async_connect(endpoint->endpoint(),
+        [self = shared_from_this(), session, standby, endpoint](beast::error_code ec) {
+            if (self->closed_) {
+                return;
+            }
+            if (!ec) {
+                self->handshake(session, standby);
+                return;
+            }
+            auto next = std::next(endpoint);
+            if (next != self->endpoints_.end() && ec != beast::error::timeout) {
+                beast::error_code ignored;
+                beast::get_lowest_layer(session->ws).socket().close(ignored);
+                self->connectEndpoint(session, standby, next);
+                return;
+            }
+            self->endpoints_ = {};  // Possibly stale; resolve again on the next attempt
+            self->onAttemptFailed(standby, "connect", ec);
+        });
+}
+
+void WsConnection::handshake(const SessionPtr& session, bool standby) {
+    auto self = shared_from_this();
+    session->ws.next_layer().async_handshake(ssl::stream_base::client,
+        [self, session, standby](beast::error_code ec) {
+            if (self->closed_) {
+                return;
+            }
+            if (ec) {
+                self->onAttemptFailed(standby, "TLS handshake", ec);
+                return;
+            }
+            if (SSL_session_reused(session->ws.next_layer().native_handle())) {
+                self->resumedHandshakes_.fetch_add(1, std::memory_order_relaxed);
+            }
+            self->cacheTlsSession(*session);
+
+            // The websocket stream manages its own timeouts from here on
+            beast::get_lowest_layer(session->ws).expires_never();
+            websocket::stream_base::timeout timeouts;
+            timeouts.handshake_timeout = self->options_.handshakeTimeout;
+            timeouts.idle_timeout = self->options_.idleTimeout;
+            timeouts.keep_alive_pings = true;
+            session->ws.set_option(timeouts);
+            session->ws.text(true);
+            // Runs inside a read, whose handler keeps the connection and the session alive.
+            // Only timed pings carry a payload; pongs to the stream's keep-alive pings are empty.
+            session->ws.control_callback(
+                [raw = self.get(), stream = session.get()](websocket::frame_type kind,
+                                                           beast::string_view payload) {
+                    if (kind == websocket::frame_type::pong && !payload.empty()) {
+                        raw->onPong(*stream, std::string_view(payload.data(), payload.size()));
+                    }
+                });
+
+            const auto& compression = self->options_.profile.compression;
+            if (compression.enabled) {
+                websocket::permessage_deflate deflate;
+                deflate.client_enable = true;
+                deflate.server_max_window_bits = compression.serverMaxWindowBits;
+                deflate.client_max_window_bits = compression.clientMaxWindowBits;
+                deflate.server_no_context_takeover = compression.serverNoContextTakeover;
+                deflate.client_no_context_takeover = compression.clientNoContextTakeover;
+                session->ws.set_option(deflate);
+            }
+
+            session->ws.async_handshake(session->handshakeResponse, self->options_.host,
+                                        self->options_.target,
+                [self, session, standby](beast::error_code ec) {
+                    if (self->closed_) {
+                        return;
+                    }
+                    if (ec) {
+                        self->onAttemptFailed(standby, "WebSocket handshake", ec);
+                        return;
+                    }
+                    auto extensions =
+                        session->handshakeResponse[beast::http::field::sec_websocket_extensions];
+                    if (extensions.find("permessage-deflate") != beast::string_view::npos) {
+                        self->compressedSessions_.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    auto& tuned = session->ws.next_layer().next_layer();
+                    tuned.setQuickAck(self->options_.profile.quickAck);
+                    tuned.setRxTimestamps(self->options_.profile.rxTimestamps);
+                    self->onSessionReady(session, standby);
+                });
+        });
+}
+
+void WsConnection::onSessionReady(const SessionPtr& session, bool standby) {
+    (standby ? standbyConnecting_ : connecting_) = false;
+    (standby ? standbyAttempts_ : attempts_) = 0;
+
+    // Whichever attempt finishes first serves the feed; the other becomes the standby
+    if (!active_) {
+        reconnectTimer_.cancel();
+        activate(session);
+    } else if (options_.standby && !standby_) {
+        logger_->info("Standby session to {} ready", options_.host);
+        standby_ = session;
+        readLoop(session);
+    }
+}
+
+void WsConnection::onAttemptFailed(bool standby, const char* stage,
+                                   const beast::error_code& ec) {
+    logger_->warn("{} to {} failed: {}", stage, options_.host, ec.message());
+    if (standby) {
+        standbyConnecting_ = false;
+        scheduleStandby();
+        return;
+    }
+    failures_.fetch_add(1, std::memory_order_relaxed);
+    connecting_ = false;
+    if (!active_) {
+        scheduleReconnect();
+    }
+}
+
+void WsConnection::onSessionLost(const SessionPtr& session, const beast::error_code& ec) {
+    cacheTlsSession(*session);
+
+    if (session == standby_) {
+        logger_->warn("Standby session to {} lost: {}", options_.host, ec.message());
+        standby_.reset();
+        scheduleStandby();
+        return;
+    }
+    if (session != active_) {
+        return;  // Already replaced
+    }
+
+    logger_->warn("Session to {} lost: {}", options_.host, ec.message());
+    failures_.fetch_add(1, std::memory_order_relaxed);
+    active_.reset();
+    notifyLost();
+    if (standby_) {
+        logger_->info("Promoting standby session to {}", options_.host);
+        promotions_.fetch_add(1, std::memory_order_relaxed);
+        activate(std::move(standby_));
+        return;
+    }
+    scheduleReconnect();
+}
+
+void WsConnection::notifyLost() {
+    if (lostHandler_) {
+        try {
+            lostHandler_(*this);
+        } catch (const std::exception& e) {
+            logger_->error("Lost handler for {} failed: {}", options_.host, e.what());
+        }
+    }
+}
+
+void WsConnection::activate(SessionPtr session) {
+    active_ = std::move(session);
+    slowRoundTrips_ = 0;
+    opens_.fetch_add(1, std::memory_order_relaxed);
+    if (!active_->reading) {
+        readLoop(active_);
+    }
+    setState(State::Open);
+    logger_->info("Session to {}{} open", options_.host, options_.target);
+    schedulePing();
+
+    if (openHandler_) {
+        try {
+            openHandler_(*this);
+        } catch (const std::exception& e) {
+            logger_->error("Open handler for {} failed: {}", options_.host, e.what());
+        }
+    }
+    if (options_.standby && !standby_ && !standbyConnecting_) {
+        standbyConnecting_ = true;
+        connectSession(true);
+    }
+}
+
+void WsConnection::readLoop(const SessionPtr& session) {
+    session->reading = true;
+    session->ws.async_read(session->buffer,
+        [self = shared_from_this(), session](beast::error_code ec, std::size_t) {
+            if (self->closed_) {
+                return;
+            }
+            if (ec) {
+                session->reading = false;
+                self->onSessionLost(session, ec);
+                return;
+            }
+
+            // Frames on the standby are read only to keep its control frames flowing
+            if (session == self->active_ && self->frameHandler_) {
+                if (self->options_.profile.rxTimestamps) {
+                    self->recordRxLatency(*session);
+                }
+                auto data = session->buffer.cdata();
+                addRelaxed<uint64_t>(self->frames_, 1);
+                addRelaxed<uint64_t>(self->bytes_, data.size());
+                self->lastFrameNs_.store(steadyNowNs(), std::memory_order_relaxed);
+                try {
+                    self->frameHandler_(
+                        std::string_view(static_cast<const char*>(data.data()), data.size()));
+                } catch (const std::exception& e) {
+                    self->logger_->error("Error processing message: {}", e.what());
+                }
+            }
+            session->buffer.consume(session->buffer.size());
+            if (!self->closed_) {
+                self->readLoop(session);
+            }
+        });
+}
+
+void WsConnection::recordRxLatency(Session& session) {
+    int64_t rxNs = session.ws.next_layer().next_layer().takeRxTimestamp();
+    if (rxNs == 0) {
+        return;
+    }
+    // Kernel timestamps are CLOCK_REALTIME
+    int64_t nowNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    int64_t latency = nowNs - rxNs;
+    rxSamples_.fetch_add(1, std::memory_order_relaxed);
+    rxLatencyTotalNs_.fetch_add(latency, std::memory_order_relaxed);
+    if (latency > rxLatencyMaxNs_.load(std::memory_order_relaxed)) {
+        rxLatencyMaxNs_.store(latency, std::memory_order_relaxed);
+    }
+}
+
+void WsConnection::writeLoop(const SessionPtr& session) {
+    session->writing = true;
+    session->ws.async_write(net::buffer(session->writes.front()),
+        [self = shared_from_this(), session](beast::error_code ec, std::size_t) {
+            if (ec) {
+                // The read side reports the failure and drives the reconnect
+                self->logger_->error("Write to {} failed: {}", self->options_.host, ec.message());
+                session->writes.clear();
+                session->writing = false;
+                return;
+            }
+            session->writes.pop_front();
+            if (session->writes.empty()) {
+                session->writing = false;
+            } else {
+                self->writeLoop(session);
+            }
+        });
+}
+
+void WsConnection::schedulePing() {
+    if (options_.pingInterval.count() <= 0 || closed_) {
+        return;
+    }
+    pingTimer_.expires_after(options_.pingInterval);
+    pingTimer_.async_wait([self = shared_from_this()](beast::error_code ec) {
+        if (ec || self->closed_) {
+            return;
+        }
+        // Past the expiry, the IO thread was busy with other handlers
+        const int64_t lagNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - self->pingTimer_.expiry()).count();
+        self->lastLoopLagNs_.store(lagNs, std::memory_order_relaxed);
+        if (lagNs > self->maxLoopLagNs_.load(std::memory_order_relaxed)) {
+            self->maxLoopLagNs_.store(lagNs, std::memory_order_relaxed);
+        }
+        // A venue that has not answered for longer than a slow round trip is not waited for
+        if (self->active_ && self->active_->awaitingPongNs != 0 &&
+            self->options_.maxRoundTrip.count() > 0) {
+            const int64_t waitedNs = steadyNowNs() - self->active_->awaitingPongNs;
+            if (waitedNs > std::chrono::duration_cast<std::chrono::nanoseconds>(
+                               self->options_.maxRoundTrip).count()) {
+                self->checkRoundTrip(waitedNs);
+            }
+        }
+        self->sendPing();
+        self->schedulePing();
+    });
+}
+
+void WsConnection::sendPing() {
+    // One timed ping in flight at a time; a session that stops answering is left to the idle
+    // timeout
+    if (!active_ || active_->pinging) {
+        return;
+    }
+    auto session = active_;
+    session->pinging = true;
+    // The payload is the send time, so the pong needs no bookkeeping to be matched
+    const int64_t nowNs = steadyNowNs();
+    char text[24];
+    auto [end, ec] = std::to_chars(text, text + sizeof(text), nowNs);
+    if (session->awaitingPongNs == 0) {
+        session->awaitingPongNs = nowNs;
+    }
+    pings_.fetch_add(1, std::memory_order_relaxed);
+    session->ws.async_ping(websocket::ping_data(text, static_cast<std::size_t>(end - text)),
+        [session](beast::error_code) { session->pinging = false; });
+}
+
+void WsConnection::onPong(Session& session, std::string_view payload) {
+    if (&session != active_.get()) {
+        return;  // A session already replaced or a standby, neither of which is timed
+    }
+    int64_t sentNs = 0;
+    auto [end, ec] = std::from_chars(payload.data(), payload.data() + payload.size(), sentNs);
+    if (ec != std::errc() || end != payload.data() + payload.size()) {
+        return;  // Unsolicited, or answering someone else's ping
+    }
+    const int64_t roundTripNs = steadyNowNs() - sentNs;
+    if (roundTripNs < 0) {
+        return;
+    }
+    session.awaitingPongNs = 0;
+    pongs_.fetch_add(1, std::memory_order_relaxed);
+    lastRoundTripNs_.store(roundTripNs, std::memory_order_relaxed);
+    const int64_t min = minRoundTripNs_.load(std::memory_order_relaxed);
+    if (min == 0 || roundTripNs < min) {
+        minRoundTripNs_.store(roundTripNs, std::memory_order_relaxed);
+    }
+    const uint64_t written = roundTripsWritten_.load(std::memory_order_relaxed);
+    roundTripRing_[written % kRoundTripRing].store(roundTripNs, std::memory_order_relaxed);
+    roundTripsWritten_.store(written + 1, std::memory_order_release);
+
+    if (roundTripHandler_) {
+        try {
+            roundTripHandler_(roundTripNs);
+        } catch (const std::exception& e) {
+            logger_->error("Round-trip handler for {} failed: {}", options_.host, e.what());
+        }
+    }
+    if (options_.maxRoundTrip.count() > 0) {
+        checkRoundTrip(roundTripNs);
+    }
+}
+
+void WsConnection::checkRoundTrip(int64_t roundTripNs) {
+    if (roundTripNs <= std::chrono::duration_cast<std::chrono::nanoseconds>(
+                           options_.maxRoundTrip).count()) {
+        slowRoundTrips_ = 0;
+        return;
+    }
+    if (++slowRoundTrips_ >= std::max(options_.slowRoundTrips, 1u)) {
+        slowRoundTrips_ = 0;
+        failOver(roundTripNs);
+    }
+}
+
+void WsConnection::failOver(int64_t roundTripNs) {
+    if (!standby_) {
+        logger_->warn("Round trips to {} are slow ({} us) and no standby is ready",
+                      options_.host, roundTripNs / 1000);
+        return;
+    }
+    logger_->warn("Round trips to {} are slow ({} us); promoting standby session", options_.host,
+                  roundTripNs / 1000);
+    SessionPtr slow = std::move(active_);
+    notifyLost();
+    promotions_.fetch_add(1, std::memory_order_relaxed);
+    slowFailovers_.fetch_add(1, std::memory_order_relaxed);
+    activate(std::move(standby_));
+    // A close frame could race a ping still being written on the slow session, so drop the
+    // transport; its read then fails and finds the session already replaced
+    beast::get_lowest_layer(slow->ws).close();
+}
+
+void WsConnection::scheduleReconnect() {
+    if (closed_ || connecting_) {
+        return;
+    }
+    setState(State::Backoff);
+    auto delay = backoffDelay(attempts_++);
+    logger_->info("Reconnecting to {} in {} ms", options_.host, delay.count());
+    reconnectTimer_.expires_after(delay);
+    reconnectTimer_.async_wait([self = shared_from_this()](beast::error_code ec) {
+        if (ec || self->closed_ || self->active_ || self->connecting_) {
+            return;
+        }
+        self->setState(State::Connecting);
+        self->connecting_ = true;
+        self->connectSession(false);
+    });
+}
+
+void WsConnection::scheduleStandby() {
+    if (closed_ || !options_.standby || standbyConnecting_) {
+        return;
+    }
+    standbyConnecting_ = true;
+    standbyTimer_.expires_after(backoffDelay(standbyAttempts_++));
+    standbyTimer_.async_wait([self = shared_from_this()](beast::error_code ec) {
+        if (ec || self->closed_) {
+            self->standbyConnecting_ = false;
+            return;
+        }
+        self->connectSession(true);
+    });
+}
+
+void WsConnection::cacheTlsSession(Session& session) {
+    // With TLS 1.3 the resumable ticket arrives after the handshake, so this is refreshed
+    // again when a session ends. Keep a copy: OpenSSL marks the original not resumable when a
+    // connection that ended without a clean shutdown is freed.
+    SSL_SESSION* tls = SSL_get0_session(session.ws.next_layer().native_handle());
+    if (tls && SSL_SESSION_is_resumable(tls)) {
+        if (SSL_SESSION* copy = SSL_SESSION_dup(tls)) {
+            tlsSession_.reset(copy, SSL_SESSION_free);
+        }
+    }
+}
+
+void WsConnection::doClose() {
+    if (closed_) {
+        return;
+    }
+    closed_ = true;
+    reconnectTimer_.cancel();
+    standbyTimer_.cancel();
+    pingTimer_.cancel();
+    resolver_.cancel();
+
+    if (active_) {
+        active_->ws.async_close(websocket::close_code::normal,
+            [session = active_](beast::error_code) {});
+        active_.reset();
+    }
+    if (standby_) {
+        beast::get_lowest_layer(standby_->ws).close();
+        standby_.reset();
+    }
+    setState(State::Closed);
+}
+
+void WsConnection::setState(State state) {
+    {
+        std::lock_guard<std::mutex> lock(stateMutex_);
+        state_.store(state, std::memory_order_release);
+    }
+    stateChanged_.notify_all();
+}
+
+std::chrono::milliseconds WsConnection::backoffDelay(unsigned attempt) {
+    // Exponential with equal jitter: uniform in [ceiling / 2, ceiling]
+    auto ceiling = options_.backoffInitial * (int64_t{1} << std::min(attempt, 16u));
+    ceiling = std::min(ceiling, options_.backoffMax);
+    std::uniform_int_distribution<int64_t> jitter(ceiling.count() / 2, ceiling.count());
+    return std::chrono::milliseconds(jitter(rng_));
+}
+
+} // namespace crypto_hft
@@ -0,0 +1,255 @@
+#pragma once
+
+#include "ConnectionProfile.hpp"
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/ssl.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/strand.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/ssl.hpp>
+#include <boost/beast/websocket.hpp>
+#include <boost/beast/websocket/ssl.hpp>
+#include <openssl/ssl.h>
+#include <spdlog/spdlog.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace crypto_hft {
+
+// One logical WebSocket feed to a venue that outlives its transport sessions. Connecting,
+// failure handling and reconnects are asynchronous on the connection's strand and never block
+// the IO thread:
+//  - failed attempts back off exponentially with jitter, starting from backoffInitial;
+//  - resolved endpoints are cached and only re-resolved after a connect failure;
+//  - the last TLS session is offered on the next handshake so reconnects can resume;
+//  - with standby enabled a second session is kept handshaken and, on failure of the active
+//    one, promoted without waiting for DNS, TCP or TLS;
+//  - with pingInterval set, the active session is pinged on a timer and the round trip of each
+//    answered ping is passed to the round-trip handler; with maxRoundTrip set as well, a run of
+//    slow round trips promotes the standby as a failure would.
+// Health counters (frames, bytes, time since the last frame, how late the ping timer fires)
+// are recorded on the strand with plain stores and turned into rates and histograms only by
+// publishMetrics().
+// Every time a session becomes active the open handler runs, so the owner can replay
+// authentication and subscriptions onto it; every time the active one fails the lost handler
+// runs, so the owner can fail whatever was still waiting on it.
+class WsConnection : public std::enable_shared_from_this<WsConnection> {
+public:
+    struct Options {
+        std::string host;
+        std::string port = "443";
+        std::string target = "/";
+        bool standby = false;
+        std::chrono::milliseconds backoffInitial{100};
+        std::chrono::milliseconds backoffMax{10000};
+        std::chrono::seconds handshakeTimeout{10};
+        // Silence for half of this sends a ping; a session silent for all of it has failed
+        std::chrono::seconds idleTimeout{15};
+        // How often the active session is pinged to time the round trip; 0 leaves only the
+        // idle keep-alive pings, which are not timed
+        std::chrono::milliseconds pingInterval{0};
+        // A round trip longer than this, answered or still outstanding at a ping tick, is slow;
+        // slowRoundTrips of them in a row fail over to a ready standby. 0 never fails over.
+        std::chrono::milliseconds maxRoundTrip{0};
+        unsigned slowRoundTrips = 3;
+        ConnectionProfile profile;
+    };
+
+    enum class State { Idle, Connecting, Open, Backoff, Closed };
+
+    struct Stats {
+        uint64_t opens = 0;              // Sessions that became active, by handshake or promotion
+        uint64_t failures = 0;           // Failed attempts and lost active sessions
+        uint64_t promotions = 0;         // Failovers served by the standby session
+        uint64_t resumedHandshakes = 0;  // TLS handshakes that resumed a cached session
+        uint64_t resolves = 0;
+        uint64_t compressedSessions = 0;  // Sessions on which the venue accepted permessage-deflate
+        // Kernel receive to frame handler, for frames with a receive timestamp
+        uint64_t rxSamples = 0;
+        double meanRxLatencyNs = 0.0;
+        int64_t maxRxLatencyNs = 0;
+        // Timed pings on the active session and the pongs that answered them
+        uint64_t pings = 0;
+        uint64_t pongs = 0;
+        int64_t lastRoundTripNs = 0;
+        int64_t minRoundTripNs = 0;
+        uint64_t slowFailovers = 0;  // Promotions forced by slow round trips, not failures
+        // Frames delivered by the active session
+        uint64_t frames = 0;
+        uint64_t bytes = 0;
+        int64_t lastFrameAgeNs = -1;  // Since the last one; -1 before the first
+        // How late the ping timer fired, i.e. how long the IO thread was busy elsewhere
+        int64_t lastLoopLagNs = 0;
+        int64_t maxLoopLagNs = 0;
+    };
+
+    using FrameHandler = std::function<void(std::string_view)>;
+    using OpenHandler = std::function<void(WsConnection&)>;
+    using LostHandler = std::function<void(WsConnection&)>;
+    // Told on the strand whether a message was queued on the active session or dropped
+    using SendHandler = std::function<void(bool queued)>;
+    // Told on the strand how long each timed ping took to be answered
+    using RoundTripHandler = std::function<void(int64_t roundTripNs)>;
+
+    static std::shared_ptr<WsConnection> create(boost::asio::io_context& ioc,
+                                                boost::asio::ssl::context& ctx, Options options,
+                                                std::shared_ptr<spdlog::logger> logger);
+
+    WsConnection(const WsConnection&) = delete;
+    WsConnection& operator=(const WsConnection&) = delete;
+
+    // Handlers run on the connection's strand; set them before start()
+    void setFrameHandler(FrameHandler handler) { frameHandler_ = std::move(handler); }
+    void setOpenHandler(OpenHandler handler) { openHandler_ = std::move(handler); }
+    // Runs when the active session fails, before a standby is promoted or a reconnect is
+    // scheduled. Messages queued on the failed session may or may not have been delivered.
+    void setLostHandler(LostHandler handler) { lostHandler_ = std::move(handler); }
+    void setRoundTripHandler(RoundTripHandler handler) { roundTripHandler_ = std::move(handler); }
+
+    // Starts connecting; keeps reconnecting until close()
+    void start();
+    // Blocks the calling thread until a session is open or the connection is closed. Must not
+    // be called from the IO thread.
+    bool waitForOpen(std::chrono::milliseconds timeout);
+    // Queues a text frame on the active session. Messages sent while no session is open are
+    // dropped: session state is replayed by the open handler instead.
+    void send(std::string message);
+    // send(), then tells handler whether the message was queued or dropped. Messages queued
+    // before the lost handler runs are exactly those that went to the failed session.
+    void send(std::string message, SendHandler handler);
+    // Closes the active session gracefully and stops reconnecting
+    void close();
+    // close(), returning once no handler will be invoked any more
+    void shutdown();
+
+    State state() const { return state_.load(std::memory_order_acquire); }
+    bool isOpen() const { return state() == State::Open; }
+    Stats getStats() const;
+    // Pushes getStats() to MetricsReporter as ws_connection_* gauges with the given labels,
+    // with frame and byte rates since the previous call and the round trips since then as the
+    // ws_connection_rtt_us histogram
+    void publishMetrics(const std::unordered_map<std::string, std::string>& labels) const;
+
+private:
+    using Stream = boost::beast::websocket::stream<boost::beast::ssl_stream<TunedStream>>;
+    using Strand = boost::asio::strand<boost::asio::io_context::executor_type>;
+
+    struct Session {
+        Session(const Strand& strand, boost::asio::ssl::context& ctx) : ws(strand, ctx) {}
+
+        Stream ws;
+        boost::beast::flat_buffer buffer;
+        boost::beast::websocket::response_type handshakeResponse;
+        std::deque<std::string> writes;
+        bool writing = false;
+        bool reading = false;
+        bool pinging = false;
+        int64_t awaitingPongNs = 0;  // Send time of the oldest unanswered timed ping, or 0
+    };
+    using SessionPtr = std::shared_ptr<Session>;
+
+    WsConnection(boost::asio::io_context& ioc, boost::asio::ssl::context& ctx, Options options,
+                 std::shared_ptr<spdlog::logger> logger);
+
+    void connectSession(bool standby);
+    void connectEndpoint(const SessionPtr& session, bool standby,
+                         boost::asio::ip::tcp::resolver::results_type::const_iterator endpoint);
+    void handshake(const SessionPtr& session, bool standby);
+    void recordRxLatency(Session& session);
+    void onSessionReady(const SessionPtr& session, bool standby);
+    void onAttemptFailed(bool standby, const char* stage, const boost::beast::error_code& ec);
+    void onSessionLost(const SessionPtr& session, const boost::beast::error_code& ec);
+    void activate(SessionPtr session);
+    void readLoop(const SessionPtr& session);
+    void writeLoop(const SessionPtr& session);
+    void schedulePing();
+    void sendPing();
+    void onPong(Session& session, std::string_view payload);
+    // Counts a slow round trip, or resets the count; fails over once there are enough
+    void checkRoundTrip(int64_t roundTripNs);
+    void failOver(int64_t roundTripNs);
+    void notifyLost();
+    void scheduleReconnect();
+    void scheduleStandby();
+    void cacheTlsSession(Session& session);
+    void doClose();
+    void setState(State state);
+    std::chrono::milliseconds backoffDelay(unsigned attempt);
+
+    boost::asio::io_context& ioc_;
+    boost::asio::ssl::context& ctx_;
+    Options options_;
+    std::shared_ptr<spdlog::logger> logger_;
+    Strand strand_;
+    boost::asio::ip::tcp::resolver resolver_;
+    boost::asio::ip::tcp::resolver::results_type endpoints_;
+    boost::asio::steady_timer reconnectTimer_;
+    boost::asio::steady_timer standbyTimer_;
+    boost::asio::steady_timer pingTimer_;
+    std::shared_ptr<SSL_SESSION> tlsSession_;
+    std::minstd_rand rng_;
+
+    // Strand-only state
+    SessionPtr active_;
+    SessionPtr standby_;
+    bool connecting_ = false;
+    bool standbyConnecting_ = false;
+    bool closed_ = false;
+    unsigned attempts_ = 0;
+    unsigned standbyAttempts_ = 0;
+    FrameHandler frameHandler_;
+    OpenHandler openHandler_;
+    LostHandler lostHandler_;
+    RoundTripHandler roundTripHandler_;
+    unsigned slowRoundTrips_ = 0;
+
+    std::atomic<State> state_{State::Idle};
+    std::mutex stateMutex_;
+    std::condition_variable stateChanged_;
+
+    std::atomic<uint64_t> opens_{0};
+    std::atomic<uint64_t> failures_{0};
+    std::atomic<uint64_t> promotions_{0};
+    std::atomic<uint64_t> resumedHandshakes_{0};
+    std::atomic<uint64_t> resolves_{0};
+    std::atomic<uint64_t> compressedSessions_{0};
+    std::atomic<uint64_t> rxSamples_{0};
+    std::atomic<int64_t> rxLatencyTotalNs_{0};
+    std::atomic<int64_t> rxLatencyMaxNs_{0};
+    std::atomic<uint64_t> pings_{0};
+    std::atomic<uint64_t> pongs_{0};
+    std::atomic<int64_t> lastRoundTripNs_{0};
+    std::atomic<int64_t> minRoundTripNs_{0};
+    std::atomic<uint64_t> slowFailovers_{0};
+
+    // Written only on the strand, so a load and a store stand in for a locked increment
+    std::atomic<uint64_t> frames_{0};
+    std::atomic<uint64_t> bytes_{0};
+    std::atomic<int64_t> lastFrameNs_{0};
+    std::atomic<int64_t> lastLoopLagNs_{0};
+    std::atomic<int64_t> maxLoopLagNs_{0};
+    // Round trips not yet fed to the histogram; at ping rates publishMetrics() keeps ahead
+    static constexpr std::size_t kRoundTripRing = 64;
+    std::array<std::atomic<int64_t>, kRoundTripRing> roundTripRing_{};
+    std::atomic<uint64_t> roundTripsWritten_{0};
+
+    // Where the previous publishMetrics() left off
+    mutable std::mutex publishMutex_;
+    mutable uint64_t publishedRoundTrips_ = 0;
+    mutable uint64_t publishedFrames_ = 0;
+    mutable uint64_t publishedBytes_ = 0;
+    mutable int64_t publishedNs_ = 0;
+};
+
+} // namespace crypto_hft
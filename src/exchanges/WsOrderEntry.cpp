@@ -0,0 +1,622 @@
+#include "WsOrderEntry.hpp"
+#include "JsonScan.hpp"
+#include "OrderSigning.hpp"
+#include <boost/asio/error.hpp>
+#include <boost/asio/post.hpp>
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace crypto_hft {
+
+namespace net = boost::asio;
+using namespace OrderSigning;
+using JsonScan::ArrayReader;
+using JsonScan::ObjectReader;
+
+namespace {
+
+void complete(WsOrderEntry::Callback& callback, OrderAck ack) {
+    if (callback) {
+        callback(std::move(ack));
+    }
+}
+
+OrderAck failed(boost::system::error_code error) {
+    OrderAck ack;
+    ack.error = error;
+    return ack;
+}
+
+} // namespace
+
+WsOrderEntry::WsOrderEntry(net::io_context& ioc, net::ssl::context& ctx, Options options,
+                           std::shared_ptr<spdlog::logger> logger)
+    : logger_(logger ? std::move(logger) : spdlog::default_logger())
+    , options_(std::move(options))
+    , ioc_(ioc)
+    , strand_(net::make_strand(ioc))
+    , deadlineTimer_(std::make_shared<net::steady_timer>(strand_))
+    , requests_(options_.maxInFlight) {
+    WsConnection::Options connection;
+    connection.host = options_.host;
+    connection.port = options_.port;
+    connection.target = options_.target;
+    connection.backoffInitial = options_.backoffInitial;
+    connection.profile = options_.profile;
+    connection_ = WsConnection::create(ioc, ctx, connection, logger_);
+    connection_->setFrameHandler([this](std::string_view frame) { onFrame(frame); });
+    connection_->setLostHandler([this](WsConnection&) { onLost(); });
+
+    // Client order ids must not repeat across restarts within the venue's lookback
+    clientIdBase_ = options_.clientIdPrefix + "-" + std::to_string(nowMs()) + "-";
+}
+
+WsOrderEntry::~WsOrderEntry() {
+    shutdown();
+}
+
+void WsOrderEntry::start() {
+    connection_->start();
+    if (options_.responseTimeout > std::chrono::milliseconds::zero()) {
+        net::post(strand_, [this] { scheduleDeadlines(); });
+    }
+}
+
+void WsOrderEntry::shutdown() {
+    connection_->shutdown();
+    stopDeadlines();
+    std::vector<Pending> pending;
+    {
+        std::lock_guard<std::mutex> lock(requestsMutex_);
+        requests_.drain([&](uint64_t, Pending entry) { pending.push_back(std::move(entry)); });
+    }
+    for (auto& entry : pending) {
+        complete(entry.callback, failed(net::error::operation_aborted));
+    }
+}
+
+std::size_t WsOrderEntry::inFlight() const {
+    std::lock_guard<std::mutex> lock(requestsMutex_);
+    return requests_.size();
+}
+
+std::size_t WsOrderEntry::openOrders() const {
+    std::lock_guard<std::mutex> lock(ordersMutex_);
+    return orders_.size();
+}
+
+template <typename Encode>
+void WsOrderEntry::send(Encode&& encode, Callback callback, bool limited) {
+    if (!connection_->isOpen()) {
+        complete(callback, failed(net::error::not_connected));
+        return;
+    }
+    if (limited && options_.limiter &&
+        options_.limiter->tryAcquire(1.0) > RateLimiter::Clock::duration::zero()) {
+        complete(callback, failed(net::error::try_again));
+        return;
+    }
+    Pending pending{std::move(callback), Clock::now()};
+    std::optional<uint64_t> id;
+    {
+        std::lock_guard<std::mutex> lock(requestsMutex_);
+        id = requests_.insert(std::move(pending));
+    }
+    if (!id) {
+        complete(pending.callback, failed(net::error::no_buffer_space));
+        return;
+    }
+    connection_->send(encode(*id), [this, id = *id](bool queued) { onQueued(id, queued); });
+}
+
+void WsOrderEntry::onQueued(uint64_t id, bool queued) {
+    std::optional<Pending> dropped;
+    {
+        std::lock_guard<std::mutex> lock(requestsMutex_);
+        if (queued) {
+            if (Pending* pending = requests_.find(id)) {
+                pending->queued = true;
+            }
+            return;
+        }
+        dropped = requests_.take(id);
+    }
+    // The session closed between the check in send() and the strand getting to the frame
+    if (dropped) {
+        complete(dropped->callback, failed(net::error::not_connected));
+    }
+}
+
+void WsOrderEntry::onLost() {
+    // Runs on the strand, so queued is settled for everything sent on the failed session;
+    // requests still on their way to the strand go out on the next one or are dropped
+    std::vector<Pending> lost;
+    {
+        std::lock_guard<std::mutex> lock(requestsMutex_);
+        requests_.drainIf([](const Pending& pending) { return pending.queued; },
+                          [&](uint64_t, Pending entry) { lost.push_back(std::move(entry)); });
+    }
+    if (!lost.empty()) {
+        logger_->warn("{} order requests to {} lost with their session", lost.size(),
+                      options_.host);
+    }
+    for (auto& entry : lost) {
+        complete(entry.callback, failed(net::error::connection_aborted));
+    }
+}
+
+void WsOrderEntry::scheduleDeadlines() {
+    if (!deadlineTimer_) {
+        return;
+    }
+    deadlineTimer_->expires_after(options_.responseTimeout / 2);
+    deadlineTimer_->async_wait(
+        [this, timer = std::weak_ptr<net::steady_timer>(deadlineTimer_)](
+            const boost::system::error_code& ec) {
+            // An expired timer means shutdown() has run and this may be gone
+            if (ec || timer.expired()) {
+                return;
+            }
+            expireRequests();
+            scheduleDeadlines();
+        });
+}
+
+void WsOrderEntry::expireRequests() {
+    const Clock::time_point cutoff = Clock::now() - options_.responseTimeout;
+    std::vector<Pending> expired;
+    {
+        std::lock_guard<std::mutex> lock(requestsMutex_);
+        requests_.drainIf([&](const Pending& pending) { return pending.start <= cutoff; },
+                          [&](uint64_t, Pending entry) { expired.push_back(std::move(entry)); });
+    }
+    if (!expired.empty()) {
+        logger_->warn("{} order requests to {} unanswered after {} ms", expired.size(),
+                      options_.host, options_.responseTimeout.count());
+    }
+    for (auto& entry : expired) {
+        complete(entry.callback, failed(net::error::timed_out));
+    }
+}
+
+void WsOrderEntry::stopDeadlines() {
+    auto stop = [this] {
+        if (deadlineTimer_) {
+            deadlineTimer_->cancel();
+            deadlineTimer_.reset();
+        }
+    };
+    // As in WsConnection::shutdown(): on the context's own thread no tick can run concurrently
+    if (ioc_.get_executor().running_in_this_thread() || ioc_.stopped()) {
+        stop();
+        return;
+    }
+    std::promise<void> done;
+    net::post(strand_, [&] {
+        stop();
+        done.set_value();
+    });
+    done.get_future().wait();
+}
+
+void WsOrderEntry::onFrame(std::string_view frame) {
+    OrderAck ack;
+    std::optional<uint64_t> id = parseResponse(frame, ack);
+    if (!id) {
+        return;
+    }
+    std::optional<Pending> pending;
+    {
+        std::lock_guard<std::mutex> lock(requestsMutex_);
+        pending = requests_.take(*id);
+    }
+    if (!pending) {
+        logger_->debug("Response from {} to unknown request {}", options_.host, *id);
+        return;
+    }
+    ack.latency = Clock::now() - pending->start;
+    complete(pending->callback, std::move(ack));
+}
+
+void WsOrderEntry::submit(const OrderRequest& order, Callback callback) {
+    send([&](uint64_t id) { return encodeSubmit(id, order); }, std::move(callback), true);
+}
+
+void WsOrderEntry::cancel(const std::string& symbol, const std::string& orderId,
+                          Callback callback) {
+    send([&](uint64_t id) { return encodeCancel(id, symbol, orderId); }, std::move(callback),
+         false);
+}
+
+void WsOrderEntry::modify(const std::string& orderId, const OrderRequest& replacement,
+                          Callback callback) {
+    send([&](uint64_t id) { return encodeModify(id, orderId, replacement); },
+         std::move(callback), true);
+}
+
+std::future<OrderAck> WsOrderEntry::submit(const OrderRequest& order) {
+    auto promise = std::make_shared<std::promise<OrderAck>>();
+    submit(order, [promise](OrderAck ack) { promise->set_value(std::move(ack)); });
+    return promise->get_future();
+}
+
+std::future<OrderAck> WsOrderEntry::cancel(const std::string& symbol,
+                                           const std::string& orderId) {
+    auto promise = std::make_shared<std::promise<OrderAck>>();
+    cancel(symbol, orderId, [promise](OrderAck ack) { promise->set_value(std::move(ack)); });
+    return promise->get_future();
+}
+
+std::future<OrderAck> WsOrderEntry::modify(const std::string& orderId,
+                                           const OrderRequest& replacement) {
+    auto promise = std::make_shared<std::promise<OrderAck>>();
+    modify(orderId, replacement,
+           [promise](OrderAck ack) { promise->set_value(std::move(ack)); });
+    return promise->get_future();
+}
+
+// Adapter order management
+
+void WsOrderEntry::setExecutionHandler(ExecutionHandler handler) {
+    executionHandler_ = std::move(handler);
+}
+
+void WsOrderEntry::report(const std::string& clientOrderId, const std::string& orderId,
+                          utils::OrderStatus status) {
+    if (!executionHandler_) {
+        return;
+    }
+    OrderResponse response;
+    response.orderId = orderId;
+    response.clientOrderId = clientOrderId;
+    response.status = status;
+    response.filledAmount = 0.0;
+    response.fillPrice = 0.0;
+    response.timestamp = nowMs();
+    executionHandler_(response);
+}
+
+// Called with ordersMutex_ held
+void WsOrderEntry::forgetOrder(const std::string& clientOrderId) {
+    auto it = orders_.find(clientOrderId);
+    if (it == orders_.end()) {
+        return;
+    }
+    orderAge_.erase(it->second.submitted);
+    orders_.erase(it);
+}
+
+std::string WsOrderEntry::submitOrder(const OrderRequest& request) {
+    if (!isOpen()) {
+        return "";
+    }
+    OrderRequest order = request;
+    if (order.clientOrderId.empty()) {
+        order.clientOrderId = clientIdBase_ +
+            std::to_string(nextClientId_.fetch_add(1, std::memory_order_relaxed) + 1);
+    }
+    std::string clientOrderId = order.clientOrderId;
+    {
+        std::lock_guard<std::mutex> lock(ordersMutex_);
+        forgetOrder(clientOrderId);
+        // Fills are not tracked, so the oldest orders make room whether or not they are live
+        const std::size_t limit = std::max<std::size_t>(options_.maxOpenOrders, 1);
+        while (!orderAge_.empty() && orders_.size() >= limit) {
+            forgetOrder(orderAge_.begin()->second);
+        }
+        const uint64_t submitted = nextSubmitted_++;
+        orders_[clientOrderId] = OpenOrder{order, "", submitted};
+        orderAge_.emplace(submitted, clientOrderId);
+    }
+
+    submit(order, [this, clientOrderId](OrderAck ack) {
+        if (ack.ok()) {
+            {
+                std::lock_guard<std::mutex> lock(ordersMutex_);
+                auto it = orders_.find(clientOrderId);
+                if (it != orders_.end()) {
+                    it->second.orderId = ack.orderId;
+                }
+            }
+            report(clientOrderId, ack.orderId, utils::OrderStatus::NEW);
+            return;
+        }
+        {
+            // Without the venue's order id it could not be cancelled or modified anyway
+            std::lock_guard<std::mutex> lock(ordersMutex_);
+            forgetOrder(clientOrderId);
+        }
+        // Lost in transit or unanswered is not rejected: the order may be live at the venue
+        if (ack.error == net::error::connection_aborted || ack.error == net::error::timed_out) {
+            logger_->error("Order {} to {} {}; its state is unknown", clientOrderId,
+                           options_.host,
+                           ack.error == net::error::timed_out ? "went unanswered"
+                                                              : "lost in transit");
+            return;
+        }
+        logger_->warn("Order {} rejected by {}: {}", clientOrderId, options_.host,
+                      ack.error ? ack.error.message() : ack.message);
+        report(clientOrderId, "", utils::OrderStatus::REJECTED);
+    });
+    return clientOrderId;
+}
+
+bool WsOrderEntry::cancelOrder(const std::string& clientOrderId) {
+    OpenOrder order;
+    {
+        std::lock_guard<std::mutex> lock(ordersMutex_);
+        auto it = orders_.find(clientOrderId);
+        if (it == orders_.end() || it->second.orderId.empty()) {
+            return false;
+        }
+        order = it->second;
+    }
+    if (!isOpen()) {
+        return false;
+    }
+
+    cancel(order.request.symbol, order.orderId,
+        [this, clientOrderId, orderId = order.orderId](OrderAck ack) {
+            if (!ack.ok()) {
+                logger_->warn("Cancel of {} refused by {}: {}", clientOrderId, options_.host,
+                              ack.error ? ack.error.message() : ack.message);
+                return;
+            }
+            {
+                std::lock_guard<std::mutex> lock(ordersMutex_);
+                forgetOrder(clientOrderId);
+            }
+            report(clientOrderId, orderId, utils::OrderStatus::CANCELED);
+        });
+    return true;
+}
+
+bool WsOrderEntry::modifyOrder(const std::string& clientOrderId, double newPrice,
+                               double newSize) {
+    OpenOrder order;
+    {
+        std::lock_guard<std::mutex> lock(ordersMutex_);
+        auto it = orders_.find(clientOrderId);
+        if (it == orders_.end() || it->second.orderId.empty()) {
+            return false;
+        }
+        order = it->second;
+    }
+    if (!isOpen()) {
+        return false;
+    }
+
+    OrderRequest replacement = order.request;
+    replacement.type = OrderRequest::Type::LIMIT;
+    replacement.price = newPrice;
+    replacement.size = newSize;
+    // The venue names the replacement; it stays tracked under the original client order id
+    replacement.clientOrderId.clear();
+    modify(order.orderId, replacement, [this, clientOrderId, replacement](OrderAck ack) {
+        if (!ack.ok()) {
+            logger_->warn("Modify of {} refused by {}: {}", clientOrderId, options_.host,
+                          ack.error ? ack.error.message() : ack.message);
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(ordersMutex_);
+            auto it = orders_.find(clientOrderId);
+            if (it != orders_.end()) {
+                it->second.request.price = replacement.price;
+                it->second.request.size = replacement.size;
+                if (!ack.orderId.empty()) {
+                    it->second.orderId = ack.orderId;
+                }
+            }
+        }
+        report(clientOrderId, ack.orderId, utils::OrderStatus::NEW);
+    });
+    return true;
+}
+
+// Binance
+
+namespace {
+
+// Reads the order fields of a result, descending into cancelReplace's newOrderResponse
+void readBinanceOrder(std::string_view object, OrderAck& ack) {
+    ObjectReader order(object);
+    std::string_view key;
+    std::string_view value;
+    while (order.next(key, value)) {
+        if (key == "newOrderResponse") {
+            readBinanceOrder(value, ack);
+            return;
+        } else if (key == "orderId") {
+            ack.orderId = JsonScan::unquote(value);
+        } else if (key == "clientOrderId" ||
+                   (key == "origClientOrderId" && ack.clientOrderId.empty())) {
+            ack.clientOrderId = JsonScan::unquote(value);
+        }
+    }
+}
+
+} // namespace
+
+WsOrderEntry::Options BinanceWsOrderEntry::defaults() {
+    Options options;
+    options.host = "ws-api.binance.com";
+    options.port = "443";
+    options.target = "/ws-api/v3";
+    return options;
+}
+
+BinanceWsOrderEntry::BinanceWsOrderEntry(net::io_context& ioc, net::ssl::context& ctx,
+                                         Credentials credentials, Options options,
+                                         std::shared_ptr<spdlog::logger> logger,
+                                         int recvWindowMs)
+    : WsOrderEntry(ioc, ctx, std::move(options), std::move(logger))
+    , messages_(std::move(credentials.apiKey), credentials.apiSecret, recvWindowMs) {}
+
+BinanceWsOrderEntry::~BinanceWsOrderEntry() {
+    // Before the overrides the frame handler calls into are gone
+    shutdown();
+}
+
+std::string BinanceWsOrderEntry::encodeSubmit(uint64_t id, const OrderRequest& order) {
+    std::string request;
+    messages_.place(id, order, nowMs(), request);
+    return request;
+}
+
+std::string BinanceWsOrderEntry::encodeCancel(uint64_t id, const std::string& symbol,
+                                              const std::string& orderId) {
+    std::string request;
+    messages_.cancel(id, symbol, orderId, nowMs(), request);
+    return request;
+}
+
+std::string BinanceWsOrderEntry::encodeModify(uint64_t id, const std::string& orderId,
+                                              const OrderRequest& replacement) {
+    std::string request;
+    messages_.cancelReplace(id, orderId, replacement, nowMs(), request);
+    return request;
+}
+
+std::optional<uint64_t> BinanceWsOrderEntry::parseResponse(std::string_view frame,
+                                                           OrderAck& ack) const {
+    // {"id":..,"status":..,"result":{...}} or {"id":..,"status":..,"error":{"code":..,"msg":..}}
+    uint64_t id = 0;
+    bool hasId = false;
+    uint64_t status = 0;
+    std::string_view result;
+    std::string_view error;
+
+    ObjectReader message(frame);
+    std::string_view key;
+    std::string_view value;
+    while (message.next(key, value)) {
+        if (key == "id") {
+            hasId = JsonScan::toUint(value, id);
+        } else if (key == "status") {
+            JsonScan::toUint(value, status);
+        } else if (key == "result") {
+            result = value;
+        } else if (key == "error") {
+            error = value;
+        }
+    }
+    if (!hasId) {
+        return std::nullopt;
+    }
+    ack.status = static_cast<unsigned>(status);
+
+    if (!error.empty()) {
+        ObjectReader reason(error);
+        while (reason.next(key, value)) {
+            if (key == "msg") {
+                ack.message = JsonScan::unquote(value);
+            }
+        }
+        if (ack.message.empty()) {
+            ack.message = error;
+        }
+        return id;
+    }
+    if (result.empty() || result.front() != '{') {
+        ack.message = frame;
+        return id;
+    }
+    ack.accepted = status == 0 || (status >= 200 && status < 300);
+    readBinanceOrder(result, ack);
+    return id;
+}
+
+// Kraken
+
+WsOrderEntry::Options KrakenWsOrderEntry::defaults() {
+    Options options;
+    options.host = "ws-auth.kraken.com";
+    options.port = "443";
+    options.target = "/";
+    return options;
+}
+
+KrakenWsOrderEntry::KrakenWsOrderEntry(net::io_context& ioc, net::ssl::context& ctx,
+                                       Options options, std::shared_ptr<spdlog::logger> logger)
+    : WsOrderEntry(ioc, ctx, std::move(options), std::move(logger)) {}
+
+KrakenWsOrderEntry::~KrakenWsOrderEntry() {
+    // Before the overrides the frame handler calls into are gone
+    shutdown();
+}
+
+void KrakenWsOrderEntry::setToken(std::string token) {
+    std::lock_guard<std::mutex> lock(tokenMutex_);
+    token_ = std::move(token);
+}
+
+std::string KrakenWsOrderEntry::encodeSubmit(uint64_t id, const OrderRequest& order) {
+    std::string request;
+    std::lock_guard<std::mutex> lock(tokenMutex_);
+    messages_.place(id, order, token_, request);
+    return request;
+}
+
+std::string KrakenWsOrderEntry::encodeCancel(uint64_t id, const std::string&,
+                                             const std::string& orderId) {
+    std::string request;
+    std::lock_guard<std::mutex> lock(tokenMutex_);
+    messages_.cancel(id, orderId, token_, request);
+    return request;
+}
+
+std::string KrakenWsOrderEntry::encodeModify(uint64_t id, const std::string& orderId,
+                                             const OrderRequest& replacement) {
+    std::string request;
+    std::lock_guard<std::mutex> lock(tokenMutex_);
+    messages_.edit(id, orderId, replacement, token_, request);
+    return request;
+}
+
+std::optional<uint64_t> KrakenWsOrderEntry::parseResponse(std::string_view frame,
+                                                          OrderAck& ack) const {
+    // Heartbeats and status messages carry no reqid
+    uint64_t id = 0;
+    bool hasId = false;
+    std::string_view status;
+    std::string_view txid;
+    std::string_view errorMessage;
+
+    ObjectReader message(frame);
+    std::string_view key;
+    std::string_view value;
+    while (message.next(key, value)) {
+        if (key == "reqid") {
+            hasId = JsonScan::toUint(value, id);
+        } else if (key == "status") {
+            status = JsonScan::unquote(value);
+        } else if (key == "txid") {
+            txid = value;
+        } else if (key == "errorMessage") {
+            errorMessage = JsonScan::unquote(value);
+        }
+    }
+    if (!hasId) {
+        return std::nullopt;
+    }
+
+    ack.accepted = status == "ok";
+    if (!ack.accepted) {
+        ack.message = errorMessage.empty() ? frame : errorMessage;
+        return id;
+    }
+    if (!txid.empty() && txid.front() == '[') {
+        ArrayReader ids(txid);
+        std::string_view first;
+        if (ids.next(first)) {
+            ack.orderId = JsonScan::unquote(first);
+        }
+    } else {
+        ack.orderId = JsonScan::unquote(txid);
+    }
+    return id;
+}
+
+} // namespace crypto_hft
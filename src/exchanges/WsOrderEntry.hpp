@@ -0,0 +1,216 @@
+#pragma once
+
+#include "IExchangeAdapter.hpp"
+#include "OrderEntry.hpp"
+#include "OrderTemplate.hpp"
+#include "RateLimiter.hpp"
+#include "WsConnection.hpp"
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ssl.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/strand.hpp>
+#include <spdlog/spdlog.h>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace crypto_hft {
+
+// Order entry over a venue's authenticated websocket API: one persistent session of its own,
+// apart from the market data connections, on which every request is a single frame. Requests
+// carry an id from a RequestTable and responses are matched to them by that id, so they may
+// complete in any order. A request the session failed under completes with connection_aborted,
+// and one left unanswered for responseTimeout with timed_out; either way its fate at the venue
+// is unknown and it is never sent again. Thread-safe; callbacks run on the connection's strand,
+// on the entry's own strand for timeouts, or on the calling thread when a request cannot be
+// sent at all.
+class WsOrderEntry {
+public:
+    struct Options {
+        std::string host;
+        std::string port = "443";
+        std::string target = "/";
+        std::size_t maxInFlight = 1024;  // Requests awaiting a response
+        // How long a request may wait for its response; it fails within half as long again.
+        // 0 waits for ever.
+        std::chrono::milliseconds responseTimeout{10000};
+        std::string clientIdPrefix = "hft";  // For the client order ids submitOrder() makes up
+        std::size_t maxOpenOrders = 4096;  // Orders submitOrder() keeps for cancel and modify
+        std::chrono::milliseconds backoffInitial{100};
+        ConnectionProfile profile;
+        // The venue's order rate limit, e.g. RateLimiter::fromYaml(node, "max_orders"). Orders
+        // and replacements spend 1 each; cancels are never held back.
+        std::shared_ptr<RateLimiter> limiter;
+    };
+    struct Credentials {
+        std::string apiKey;
+        std::string apiSecret;
+    };
+    using Callback = std::function<void(OrderAck)>;
+    using ExecutionHandler = std::function<void(const OrderResponse&)>;
+
+    virtual ~WsOrderEntry();
+
+    WsOrderEntry(const WsOrderEntry&) = delete;
+    WsOrderEntry& operator=(const WsOrderEntry&) = delete;
+
+    // Opens the session and keeps reconnecting until shutdown()
+    void start();
+    // Closes the session and fails every outstanding request with operation_aborted
+    void shutdown();
+    bool isOpen() const { return connection_->isOpen(); }
+    bool waitForOpen(std::chrono::milliseconds timeout) { return connection_->waitForOpen(timeout); }
+
+    // Requests fail at once with not_connected while no session is open, with try_again when
+    // they would exceed the order rate limit, and with no_buffer_space while maxInFlight are
+    // awaiting a response
+    void submit(const OrderRequest& order, Callback callback);
+    std::future<OrderAck> submit(const OrderRequest& order);
+    // Binance identifies orders per symbol; Kraken ignores it
+    void cancel(const std::string& symbol, const std::string& orderId, Callback callback);
+    std::future<OrderAck> cancel(const std::string& symbol, const std::string& orderId);
+    // Replaces the order's price and size; replacement carries the order's symbol and side
+    void modify(const std::string& orderId, const OrderRequest& replacement, Callback callback);
+    std::future<OrderAck> modify(const std::string& orderId, const OrderRequest& replacement);
+
+    // IExchangeAdapter's order management. Orders are tracked by client order id from submission
+    // until they are cancelled or rejected, and every ack is reported to the execution handler:
+    // NEW when an order or its replacement is accepted, REJECTED, CANCELED. Fills are not
+    // tracked: the venue's execution reports are not subscribed to, so a filled order is never
+    // reported and stays tracked until maxOpenOrders newer ones push it out, oldest first. An
+    // order lost in transit or left unanswered, its state unknown, is forgotten. submitOrder()
+    // returns the order's client order id, made up when the request has none, or an empty
+    // string when no session is open. cancelOrder() and modifyOrder() take that id and return
+    // false until the venue has acked the order. Set the handler before start().
+    void setExecutionHandler(ExecutionHandler handler);
+    std::string submitOrder(const OrderRequest& request);
+    bool cancelOrder(const std::string& clientOrderId);
+    bool modifyOrder(const std::string& clientOrderId, double newPrice, double newSize);
+
+    std::size_t inFlight() const;
+    std::size_t openOrders() const;
+    WsConnection::Stats getConnectionStats() const { return connection_->getStats(); }
+
+protected:
+    WsOrderEntry(boost::asio::io_context& ioc, boost::asio::ssl::context& ctx, Options options,
+                 std::shared_ptr<spdlog::logger> logger);
+
+    // One request frame carrying id
+    virtual std::string encodeSubmit(uint64_t id, const OrderRequest& order) = 0;
+    virtual std::string encodeCancel(uint64_t id, const std::string& symbol,
+                                     const std::string& orderId) = 0;
+    virtual std::string encodeModify(uint64_t id, const std::string& orderId,
+                                     const OrderRequest& replacement) = 0;
+    // The id of the request a frame answers, with accepted, orderId, clientOrderId and message
+    // filled in; nullopt for frames that answer no request
+    virtual std::optional<uint64_t> parseResponse(std::string_view frame,
+                                                  OrderAck& ack) const = 0;
+
+    std::shared_ptr<spdlog::logger> logger_;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Pending {
+        Callback callback;
+        Clock::time_point start{};
+        bool queued = false;  // Handed to the session, so lost with it if it fails
+    };
+
+    // An order from submission until it is cancelled, rejected, lost or evicted
+    struct OpenOrder {
+        OrderRequest request;
+        std::string orderId;  // The venue's id, once acked
+        uint64_t submitted = 0;  // Its key in orderAge_
+    };
+
+    template <typename Encode>
+    void send(Encode&& encode, Callback callback, bool limited);
+    void onQueued(uint64_t id, bool queued);
+    void onFrame(std::string_view frame);
+    void onLost();
+    void scheduleDeadlines();
+    void expireRequests();
+    void stopDeadlines();
+    void report(const std::string& clientOrderId, const std::string& orderId,
+                utils::OrderStatus status);
+    void forgetOrder(const std::string& clientOrderId);
+
+    Options options_;
+    boost::asio::io_context& ioc_;
+    std::shared_ptr<WsConnection> connection_;
+    // Checks responseTimeout; reset on the strand by shutdown(), which a late tick sees
+    boost::asio::strand<boost::asio::io_context::executor_type> strand_;
+    std::shared_ptr<boost::asio::steady_timer> deadlineTimer_;
+
+    mutable std::mutex requestsMutex_;
+    RequestTable<Pending> requests_;
+
+    mutable std::mutex ordersMutex_;
+    std::unordered_map<std::string, OpenOrder> orders_;
+    std::map<uint64_t, std::string> orderAge_;  // Client order ids by submission, oldest first
+    uint64_t nextSubmitted_ = 0;
+    std::string clientIdBase_;
+    std::atomic<uint64_t> nextClientId_{0};
+    ExecutionHandler executionHandler_;
+};
+
+// Binance WebSocket API (order.place, order.cancel, order.cancelReplace), every request signed
+// with HMAC-SHA256 over its parameters and rendered from BinanceOrderMessages' templates
+class BinanceWsOrderEntry final : public WsOrderEntry {
+public:
+    static Options defaults();
+
+    BinanceWsOrderEntry(boost::asio::io_context& ioc, boost::asio::ssl::context& ctx,
+                        Credentials credentials, Options options = defaults(),
+                        std::shared_ptr<spdlog::logger> logger = nullptr,
+                        int recvWindowMs = 5000);
+    ~BinanceWsOrderEntry() override;
+
+private:
+    std::string encodeSubmit(uint64_t id, const OrderRequest& order) override;
+    std::string encodeCancel(uint64_t id, const std::string& symbol,
+                             const std::string& orderId) override;
+    std::string encodeModify(uint64_t id, const std::string& orderId,
+                             const OrderRequest& replacement) override;
+    std::optional<uint64_t> parseResponse(std::string_view frame, OrderAck& ack) const override;
+
+    BinanceOrderMessages messages_;
+};
+
+// Kraken's authenticated websocket (addOrder, cancelOrder, editOrder), each request carrying
+// the session token from GetWebSocketsToken
+class KrakenWsOrderEntry final : public WsOrderEntry {
+public:
+    static Options defaults();
+
+    KrakenWsOrderEntry(boost::asio::io_context& ioc, boost::asio::ssl::context& ctx,
+                       Options options = defaults(),
+                       std::shared_ptr<spdlog::logger> logger = nullptr);
+    ~KrakenWsOrderEntry() override;
+
+    // Requests sent from now on carry token; see KrakenRestOrderEntry::getWebSocketsToken()
+    void setToken(std::string token);
+
+private:
+    std::string encodeSubmit(uint64_t id, const OrderRequest& order) override;
+    std::string encodeCancel(uint64_t id, const std::string& symbol,
+                             const std::string& orderId) override;
+    std::string encodeModify(uint64_t id, const std::string& orderId,
+                             const OrderRequest& replacement) override;
+    std::optional<uint64_t> parseResponse(std::string_view frame, OrderAck& ack) const override;
+
+    KrakenOrderMessages messages_;
+    std::mutex tokenMutex_;  // Held while a request is rendered with token_
+    std::string token_;
+};
+
+} // namespace crypto_hft
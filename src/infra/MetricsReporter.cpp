@@ -0,0 +1,195 @@
+#include "MetricsReporter.hpp"
+#include <map>
+#include <spdlog/spdlog.h>
+
+namespace crypto_hft {
+
+namespace {
+
+prometheus::Labels toLabels(const std::unordered_map<std::string, std::string>& labels) {
+    return prometheus::Labels(labels.begin(), labels.end());
+}
+
+// Cache key: metric name followed by the labels in sorted order
+std::string metricKey(const std::string& name, const prometheus::Labels& labels) {
+    std::string key = name;
+    for (const auto& [k, v] : labels) {
+        key += '|';
+        key += k;
+        key += '=';
+        key += v;
+    }
+    return key;
+}
+
+// Exponential buckets from 1 to ~1e9, suitable for nanosecond and microsecond latencies
+prometheus::Histogram::BucketBoundaries defaultBuckets() {
+    prometheus::Histogram::BucketBoundaries buckets;
+    for (double bound = 1.0; bound < 2e9; bound *= 4.0) {
+        buckets.push_back(bound);
+    }
+    return buckets;
+}
+
+} // namespace
+
+MetricsReporter& MetricsReporter::getInstance() {
+    static MetricsReporter instance;
+    return instance;
+}
+
+void MetricsReporter::initialize(const std::string& host, int port) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (registry_) {
+        spdlog::warn("MetricsReporter already initialized");
+        return;
+    }
+
+    try {
+        registry_ = std::make_shared<prometheus::Registry>();
+        exposer_ = std::make_unique<prometheus::Exposer>(host + ":" + std::to_string(port));
+        exposer_->RegisterCollectable(registry_);
+        spdlog::info("Metrics exposed on {}:{}", host, port);
+    } catch (const std::exception& e) {
+        spdlog::error("Failed to start metrics exposer: {}", e.what());
+        exposer_.reset();
+    }
+}
+
+void MetricsReporter::incrementCounter(const std::string& name,
+                                       const std::unordered_map<std::string, std::string>& labels) {
+    addCounter(name, 1.0, labels);
+}
+
+void MetricsReporter::addCounter(const std::string& name,
+                                 double value,
+                                 const std::unordered_map<std::string, std::string>& labels) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (auto* counter = getOrCreateCounter(name, labels)) {
+        counter->Increment(value);
+    }
+}
+
+void MetricsReporter::setGauge(const std::string& name,
+                               double value,
+                               const std::unordered_map<std::string, std::string>& labels) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (auto* gauge = getOrCreateGauge(name, labels)) {
+        gauge->Set(value);
+    }
+}
+
+void MetricsReporter::incrementGauge(const std::string& name,
+                                     double value,
+                                     const std::unordered_map<std::string, std::string>& labels) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (auto* gauge = getOrCreateGauge(name, labels)) {
+        gauge->Increment(value);
+    }
+}
+
+void MetricsReporter::decrementGauge(const std::string& name,
+                                     double value,
+                                     const std::unordered_map<std::string, std::string>& labels) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (auto* gauge = getOrCreateGauge(name, labels)) {
+        gauge->Decrement(value);
+    }
+}
+
+std::optional<double> MetricsReporter::getGauge(
+    const std::string& name,
+    const std::unordered_map<std::string, std::string>& labels) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = gauges_.find(metricKey(name, toLabels(labels)));
+    if (it == gauges_.end()) {
+        return std::nullopt;
+    }
+    return it->second->Value();
+}
+
+void MetricsReporter::observeHistogram(const std::string& name,
+                                       double value,
+                                       const std::unordered_map<std::string, std::string>& labels) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (auto* histogram = getOrCreateHistogram(name, labels)) {
+        histogram->Observe(value);
+    }
+}
+
+MetricsReporter::ScopedTimer::ScopedTimer(MetricsReporter& reporter,
+                                          const std::string& name,
+                                          const std::unordered_map<std::string, std::string>& labels)
+    : reporter_(reporter)
+    , name_(name)
+    , labels_(labels)
+    , start_(std::chrono::steady_clock::now()) {
+}
+
+MetricsReporter::ScopedTimer::~ScopedTimer() {
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start_).count();
+    reporter_.observeHistogram(name_, static_cast<double>(elapsed), labels_);
+}
+
+MetricsReporter::ScopedTimer MetricsReporter::createTimer(
+    const std::string& name,
+    const std::unordered_map<std::string, std::string>& labels) {
+    return ScopedTimer(*this, name, labels);
+}
+
+prometheus::Counter* MetricsReporter::getOrCreateCounter(
+    const std::string& name,
+    const std::unordered_map<std::string, std::string>& labels) {
+    if (!registry_) {
+        return nullptr;
+    }
+    auto promLabels = toLabels(labels);
+    auto key = metricKey(name, promLabels);
+    auto it = counters_.find(key);
+    if (it != counters_.end()) {
+        return it->second;
+    }
+    auto& family = prometheus::BuildCounter().Name(name).Help(name).Register(*registry_);
+    auto* counter = &family.Add(promLabels);
+    counters_.emplace(key, counter);
+    return counter;
+}
+
+prometheus::Gauge* MetricsReporter::getOrCreateGauge(
+    const std::string& name,
+    const std::unordered_map<std::string, std::string>& labels) {
+    if (!registry_) {
+        return nullptr;
+    }
+    auto promLabels = toLabels(labels);
+    auto key = metricKey(name, promLabels);
+    auto it = gauges_.find(key);
+    if (it != gauges_.end()) {
+        return it->second;
+    }
+    auto& family = prometheus::BuildGauge().Name(name).Help(name).Register(*registry_);
+    auto* gauge = &family.Add(promLabels);
+    gauges_.emplace(key, gauge);
+    return gauge;
+}
+
+prometheus::Histogram* MetricsReporter::getOrCreateHistogram(
+    const std::string& name,
+    const std::unordered_map<std::string, std::string>& labels) {
+    if (!registry_) {
+        return nullptr;
+    }
+    auto promLabels = toLabels(labels);
+    auto key = metricKey(name, promLabels);
+    auto it = histograms_.find(key);
+    if (it != histograms_.end()) {
+        return it->second;
+    }
+    auto& family = prometheus::BuildHistogram().Name(name).Help(name).Register(*registry_);
+    auto* histogram = &family.Add(promLabels, defaultBuckets());
+    histograms_.emplace(key, histogram);
+    return histogram;
+}
+
+} // namespace crypto_hft
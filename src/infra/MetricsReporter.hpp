@@ -4,7 +4,10 @@
 #include <memory>
 #include <unordered_map>
 #include <chrono>
+#include <mutex>
+#include <optional>
 #include <prometheus/counter.h>
+#include <prometheus/exposer.h>
 #include <prometheus/gauge.h>
 #include <prometheus/histogram.h>
 #include <prometheus/registry.h>
@@ -42,6 +45,10 @@ public:
                          double value,
                          const std::unordered_map<std::string, std::string>& labels = {});
     
+    // The gauge's current value; nullopt if it has not been set since initialize()
+    std::optional<double> getGauge(const std::string& name,
+                                   const std::unordered_map<std::string, std::string>& labels = {});
+
     // Latency measurement
     class ScopedTimer {
     public:
@@ -68,22 +75,24 @@ private:
     MetricsReporter(const MetricsReporter&) = delete;
     MetricsReporter& operator=(const MetricsReporter&) = delete;
     
-    // Prometheus registry
+    // Prometheus registry and HTTP exposer
     std::shared_ptr<prometheus::Registry> registry_;
+    std::unique_ptr<prometheus::Exposer> exposer_;
+    std::mutex mutex_;
     
-    // Metric families
-    std::unordered_map<std::string, std::shared_ptr<prometheus::Counter>> counters_;
-    std::unordered_map<std::string, std::shared_ptr<prometheus::Gauge>> gauges_;
-    std::unordered_map<std::string, std::shared_ptr<prometheus::Histogram>> histograms_;
+    // Metric instances, keyed by name plus labels. Owned by their families in registry_.
+    std::unordered_map<std::string, prometheus::Counter*> counters_;
+    std::unordered_map<std::string, prometheus::Gauge*> gauges_;
+    std::unordered_map<std::string, prometheus::Histogram*> histograms_;
     
-    // Helper functions
-    std::shared_ptr<prometheus::Counter> getOrCreateCounter(
+    // Helper functions (return nullptr until initialize() has been called)
+    prometheus::Counter* getOrCreateCounter(
         const std::string& name,
         const std::unordered_map<std::string, std::string>& labels);
-    std::shared_ptr<prometheus::Gauge> getOrCreateGauge(
+    prometheus::Gauge* getOrCreateGauge(
         const std::string& name,
         const std::unordered_map<std::string, std::string>& labels);
-    std::shared_ptr<prometheus::Histogram> getOrCreateHistogram(
+    prometheus::Histogram* getOrCreateHistogram(
         const std::string& name,
         const std::unordered_map<std::string, std::string>& labels);
 };
@@ -0,0 +1,415 @@
+#include "ExchangeSimulator.hpp"
+#include "SelfSignedCertificate.hpp"
+#include <boost/asio/post.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/ssl.hpp>
+#include <boost/beast/websocket.hpp>
+#include <boost/beast/websocket/ssl.hpp>
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <fstream>
+#include <stdexcept>
+#include <type_traits>
+
+namespace crypto_hft {
+
+namespace net = boost::asio;
+namespace ssl = boost::asio::ssl;
+namespace beast = boost::beast;
+namespace websocket = boost::beast::websocket;
+using tcp = boost::asio::ip::tcp;
+
+namespace {
+
+// The symbols a venue's recorded corpus uses, for a simulator given none
+std::vector<SimSymbol> defaultSymbols(const std::string& venue) {
+    if (venue == "kraken") {
+        return {{"XBT/USD", 43000.0, 0.1}, {"ETH/USD", 2250.0, 0.01}};
+    }
+    if (venue == "coinbase") {
+        return {{"BTC-USD", 43000.0, 0.01}, {"ETH-USD", 2250.0, 0.01}};
+    }
+    return {{"BTCUSDT", 43000.0, 0.01}, {"ETHUSDT", 2250.0, 0.01}};
+}
+
+} // namespace
+
+// One client's websocket session, whatever the transport under it
+class ExchangeSimulator::Connection : public std::enable_shared_from_this<Connection> {
+public:
+    virtual ~Connection() = default;
+
+    virtual void start() = 0;
+    // Queues a text frame; frames go out in order, one write at a time
+    virtual void write(std::string frame) = 0;
+    virtual void close() = 0;
+
+    VenueProtocol::Session state;
+};
+
+// Next is the layer under the websocket: a TCP stream, or a TLS stream over one
+template <typename Next>
+class ExchangeSimulator::Session final : public Connection {
+public:
+    static constexpr bool kTls = !std::is_same_v<Next, beast::tcp_stream>;
+
+    template <typename... Args>
+    explicit Session(ExchangeSimulator& simulator, Args&&... args)
+        : simulator_(simulator)
+        , ws_(std::forward<Args>(args)...) {}
+
+    void start() override {
+        if constexpr (kTls) {
+            beast::get_lowest_layer(ws_).expires_after(std::chrono::seconds(30));
+            ws_.next_layer().async_handshake(ssl::stream_base::server,
+                [self = self()](beast::error_code ec) {
+                    if (!ec) {
+                        self->accept();
+                    }
+                });
+        } else {
+            accept();
+        }
+    }
+
+    void write(std::string frame) override {
+        if (closed_) {
+            return;
+        }
+        writes_.push_back(std::move(frame));
+        if (!writing_) {
+            writeNext();
+        }
+    }
+
+    void close() override {
+        closed_ = true;
+        beast::error_code ignored;
+        beast::get_lowest_layer(ws_).socket().close(ignored);
+    }
+
+private:
+    std::shared_ptr<Session> self() {
+        return std::static_pointer_cast<Session>(shared_from_this());
+    }
+
+    void accept() {
+        // The websocket keeps its own timeouts, and pings an idle client
+        beast::get_lowest_layer(ws_).expires_never();
+        ws_.set_option(websocket::stream_base::timeout::suggested(beast::role_type::server));
+        ws_.set_option(websocket::stream_base::decorator([](websocket::response_type& response) {
+            response.set(beast::http::field::server, "crypto-hft-exchange-simulator");
+        }));
+        ws_.text(true);
+        ws_.async_accept([self = self()](beast::error_code ec) {
+            if (ec) {
+                return;
+            }
+            self->simulator_.onOpen(self);
+            self->read();
+        });
+    }
+
+    void read() {
+        ws_.async_read(buffer_, [self = self()](beast::error_code ec, std::size_t) {
+            if (ec) {
+                self->closed_ = true;
+                self->simulator_.onClosed(self);
+                return;
+            }
+            std::string message = beast::buffers_to_string(self->buffer_.data());
+            self->buffer_.consume(self->buffer_.size());
+            self->simulator_.onMessage(self, std::move(message));
+            self->read();
+        });
+    }
+
+    void writeNext() {
+        writing_ = true;
+        ws_.async_write(net::buffer(writes_.front()),
+            [self = self()](beast::error_code ec, std::size_t) {
+                self->writes_.pop_front();
+                if (ec || self->writes_.empty()) {
+                    // A failed write ends the read too, which reports the session closed
+                    self->writing_ = false;
+                    return;
+                }
+                self->writeNext();
+            });
+    }
+
+    ExchangeSimulator& simulator_;
+    websocket::stream<Next> ws_;
+    beast::flat_buffer buffer_;
+    std::deque<std::string> writes_;
+    bool writing_ = false;
+    bool closed_ = false;
+};
+
+ExchangeSimulator::ExchangeSimulator(Options options)
+    : options_(std::move(options))
+    , ctx_(ssl::context::tls_server)
+    , acceptor_(ioc_, {net::ip::make_address(options_.address), options_.port})
+    , timer_(ioc_)
+    , rng_(options_.seed) {
+    if (options_.symbols.empty()) {
+        options_.symbols = defaultSymbols(options_.venue);
+    }
+    market_.symbols = options_.symbols;
+    protocol_ = VenueProtocol::create(options_.venue, market_, options_.binanceSecret);
+    if (!protocol_) {
+        throw std::invalid_argument("Unknown venue for the exchange simulator: " + options_.venue);
+    }
+    if (!options_.replayFile.empty()) {
+        std::ifstream file(options_.replayFile);
+        if (!file) {
+            throw std::runtime_error("Cannot read replay file " + options_.replayFile);
+        }
+        std::string line;
+        while (std::getline(file, line)) {
+            if (!line.empty()) {
+                replayFrames_.push_back(std::move(line));
+            }
+        }
+    }
+    if (options_.tls) {
+        certificatePem_ = useSelfSignedCertificate(ctx_, std::chrono::hours(24));
+    }
+    port_ = acceptor_.local_endpoint().port();
+
+    seedBooks();
+    accept();
+    if (options_.updatesPerSecond > 0.0) {
+        lastTick_ = Clock::now();
+        scheduleTick();
+    }
+}
+
+ExchangeSimulator::~ExchangeSimulator() {
+    stop();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void ExchangeSimulator::start() {
+    thread_ = std::thread([this] { run(); });
+}
+
+void ExchangeSimulator::run() {
+    ioc_.run();
+}
+
+void ExchangeSimulator::stop() {
+    if (stopped_.exchange(true)) {
+        return;
+    }
+    net::post(ioc_, [this] {
+        beast::error_code ignored;
+        acceptor_.close(ignored);
+        timer_.cancel();
+        for (const auto& connection : connections_) {
+            connection->close();
+        }
+        connections_.clear();
+        // Sessions still handshaking would otherwise keep the context running
+        ioc_.stop();
+    });
+}
+
+ExchangeSimulator::Stats ExchangeSimulator::getStats() const {
+    Stats stats;
+    stats.sessions = sessions_.load(std::memory_order_relaxed);
+    stats.messages = messages_.load(std::memory_order_relaxed);
+    stats.bookUpdates = bookUpdates_.load(std::memory_order_relaxed);
+    stats.framesSent = framesSent_.load(std::memory_order_relaxed);
+    stats.bytesSent = bytesSent_.load(std::memory_order_relaxed);
+    stats.orders = orders_.load(std::memory_order_relaxed);
+    stats.fills = fills_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void ExchangeSimulator::accept() {
+    acceptor_.async_accept([this](beast::error_code ec, tcp::socket socket) {
+        if (ec) {
+            return;  // Closed by stop()
+        }
+        // As a venue's servers do; otherwise Nagle holds back small frames
+        beast::error_code ignored;
+        socket.set_option(tcp::no_delay(true), ignored);
+        ConnectionPtr connection;
+        if (options_.tls) {
+            connection = std::make_shared<Session<beast::ssl_stream<beast::tcp_stream>>>(
+                *this, std::move(socket), ctx_);
+        } else {
+            connection = std::make_shared<Session<beast::tcp_stream>>(*this, std::move(socket));
+        }
+        connection->start();
+        accept();
+    });
+}
+
+void ExchangeSimulator::onOpen(const ConnectionPtr& connection) {
+    sessions_.fetch_add(1, std::memory_order_relaxed);
+    connections_.push_back(connection);
+    VenueProtocol::Frames frames;
+    protocol_->open(connection->state, frames);
+    send(*connection, frames);
+}
+
+void ExchangeSimulator::onMessage(const ConnectionPtr& connection, std::string message) {
+    messages_.fetch_add(1, std::memory_order_relaxed);
+    VenueProtocol::Frames frames;
+    protocol_->onMessage(connection->state, message, frames);
+    send(*connection, frames);
+    orders_.store(protocol_->orders(), std::memory_order_relaxed);
+    fills_.store(protocol_->fills(), std::memory_order_relaxed);
+    // What the message's orders did to the books goes out right behind its answer
+    publishAll();
+}
+
+void ExchangeSimulator::onClosed(const ConnectionPtr& connection) {
+    connections_.erase(std::remove(connections_.begin(), connections_.end(), connection),
+                       connections_.end());
+}
+
+void ExchangeSimulator::send(Connection& connection, VenueProtocol::Frames& frames) {
+    for (auto& frame : frames) {
+        framesSent_.fetch_add(1, std::memory_order_relaxed);
+        bytesSent_.fetch_add(frame.size(), std::memory_order_relaxed);
+        connection.write(std::move(frame));
+    }
+    frames.clear();
+}
+
+void ExchangeSimulator::seedBooks() {
+    for (const auto& symbol : market_.symbols) {
+        market_.engine.addSymbol(symbol.name);
+        // Replayed frames bring their own book
+        if (!replayFrames_.empty()) {
+            continue;
+        }
+        const auto mid = static_cast<MatchingEngine::Ticks>(std::llround(symbol.midPrice /
+                                                                          symbol.tick));
+        for (std::size_t i = 1; i <= 2 * options_.depth; ++i) {
+            const auto offset = static_cast<MatchingEngine::Ticks>(i);
+            market_.engine.setMakerQuantity(symbol.name, MatchingEngine::Side::Buy, mid - offset,
+                                            randomQuantity());
+            market_.engine.setMakerQuantity(symbol.name, MatchingEngine::Side::Sell,
+                                            mid + offset, randomQuantity());
+        }
+        // Nobody has subscribed yet: the first subscriber gets this as its snapshot
+        market_.engine.takeChanges(symbol.name, changes_);
+        changes_.clear();
+    }
+}
+
+void ExchangeSimulator::scheduleTick() {
+    timer_.expires_after(kTick);
+    timer_.async_wait([this](const beast::error_code& ec) {
+        if (!ec) {
+            onTick();
+        }
+    });
+}
+
+void ExchangeSimulator::onTick() {
+    const Clock::time_point now = Clock::now();
+    const double elapsed = std::chrono::duration<double>(now - lastTick_).count();
+    lastTick_ = now;
+    // A thread that fell behind catches up on at most a tenth of a second's worth
+    due_ = std::min(due_ + elapsed * options_.updatesPerSecond,
+                    std::max(1.0, options_.updatesPerSecond / 10.0));
+    const auto count = static_cast<uint64_t>(due_);
+    due_ -= static_cast<double>(count);
+
+    for (uint64_t i = 0; i < count; ++i) {
+        if (!replayFrames_.empty()) {
+            replay();
+            continue;
+        }
+        const SimSymbol& symbol = market_.symbols[nextSymbol_++ % market_.symbols.size()];
+        moveMarket(symbol);
+        publish(symbol);
+    }
+    bookUpdates_.fetch_add(count, std::memory_order_relaxed);
+    scheduleTick();
+}
+
+void ExchangeSimulator::moveMarket(const SimSymbol& symbol) {
+    using Side = MatchingEngine::Side;
+    MatchingEngine& engine = market_.engine;
+    const Side side = (rng_() & 1) ? Side::Buy : Side::Sell;
+    const Side other = side == Side::Buy ? Side::Sell : Side::Buy;
+    // Further from the other side of the book by ticks
+    auto away = [side](MatchingEngine::Ticks price, MatchingEngine::Ticks ticks) {
+        return side == Side::Buy ? price - ticks : price + ticks;
+    };
+    const auto levels = engine.levels(symbol.name, side, options_.depth);
+    const double roll = std::uniform_real_distribution<double>(0.0, 1.0)(rng_);
+
+    if (levels.size() < options_.depth || roll < 0.15) {
+        // A new level behind the last one shown
+        MatchingEngine::Ticks from = 0;
+        if (!levels.empty()) {
+            from = levels.back().first;
+        } else if (auto best = engine.best(symbol.name, other)) {
+            from = *best;
+        } else {
+            from = std::llround(symbol.midPrice / symbol.tick);
+        }
+        const auto ticks = static_cast<MatchingEngine::Ticks>(1 + rng_() % 3);
+        engine.setMakerQuantity(symbol.name, side, away(from, ticks), randomQuantity());
+        return;
+    }
+    // Quotes inside the spread are refused once it is a tick wide; those resize a level instead
+    if (roll < 0.25 &&
+        engine.setMakerQuantity(symbol.name, side, away(levels.front().first, -1),
+                                randomQuantity())) {
+        return;
+    }
+    const auto& level = levels[rng_() % levels.size()];
+    if (roll < 0.45 && engine.levelCount(symbol.name, side) > options_.depth) {
+        engine.setMakerQuantity(symbol.name, side, level.first, 0);
+        return;
+    }
+    engine.setMakerQuantity(symbol.name, side, level.first, randomQuantity());
+}
+
+MatchingEngine::Lots ExchangeSimulator::randomQuantity() {
+    // 0.01 to 3 units
+    return std::uniform_int_distribution<MatchingEngine::Lots>(1000000, 300000000)(rng_);
+}
+
+void ExchangeSimulator::publish(const SimSymbol& symbol) {
+    changes_.clear();
+    market_.engine.takeChanges(symbol.name, changes_);
+    if (changes_.empty() || !protocol_->prepare(symbol, changes_)) {
+        return;
+    }
+    VenueProtocol::Frames frames;
+    for (const auto& connection : connections_) {
+        protocol_->update(connection->state, symbol, frames);
+        send(*connection, frames);
+    }
+}
+
+void ExchangeSimulator::publishAll() {
+    for (const auto& symbol : market_.symbols) {
+        publish(symbol);
+    }
+}
+
+void ExchangeSimulator::replay() {
+    const std::string& frame = replayFrames_[nextFrame_++ % replayFrames_.size()];
+    for (const auto& connection : connections_) {
+        if (!connection->state.streams.empty()) {
+            framesSent_.fetch_add(1, std::memory_order_relaxed);
+            bytesSent_.fetch_add(frame.size(), std::memory_order_relaxed);
+            connection->write(frame);
+        }
+    }
+}
+
+} // namespace crypto_hft
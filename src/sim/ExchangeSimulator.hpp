@@ -0,0 +1,129 @@
+#pragma once
+
+#include "MatchingEngine.hpp"
+#include "VenueProtocol.hpp"
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/ssl.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace crypto_hft {
+
+// A venue on the loopback interface, for end-to-end tests of the adapters and order entry
+// through their real socket, TLS, websocket and parsing code. It serves one venue's websocket
+// protocol (see VenueProtocol) over TLS with a throwaway self-signed certificate for
+// "localhost", or over plain TCP. Orders are matched in a MatchingEngine whose books the feed
+// publishes, and which a synthetic market maker keeps moving at updatesPerSecond book messages
+// per second. With a replay file, its frames are sent as recorded instead, at the same rate, to
+// every session that has subscribed to anything. Everything runs on one IO thread.
+class ExchangeSimulator {
+public:
+    struct Options {
+        std::string venue = "binance";  // "binance", "kraken" or "coinbase"
+        std::string address = "127.0.0.1";
+        uint16_t port = 0;  // 0 takes any free port; see port()
+        bool tls = true;
+        // Symbols under the venue's names for them
+        std::vector<SimSymbol> symbols;
+        double updatesPerSecond = 1000.0;
+        std::size_t depth = 10;  // Levels the market maker keeps on each side
+        std::string replayFile;  // One raw frame per line
+        uint64_t seed = 1;
+        std::string binanceSecret;  // Order signatures are checked when set
+    };
+
+    struct Stats {
+        uint64_t sessions = 0;      // Websocket handshakes completed
+        uint64_t messages = 0;      // Received from clients
+        uint64_t bookUpdates = 0;   // Synthetic book messages or replayed frames
+        uint64_t framesSent = 0;
+        uint64_t bytesSent = 0;
+        uint64_t orders = 0;        // Accepted by the matching engine
+        uint64_t fills = 0;
+    };
+
+    // Binds the listening socket; throws if it cannot, if the venue is unknown or if the
+    // replay file cannot be read
+    explicit ExchangeSimulator(Options options);
+    ~ExchangeSimulator();
+
+    ExchangeSimulator(const ExchangeSimulator&) = delete;
+    ExchangeSimulator& operator=(const ExchangeSimulator&) = delete;
+
+    // Serves on a thread of its own
+    void start();
+    // Serves on the calling thread until stop()
+    void run();
+    // Closes every session and stops serving; safe from any thread
+    void stop();
+
+    uint16_t port() const { return port_; }
+    // The self-signed certificate, for clients that are to trust it; empty without TLS
+    const std::string& certificatePem() const { return certificatePem_; }
+    Stats getStats() const;
+
+private:
+    class Connection;
+    template <typename Stream>
+    class Session;
+    using ConnectionPtr = std::shared_ptr<Connection>;
+    using Clock = std::chrono::steady_clock;
+
+    void accept();
+    void onOpen(const ConnectionPtr& connection);
+    void onMessage(const ConnectionPtr& connection, std::string message);
+    void onClosed(const ConnectionPtr& connection);
+    void send(Connection& connection, VenueProtocol::Frames& frames);
+
+    void seedBooks();
+    void scheduleTick();
+    void onTick();
+    void moveMarket(const SimSymbol& symbol);
+    MatchingEngine::Lots randomQuantity();
+    // Sends the book changes since the last publish to the subscribed sessions
+    void publish(const SimSymbol& symbol);
+    void publishAll();
+    void replay();
+
+    Options options_;
+    boost::asio::io_context ioc_;
+    boost::asio::ssl::context ctx_;
+    boost::asio::ip::tcp::acceptor acceptor_;
+    boost::asio::steady_timer timer_;
+    uint16_t port_ = 0;
+    std::string certificatePem_;
+    std::thread thread_;
+    std::atomic<bool> stopped_{false};
+
+    // IO thread only
+    SimMarket market_;
+    std::unique_ptr<VenueProtocol> protocol_;
+    std::vector<ConnectionPtr> connections_;
+    std::vector<MatchingEngine::LevelChange> changes_;
+    std::mt19937_64 rng_;
+    Clock::time_point lastTick_;
+    double due_ = 0.0;  // Book messages owed by the rate, carried between ticks
+    std::size_t nextSymbol_ = 0;
+    std::vector<std::string> replayFrames_;
+    std::size_t nextFrame_ = 0;
+
+    std::atomic<uint64_t> sessions_{0};
+    std::atomic<uint64_t> messages_{0};
+    std::atomic<uint64_t> bookUpdates_{0};
+    std::atomic<uint64_t> framesSent_{0};
+    std::atomic<uint64_t> bytesSent_{0};
+    std::atomic<uint64_t> orders_{0};
+    std::atomic<uint64_t> fills_{0};
+
+    static constexpr std::chrono::milliseconds kTick{1};
+};
+
+} // namespace crypto_hft
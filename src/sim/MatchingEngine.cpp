@@ -0,0 +1,278 @@
+#include "MatchingEngine.hpp"
+#include <algorithm>
+
+namespace crypto_hft {
+
+void MatchingEngine::addSymbol(const std::string& symbol) {
+    books_.try_emplace(symbol);
+}
+
+MatchingEngine::Book& MatchingEngine::book(const std::string& symbol) {
+    return books_.at(symbol);
+}
+
+const MatchingEngine::Book* MatchingEngine::find(const std::string& symbol) const {
+    auto it = books_.find(symbol);
+    return it == books_.end() ? nullptr : &it->second;
+}
+
+MatchingEngine::Result MatchingEngine::submit(const Order& order) {
+    Result result;
+    auto it = books_.find(order.symbol);
+    if (it == books_.end()) {
+        result.reason = "Unknown symbol";
+        return result;
+    }
+    if (order.quantity <= 0) {
+        result.reason = "Invalid quantity";
+        return result;
+    }
+    if (order.type == Type::Limit && order.price <= 0) {
+        result.reason = "Invalid price";
+        return result;
+    }
+
+    Book& book = it->second;
+    result.accepted = true;
+    result.orderId = nextOrderId_++;
+    if (order.side == Side::Buy) {
+        match(book, book.asks, order, result);
+    } else {
+        match(book, book.bids, order, result);
+    }
+
+    const Lots remaining = order.quantity - result.filled;
+    if (order.type == Type::Limit && remaining > 0) {
+        rest(book, order.side, order.price,
+             Resting{result.orderId, remaining, false, order.clientOrderId});
+        result.resting = remaining;
+    }
+    return result;
+}
+
+template <typename Levels>
+void MatchingEngine::match(Book& book, Levels& levels, const Order& order, Result& result) {
+    const Side makerSide = order.side == Side::Buy ? Side::Sell : Side::Buy;
+    auto crosses = [&](Ticks price) {
+        if (order.type == Type::Market) {
+            return true;
+        }
+        return order.side == Side::Buy ? price <= order.price : price >= order.price;
+    };
+
+    while (result.filled < order.quantity && !levels.empty() && crosses(levels.begin()->first)) {
+        auto levelIt = levels.begin();
+        const Ticks price = levelIt->first;
+        PriceLevel& level = levelIt->second;
+        while (result.filled < order.quantity && !level.queue.empty()) {
+            Resting& maker = level.queue.front();
+            const Lots quantity = std::min(maker.quantity, order.quantity - result.filled);
+            result.fills.push_back(Fill{maker.id, price, quantity});
+            result.filled += quantity;
+            maker.quantity -= quantity;
+            level.total -= quantity;
+            if (maker.quantity == 0) {
+                if (maker.maker) {
+                    (makerSide == Side::Buy ? book.makerBids : book.makerAsks).erase(price);
+                }
+                book.orders.erase(maker.id);
+                level.queue.pop_front();
+            }
+        }
+        touch(book, makerSide, price);
+        if (level.queue.empty()) {
+            levels.erase(levelIt);
+        }
+    }
+}
+
+void MatchingEngine::rest(Book& book, Side side, Ticks price, Resting resting) {
+    const uint64_t id = resting.id;
+    PriceLevel& level = side == Side::Buy ? book.bids[price] : book.asks[price];
+    level.total += resting.quantity;
+    level.queue.push_back(std::move(resting));
+    book.orders[id] = Location{side, price, std::prev(level.queue.end())};
+    touch(book, side, price);
+}
+
+void MatchingEngine::remove(Book& book, uint64_t orderId) {
+    auto it = book.orders.find(orderId);
+    const Location location = it->second;
+    book.orders.erase(it);
+
+    auto erase = [&](auto& levels) {
+        auto levelIt = levels.find(location.price);
+        PriceLevel& level = levelIt->second;
+        level.total -= location.entry->quantity;
+        level.queue.erase(location.entry);
+        if (level.queue.empty()) {
+            levels.erase(levelIt);
+        }
+    };
+    if (location.side == Side::Buy) {
+        erase(book.bids);
+    } else {
+        erase(book.asks);
+    }
+    touch(book, location.side, location.price);
+}
+
+bool MatchingEngine::cancel(const std::string& symbol, uint64_t orderId) {
+    auto it = books_.find(symbol);
+    if (it == books_.end()) {
+        return false;
+    }
+    Book& book = it->second;
+    auto order = book.orders.find(orderId);
+    if (order == book.orders.end() || order->second.entry->maker) {
+        return false;
+    }
+    remove(book, orderId);
+    return true;
+}
+
+MatchingEngine::Result MatchingEngine::replace(const std::string& symbol, uint64_t orderId,
+                                               Ticks price, Lots quantity) {
+    Result result;
+    auto it = books_.find(symbol);
+    if (it == books_.end()) {
+        result.reason = "Unknown symbol";
+        return result;
+    }
+    Book& book = it->second;
+    auto order = book.orders.find(orderId);
+    if (order == book.orders.end() || order->second.entry->maker) {
+        result.reason = "Unknown order";
+        return result;
+    }
+    Order replacement;
+    replacement.symbol = symbol;
+    replacement.side = order->second.side;
+    replacement.price = price;
+    replacement.quantity = quantity;
+    replacement.clientOrderId = order->second.entry->clientOrderId;
+    remove(book, orderId);
+    return submit(replacement);
+}
+
+std::optional<uint64_t> MatchingEngine::findByClientOrderId(
+    const std::string& symbol, const std::string& clientOrderId) const {
+    const Book* book = find(symbol);
+    if (!book || clientOrderId.empty()) {
+        return std::nullopt;
+    }
+    for (const auto& [id, location] : book->orders) {
+        if (!location.entry->maker && location.entry->clientOrderId == clientOrderId) {
+            return id;
+        }
+    }
+    return std::nullopt;
+}
+
+bool MatchingEngine::setMakerQuantity(const std::string& symbol, Side side, Ticks price,
+                                      Lots quantity) {
+    auto it = books_.find(symbol);
+    if (it == books_.end() || price <= 0 || quantity < 0) {
+        return false;
+    }
+    Book& book = it->second;
+    auto& quotes = side == Side::Buy ? book.makerBids : book.makerAsks;
+    auto quote = quotes.find(price);
+
+    if (quantity == 0) {
+        if (quote != quotes.end()) {
+            const uint64_t id = quote->second;
+            quotes.erase(quote);
+            remove(book, id);
+        }
+        return true;
+    }
+    if (quote != quotes.end()) {
+        // Resized in place, keeping its place in the queue
+        Location& location = book.orders.at(quote->second);
+        PriceLevel& level = side == Side::Buy ? book.bids.at(price) : book.asks.at(price);
+        level.total += quantity - location.entry->quantity;
+        location.entry->quantity = quantity;
+        touch(book, side, price);
+        return true;
+    }
+
+    auto other = best(symbol, side == Side::Buy ? Side::Sell : Side::Buy);
+    if (other && (side == Side::Buy ? price >= *other : price <= *other)) {
+        return false;
+    }
+    const uint64_t id = nextOrderId_++;
+    quotes.emplace(price, id);
+    rest(book, side, price, Resting{id, quantity, true, {}});
+    return true;
+}
+
+std::vector<MatchingEngine::Level> MatchingEngine::levels(const std::string& symbol, Side side,
+                                                          std::size_t depth) const {
+    std::vector<Level> out;
+    const Book* book = find(symbol);
+    if (!book) {
+        return out;
+    }
+    auto collect = [&](const auto& levels) {
+        for (auto it = levels.begin(); it != levels.end() && out.size() < depth; ++it) {
+            out.emplace_back(it->first, it->second.total);
+        }
+    };
+    if (side == Side::Buy) {
+        collect(book->bids);
+    } else {
+        collect(book->asks);
+    }
+    return out;
+}
+
+std::optional<MatchingEngine::Ticks> MatchingEngine::best(const std::string& symbol,
+                                                          Side side) const {
+    const Book* book = find(symbol);
+    if (!book) {
+        return std::nullopt;
+    }
+    if (side == Side::Buy) {
+        return book->bids.empty() ? std::nullopt : std::optional<Ticks>(book->bids.begin()->first);
+    }
+    return book->asks.empty() ? std::nullopt : std::optional<Ticks>(book->asks.begin()->first);
+}
+
+std::size_t MatchingEngine::levelCount(const std::string& symbol, Side side) const {
+    const Book* book = find(symbol);
+    if (!book) {
+        return 0;
+    }
+    return side == Side::Buy ? book->bids.size() : book->asks.size();
+}
+
+void MatchingEngine::touch(Book& book, Side side, Ticks price) {
+    if (book.touchedKeys.insert(price * 2 + (side == Side::Sell ? 1 : 0)).second) {
+        book.touched.emplace_back(side, price);
+    }
+}
+
+MatchingEngine::Lots MatchingEngine::total(const Book& book, Side side, Ticks price) const {
+    if (side == Side::Buy) {
+        auto it = book.bids.find(price);
+        return it == book.bids.end() ? 0 : it->second.total;
+    }
+    auto it = book.asks.find(price);
+    return it == book.asks.end() ? 0 : it->second.total;
+}
+
+void MatchingEngine::takeChanges(const std::string& symbol, std::vector<LevelChange>& out) {
+    auto it = books_.find(symbol);
+    if (it == books_.end()) {
+        return;
+    }
+    Book& book = it->second;
+    for (const auto& [side, price] : book.touched) {
+        out.push_back(LevelChange{side, price, total(book, side, price)});
+    }
+    book.touched.clear();
+    book.touchedKeys.clear();
+}
+
+} // namespace crypto_hft
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <map>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace crypto_hft {
+
+// Price-time priority limit order books for the exchange simulator, one per symbol. Prices are
+// whole ticks and quantities whole lots (1e-8 of the base asset), so matching and the level
+// text the feeds derive from it are exact. Besides client orders the books hold the simulator's
+// own market maker, one resting order per level it quotes, which the synthetic feed moves
+// around. Every change to a level's total quantity is recorded for the feeds to publish.
+// Not thread-safe: the simulator only touches it from its IO thread.
+class MatchingEngine {
+public:
+    using Ticks = int64_t;
+    using Lots = int64_t;
+
+    static constexpr double kLotSize = 1e-8;
+
+    enum class Side : uint8_t { Buy, Sell };
+    enum class Type : uint8_t { Limit, Market };
+
+    struct Order {
+        std::string symbol;
+        Side side = Side::Buy;
+        Type type = Type::Limit;
+        Ticks price = 0;  // Ignored for market orders
+        Lots quantity = 0;
+        std::string clientOrderId;
+    };
+
+    struct Fill {
+        uint64_t makerOrderId = 0;
+        Ticks price = 0;
+        Lots quantity = 0;
+    };
+
+    struct Result {
+        bool accepted = false;
+        std::string reason;  // Why the order was rejected
+        uint64_t orderId = 0;
+        Lots filled = 0;
+        Lots resting = 0;  // Left on the book; market orders never rest
+        std::vector<Fill> fills;
+    };
+
+    // A level's new total quantity; 0 means the level is gone
+    struct LevelChange {
+        Side side = Side::Buy;
+        Ticks price = 0;
+        Lots quantity = 0;
+    };
+
+    using Level = std::pair<Ticks, Lots>;
+
+    void addSymbol(const std::string& symbol);
+    bool hasSymbol(const std::string& symbol) const { return books_.count(symbol) > 0; }
+
+    // Limit orders match what they cross and rest the remainder; market orders match what there
+    // is and drop the rest
+    Result submit(const Order& order);
+    bool cancel(const std::string& symbol, uint64_t orderId);
+    // Cancels the order and submits its replacement, which queues behind the level
+    Result replace(const std::string& symbol, uint64_t orderId, Ticks price, Lots quantity);
+    // Resting client order with this client order id, if any
+    std::optional<uint64_t> findByClientOrderId(const std::string& symbol,
+                                                const std::string& clientOrderId) const;
+
+    // Makes the market maker show quantity at price (0 withdraws it). Quotes that would cross
+    // the other side are refused.
+    bool setMakerQuantity(const std::string& symbol, Side side, Ticks price, Lots quantity);
+
+    // Best first, at most depth levels
+    std::vector<Level> levels(const std::string& symbol, Side side,
+                              std::size_t depth = SIZE_MAX) const;
+    std::optional<Ticks> best(const std::string& symbol, Side side) const;
+    std::size_t levelCount(const std::string& symbol, Side side) const;
+
+    // Appends the level changes since the last call, one per level touched, in the order they
+    // were first touched
+    void takeChanges(const std::string& symbol, std::vector<LevelChange>& out);
+
+private:
+    struct Resting {
+        uint64_t id = 0;
+        Lots quantity = 0;
+        bool maker = false;
+        std::string clientOrderId;
+    };
+    struct PriceLevel {
+        Lots total = 0;
+        std::list<Resting> queue;
+    };
+    struct Location {
+        Side side = Side::Buy;
+        Ticks price = 0;
+        std::list<Resting>::iterator entry;
+    };
+    struct Book {
+        std::map<Ticks, PriceLevel, std::greater<Ticks>> bids;
+        std::map<Ticks, PriceLevel> asks;
+        std::unordered_map<uint64_t, Location> orders;
+        std::map<Ticks, uint64_t> makerBids;  // Price to the maker's order there
+        std::map<Ticks, uint64_t> makerAsks;
+        std::vector<std::pair<Side, Ticks>> touched;
+        std::unordered_set<int64_t> touchedKeys;  // price * 2 + side
+    };
+
+    Book& book(const std::string& symbol);
+    const Book* find(const std::string& symbol) const;
+    template <typename Levels>
+    void match(Book& book, Levels& levels, const Order& order, Result& result);
+    void rest(Book& book, Side side, Ticks price, Resting resting);
+    void remove(Book& book, uint64_t orderId);
+    void touch(Book& book, Side side, Ticks price);
+    Lots total(const Book& book, Side side, Ticks price) const;
+
+    std::unordered_map<std::string, Book> books_;
+    uint64_t nextOrderId_ = 1;
+};
+
+} // namespace crypto_hft
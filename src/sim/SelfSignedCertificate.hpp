@@ -0,0 +1,44 @@
+#pragma once
+
+#include <boost/asio/ssl.hpp>
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/x509.h>
+#include <chrono>
+#include <string>
+
+namespace crypto_hft {
+
+// Gives a loopback server a throwaway self-signed certificate for "localhost". Returns the
+// certificate in PEM form, for clients that are to trust it rather than skip verification.
+inline std::string useSelfSignedCertificate(boost::asio::ssl::context& ctx,
+                                            std::chrono::seconds validFor =
+                                                std::chrono::hours(1)) {
+    EVP_PKEY* key = EVP_EC_gen("P-256");
+    X509* cert = X509_new();
+    ASN1_INTEGER_set(X509_get_serialNumber(cert), 1);
+    X509_gmtime_adj(X509_getm_notBefore(cert), 0);
+    X509_gmtime_adj(X509_getm_notAfter(cert), static_cast<long>(validFor.count()));
+    X509_set_pubkey(cert, key);
+    X509_NAME* name = X509_get_subject_name(cert);
+    X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC,
+                               reinterpret_cast<const unsigned char*>("localhost"), -1, -1, 0);
+    X509_set_issuer_name(cert, name);
+    X509_sign(cert, key, EVP_sha256());
+    SSL_CTX_use_certificate(ctx.native_handle(), cert);
+    SSL_CTX_use_PrivateKey(ctx.native_handle(), key);
+
+    std::string pem;
+    if (BIO* bio = BIO_new(BIO_s_mem())) {
+        PEM_write_bio_X509(bio, cert);
+        char* data = nullptr;
+        long size = BIO_get_mem_data(bio, &data);
+        pem.assign(data, static_cast<std::size_t>(size));
+        BIO_free(bio);
+    }
+    X509_free(cert);
+    EVP_PKEY_free(key);
+    return pem;
+}
+
+} // namespace crypto_hft
@@ -0,0 +1,973 @@
+#include "VenueProtocol.hpp"
+#include "../exchanges/Crc32.hpp"
+#include "../exchanges/ExchangeUtils.hpp"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+#include <optional>
+#include <unordered_map>
+
+namespace crypto_hft {
+
+namespace {
+
+using json = nlohmann::json;
+using Side = MatchingEngine::Side;
+using Ticks = MatchingEngine::Ticks;
+using Lots = MatchingEngine::Lots;
+using Level = MatchingEngine::Level;
+using LevelChange = MatchingEngine::LevelChange;
+
+int64_t epochMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// 2024-01-01T00:00:00.000000Z
+std::string isoTime() {
+    const int64_t micros = epochMicros();
+    const std::time_t seconds = static_cast<std::time_t>(micros / 1000000);
+    std::tm utc{};
+    gmtime_r(&seconds, &utc);
+    char text[40];
+    std::size_t n = std::strftime(text, sizeof(text), "%Y-%m-%dT%H:%M:%S", &utc);
+    std::snprintf(text + n, sizeof(text) - n, ".%06lldZ",
+                  static_cast<long long>(micros % 1000000));
+    return text;
+}
+
+// A parameter as the text it was sent as, e.g. "0.5" for both "0.5" and 0.5
+std::string jsonText(const json& value) {
+    return value.is_string() ? value.get<std::string>() : value.dump();
+}
+
+int tickDecimals(double tick) {
+    int decimals = 0;
+    for (double scaled = tick; decimals < 12 && std::fabs(scaled - std::round(scaled)) > 1e-9;
+         scaled *= 10.0) {
+        ++decimals;
+    }
+    return decimals;
+}
+
+// A request the venue refuses, with its error code and message
+struct Rejected {
+    int code = 0;
+    std::string message;
+};
+
+} // namespace
+
+const SimSymbol* SimMarket::find(std::string_view name) const {
+    for (const auto& symbol : symbols) {
+        if (symbol.name == name) {
+            return &symbol;
+        }
+    }
+    return nullptr;
+}
+
+std::string VenueProtocol::formatPrice(const SimSymbol& symbol, Ticks price, int decimals) {
+    char text[64];
+    std::snprintf(text, sizeof(text), "%.*f", std::max(decimals, tickDecimals(symbol.tick)),
+                  static_cast<double>(price) * symbol.tick);
+    return text;
+}
+
+std::string VenueProtocol::formatQuantity(Lots quantity) {
+    char text[48];
+    std::snprintf(text, sizeof(text), "%lld.%08lld", static_cast<long long>(quantity / 100000000),
+                  static_cast<long long>(quantity % 100000000));
+    return text;
+}
+
+bool VenueProtocol::parsePrice(const SimSymbol& symbol, std::string_view text, Ticks& price) {
+    double value = 0.0;
+    auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (ec != std::errc() || end != text.data() + text.size() || !(value > 0.0)) {
+        return false;
+    }
+    const double ticks = value / symbol.tick;
+    price = std::llround(ticks);
+    return price > 0 && std::fabs(ticks - static_cast<double>(price)) < 1e-6;
+}
+
+bool VenueProtocol::parseQuantity(std::string_view text, Lots& quantity) {
+    double value = 0.0;
+    auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (ec != std::errc() || end != text.data() + text.size() || !(value > 0.0)) {
+        return false;
+    }
+    quantity = std::llround(value / MatchingEngine::kLotSize);
+    return quantity > 0;
+}
+
+MatchingEngine::Result VenueProtocol::submit(const MatchingEngine::Order& order) {
+    MatchingEngine::Result result = market_.engine.submit(order);
+    if (result.accepted) {
+        ++orders_;
+        fills_ += result.fills.size();
+    }
+    return result;
+}
+
+namespace {
+
+// Binance spot: combined depth and bookTicker streams, and the WebSocket API's order.place,
+// order.cancel and order.cancelReplace. Depth streams are not depth-limited, and start with
+// one update carrying the whole book in place of the REST snapshot.
+class BinanceProtocol final : public VenueProtocol {
+public:
+    BinanceProtocol(SimMarket& market, std::string secret)
+        : VenueProtocol(market)
+        , secret_(std::move(secret)) {}
+
+    void open(Session&, Frames&) override {}
+
+    void onMessage(Session& session, std::string_view message, Frames& out) override {
+        json request = json::parse(message, nullptr, false);
+        if (request.is_discarded() || !request.is_object()) {
+            out.push_back(R"({"code":3,"msg":"Invalid JSON"})");
+            return;
+        }
+        const json id = request.value("id", json());
+        try {
+            const std::string method = request.value("method", "");
+            const json& params = request.contains("params") ? request["params"] : json();
+            if (method == "SUBSCRIBE") {
+                subscribe(session, params, id, out);
+            } else if (method == "UNSUBSCRIBE") {
+                for (const auto& stream : params) {
+                    session.streams.erase(stream.get<std::string>());
+                }
+                out.push_back(json{{"result", nullptr}, {"id", id}}.dump());
+            } else if (method == "LIST_SUBSCRIPTIONS") {
+                json streams = json::array();
+                for (const auto& [stream, symbol] : session.streams) {
+                    streams.push_back(stream);
+                }
+                out.push_back(json{{"result", streams}, {"id", id}}.dump());
+            } else if (method == "order.place") {
+                authenticate(params);
+                respond(id, placeOrder(params), out);
+            } else if (method == "order.cancel") {
+                authenticate(params);
+                respond(id, cancelOrder(params, "orderId", "origClientOrderId"), out);
+            } else if (method == "order.cancelReplace") {
+                authenticate(params);
+                respond(id, cancelReplace(params), out);
+            } else {
+                throw Rejected{-1020, "Unsupported operation."};
+            }
+        } catch (const Rejected& rejected) {
+            out.push_back(json{{"id", id}, {"status", 400},
+                               {"error", {{"code", rejected.code},
+                                          {"msg", rejected.message}}}}.dump());
+        } catch (const json::exception&) {
+            out.push_back(json{{"id", id}, {"status", 400},
+                               {"error", {{"code", -1102},
+                                          {"msg", "A mandatory parameter was not sent, was "
+                                                  "empty/null, or malformed."}}}}.dump());
+        }
+    }
+
+    bool prepare(const SimSymbol& symbol, const std::vector<LevelChange>& changes) override {
+        Feed& feed = feeds_[symbol.name];
+        std::vector<Level> bids;
+        std::vector<Level> asks;
+        for (const auto& change : changes) {
+            (change.side == Side::Buy ? bids : asks).emplace_back(change.price, change.quantity);
+        }
+        const uint64_t first = feed.lastUpdateId + 1;
+        feed.lastUpdateId += changes.size();
+        feed.depth = depthEvent(symbol, first, feed.lastUpdateId, bids, asks);
+
+        // bookTicker only speaks when the top of the book changes
+        Top top = topOf(symbol);
+        feed.ticker.clear();
+        if (top != feed.top) {
+            feed.top = top;
+            feed.ticker = tickerEvent(symbol, feed);
+        }
+        return true;
+    }
+
+    void update(Session& session, const SimSymbol& symbol, Frames& out) override {
+        const Feed& feed = feeds_[symbol.name];
+        for (const auto& [stream, name] : session.streams) {
+            if (name != symbol.name) {
+                continue;
+            }
+            const std::string& data = isTicker(stream) ? feed.ticker : feed.depth;
+            if (!data.empty()) {
+                out.push_back(wrap(stream, data));
+            }
+        }
+    }
+
+private:
+    using Top = std::pair<Level, Level>;
+
+    struct Feed {
+        uint64_t lastUpdateId = 0;
+        std::string depth;   // The last prepared depthUpdate
+        std::string ticker;  // The last prepared bookTicker, if the top changed
+        Top top;
+    };
+
+    static constexpr int kDecimals = 8;
+
+    static bool isTicker(const std::string& stream) {
+        return stream.size() > 11 && stream.compare(stream.size() - 11, 11, "@bookTicker") == 0;
+    }
+
+    static std::string wrap(const std::string& stream, const std::string& data) {
+        std::string frame;
+        frame.reserve(data.size() + stream.size() + 20);
+        frame.append("{\"stream\":\"").append(stream).append("\",\"data\":").append(data);
+        frame += '}';
+        return frame;
+    }
+
+    static void appendLevels(const SimSymbol& symbol, const std::vector<Level>& levels,
+                             std::string& out) {
+        out += '[';
+        for (std::size_t i = 0; i < levels.size(); ++i) {
+            out.append(i == 0 ? "[\"" : ",[\"")
+                .append(formatPrice(symbol, levels[i].first, kDecimals))
+                .append("\",\"")
+                .append(formatQuantity(levels[i].second))
+                .append("\"]");
+        }
+        out += ']';
+    }
+
+    static std::string depthEvent(const SimSymbol& symbol, uint64_t first, uint64_t last,
+                                  const std::vector<Level>& bids,
+                                  const std::vector<Level>& asks) {
+        const int64_t millis = epochMicros() / 1000;
+        std::string event = "{\"e\":\"depthUpdate\",\"E\":" + std::to_string(millis) +
+                            ",\"s\":\"" + symbol.name + "\",\"U\":" + std::to_string(first) +
+                            ",\"u\":" + std::to_string(last) + ",\"b\":";
+        appendLevels(symbol, bids, event);
+        event += ",\"a\":";
+        appendLevels(symbol, asks, event);
+        event += '}';
+        return event;
+    }
+
+    Top topOf(const SimSymbol& symbol) const {
+        auto bids = market_.engine.levels(symbol.name, Side::Buy, 1);
+        auto asks = market_.engine.levels(symbol.name, Side::Sell, 1);
+        return {bids.empty() ? Level{} : bids.front(), asks.empty() ? Level{} : asks.front()};
+    }
+
+    static std::string tickerEvent(const SimSymbol& symbol, const Feed& feed) {
+        return "{\"u\":" + std::to_string(feed.lastUpdateId) + ",\"s\":\"" + symbol.name +
+               "\",\"b\":\"" + formatPrice(symbol, feed.top.first.first, kDecimals) +
+               "\",\"B\":\"" + formatQuantity(feed.top.first.second) +
+               "\",\"a\":\"" + formatPrice(symbol, feed.top.second.first, kDecimals) +
+               "\",\"A\":\"" + formatQuantity(feed.top.second.second) + "\"}";
+    }
+
+    void subscribe(Session& session, const json& params, const json& id, Frames& out) {
+        std::vector<std::pair<std::string, const SimSymbol*>> added;
+        for (const auto& param : params) {
+            const std::string stream = param.get<std::string>();
+            const auto at = stream.find('@');
+            std::string name = stream.substr(0, at);
+            std::transform(name.begin(), name.end(), name.begin(),
+                           [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+            const SimSymbol* symbol = market_.find(name);
+            const std::string_view kind =
+                at == std::string::npos ? std::string_view() : std::string_view(stream).substr(at);
+            if (!symbol || (kind.rfind("@depth", 0) != 0 && kind != "@bookTicker")) {
+                throw Rejected{2, "Invalid request: unknown stream " + stream};
+            }
+            added.emplace_back(stream, symbol);
+        }
+        out.push_back(json{{"result", nullptr}, {"id", id}}.dump());
+
+        // Nothing happens to a book between publishes, so the book now is what the last
+        // update left it at
+        for (const auto& [stream, symbol] : added) {
+            if (!session.streams.emplace(stream, symbol->name).second) {
+                continue;
+            }
+            Feed& feed = feeds_[symbol->name];
+            if (isTicker(stream)) {
+                feed.top = topOf(*symbol);
+                out.push_back(wrap(stream, tickerEvent(*symbol, feed)));
+            } else {
+                out.push_back(wrap(stream, depthEvent(
+                    *symbol, feed.lastUpdateId, feed.lastUpdateId,
+                    market_.engine.levels(symbol->name, Side::Buy),
+                    market_.engine.levels(symbol->name, Side::Sell))));
+            }
+        }
+    }
+
+    void respond(const json& id, const json& result, Frames& out) const {
+        out.push_back(json{{"id", id}, {"status", 200}, {"result", result}}.dump());
+    }
+
+    static std::string param(const json& params, const char* name) {
+        if (!params.contains(name) || params[name].is_null() || jsonText(params[name]).empty()) {
+            throw Rejected{-1102, std::string("Mandatory parameter '") + name +
+                                  "' was not sent, was empty/null, or malformed."};
+        }
+        return jsonText(params[name]);
+    }
+
+    // HMAC-SHA256 over every other parameter as key=value pairs, in name order, joined by '&'
+    void authenticate(const json& params) const {
+        if (secret_.empty()) {
+            return;
+        }
+        std::string payload;
+        for (auto it = params.begin(); it != params.end(); ++it) {
+            if (it.key() == "signature") {
+                continue;
+            }
+            if (!payload.empty()) {
+                payload += '&';
+            }
+            payload.append(it.key()).append("=").append(jsonText(it.value()));
+        }
+        char expected[ExchangeUtils::HmacSigner::kMaxHexSize];
+        std::size_t size = signer_->sign_hex(payload, expected);
+        if (params.value("signature", "") != std::string_view(expected, size)) {
+            throw Rejected{-1022, "Signature for this request is not valid."};
+        }
+    }
+
+    const SimSymbol& symbolOf(const json& params) const {
+        const SimSymbol* symbol = market_.find(param(params, "symbol"));
+        if (!symbol) {
+            throw Rejected{-1121, "Invalid symbol."};
+        }
+        return *symbol;
+    }
+
+    json placeOrder(const json& params) {
+        const SimSymbol& symbol = symbolOf(params);
+        MatchingEngine::Order order;
+        order.symbol = symbol.name;
+
+        const std::string side = param(params, "side");
+        if (side != "BUY" && side != "SELL") {
+            throw Rejected{-1117, "Invalid side."};
+        }
+        order.side = side == "BUY" ? Side::Buy : Side::Sell;
+        const std::string type = param(params, "type");
+        if (type != "LIMIT" && type != "MARKET") {
+            throw Rejected{-1116, "Invalid orderType."};
+        }
+        order.type = type == "LIMIT" ? MatchingEngine::Type::Limit : MatchingEngine::Type::Market;
+        if (order.type == MatchingEngine::Type::Limit &&
+            !parsePrice(symbol, param(params, "price"), order.price)) {
+            throw Rejected{-1013, "Filter failure: PRICE_FILTER"};
+        }
+        if (!parseQuantity(param(params, "quantity"), order.quantity)) {
+            throw Rejected{-1013, "Filter failure: LOT_SIZE"};
+        }
+        order.clientOrderId = params.value("newClientOrderId", "");
+        if (order.clientOrderId.empty()) {
+            order.clientOrderId = "sim" + std::to_string(++nextClientId_);
+        } else if (market_.engine.findByClientOrderId(symbol.name, order.clientOrderId)) {
+            throw Rejected{-2010, "Duplicate order sent."};
+        }
+
+        MatchingEngine::Result result = submit(order);
+        json response = {
+            {"symbol", symbol.name},
+            {"orderId", result.orderId},
+            {"orderListId", -1},
+            {"clientOrderId", order.clientOrderId},
+            {"transactTime", epochMicros() / 1000}
+        };
+        // Binance answers with the full order and its fills unless asked for less
+        const std::string respType = params.value("newOrderRespType", "FULL");
+        if (respType == "ACK") {
+            return response;
+        }
+
+        double quoteQuantity = 0.0;
+        for (const auto& fill : result.fills) {
+            quoteQuantity += static_cast<double>(fill.price) * symbol.tick *
+                             static_cast<double>(fill.quantity) * MatchingEngine::kLotSize;
+        }
+        char quote[64];
+        std::snprintf(quote, sizeof(quote), "%.8f", quoteQuantity);
+        const char* status = result.filled == order.quantity ? "FILLED"
+                           : order.type == MatchingEngine::Type::Market ? "EXPIRED"
+                           : result.filled > 0 ? "PARTIALLY_FILLED"
+                           : "NEW";
+        response["price"] = formatPrice(symbol, order.price, kDecimals);
+        response["origQty"] = formatQuantity(order.quantity);
+        response["executedQty"] = formatQuantity(result.filled);
+        response["cummulativeQuoteQty"] = quote;
+        response["status"] = status;
+        response["timeInForce"] = "GTC";
+        response["type"] = type;
+        response["side"] = side;
+        if (respType == "FULL") {
+            json fills = json::array();
+            for (const auto& fill : result.fills) {
+                fills.push_back({
+                    {"price", formatPrice(symbol, fill.price, kDecimals)},
+                    {"qty", formatQuantity(fill.quantity)},
+                    {"commission", "0.00000000"},
+                    {"commissionAsset", "BNB"},
+                    {"tradeId", ++nextTradeId_}
+                });
+            }
+            response["fills"] = std::move(fills);
+        }
+        return response;
+    }
+
+    // By the venue's order id or, failing that, the client order id
+    json cancelOrder(const json& params, const char* idKey, const char* clientIdKey) {
+        const SimSymbol& symbol = symbolOf(params);
+        const std::string clientOrderId = params.value(clientIdKey, "");
+        std::optional<uint64_t> orderId;
+        if (params.contains(idKey)) {
+            uint64_t id = 0;
+            const std::string text = jsonText(params[idKey]);
+            if (std::from_chars(text.data(), text.data() + text.size(), id).ec == std::errc()) {
+                orderId = id;
+            }
+        } else if (!clientOrderId.empty()) {
+            orderId = market_.engine.findByClientOrderId(symbol.name, clientOrderId);
+        } else {
+            param(params, idKey);  // Neither was sent: throws
+        }
+        if (!orderId || !market_.engine.cancel(symbol.name, *orderId)) {
+            throw Rejected{-2011, "Unknown order sent."};
+        }
+        return {
+            {"symbol", symbol.name},
+            {"origClientOrderId", clientOrderId},
+            {"orderId", *orderId},
+            {"orderListId", -1},
+            {"clientOrderId", "sim" + std::to_string(++nextClientId_)},
+            {"status", "CANCELED"}
+        };
+    }
+
+    json cancelReplace(const json& params) {
+        json cancelled;
+        try {
+            cancelled = cancelOrder(params, "cancelOrderId", "cancelOrigClientOrderId");
+        } catch (const Rejected& rejected) {
+            if (rejected.code != -2011) {
+                throw;
+            }
+            throw Rejected{-2021, "Order cancel-replace failed."};
+        }
+        return {
+            {"cancelResult", "SUCCESS"},
+            {"newOrderResult", "SUCCESS"},
+            {"cancelResponse", std::move(cancelled)},
+            {"newOrderResponse", placeOrder(params)}
+        };
+    }
+
+    std::string secret_;
+    std::unique_ptr<ExchangeUtils::HmacSigner> signer_ =
+        secret_.empty() ? nullptr
+                        : std::make_unique<ExchangeUtils::HmacSigner>(
+                              ExchangeUtils::HmacSigner::Digest::SHA256, secret_);
+    std::unordered_map<std::string, Feed> feeds_;
+    uint64_t nextClientId_ = 0;
+    uint64_t nextTradeId_ = 0;
+};
+
+// Kraken websocket v1: book-10 subscriptions with a CRC-32 checksum on every update, and
+// addOrder, cancelOrder and editOrder on the same socket. The feed publishes the difference
+// between the top ten levels as last sent and as they are now, so changes deeper in the book
+// send nothing and levels coming back into the top ten are sent again.
+class KrakenProtocol final : public VenueProtocol {
+public:
+    explicit KrakenProtocol(SimMarket& market) : VenueProtocol(market) {}
+
+    void open(Session&, Frames& out) override {
+        out.push_back(json{{"connectionID", ++nextConnectionId_}, {"event", "systemStatus"},
+                           {"status", "online"}, {"version", "1.9.0"}}.dump());
+    }
+
+    void onMessage(Session& session, std::string_view message, Frames& out) override {
+        json request = json::parse(message, nullptr, false);
+        if (request.is_discarded() || !request.is_object()) {
+            out.push_back(R"({"errorMessage":"Malformed request","event":"error"})");
+            return;
+        }
+        const std::string event = request.value("event", "");
+        const json reqid = request.value("reqid", json());
+        try {
+            if (event == "ping") {
+                json pong = {{"event", "pong"}};
+                if (!reqid.is_null()) {
+                    pong["reqid"] = reqid;
+                }
+                out.push_back(pong.dump());
+            } else if (event == "subscribe" || event == "unsubscribe") {
+                subscribe(session, request, event == "subscribe", out);
+            } else if (event == "addOrder" || event == "cancelOrder" || event == "editOrder") {
+                if (request.value("token", "").empty()) {
+                    throw Rejected{0, "ESession:Invalid session"};
+                }
+                if (event == "addOrder") {
+                    addOrder(request, reqid, out);
+                } else if (event == "cancelOrder") {
+                    cancelOrder(request, reqid, out);
+                } else {
+                    editOrder(request, reqid, out);
+                }
+            } else {
+                throw Rejected{0, "EGeneral:Unknown method"};
+            }
+        } catch (const Rejected& rejected) {
+            json error = {{"errorMessage", rejected.message}, {"status", "error"},
+                          {"event", event.empty() ? "error" : event + "Status"}};
+            if (!reqid.is_null()) {
+                error["reqid"] = reqid;
+            }
+            out.push_back(error.dump());
+        } catch (const json::exception&) {
+            json error = {{"errorMessage", "EGeneral:Invalid arguments"}, {"status", "error"},
+                          {"event", event + "Status"}};
+            if (!reqid.is_null()) {
+                error["reqid"] = reqid;
+            }
+            out.push_back(error.dump());
+        }
+    }
+
+    bool prepare(const SimSymbol& symbol, const std::vector<LevelChange>&) override {
+        Feed& feed = feedOf(symbol);
+        feed.update.clear();
+        auto bids = market_.engine.levels(symbol.name, Side::Buy, kDepth);
+        auto asks = market_.engine.levels(symbol.name, Side::Sell, kDepth);
+        const std::string timestamp = krakenTime();
+        std::string askUpdates = difference(symbol, feed.asks, asks, timestamp);
+        std::string bidUpdates = difference(symbol, feed.bids, bids, timestamp);
+        if (askUpdates.empty() && bidUpdates.empty()) {
+            return false;
+        }
+        feed.bids = std::move(bids);
+        feed.asks = std::move(asks);
+
+        const std::string checksum = ",\"c\":\"" + std::to_string(checksumOf(symbol, feed)) + "\"}";
+        feed.update = "[" + std::to_string(feed.channelId);
+        if (!askUpdates.empty()) {
+            feed.update.append(",{\"a\":[").append(askUpdates).append("]");
+            feed.update.append(bidUpdates.empty() ? checksum : "}");
+        }
+        if (!bidUpdates.empty()) {
+            feed.update.append(",{\"b\":[").append(bidUpdates).append("]").append(checksum);
+        }
+        feed.update.append(",\"book-10\",").append(json(symbol.name).dump()).append("]");
+        return true;
+    }
+
+    void update(Session& session, const SimSymbol& symbol, Frames& out) override {
+        const Feed& feed = feedOf(symbol);
+        if (!feed.update.empty() && session.streams.count(symbol.name)) {
+            out.push_back(feed.update);
+        }
+    }
+
+private:
+    struct Feed {
+        uint64_t channelId = 0;
+        std::vector<Level> bids;  // The top of the book as last sent
+        std::vector<Level> asks;
+        std::string update;  // The last prepared update, if any
+    };
+
+    static constexpr std::size_t kDepth = 10;
+    static constexpr int kDecimals = 5;
+
+    static std::string krakenTime() {
+        const int64_t micros = epochMicros();
+        char text[32];
+        std::snprintf(text, sizeof(text), "%lld.%06lld", static_cast<long long>(micros / 1000000),
+                      static_cast<long long>(micros % 1000000));
+        return text;
+    }
+
+    Feed& feedOf(const SimSymbol& symbol) {
+        auto [it, added] = feeds_.try_emplace(symbol.name);
+        if (added) {
+            // Channel ids stand for a subscription, so every session gets the same one
+            it->second.channelId = 100 + feeds_.size();
+            it->second.bids = market_.engine.levels(symbol.name, Side::Buy, kDepth);
+            it->second.asks = market_.engine.levels(symbol.name, Side::Sell, kDepth);
+        }
+        return it->second;
+    }
+
+    static void appendLevel(const SimSymbol& symbol, Ticks price, Lots quantity,
+                            const std::string& timestamp, std::string& out) {
+        if (!out.empty()) {
+            out += ',';
+        }
+        out.append("[\"")
+            .append(formatPrice(symbol, price, kDecimals))
+            .append("\",\"")
+            .append(formatQuantity(quantity))
+            .append("\",\"")
+            .append(timestamp)
+            .append("\"]");
+    }
+
+    // Removals of the levels that left the top, then the levels that are new or resized
+    static std::string difference(const SimSymbol& symbol, const std::vector<Level>& sent,
+                                  const std::vector<Level>& now, const std::string& timestamp) {
+        std::string updates;
+        for (const auto& [price, quantity] : sent) {
+            auto it = std::find_if(now.begin(), now.end(),
+                                   [price = price](const Level& level) { return level.first == price; });
+            if (it == now.end()) {
+                appendLevel(symbol, price, 0, timestamp, updates);
+            }
+        }
+        for (const auto& level : now) {
+            if (std::find(sent.begin(), sent.end(), level) == sent.end()) {
+                appendLevel(symbol, level.first, level.second, timestamp, updates);
+            }
+        }
+        return updates;
+    }
+
+    // Over the asks then the bids as sent, each level's price and volume text with the
+    // decimal point and leading zeros removed
+    static uint32_t checksumOf(const SimSymbol& symbol, const Feed& feed) {
+        uint32_t crc = 0;
+        auto add = [&crc](std::string text) {
+            text.erase(std::remove(text.begin(), text.end(), '.'), text.end());
+            const auto digits = text.find_first_not_of('0');
+            std::string_view value = digits == std::string::npos
+                                         ? std::string_view()
+                                         : std::string_view(text).substr(digits);
+            crc = Crc32::update(crc, value.data(), value.size());
+        };
+        for (const auto* side : {&feed.asks, &feed.bids}) {
+            for (const auto& [price, quantity] : *side) {
+                add(formatPrice(symbol, price, kDecimals));
+                add(formatQuantity(quantity));
+            }
+        }
+        return crc;
+    }
+
+    std::string snapshot(const SimSymbol& symbol, const Feed& feed) const {
+        const std::string timestamp = krakenTime();
+        std::string asks;
+        std::string bids;
+        for (const auto& [price, quantity] : feed.asks) {
+            appendLevel(symbol, price, quantity, timestamp, asks);
+        }
+        for (const auto& [price, quantity] : feed.bids) {
+            appendLevel(symbol, price, quantity, timestamp, bids);
+        }
+        return "[" + std::to_string(feed.channelId) + ",{\"as\":[" + asks + "],\"bs\":[" + bids +
+               "]},\"book-10\"," + json(symbol.name).dump() + "]";
+    }
+
+    void subscribe(Session& session, const json& request, bool subscribing, Frames& out) {
+        const json& subscription = request.at("subscription");
+        const std::string name = subscription.value("name", "");
+        const int depth = subscription.value("depth", 10);
+        for (const auto& pair : request.at("pair")) {
+            const std::string pairName = pair.get<std::string>();
+            json status = {{"event", "subscriptionStatus"}, {"pair", pairName},
+                           {"subscription", subscription}};
+            if (request.contains("reqid")) {
+                status["reqid"] = request["reqid"];
+            }
+            const SimSymbol* symbol = market_.find(pairName);
+            std::string error;
+            if (name != "book") {
+                error = "Subscription name invalid";
+            } else if (depth != static_cast<int>(kDepth)) {
+                error = "Subscription depth not supported";
+            } else if (!symbol) {
+                error = "Currency pair not supported " + pairName;
+            } else if (!subscribing && !session.streams.count(pairName)) {
+                error = "Subscription Not Found";
+            }
+            if (!error.empty()) {
+                status["status"] = "error";
+                status["errorMessage"] = error;
+                out.push_back(status.dump());
+                continue;
+            }
+
+            const Feed& feed = feedOf(*symbol);
+            status["channelID"] = feed.channelId;
+            status["channelName"] = "book-10";
+            status["status"] = subscribing ? "subscribed" : "unsubscribed";
+            out.push_back(status.dump());
+            if (!subscribing) {
+                session.streams.erase(pairName);
+            } else if (session.streams.emplace(pairName, pairName).second) {
+                out.push_back(snapshot(*symbol, feed));
+            }
+        }
+    }
+
+    const SimSymbol& pairOf(const json& request) const {
+        const SimSymbol* symbol = market_.find(request.at("pair").get<std::string>());
+        if (!symbol) {
+            throw Rejected{0, "EQuery:Unknown asset pair"};
+        }
+        return *symbol;
+    }
+
+    std::string txidOf(const std::string& pair, uint64_t orderId) {
+        std::string txid = "OSIM-" + std::to_string(orderId);
+        txids_[txid] = {pair, orderId};
+        return txid;
+    }
+
+    void addOrder(const json& request, const json& reqid, Frames& out) {
+        const SimSymbol& symbol = pairOf(request);
+        MatchingEngine::Order order;
+        order.symbol = symbol.name;
+        const std::string type = request.at("type").get<std::string>();
+        const std::string orderType = request.at("ordertype").get<std::string>();
+        if ((type != "buy" && type != "sell") || (orderType != "limit" && orderType != "market")) {
+            throw Rejected{0, "EGeneral:Invalid arguments"};
+        }
+        order.side = type == "buy" ? Side::Buy : Side::Sell;
+        order.type = orderType == "limit" ? MatchingEngine::Type::Limit
+                                          : MatchingEngine::Type::Market;
+        if (order.type == MatchingEngine::Type::Limit &&
+            !parsePrice(symbol, jsonText(request.at("price")), order.price)) {
+            throw Rejected{0, "EOrder:Invalid price"};
+        }
+        if (!parseQuantity(jsonText(request.at("volume")), order.quantity)) {
+            throw Rejected{0, "EGeneral:Invalid arguments:volume"};
+        }
+
+        MatchingEngine::Result result = submit(order);
+        std::string description = type + " " + formatQuantity(order.quantity) + " " +
+                                  symbol.name + " @ " + orderType;
+        if (order.type == MatchingEngine::Type::Limit) {
+            description += " " + formatPrice(symbol, order.price, kDecimals);
+        }
+        json ack = {{"descr", description}, {"event", "addOrderStatus"}, {"status", "ok"},
+                    {"txid", txidOf(symbol.name, result.orderId)}};
+        if (!reqid.is_null()) {
+            ack["reqid"] = reqid;
+        }
+        out.push_back(ack.dump());
+    }
+
+    void cancelOrder(const json& request, const json& reqid, Frames& out) {
+        const json& txid = request.at("txid");
+        std::vector<std::string> txids;
+        if (txid.is_array()) {
+            for (const auto& id : txid) {
+                txids.push_back(id.get<std::string>());
+            }
+        } else {
+            txids.push_back(txid.get<std::string>());
+        }
+        // All or nothing is not promised by Kraken either; the first unknown id fails the rest
+        for (const auto& id : txids) {
+            auto it = txids_.find(id);
+            if (it == txids_.end() || !market_.engine.cancel(it->second.first, it->second.second)) {
+                throw Rejected{0, "EOrder:Unknown order"};
+            }
+            txids_.erase(it);
+        }
+        json ack = {{"event", "cancelOrderStatus"}, {"status", "ok"}};
+        if (!reqid.is_null()) {
+            ack["reqid"] = reqid;
+        }
+        out.push_back(ack.dump());
+    }
+
+    void editOrder(const json& request, const json& reqid, Frames& out) {
+        const SimSymbol& symbol = pairOf(request);
+        const std::string original = request.at("orderid").get<std::string>();
+        Ticks price = 0;
+        Lots quantity = 0;
+        if (!parsePrice(symbol, jsonText(request.at("price")), price)) {
+            throw Rejected{0, "EOrder:Invalid price"};
+        }
+        if (!parseQuantity(jsonText(request.at("volume")), quantity)) {
+            throw Rejected{0, "EGeneral:Invalid arguments:volume"};
+        }
+        auto it = txids_.find(original);
+        if (it == txids_.end() || it->second.first != symbol.name) {
+            throw Rejected{0, "EOrder:Unknown order"};
+        }
+        MatchingEngine::Result result =
+            market_.engine.replace(symbol.name, it->second.second, price, quantity);
+        if (!result.accepted) {
+            throw Rejected{0, "EOrder:Unknown order"};
+        }
+        txids_.erase(it);
+        ++orders_;
+        fills_ += result.fills.size();
+        json ack = {{"descr", "order edited price = " + formatPrice(symbol, price, kDecimals) +
+                                  " volume = " + formatQuantity(quantity)},
+                    {"event", "editOrderStatus"}, {"status", "ok"},
+                    {"txid", txidOf(symbol.name, result.orderId)}, {"originaltxid", original}};
+        if (!reqid.is_null()) {
+            ack["reqid"] = reqid;
+        }
+        out.push_back(ack.dump());
+    }
+
+    std::unordered_map<std::string, Feed> feeds_;
+    // Order ids handed out, to their pair and engine order
+    std::unordered_map<std::string, std::pair<std::string, uint64_t>> txids_;
+    uint64_t nextConnectionId_ = 0;
+};
+
+// Coinbase Advanced Trade level2: l2_data snapshots and updates, every message on a session
+// numbered by sequence_num. Orders go to Coinbase over REST, so none are taken here.
+class CoinbaseProtocol final : public VenueProtocol {
+public:
+    explicit CoinbaseProtocol(SimMarket& market) : VenueProtocol(market) {}
+
+    void open(Session&, Frames&) override {}
+
+    void onMessage(Session& session, std::string_view message, Frames& out) override {
+        json request = json::parse(message, nullptr, false);
+        if (request.is_discarded() || !request.is_object()) {
+            out.push_back(R"({"type":"error","message":"Malformed JSON"})");
+            return;
+        }
+        const std::string type = request.value("type", "");
+        if (type == "authenticate") {
+            // The token is not checked: there is nothing private to protect
+            out.push_back(R"({"type":"authenticate","success":true})");
+            return;
+        }
+        if (type != "subscribe" && type != "unsubscribe") {
+            out.push_back(json{{"type", "error"},
+                               {"message", "Failed to parse message: unknown type " + type}}.dump());
+            return;
+        }
+        if (request.value("channel", "") != "level2") {
+            out.push_back(R"({"type":"error","message":"Failed to subscribe","reason":"channel is not supported"})");
+            return;
+        }
+
+        std::vector<const SimSymbol*> products;
+        for (const auto& product : request.value("product_ids", json::array())) {
+            const SimSymbol* symbol = market_.find(product.get<std::string>());
+            if (!symbol) {
+                out.push_back(json{{"type", "error"}, {"message", "Failed to subscribe"},
+                                   {"reason", product.get<std::string>() +
+                                              " is not a valid product"}}.dump());
+                return;
+            }
+            products.push_back(symbol);
+        }
+        std::vector<const SimSymbol*> added;
+        for (const auto* symbol : products) {
+            if (type == "unsubscribe") {
+                session.streams.erase(symbol->name);
+            } else if (session.streams.emplace(symbol->name, symbol->name).second) {
+                added.push_back(symbol);
+            }
+        }
+
+        json subscribed = json::array();
+        for (const auto& [product, symbol] : session.streams) {
+            subscribed.push_back(product);
+        }
+        out.push_back(wrap(session, "subscriptions",
+                           json::array({{{"subscriptions", {{"level2", subscribed}}}}}).dump()));
+        for (const auto* symbol : added) {
+            out.push_back(wrap(session, "l2_data", snapshot(*symbol)));
+        }
+    }
+
+    bool prepare(const SimSymbol& symbol, const std::vector<LevelChange>& changes) override {
+        const std::string time = isoTime();
+        std::string updates;
+        for (const auto& change : changes) {
+            appendUpdate(symbol, change.side, change.price, change.quantity, time, updates);
+        }
+        events_[symbol.name] = "[{\"type\":\"update\",\"product_id\":\"" + symbol.name +
+                               "\",\"updates\":[" + updates + "]}]";
+        return true;
+    }
+
+    void update(Session& session, const SimSymbol& symbol, Frames& out) override {
+        if (session.streams.count(symbol.name)) {
+            out.push_back(wrap(session, "l2_data", events_[symbol.name]));
+        }
+    }
+
+private:
+    static constexpr int kDecimals = 2;
+
+    static std::string wrap(Session& session, const char* channel, const std::string& events) {
+        return std::string("{\"channel\":\"") + channel +
+               "\",\"client_id\":\"\",\"timestamp\":\"" + isoTime() +
+               "\",\"sequence_num\":" + std::to_string(session.sequence++) +
+               ",\"events\":" + events + "}";
+    }
+
+    static void appendUpdate(const SimSymbol& symbol, Side side, Ticks price, Lots quantity,
+                             const std::string& time, std::string& out) {
+        if (!out.empty()) {
+            out += ',';
+        }
+        out.append(side == Side::Buy ? "{\"side\":\"bid\"" : "{\"side\":\"offer\"")
+            .append(",\"event_time\":\"")
+            .append(time)
+            .append("\",\"price_level\":\"")
+            .append(formatPrice(symbol, price, kDecimals))
+            .append("\",\"new_quantity\":\"")
+            .append(formatQuantity(quantity))
+            .append("\"}");
+    }
+
+    std::string snapshot(const SimSymbol& symbol) const {
+        const std::string time = isoTime();
+        std::string updates;
+        for (Side side : {Side::Buy, Side::Sell}) {
+            for (const auto& [price, quantity] : market_.engine.levels(symbol.name, side)) {
+                appendUpdate(symbol, side, price, quantity, time, updates);
+            }
+        }
+        return "[{\"type\":\"snapshot\",\"product_id\":\"" + symbol.name + "\",\"updates\":[" +
+               updates + "]}]";
+    }
+
+    std::unordered_map<std::string, std::string> events_;  // The last prepared update's events
+};
+
+} // namespace
+
+std::unique_ptr<VenueProtocol> VenueProtocol::create(std::string_view venue, SimMarket& market,
+                                                     std::string binanceSecret) {
+    if (venue == "binance") {
+        return std::make_unique<BinanceProtocol>(market, std::move(binanceSecret));
+    }
+    if (venue == "kraken") {
+        return std::make_unique<KrakenProtocol>(market);
+    }
+    if (venue == "coinbase") {
+        return std::make_unique<CoinbaseProtocol>(market);
+    }
+    return nullptr;
+}
+
+} // namespace crypto_hft
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "MatchingEngine.hpp"
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace crypto_hft {
+
+// A symbol the simulator makes a market in, under the venue's own name for it, e.g. "BTCUSDT",
+// "XBT/USD" or "BTC-USD"
+struct SimSymbol {
+    std::string name;
+    double midPrice = 0.0;  // Where the synthetic book starts
+    double tick = 0.01;     // Price increment; order prices must be a multiple of it
+};
+
+// The books a simulator's sessions share, and the symbols they are kept for
+struct SimMarket {
+    MatchingEngine engine;
+    std::vector<SimSymbol> symbols;
+
+    const SimSymbol* find(std::string_view name) const;
+};
+
+// One venue's side of the wire. Sessions are sent what open() returns when their websocket
+// handshake completes and what onMessage() returns in answer to each message, subscription
+// requests and orders alike. Book changes are published in two steps, so that work common to
+// every session is done once: prepare() turns a symbol's level changes into the venue's update
+// and update() writes it out for each session subscribed to the symbol. The simulator drives a
+// protocol from its IO thread only.
+class VenueProtocol {
+public:
+    // What a protocol keeps per session
+    struct Session {
+        std::map<std::string, std::string> streams;  // Subscribed stream or channel to symbol
+        uint64_t sequence = 0;  // Messages numbered so far, where the venue numbers them
+    };
+    using Frames = std::vector<std::string>;
+
+    // "binance", "kraken" or "coinbase"; nullptr for any other venue. Binance order requests
+    // have their signature checked when binanceSecret is not empty.
+    static std::unique_ptr<VenueProtocol> create(std::string_view venue, SimMarket& market,
+                                                 std::string binanceSecret = "");
+
+    virtual ~VenueProtocol() = default;
+
+    virtual void open(Session& session, Frames& out) = 0;
+    // Book changes made by the message's orders are left for the caller to publish
+    virtual void onMessage(Session& session, std::string_view message, Frames& out) = 0;
+    // False when the changes make no update, e.g. they are all below a depth-limited feed
+    virtual bool prepare(const SimSymbol& symbol,
+                         const std::vector<MatchingEngine::LevelChange>& changes) = 0;
+    // The update prepared last for symbol, if session is subscribed to it
+    virtual void update(Session& session, const SimSymbol& symbol, Frames& out) = 0;
+
+    // Orders accepted, and fills they made
+    uint64_t orders() const { return orders_; }
+    uint64_t fills() const { return fills_; }
+
+protected:
+    explicit VenueProtocol(SimMarket& market) : market_(market) {}
+
+    // Price text with at least decimals places, and more if the tick needs them
+    static std::string formatPrice(const SimSymbol& symbol, MatchingEngine::Ticks price,
+                                   int decimals);
+    // Quantity text with the 8 decimals of a lot
+    static std::string formatQuantity(MatchingEngine::Lots quantity);
+    // Order text converted to ticks and lots; false unless positive and, for the price, on a tick
+    static bool parsePrice(const SimSymbol& symbol, std::string_view text,
+                           MatchingEngine::Ticks& price);
+    static bool parseQuantity(std::string_view text, MatchingEngine::Lots& quantity);
+
+    MatchingEngine::Result submit(const MatchingEngine::Order& order);
+
+    SimMarket& market_;
+    uint64_t orders_ = 0;
+    uint64_t fills_ = 0;
+};
+
+} // namespace crypto_hft
@@ -0,0 +1,120 @@
+#include "ExchangeSimulator.hpp"
+#include <spdlog/spdlog.h>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace {
+
+std::atomic<bool> g_stop{false};
+
+void usage() {
+    spdlog::info(
+        "Usage: exchange_simulator [--venue binance|kraken|coinbase] [--port N] [--plain]\n"
+        "    [--rate UPDATES_PER_SECOND] [--depth LEVELS] [--symbols NAME:MID:TICK,...]\n"
+        "    [--replay FILE] [--seed N] [--cert-out FILE] [--binance-secret SECRET]");
+}
+
+// "BTCUSDT:43000:0.01,ETHUSDT:2250:0.01"
+std::vector<crypto_hft::SimSymbol> parseSymbols(const std::string& text) {
+    std::vector<crypto_hft::SimSymbol> symbols;
+    std::stringstream list(text);
+    std::string entry;
+    while (std::getline(list, entry, ',')) {
+        std::stringstream fields(entry);
+        std::string name, mid, tick;
+        std::getline(fields, name, ':');
+        std::getline(fields, mid, ':');
+        std::getline(fields, tick, ':');
+        if (name.empty() || mid.empty()) {
+            throw std::invalid_argument("Bad symbol '" + entry + "', expected NAME:MID[:TICK]");
+        }
+        crypto_hft::SimSymbol symbol;
+        symbol.name = name;
+        symbol.midPrice = std::stod(mid);
+        if (!tick.empty()) {
+            symbol.tick = std::stod(tick);
+        }
+        symbols.push_back(std::move(symbol));
+    }
+    return symbols;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    crypto_hft::ExchangeSimulator::Options options;
+    std::string certOut;
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            auto value = [&]() -> std::string {
+                if (i + 1 >= argc) {
+                    throw std::invalid_argument("Missing value for " + arg);
+                }
+                return argv[++i];
+            };
+            if (arg == "--venue") {
+                options.venue = value();
+            } else if (arg == "--port") {
+                options.port = static_cast<uint16_t>(std::stoul(value()));
+            } else if (arg == "--plain") {
+                options.tls = false;
+            } else if (arg == "--rate") {
+                options.updatesPerSecond = std::stod(value());
+            } else if (arg == "--depth") {
+                options.depth = std::stoul(value());
+            } else if (arg == "--symbols") {
+                options.symbols = parseSymbols(value());
+            } else if (arg == "--replay") {
+                options.replayFile = value();
+            } else if (arg == "--seed") {
+                options.seed = std::stoull(value());
+            } else if (arg == "--cert-out") {
+                certOut = value();
+            } else if (arg == "--binance-secret") {
+                options.binanceSecret = value();
+            } else {
+                usage();
+                return arg == "--help" ? 0 : 1;
+            }
+        }
+
+        crypto_hft::ExchangeSimulator simulator(options);
+        if (!certOut.empty() && !simulator.certificatePem().empty()) {
+            std::ofstream(certOut) << simulator.certificatePem();
+        }
+        spdlog::info("Simulating {} on {}://{}:{}", options.venue, options.tls ? "wss" : "ws",
+                     options.address, simulator.port());
+
+        std::signal(SIGINT, [](int) { g_stop = true; });
+        std::signal(SIGTERM, [](int) { g_stop = true; });
+        simulator.start();
+
+        auto lastReport = std::chrono::steady_clock::now();
+        while (!g_stop) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            if (std::chrono::steady_clock::now() - lastReport >= std::chrono::seconds(10)) {
+                lastReport = std::chrono::steady_clock::now();
+                const auto stats = simulator.getStats();
+                spdlog::info("sessions={} messages={} updates={} frames={} bytes={} orders={} "
+                             "fills={}",
+                             stats.sessions, stats.messages, stats.bookUpdates, stats.framesSent,
+                             stats.bytesSent, stats.orders, stats.fills);
+            }
+        }
+        spdlog::info("Shutting down...");
+        simulator.stop();
+    } catch (const std::exception& e) {
+        spdlog::error("Fatal Error: {}", e.what());
+        return 1;
+    }
+
+    return 0;
+}
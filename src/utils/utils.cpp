@@ -76,15 +76,6 @@ namespace utils {
             key_secret.replace(pos, 2, "\n");
         }
 
-        // Logging for debugging
-        std::cout << "[coinbase_create_jwt] key_name: " << key_name << std::endl;
-        if (key_secret.length() > 40) {
-            std::cout << "[coinbase_create_jwt] key_secret (first 20): " << key_secret.substr(0, 20) << std::endl;
-            std::cout << "[coinbase_create_jwt] key_secret (last 20): " << key_secret.substr(key_secret.length() - 20) << std::endl;
-        } else {
-            std::cout << "[coinbase_create_jwt] key_secret: " << key_secret << std::endl;
-        }
-
         // Generate a random nonce
         unsigned char nonce_raw[16];
         RAND_bytes(nonce_raw, sizeof(nonce_raw));
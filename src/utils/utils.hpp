@@ -72,6 +72,7 @@ struct ExecReport {
 };
 
 bool load_env_file(const std::string& path = ".env");
+// Parses the key and signs a fresh token on every call; CoinbaseJwtProvider caches them
 std::string coinbase_create_jwt();
 
 } // namespace utils
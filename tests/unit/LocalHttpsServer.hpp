@@ -0,0 +1,143 @@
+#pragma once
+
+#include "../../src/sim/SelfSignedCertificate.hpp"
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/ssl.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <boost/beast/ssl.hpp>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace crypto_hft {
+
+// Keep-alive HTTPS server on the loopback interface with a throwaway self-signed certificate.
+// Requests on a connection are answered one after another, in order, by the handler, which runs
+// on the server thread and may block it.
+class LocalHttpsServer {
+public:
+    using Request = boost::beast::http::request<boost::beast::http::string_body>;
+    using Response = boost::beast::http::response<boost::beast::http::string_body>;
+    using Handler = std::function<Response(const Request&)>;
+
+    explicit LocalHttpsServer(Handler handler)
+        : ctx_(boost::asio::ssl::context::tls_server)
+        , acceptor_(ioc_, {boost::asio::ip::make_address("127.0.0.1"), 0})
+        , handler_(std::move(handler)) {
+        useSelfSignedCertificate(ctx_);
+        accept();
+        thread_ = std::thread([this] { ioc_.run(); });
+    }
+
+    ~LocalHttpsServer() {
+        boost::asio::post(ioc_, [this] {
+            acceptor_.close();
+            for (auto& session : sessions_) {
+                boost::beast::get_lowest_layer(session->stream).close();
+            }
+        });
+        ioc_.stop();
+        thread_.join();
+    }
+
+    std::string port() const { return std::to_string(acceptor_.local_endpoint().port()); }
+
+    std::size_t connections() const { return connections_.load(); }
+    std::size_t requests() const { return requests_.load(); }
+
+    // A handler returning this gets the connection closed without an answer
+    static Response hangUp() { return Response{static_cast<boost::beast::http::status>(444), 11}; }
+
+    // Builds a response to request with the given status and body
+    static Response reply(const Request& request, unsigned status, std::string body) {
+        Response response{static_cast<boost::beast::http::status>(status), request.version()};
+        response.set(boost::beast::http::field::content_type, "application/json");
+        response.keep_alive(request.keep_alive());
+        response.body() = std::move(body);
+        response.prepare_payload();
+        return response;
+    }
+
+private:
+    struct Session {
+        Session(boost::asio::ip::tcp::socket socket, boost::asio::ssl::context& ctx)
+            : stream(std::move(socket), ctx) {}
+        boost::beast::ssl_stream<boost::beast::tcp_stream> stream;
+        boost::beast::flat_buffer buffer;
+        Request request;
+        Response response;
+    };
+    using SessionPtr = std::shared_ptr<Session>;
+
+    void accept() {
+        acceptor_.async_accept(
+            [this](boost::beast::error_code ec, boost::asio::ip::tcp::socket socket) {
+                if (ec) {
+                    return;
+                }
+                ++connections_;
+                // As a venue's servers do; otherwise Nagle holds back every other TLS record
+                boost::beast::error_code ignored;
+                socket.set_option(boost::asio::ip::tcp::no_delay(true), ignored);
+                auto session = std::make_shared<Session>(std::move(socket), ctx_);
+                sessions_.push_back(session);
+                session->stream.async_handshake(boost::asio::ssl::stream_base::server,
+                    [this, session](boost::beast::error_code ec) {
+                        if (!ec) {
+                            read(session);
+                        }
+                    });
+                accept();
+            });
+    }
+
+    void read(const SessionPtr& session) {
+        session->request = {};
+        boost::beast::http::async_read(session->stream, session->buffer, session->request,
+            [this, session](boost::beast::error_code ec, std::size_t) {
+                if (ec) {
+                    close(session);
+                    return;
+                }
+                ++requests_;
+                session->response = handler_(session->request);
+                if (session->response.result_int() == 444) {
+                    close(session);
+                    return;
+                }
+                boost::beast::http::async_write(session->stream, session->response,
+                    [this, session](boost::beast::error_code ec, std::size_t) {
+                        if (ec || !session->response.keep_alive()) {
+                            close(session);
+                            return;
+                        }
+                        read(session);
+                    });
+            });
+    }
+
+    void close(const SessionPtr& session) {
+        boost::beast::error_code ignored;
+        boost::beast::get_lowest_layer(session->stream).socket().close(ignored);
+        sessions_.erase(std::remove(sessions_.begin(), sessions_.end(), session),
+                        sessions_.end());
+    }
+
+    boost::asio::io_context ioc_;
+    boost::asio::ssl::context ctx_;
+    boost::asio::ip::tcp::acceptor acceptor_;
+    Handler handler_;
+    std::vector<SessionPtr> sessions_;  // Server thread only
+    std::atomic<std::size_t> connections_{0};
+    std::atomic<std::size_t> requests_{0};
+    std::thread thread_;
+};
+
+} // namespace crypto_hft
@@ -0,0 +1,183 @@
+#pragma once
+
+#include "../../src/sim/SelfSignedCertificate.hpp"
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/ssl.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/ssl.hpp>
+#include <boost/beast/websocket.hpp>
+#include <boost/beast/websocket/ssl.hpp>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace crypto_hft {
+
+// Secure WebSocket server on the loopback interface with a throwaway self-signed certificate.
+// Sessions record the text they receive and can be sent to or dropped from the test thread.
+// With a handler, each message is answered with the frames it returns, in order, before the
+// session reads the next; the handler runs on the server thread.
+class LocalWsServer {
+public:
+    using Handler = std::function<std::vector<std::string>(const std::string&)>;
+
+    explicit LocalWsServer(bool deflate = false) : LocalWsServer(deflate, nullptr) {}
+
+    // Constrained so that a lambda is not taken for the deflate flag
+    template <typename Function,
+              typename = std::enable_if_t<std::is_invocable_v<Function&, const std::string&>>>
+    explicit LocalWsServer(Function handler) : LocalWsServer(false, Handler(std::move(handler))) {}
+
+    LocalWsServer(bool deflate, Handler handler)
+        : ctx_(boost::asio::ssl::context::tls_server)
+        , acceptor_(ioc_, {boost::asio::ip::make_address("127.0.0.1"), 0})
+        , deflate_(deflate)
+        , handler_(std::move(handler)) {
+        useSelfSignedCertificate(ctx_);
+        accept();
+        thread_ = std::thread([this] { ioc_.run(); });
+    }
+
+    ~LocalWsServer() {
+        boost::asio::post(ioc_, [this] {
+            acceptor_.close();
+            for (auto& session : sessions_) {
+                boost::beast::get_lowest_layer(session->ws).close();
+            }
+        });
+        ioc_.stop();
+        thread_.join();
+    }
+
+    std::string port() const { return std::to_string(acceptor_.local_endpoint().port()); }
+
+    std::size_t accepted() const { return accepted_.load(); }
+
+    // Messages received on all sessions, in arrival order
+    std::vector<std::string> received() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return received_;
+    }
+
+    void sendToAll(const std::string& text) {
+        boost::asio::post(ioc_, [this, text] {
+            for (auto& session : sessions_) {
+                auto message = std::make_shared<std::string>(text);
+                session->ws.async_write(boost::asio::buffer(*message),
+                    [message, session](boost::beast::error_code, std::size_t) {});
+            }
+        });
+    }
+
+    // Drops sessions that have received a message (the client's active one) or all sessions
+    void drop(bool onlyActive) {
+        boost::asio::post(ioc_, [this, onlyActive] {
+            for (auto& session : sessions_) {
+                if (!onlyActive || session->messages > 0) {
+                    boost::beast::get_lowest_layer(session->ws).close();
+                }
+            }
+        });
+    }
+
+private:
+    struct Session {
+        Session(boost::asio::ip::tcp::socket socket, boost::asio::ssl::context& ctx)
+            : ws(std::move(socket), ctx) {}
+        boost::beast::websocket::stream<boost::beast::ssl_stream<boost::beast::tcp_stream>> ws;
+        boost::beast::flat_buffer buffer;
+        std::vector<std::string> replies;
+        int messages = 0;
+    };
+    using SessionPtr = std::shared_ptr<Session>;
+
+    void accept() {
+        acceptor_.async_accept(
+            [this](boost::beast::error_code ec, boost::asio::ip::tcp::socket socket) {
+                if (ec) {
+                    return;
+                }
+                // As a venue's servers do; otherwise Nagle holds back every other TLS record
+                boost::beast::error_code ignored;
+                socket.set_option(boost::asio::ip::tcp::no_delay(true), ignored);
+                auto session = std::make_shared<Session>(std::move(socket), ctx_);
+                if (deflate_) {
+                    boost::beast::websocket::permessage_deflate options;
+                    options.server_enable = true;
+                    session->ws.set_option(options);
+                }
+                sessions_.push_back(session);
+                session->ws.next_layer().async_handshake(boost::asio::ssl::stream_base::server,
+                    [this, session](boost::beast::error_code ec) {
+                        if (ec) {
+                            return;
+                        }
+                        session->ws.async_accept([this, session](boost::beast::error_code ec) {
+                            if (!ec) {
+                                ++accepted_;
+                                read(session);
+                            }
+                        });
+                    });
+                accept();
+            });
+    }
+
+    void read(const SessionPtr& session) {
+        session->ws.async_read(session->buffer,
+            [this, session](boost::beast::error_code ec, std::size_t) {
+                if (ec) {
+                    sessions_.erase(std::remove(sessions_.begin(), sessions_.end(), session),
+                                    sessions_.end());
+                    return;
+                }
+                ++session->messages;
+                std::string message = boost::beast::buffers_to_string(session->buffer.data());
+                session->buffer.consume(session->buffer.size());
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    received_.push_back(message);
+                }
+                if (handler_) {
+                    session->replies = handler_(message);
+                    reply(session, 0);
+                    return;
+                }
+                read(session);
+            });
+    }
+
+    void reply(const SessionPtr& session, std::size_t index) {
+        if (index == session->replies.size()) {
+            read(session);
+            return;
+        }
+        session->ws.async_write(boost::asio::buffer(session->replies[index]),
+            [this, session, index](boost::beast::error_code ec, std::size_t) {
+                if (!ec) {
+                    reply(session, index + 1);
+                }
+            });
+    }
+
+    boost::asio::io_context ioc_;
+    boost::asio::ssl::context ctx_;
+    boost::asio::ip::tcp::acceptor acceptor_;
+    bool deflate_;
+    Handler handler_;
+    std::vector<SessionPtr> sessions_;  // Server thread only
+    std::atomic<std::size_t> accepted_{0};
+    std::mutex mutex_;
+    std::vector<std::string> received_;
+    std::thread thread_;
+};
+
+} // namespace crypto_hft
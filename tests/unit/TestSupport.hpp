@@ -0,0 +1,76 @@
+#pragma once
+
+#include "../../src/exchanges/IExchangeAdapter.hpp"
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+#include <gtest/gtest.h>
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <chrono>
+#include <cstdio>
+#include <optional>
+#include <string>
+#include <thread>
+
+namespace crypto_hft {
+
+// Polls until the predicate holds or the timeout expires
+template <typename Predicate>
+bool eventually(Predicate predicate, std::chrono::milliseconds timeout = std::chrono::seconds(5)) {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (std::chrono::steady_clock::now() < deadline) {
+        if (predicate()) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return predicate();
+}
+
+// HMAC of data in lowercase hex, the way the venues expect request signatures
+inline std::string hmacHex(const EVP_MD* md, const std::string& key, const std::string& data) {
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    unsigned int length = 0;
+    HMAC(md, key.data(), static_cast<int>(key.size()),
+         reinterpret_cast<const unsigned char*>(data.data()), data.size(), digest, &length);
+    std::string out;
+    char byte[3];
+    for (unsigned int i = 0; i < length; ++i) {
+        std::snprintf(byte, sizeof(byte), "%02x", digest[i]);
+        out += byte;
+    }
+    return out;
+}
+
+inline OrderRequest limitBuy(const std::string& symbol, const std::string& clientOrderId) {
+    OrderRequest order;
+    order.symbol = symbol;
+    order.side = OrderRequest::Side::BUY;
+    order.type = OrderRequest::Type::LIMIT;
+    order.price = 42000.5;
+    order.size = 0.0015;
+    order.clientOrderId = clientOrderId;
+    return order;
+}
+
+// Runs ioc_ on a thread of its own for the length of each test. Fixtures that keep clients on
+// it shut them down in their own TearDown() before calling this one.
+class IoContextTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        work_.emplace(boost::asio::make_work_guard(ioc_));
+        thread_ = std::thread([this] { ioc_.run(); });
+    }
+
+    void TearDown() override {
+        work_.reset();
+        ioc_.stop();
+        thread_.join();
+    }
+
+    boost::asio::io_context ioc_;
+    std::optional<boost::asio::executor_work_guard<boost::asio::io_context::executor_type>> work_;
+    std::thread thread_;
+};
+
+} // namespace crypto_hft
@@ -0,0 +1,161 @@
+#include "../../src/exchanges/BinanceAdapter.hpp"
+#include "../../src/exchanges/CoinbaseAdapter.hpp"
+#include "../../src/exchanges/KrakenAdapter.hpp"
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <string>
+#include <vector>
+
+using namespace crypto_hft;
+
+// Counts heap allocations made by the current thread while enabled. The adapters' IO threads
+// run concurrently and are not counted.
+namespace {
+thread_local bool countAllocations = false;
+thread_local std::size_t allocationCount = 0;
+} // namespace
+
+void* operator new(std::size_t size) {
+    if (countAllocations) {
+        ++allocationCount;
+    }
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+// GCC pairs the free() below with inlined new-expressions and flags a mismatch that cannot
+// happen: every operator new in this binary is the malloc-backed one above.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+void operator delete[](void* p) noexcept {
+    operator delete(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    operator delete(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+    operator delete(p);
+}
+
+namespace {
+
+// Book and heartbeat frames: the steady-state traffic. Subscription acks and other control
+// messages are once-per-session and go through json on purpose.
+template <typename Parser>
+std::vector<std::string> loadSteadyStateFrames(const std::string& name) {
+    std::ifstream file(std::string(CORPUS_DIR) + "/" + name);
+    std::vector<std::string> frames;
+    std::string line;
+    OrderBookSnapshot snapshot;
+    OrderBookDelta delta;
+    while (std::getline(file, line)) {
+        FrameType type = Parser::parse(line, snapshot, delta);
+        if (type == FrameType::BookSnapshot || type == FrameType::BookDelta ||
+            type == FrameType::Heartbeat) {
+            frames.push_back(line);
+        }
+    }
+    return frames;
+}
+
+// Advanced Trade frames go through the batch parser; the single-product one rejects the
+// messages that carry several products
+struct CoinbaseBatchParser {
+    static FrameType parse(std::string_view frame, OrderBookSnapshot&, OrderBookDelta&) {
+        static CoinbaseBookBatch batch;
+        return CoinbaseFrameParser::parse(frame, batch);
+    }
+};
+
+// The frames with every sequence_num moved up by offset, so a second pass continues the first
+// instead of reading as a gap
+std::vector<std::string> renumber(std::vector<std::string> frames, uint64_t offset) {
+    static constexpr std::string_view key = "\"sequence_num\":";
+    for (auto& frame : frames) {
+        std::size_t start = frame.find(key);
+        if (start == std::string::npos) {
+            continue;
+        }
+        start += key.size();
+        std::size_t end = frame.find_first_not_of("0123456789", start);
+        uint64_t sequence = std::stoull(frame.substr(start, end - start));
+        frame.replace(start, end - start, std::to_string(sequence + offset));
+    }
+    return frames;
+}
+
+template <typename Adapter>
+void expectNoSteadyStateAllocations(const std::vector<std::string>& warmup,
+                                    const std::vector<std::string>& frames) {
+    ASSERT_FALSE(frames.empty());
+
+    Adapter adapter;
+    adapter.setFrameCaptureSampling(0);
+    std::size_t levels = 0;
+    adapter.registerOrderBookCallback([&levels](const OrderBookSnapshot& snapshot) {
+        levels += snapshot.bids.size() + snapshot.asks.size();
+    });
+    adapter.registerOrderBookDeltaCallback([&levels](const OrderBookDelta& delta) {
+        levels += delta.bidUpdates.size() + delta.askUpdates.size();
+    });
+
+    // The first pass sizes the reused parse outputs
+    for (const auto& frame : warmup) {
+        adapter.handle_frame(frame);
+    }
+    ASSERT_GT(levels, 0u);
+
+    allocationCount = 0;
+    countAllocations = true;
+    for (const auto& frame : frames) {
+        adapter.handle_frame(frame);
+    }
+    countAllocations = false;
+
+    EXPECT_EQ(allocationCount, 0u) << "over " << frames.size() << " frames";
+}
+
+template <typename Adapter, typename Parser>
+void expectNoSteadyStateAllocations(const std::string& corpus) {
+    auto frames = loadSteadyStateFrames<Parser>(corpus);
+    expectNoSteadyStateAllocations<Adapter>(frames, frames);
+}
+
+} // namespace
+
+TEST(AdapterAllocationTest, BinanceFramesDoNotAllocate) {
+    expectNoSteadyStateAllocations<BinanceAdapter, BinanceFrameParser>("binance_book.jsonl");
+}
+
+TEST(AdapterAllocationTest, CoinbaseFramesDoNotAllocate) {
+    expectNoSteadyStateAllocations<CoinbaseAdapter, CoinbaseFrameParser>("coinbase_book.jsonl");
+}
+
+TEST(AdapterAllocationTest, CoinbaseAdvancedFramesDoNotAllocate) {
+    auto frames = loadSteadyStateFrames<CoinbaseBatchParser>("coinbase_advanced_book.jsonl");
+    ASSERT_FALSE(frames.empty());
+    expectNoSteadyStateAllocations<CoinbaseAdapter>(frames, renumber(frames, frames.size()));
+}
+
+TEST(AdapterAllocationTest, KrakenFramesDoNotAllocate) {
+    expectNoSteadyStateAllocations<KrakenAdapter, KrakenFrameParser>("kraken_book.jsonl");
+}
@@ -0,0 +1,181 @@
+#include "../../src/exchanges/BinanceAdapter.hpp"
+#include "../../src/exchanges/CoinbaseAdapter.hpp"
+#include "../../src/exchanges/KrakenAdapter.hpp"
+#include <gtest/gtest.h>
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+using namespace crypto_hft;
+
+namespace {
+
+struct EventCounts {
+    std::size_t snapshots = 0;
+    std::size_t deltas = 0;
+    std::size_t quotes = 0;
+    std::size_t levels = 0;
+    double volume = 0.0;  // Sum of level sizes, so two runs agree on content as well as count
+
+    bool operator==(const EventCounts&) const = default;
+};
+
+// A sink known at compile time: the adapter calls it directly
+struct CountingSink {
+    EventCounts counts;
+
+    void onSnapshot(const OrderBookSnapshot& snapshot) {
+        ++counts.snapshots;
+        for (const auto* side : {&snapshot.bids, &snapshot.asks}) {
+            for (const auto& [price, size] : *side) {
+                ++counts.levels;
+                counts.volume += size;
+            }
+        }
+    }
+    void onDelta(const OrderBookDelta& delta) {
+        ++counts.deltas;
+        for (const auto* side : {&delta.bidUpdates, &delta.askUpdates}) {
+            for (const auto& [price, size] : *side) {
+                ++counts.levels;
+                counts.volume += size;
+            }
+        }
+    }
+    void onTopOfBook(const TopOfBookUpdate&) { ++counts.quotes; }
+};
+
+static_assert(BookEventSink<CountingSink>);
+static_assert(BookEventSink<CallbackSink>);
+
+std::vector<std::string> loadFrames(const std::string& name) {
+    std::ifstream file(std::string(CORPUS_DIR) + "/" + name);
+    std::vector<std::string> frames;
+    std::string line;
+    while (std::getline(file, line)) {
+        frames.push_back(line);
+    }
+    return frames;
+}
+
+// The events of the corpus as delivered through IExchangeAdapter's callbacks
+template <template <typename> class Adapter>
+EventCounts throughCallbacks(const std::vector<std::string>& frames) {
+    Adapter<CallbackSink> adapter;
+    adapter.setFrameCaptureSampling(0);
+    CountingSink counter;
+    IExchangeAdapter& control = adapter;
+    control.registerOrderBookCallback(
+        [&counter](const OrderBookSnapshot& snapshot) { counter.onSnapshot(snapshot); });
+    control.registerOrderBookDeltaCallback(
+        [&counter](const OrderBookDelta& delta) { counter.onDelta(delta); });
+    control.registerTopOfBookCallback(
+        [&counter](const TopOfBookUpdate& quote) { counter.onTopOfBook(quote); });
+    for (const auto& frame : frames) {
+        adapter.handle_frame(frame);
+    }
+    return counter.counts;
+}
+
+template <template <typename> class Adapter>
+void expectSameEventsAsCallbacks(const std::string& corpus) {
+    auto frames = loadFrames(corpus);
+    ASSERT_FALSE(frames.empty());
+
+    Adapter<CountingSink> adapter;
+    adapter.setFrameCaptureSampling(0);
+    for (const auto& frame : frames) {
+        adapter.handle_frame(frame);
+    }
+    const EventCounts& counts = adapter.sink().counts;
+    EXPECT_GT(counts.snapshots + counts.deltas, 0u);
+    EXPECT_EQ(counts, throughCallbacks<Adapter>(frames));
+}
+
+} // namespace
+
+TEST(AdapterCoreTest, BinanceSinkSeesTheCallbackEvents) {
+    expectSameEventsAsCallbacks<BasicBinanceAdapter>("binance_book.jsonl");
+}
+
+TEST(AdapterCoreTest, CoinbaseSinkSeesTheCallbackEvents) {
+    expectSameEventsAsCallbacks<BasicCoinbaseAdapter>("coinbase_advanced_book.jsonl");
+}
+
+TEST(AdapterCoreTest, KrakenSinkSeesTheCallbackEvents) {
+    expectSameEventsAsCallbacks<BasicKrakenAdapter>("kraken_book.jsonl");
+}
+
+TEST(AdapterCoreTest, CallbacksDoNotReplaceAStaticSink) {
+    BasicKrakenAdapter<CountingSink> adapter;
+    adapter.setFrameCaptureSampling(0);
+    bool called = false;
+    IExchangeAdapter& control = adapter;
+    control.registerOrderBookCallback([&called](const OrderBookSnapshot&) { called = true; });
+    control.registerOrderBookDeltaCallback([&called](const OrderBookDelta&) { called = true; });
+
+    for (const auto& frame : loadFrames("kraken_book.jsonl")) {
+        adapter.handle_frame(frame);
+    }
+    EXPECT_FALSE(called);
+    EXPECT_GT(adapter.sink().counts.snapshots, 0u);
+    EXPECT_EQ(control.getName(), "Kraken");
+}
+
+TEST(AdapterCoreTest, ReplayedRecordingsTakeTheFramePath) {
+    const std::string path = std::string(CORPUS_DIR) + "/kraken_book.jsonl";
+    const auto frames = loadFrames("kraken_book.jsonl");
+
+    BasicKrakenAdapter<CountingSink> replayed;
+    replayed.setFrameCaptureSampling(0);
+    EXPECT_EQ(replayed.replayFile(path), frames.size());
+    EXPECT_EQ(replayed.sink().counts, throughCallbacks<BasicKrakenAdapter>(frames));
+    EXPECT_EQ(replayed.getChecksumFailures(), 0u);
+
+    // CRLF line ends, blank lines and a last frame without a newline
+    std::string recording;
+    for (const auto& frame : frames) {
+        recording += frame + "\r\n\n";
+    }
+    recording.resize(recording.size() - 3);
+    BasicKrakenAdapter<CountingSink> fromMemory;
+    fromMemory.setFrameCaptureSampling(0);
+    EXPECT_EQ(fromMemory.replayFrames(recording), frames.size());
+    EXPECT_EQ(fromMemory.sink().counts, replayed.sink().counts);
+    EXPECT_EQ(fromMemory.getSkippedReplayFrames(), 0u);
+
+    // A frame that fails to parse is skipped, not the rest of the recording
+    std::string damaged = frames.front() + "\n{\"event\":\n";
+    for (std::size_t i = 1; i < frames.size(); ++i) {
+        damaged += frames[i] + "\n";
+    }
+    BasicKrakenAdapter<CountingSink> fromDamaged;
+    fromDamaged.setFrameCaptureSampling(0);
+    EXPECT_EQ(fromDamaged.replayFrames(damaged), frames.size());
+    EXPECT_EQ(fromDamaged.getSkippedReplayFrames(), 1u);
+    EXPECT_EQ(fromDamaged.sink().counts, replayed.sink().counts);
+
+    EXPECT_THROW(fromMemory.replayFile(path + ".missing"), std::system_error);
+}
+
+TEST(AdapterCoreTest, ControlPlaneIsSharedAcrossVenues) {
+    // Without a session or order entry nothing is sent, on any venue
+    std::vector<std::unique_ptr<IExchangeAdapter>> adapters;
+    adapters.push_back(std::make_unique<CoinbaseAdapter>());
+    adapters.push_back(std::make_unique<KrakenAdapter>());
+    adapters.push_back(std::make_unique<BinanceAdapter>());
+    OrderRequest order{};
+    order.symbol = "BTC-USD";
+    for (const auto& adapter : adapters) {
+        EXPECT_FALSE(adapter->isConnected());
+        EXPECT_TRUE(adapter->subscribe({"BTC-USD"}));  // Queued until connected
+        EXPECT_FALSE(adapter->unsubscribe({"BTC-USD"}));
+        EXPECT_EQ(adapter->submitOrder(order), "");
+        EXPECT_FALSE(adapter->cancelOrder("1"));
+        EXPECT_TRUE(adapter->getAllBalances().empty());
+    }
+    EXPECT_EQ(adapters[0]->getName(), "coinbase");
+    EXPECT_EQ(adapters[1]->getName(), "Kraken");
+    EXPECT_EQ(adapters[2]->getName(), "Binance");
+}
@@ -0,0 +1,91 @@
+#include "../../src/exchanges/AdapterRuntime.hpp"
+#include "../../src/exchanges/BinanceAdapter.hpp"
+#include "../../src/exchanges/KrakenAdapter.hpp"
+#include <gtest/gtest.h>
+#include <boost/asio/post.hpp>
+#include <future>
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+using namespace crypto_hft;
+
+TEST(AdapterRuntimeTest, ConfigFromYaml) {
+    YAML::Node node = YAML::Load(
+        "contexts: 2\n"
+        "cpu_affinity: [3, -1]\n"
+        "venues: {binance: 1, kraken: 0}\n");
+    auto config = AdapterRuntime::Config::fromYaml(node);
+    EXPECT_EQ(config.contexts, 2u);
+    EXPECT_EQ(config.cpus, (std::vector<int>{3, -1}));
+    EXPECT_EQ(config.venues.at("binance"), 1u);
+    EXPECT_EQ(config.venues.at("kraken"), 0u);
+
+    auto defaults = AdapterRuntime::Config::fromYaml(YAML::Node());
+    EXPECT_EQ(defaults.contexts, 1u);
+    EXPECT_TRUE(defaults.cpus.empty());
+}
+
+TEST(AdapterRuntimeTest, VenuesMapToConfiguredAndStickyContexts) {
+    AdapterRuntime::Config config;
+    config.contexts = 3;
+    config.venues["binance"] = 2;
+    AdapterRuntime runtime(config);
+    ASSERT_EQ(runtime.size(), 3u);
+
+    EXPECT_EQ(&runtime.contextFor("binance"), &runtime.context(2));
+
+    // Unconfigured venues are spread round-robin and keep their first assignment
+    auto& coinbase = runtime.contextFor("coinbase");
+    auto& kraken = runtime.contextFor("kraken");
+    EXPECT_NE(&coinbase, &kraken);
+    EXPECT_EQ(&runtime.contextFor("coinbase"), &coinbase);
+}
+
+TEST(AdapterRuntimeTest, OneThreadPerContext) {
+    AdapterRuntime::Config config;
+    config.contexts = 2;
+    AdapterRuntime runtime(config);
+    runtime.start();
+
+    std::promise<std::thread::id> first;
+    std::promise<std::thread::id> second;
+    boost::asio::post(runtime.context(0), [&] { first.set_value(std::this_thread::get_id()); });
+    boost::asio::post(runtime.context(1), [&] { second.set_value(std::this_thread::get_id()); });
+    auto a = first.get_future().get();
+    auto b = second.get_future().get();
+    EXPECT_NE(a, b);
+    EXPECT_NE(a, std::this_thread::get_id());
+
+    runtime.stop();
+    EXPECT_FALSE(runtime.isRunning());
+}
+
+#if defined(__linux__)
+TEST(AdapterRuntimeTest, PinsIoThreads) {
+    AdapterRuntime::Config config;
+    config.cpus = {0};
+    AdapterRuntime runtime(config);
+    runtime.start();
+
+    std::promise<int> cpu;
+    boost::asio::post(runtime.context(0), [&] { cpu.set_value(sched_getcpu()); });
+    EXPECT_EQ(cpu.get_future().get(), 0);
+}
+#endif
+
+TEST(AdapterRuntimeTest, AdaptersShareAndReleaseContexts) {
+    auto runtime = std::make_shared<AdapterRuntime>();
+    runtime->start();
+    {
+        BinanceAdapter binance(runtime);
+        KrakenAdapter kraken(runtime);
+        KrakenAdapter krakenStandby(runtime);
+    }
+
+    // The shared context keeps serving work after its adapters are gone
+    std::promise<void> ran;
+    boost::asio::post(runtime->context(0), [&] { ran.set_value(); });
+    EXPECT_EQ(ran.get_future().wait_for(std::chrono::seconds(5)), std::future_status::ready);
+    runtime->stop();
+}
@@ -0,0 +1,202 @@
+#include "../../src/exchanges/BinanceAdapter.hpp"
+#include "../../src/exchanges/ClockOffsetEstimator.hpp"
+#include "../../src/exchanges/ServerTimeProbe.hpp"
+#include "LocalHttpsServer.hpp"
+#include "TestSupport.hpp"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <optional>
+#include <thread>
+#include <vector>
+
+using namespace crypto_hft;
+namespace net = boost::asio;
+
+namespace {
+
+constexpr int64_t kMs = 1000000;
+// Venue clock minus local steady clock in these tests
+constexpr int64_t kOffset = 1600000000000000000;
+
+// A venue whose messages take 2 to 6 ms to arrive, sent every 10 ms from local time start on
+struct Feed {
+    int64_t start = ClockOffsetEstimator::steadyNowNs();
+    int64_t offset = kOffset;
+    int sent = 0;
+
+    int64_t latency(int i) const { return 2 * kMs + (i % 5) * kMs; }
+
+    // Sends count messages into clock; returns the local time after the last
+    int64_t send(ClockOffsetEstimator& clock, int count) {
+        int64_t received = 0;
+        for (int end = sent + count; sent < end; ++sent) {
+            const int64_t at = start + sent * 10 * kMs;
+            received = at + latency(sent);
+            clock.onEvent(at + offset, received);
+        }
+        return received;
+    }
+};
+
+} // namespace
+
+TEST(ClockOffsetEstimatorTest, NoEstimateBeforeObservations) {
+    ClockOffsetEstimator clock;
+    EXPECT_FALSE(clock.estimate().valid);
+    EXPECT_EQ(clock.toLocal(kOffset), 0);
+}
+
+TEST(ClockOffsetEstimatorTest, EventsAloneBoundTheOffsetFromBelow) {
+    ClockOffsetEstimator clock;
+    Feed feed;
+    feed.send(clock, 100);
+
+    // Without round trips the least delayed message is taken to have arrived instantly
+    auto estimate = clock.estimate();
+    ASSERT_TRUE(estimate.valid);
+    EXPECT_EQ(estimate.offsetNs, kOffset - 2 * kMs);
+    EXPECT_EQ(estimate.uncertaintyNs, -1);
+    EXPECT_EQ(estimate.minOneWayLatencyNs, 0);
+    EXPECT_EQ(estimate.events, 100u);
+    EXPECT_EQ(clock.toLocal(feed.start + kOffset), feed.start + 2 * kMs);
+}
+
+TEST(ClockOffsetEstimatorTest, RoundTripsCentreTheEstimate) {
+    ClockOffsetEstimator clock;
+    Feed feed;
+    feed.send(clock, 10);
+    clock.onRoundTrip(4 * kMs);
+    feed.send(clock, 500);
+
+    auto estimate = clock.estimate();
+    ASSERT_TRUE(estimate.valid);
+    EXPECT_NEAR(static_cast<double>(estimate.offsetNs), static_cast<double>(kOffset), 10000.0);
+    EXPECT_EQ(estimate.uncertaintyNs, 2 * kMs);
+    EXPECT_EQ(estimate.minRoundTripNs, 4 * kMs);
+    EXPECT_NEAR(static_cast<double>(estimate.minOneWayLatencyNs), 2.0 * kMs, 10000.0);
+    EXPECT_GT(estimate.oneWayLatencyNs, 2 * kMs);
+    EXPECT_LT(estimate.oneWayLatencyNs, 6 * kMs);
+    EXPECT_EQ(estimate.steps, 0u);
+}
+
+TEST(ClockOffsetEstimatorTest, ServerTimeTighterThanEventsWins) {
+    ClockOffsetEstimator clock;
+    Feed feed;
+    int64_t now = feed.send(clock, 10);
+
+    // Answered 200 us after asking, with the venue time truncated to the millisecond
+    const int64_t truth = now + 100000 + kOffset;
+    clock.onServerTime(truth - truth % kMs, now, now + 200000, kMs);
+    feed.send(clock, 300);
+
+    auto estimate = clock.estimate();
+    EXPECT_EQ(estimate.uncertaintyNs, 600000);
+    EXPECT_EQ(estimate.serverTimes, 1u);
+    EXPECT_NEAR(static_cast<double>(estimate.offsetNs), static_cast<double>(kOffset), 600000.0);
+}
+
+TEST(ClockOffsetEstimatorTest, ServerTimeCannotContradictTheEvents) {
+    ClockOffsetEstimator clock;
+    Feed feed;
+    int64_t now = feed.send(clock, 10);
+
+    // A venue clock 50 ms behind would have its messages arrive before they were sent
+    clock.onServerTime(now + kOffset - 50 * kMs, now, now + 100000, kMs);
+    feed.send(clock, 100);
+    EXPECT_EQ(clock.estimate().offsetNs, kOffset - 2 * kMs);
+}
+
+TEST(ClockOffsetEstimatorTest, StepsWhenTheVenueClockJumps) {
+    ClockOffsetEstimator clock;
+    Feed feed;
+    feed.send(clock, 100);
+    EXPECT_EQ(clock.estimate().offsetNs, kOffset - 2 * kMs);
+
+    feed.offset += 2000 * kMs;
+    feed.send(clock, 100);
+    auto estimate = clock.estimate();
+    EXPECT_EQ(estimate.steps, 1u);
+    EXPECT_EQ(estimate.offsetNs, kOffset + 2000 * kMs - 2 * kMs);
+}
+
+TEST(ClockOffsetEstimatorTest, ProbesTheVenueServerTime) {
+    std::atomic<bool> broken{false};
+    LocalHttpsServer server([&](const LocalHttpsServer::Request& request) {
+        if (broken) {
+            return LocalHttpsServer::reply(request, 200, R"({"unexpected":true})");
+        }
+        const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        return LocalHttpsServer::reply(request, 200,
+                                       R"({"serverTime":)" + std::to_string(ms) + "}");
+    });
+
+    net::io_context ioc;
+    auto work = net::make_work_guard(ioc);
+    std::thread thread([&] { ioc.run(); });
+
+    ServerTimeProbe::Endpoint endpoint;
+    endpoint.rest.host = "localhost";
+    endpoint.rest.port = server.port();
+    endpoint.rest.verifyPeer = false;
+    endpoint.target = "/api/v3/time";
+    endpoint.parse = [](std::string_view body, int64_t& serverTimeNs) {
+        auto data = nlohmann::json::parse(body);
+        if (!data.contains("serverTime")) {
+            return false;
+        }
+        serverTimeNs = data["serverTime"].get<int64_t>() * kMs;
+        return true;
+    };
+    auto clock = std::make_shared<ClockOffsetEstimator>();
+    auto probe = ServerTimeProbe::create(ioc, endpoint, std::chrono::milliseconds(20), clock,
+                                         nullptr);
+    probe->start();
+    ASSERT_TRUE(eventually([&] { return probe->getStats().samples >= 3; }));
+
+    // Here the venue clock is our own wall clock
+    auto estimate = clock->estimate();
+    ASSERT_TRUE(estimate.valid);
+    const int64_t wallOffset =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count() -
+        ClockOffsetEstimator::steadyNowNs();
+    EXPECT_NEAR(static_cast<double>(estimate.offsetNs), static_cast<double>(wallOffset),
+                50.0 * kMs);
+    EXPECT_GT(estimate.uncertaintyNs, 0);
+
+    broken = true;
+    EXPECT_TRUE(eventually([&] { return probe->getStats().failures > 0; }));
+
+    probe->shutdown();
+    work.reset();
+    ioc.stop();
+    thread.join();
+}
+
+TEST(ClockOffsetEstimatorTest, AdaptersStampEventsWithBothClocks) {
+    std::vector<OrderBookDelta> deltas;
+    BinanceAdapter adapter;
+    adapter.setFrameCaptureSampling(0);
+    adapter.registerOrderBookDeltaCallback(
+        [&](const OrderBookDelta& delta) { deltas.push_back(delta); });
+
+    const int64_t before = ClockOffsetEstimator::steadyNowNs();
+    adapter.replayFrames(
+        R"({"e":"depthUpdate","E":1700000000090,"s":"BTCUSDT","U":1,"u":2,"b":[["1","1"]],"a":[]})"
+        "\n"
+        R"({"e":"depthUpdate","E":1700000000190,"s":"BTCUSDT","U":3,"u":4,"b":[["1","2"]],"a":[]})");
+    ASSERT_EQ(deltas.size(), 2u);
+
+    auto estimate = adapter.getClockEstimate();
+    ASSERT_TRUE(estimate.valid);
+    EXPECT_EQ(estimate.events, 2u);
+    for (const auto& delta : deltas) {
+        EXPECT_GE(delta.receiveTime, before);
+        EXPECT_LE(delta.receiveTime, ClockOffsetEstimator::steadyNowNs());
+        EXPECT_NE(delta.exchangeTimeLocal, 0);
+    }
+    EXPECT_EQ(deltas[1].exchangeTime, 1700000000190 * kMs);
+    // The first event set the estimate, so it arrived with no delay at all
+    EXPECT_EQ(deltas[0].exchangeTimeLocal, deltas[0].receiveTime);
+}
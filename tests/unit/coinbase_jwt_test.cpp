@@ -0,0 +1,194 @@
+#include "../../src/exchanges/CoinbaseJwtProvider.hpp"
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+#include <openssl/bn.h>
+#include <openssl/ec.h>
+#include <openssl/ecdsa.h>
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <algorithm>
+#include <set>
+#include <thread>
+#include <vector>
+
+using namespace crypto_hft;
+using json = nlohmann::json;
+
+namespace {
+
+const std::string kKeyName = "organizations/test-org/apiKeys/test-key";
+
+struct KeyPair {
+    EVP_PKEY* key = EVP_EC_gen("P-256");
+    ~KeyPair() { EVP_PKEY_free(key); }
+
+    std::string pem() const {
+        BIO* bio = BIO_new(BIO_s_mem());
+        PEM_write_bio_PrivateKey(bio, key, nullptr, nullptr, 0, nullptr, nullptr);
+        char* data = nullptr;
+        long size = BIO_get_mem_data(bio, &data);
+        std::string out(data, static_cast<std::size_t>(size));
+        BIO_free(bio);
+        return out;
+    }
+};
+
+std::string base64UrlDecode(std::string text) {
+    std::replace(text.begin(), text.end(), '-', '+');
+    std::replace(text.begin(), text.end(), '_', '/');
+    std::size_t padding = (4 - text.size() % 4) % 4;
+    text.append(padding, '=');
+    std::string out(3 * text.size() / 4, '\0');
+    int length = EVP_DecodeBlock(reinterpret_cast<unsigned char*>(out.data()),
+                                 reinterpret_cast<const unsigned char*>(text.data()),
+                                 static_cast<int>(text.size()));
+    out.resize(static_cast<std::size_t>(length) - padding);
+    return out;
+}
+
+struct Decoded {
+    json header;
+    json claims;
+    bool verified = false;
+};
+
+// Splits a JWT and checks its ES256 signature against key
+Decoded decode(const std::string& jwt, EVP_PKEY* key) {
+    std::size_t first = jwt.find('.');
+    std::size_t second = jwt.find('.', first + 1);
+    Decoded decoded;
+    decoded.header = json::parse(base64UrlDecode(jwt.substr(0, first)));
+    decoded.claims = json::parse(base64UrlDecode(jwt.substr(first + 1, second - first - 1)));
+
+    std::string raw = base64UrlDecode(jwt.substr(second + 1));
+    if (raw.size() != 64) {
+        return decoded;
+    }
+    const auto* bytes = reinterpret_cast<const unsigned char*>(raw.data());
+    ECDSA_SIG* signature = ECDSA_SIG_new();
+    ECDSA_SIG_set0(signature, BN_bin2bn(bytes, 32, nullptr), BN_bin2bn(bytes + 32, 32, nullptr));
+    unsigned char* der = nullptr;
+    int derSize = i2d_ECDSA_SIG(signature, &der);
+    ECDSA_SIG_free(signature);
+
+    std::string signingInput = jwt.substr(0, second);
+    EVP_MD_CTX* md = EVP_MD_CTX_new();
+    decoded.verified =
+        EVP_DigestVerifyInit(md, nullptr, EVP_sha256(), nullptr, key) == 1 &&
+        EVP_DigestVerify(md, der, static_cast<std::size_t>(derSize),
+                         reinterpret_cast<const unsigned char*>(signingInput.data()),
+                         signingInput.size()) == 1;
+    EVP_MD_CTX_free(md);
+    OPENSSL_free(der);
+    return decoded;
+}
+
+} // namespace
+
+TEST(CoinbaseJwtProviderTest, SignsVerifiableEs256Tokens) {
+    KeyPair keys;
+    CoinbaseJwtProvider provider(kKeyName, keys.pem());
+
+    auto before = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    Decoded websocket = decode(*provider.token(), keys.key);
+    EXPECT_TRUE(websocket.verified);
+    EXPECT_EQ(websocket.header["alg"], "ES256");
+    EXPECT_EQ(websocket.header["kid"], kKeyName);
+    EXPECT_EQ(websocket.header["nonce"].get<std::string>().size(), 32u);
+    EXPECT_EQ(websocket.claims["iss"], "cdp");
+    EXPECT_EQ(websocket.claims["sub"], kKeyName);
+    EXPECT_FALSE(websocket.claims.contains("uri"));
+    EXPECT_GE(websocket.claims["nbf"].get<int64_t>(), before);
+    EXPECT_EQ(websocket.claims["exp"].get<int64_t>() - websocket.claims["nbf"].get<int64_t>(),
+              120);
+
+    auto source = provider.tokenSource();
+    Decoded rest = decode(source("POST", "/api/v3/brokerage/orders"), keys.key);
+    EXPECT_TRUE(rest.verified);
+    EXPECT_EQ(rest.claims["uri"], "POST api.coinbase.com/api/v3/brokerage/orders");
+    EXPECT_NE(rest.header["nonce"], websocket.header["nonce"]);
+
+    // A token signed by another key does not verify
+    KeyPair other;
+    EXPECT_FALSE(decode(*provider.token(), other.key).verified);
+}
+
+TEST(CoinbaseJwtProviderTest, CachesTokensPerUri) {
+    KeyPair keys;
+    CoinbaseJwtProvider provider(kKeyName, keys.pem());
+
+    auto websocket = provider.token();
+    auto orders = provider.token("POST api.coinbase.com/api/v3/brokerage/orders");
+    EXPECT_EQ(provider.minted(), 2u);
+    EXPECT_NE(*websocket, *orders);
+
+    // Readers on any thread share the cached tokens until they are refreshed
+    std::vector<std::thread> threads;
+    std::vector<std::shared_ptr<const std::string>> seen(4);
+    for (std::size_t t = 0; t < seen.size(); ++t) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < 1000; ++i) {
+                seen[t] = provider.token("POST api.coinbase.com/api/v3/brokerage/orders");
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (const auto& token : seen) {
+        EXPECT_EQ(token.get(), orders.get());
+    }
+    EXPECT_EQ(provider.token().get(), websocket.get());
+    EXPECT_EQ(provider.minted(), 2u);
+}
+
+TEST(CoinbaseJwtProviderTest, RefreshesInTheBackgroundBeforeTokensGetOld) {
+    KeyPair keys;
+    CoinbaseJwtProvider::Options options;
+    options.refreshAfter = std::chrono::seconds(1);
+    options.maxAge = std::chrono::seconds(100);
+    CoinbaseJwtProvider provider(kKeyName, keys.pem(), options);
+
+    auto first = provider.token();
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (provider.token() == first && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    auto second = provider.token();
+    EXPECT_NE(second.get(), first.get());
+    EXPECT_TRUE(decode(*second, keys.key).verified);
+    // Replaced by the refresher, not by token()
+    EXPECT_EQ(provider.minted(), 2u);
+}
+
+TEST(CoinbaseJwtProviderTest, NeverHandsOutTokensPastMaxAge) {
+    KeyPair keys;
+    CoinbaseJwtProvider::Options options;
+    options.refreshAfter = std::chrono::seconds(100);
+    options.maxAge = std::chrono::seconds(0);
+    CoinbaseJwtProvider provider(kKeyName, keys.pem(), options);
+
+    // Every call is too late for the cached token, so each one is signed on the spot
+    std::set<std::string> tokens;
+    for (int i = 0; i < 5; ++i) {
+        auto token = provider.token("GET api.coinbase.com/api/v3/brokerage/accounts");
+        EXPECT_TRUE(decode(*token, keys.key).verified);
+        tokens.insert(*token);
+    }
+    EXPECT_EQ(tokens.size(), 5u);
+}
+
+TEST(CoinbaseJwtProviderTest, RejectsKeysThatAreNotP256) {
+    EXPECT_THROW(CoinbaseJwtProvider(kKeyName, "not a key"), std::invalid_argument);
+
+    EVP_PKEY* rsa = EVP_RSA_gen(2048);
+    BIO* bio = BIO_new(BIO_s_mem());
+    PEM_write_bio_PrivateKey(bio, rsa, nullptr, nullptr, 0, nullptr, nullptr);
+    char* data = nullptr;
+    long size = BIO_get_mem_data(bio, &data);
+    std::string pem(data, static_cast<std::size_t>(size));
+    BIO_free(bio);
+    EVP_PKEY_free(rsa);
+    EXPECT_THROW(CoinbaseJwtProvider(kKeyName, pem), std::invalid_argument);
+}
@@ -0,0 +1,115 @@
+#include "../../src/exchanges/CoinbaseAdapter.hpp"
+#include "../../src/exchanges/RedundantFeedAdapter.hpp"
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace crypto_hft;
+
+namespace {
+
+std::string l2Data(uint64_t sequence, const std::string& events) {
+    return R"({"channel":"l2_data","client_id":"","timestamp":"2024-01-01T00:00:00Z",)"
+           R"("sequence_num":)" + std::to_string(sequence) + R"(,"events":[)" + events + "]}";
+}
+
+std::string event(const std::string& type, const std::string& product, const std::string& side,
+                  const std::string& price, const std::string& quantity = "1.5") {
+    return R"({"type":")" + type + R"(","product_id":")" + product + R"(","updates":[)"
+           R"({"side":")" + side + R"(","event_time":"2024-01-01T00:00:00Z","price_level":")" +
+           price + R"(","new_quantity":")" + quantity + R"("}]})";
+}
+
+struct Recorder {
+    std::vector<std::string> events;
+
+    void attach(CoinbaseAdapter& adapter) {
+        // sequence_num numbers messages on the connection, not book updates
+        adapter.registerOrderBookCallback([this](const OrderBookSnapshot& book) {
+            EXPECT_EQ(book.sequence, 0u);
+            events.push_back(book.symbol + " snapshot");
+        });
+        adapter.registerOrderBookDeltaCallback([this](const OrderBookDelta& update) {
+            EXPECT_EQ(update.sequence, 0u);
+            events.push_back(update.symbol + " delta " +
+                             std::to_string(update.bidUpdates.size()) + "/" +
+                             std::to_string(update.askUpdates.size()));
+        });
+    }
+};
+
+} // namespace
+
+TEST(CoinbaseL2Test, OneDeltaPerProductPerMessage) {
+    CoinbaseAdapter adapter;
+    Recorder recorder;
+    recorder.attach(adapter);
+
+    adapter.handle_frame(l2Data(1, event("snapshot", "BTC-USD", "bid", "100.0") + "," +
+                                   event("snapshot", "ETH-USD", "offer", "20.0")));
+    adapter.handle_frame(l2Data(2, event("update", "BTC-USD", "bid", "100.1") + "," +
+                                   event("update", "ETH-USD", "bid", "19.9") + "," +
+                                   event("update", "BTC-USD", "offer", "100.3") + "," +
+                                   event("update", "BTC-USD", "bid", "100.2")));
+    adapter.handle_frame(R"({"channel":"heartbeats","sequence_num":3,"events":[]})");
+    adapter.handle_frame(l2Data(4, event("update", "ETH-USD", "offer", "20.1")));
+
+    EXPECT_EQ(recorder.events, (std::vector<std::string>{
+                                   "BTC-USD snapshot", "ETH-USD snapshot",
+                                   "BTC-USD delta 2/1", "ETH-USD delta 1/0",
+                                   "ETH-USD delta 0/1"}));
+    EXPECT_EQ(adapter.getSequenceGaps(), 0u);
+}
+
+TEST(CoinbaseL2Test, SequenceGapHoldsDeltasUntilTheNextSnapshot) {
+    CoinbaseAdapter adapter;
+    Recorder recorder;
+    recorder.attach(adapter);
+    // Queued while disconnected; the gap marks every subscribed product
+    ASSERT_TRUE(adapter.subscribe({"BTC-USD", "ETH-USD"}));
+
+    adapter.handle_frame(l2Data(10, event("snapshot", "BTC-USD", "bid", "100.0") + "," +
+                                    event("snapshot", "ETH-USD", "bid", "20.0")));
+    adapter.handle_frame(l2Data(11, event("update", "BTC-USD", "bid", "100.1")));
+    // 12 never arrives
+    adapter.handle_frame(l2Data(13, event("update", "BTC-USD", "bid", "100.2") + "," +
+                                    event("update", "ETH-USD", "bid", "20.1")));
+    EXPECT_EQ(adapter.getSequenceGaps(), 1u);
+
+    adapter.handle_frame(l2Data(14, event("snapshot", "ETH-USD", "bid", "20.2")));
+    adapter.handle_frame(l2Data(15, event("update", "BTC-USD", "bid", "100.3") + "," +
+                                    event("update", "ETH-USD", "bid", "20.3")));
+    adapter.handle_frame(l2Data(16, event("snapshot", "BTC-USD", "bid", "100.4")));
+    adapter.handle_frame(l2Data(17, event("update", "BTC-USD", "bid", "100.5")));
+
+    EXPECT_EQ(recorder.events, (std::vector<std::string>{
+                                   "BTC-USD snapshot", "ETH-USD snapshot",
+                                   "BTC-USD delta 1/0",
+                                   "ETH-USD snapshot", "ETH-USD delta 1/0",
+                                   "BTC-USD snapshot", "BTC-USD delta 1/0"}));
+    EXPECT_EQ(adapter.getSequenceGaps(), 1u);
+}
+
+TEST(CoinbaseL2Test, RedundantSessionsDoNotCompareMessageNumbers) {
+    // The standby has been up for a while; the primary has just reconnected and numbers its
+    // messages from scratch
+    auto primary = std::make_shared<CoinbaseAdapter>();
+    auto standby = std::make_shared<CoinbaseAdapter>();
+    RedundantFeedAdapter adapter({primary, standby});
+    std::vector<double> sizes;
+    adapter.registerOrderBookDeltaCallback([&](const OrderBookDelta& update) {
+        EXPECT_EQ(update.sequence, 0u);
+        sizes.push_back(update.bidUpdates.at(0).second);
+    });
+
+    standby->handle_frame(l2Data(900, event("update", "BTC-USD", "bid", "100.0", "1")));
+    primary->handle_frame(l2Data(1, event("update", "BTC-USD", "bid", "100.0", "1")));
+    primary->handle_frame(l2Data(2, event("update", "BTC-USD", "bid", "100.0", "2")));
+    standby->handle_frame(l2Data(901, event("update", "BTC-USD", "bid", "100.0", "2")));
+
+    // Without book ids only the primary feeds the book, whatever the sessions' numbering
+    EXPECT_EQ(sizes, (std::vector<double>{1.0, 2.0}));
+    EXPECT_EQ(adapter.getArbiter().getSessionStats(0).wins, 2u);
+    EXPECT_EQ(adapter.getArbiter().getSessionStats(1).duplicates, 2u);
+}
@@ -0,0 +1,160 @@
+#include "../../src/exchanges/ConnectionProfile.hpp"
+#include <gtest/gtest.h>
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+#include <spdlog/sinks/ostream_sink.h>
+#include <cerrno>
+#include <chrono>
+#include <sstream>
+#include <thread>
+#if defined(__linux__)
+#include <linux/net_tstamp.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#endif
+
+using namespace crypto_hft;
+namespace net = boost::asio;
+using tcp = net::ip::tcp;
+
+namespace {
+
+int intOption(tcp::socket& socket, int level, int name) {
+    int value = 0;
+    socklen_t length = sizeof(value);
+    ::getsockopt(socket.native_handle(), level, name, &value, &length);
+    return value;
+}
+
+} // namespace
+
+TEST(ConnectionProfileTest, ConfigFromYaml) {
+    YAML::Node node = YAML::Load(
+        "tcp_nodelay: false\n"
+        "rcvbuf_bytes: 262144\n"
+        "busy_poll_us: 50\n"
+        "quickack: true\n"
+        "rx_timestamps: true\n");
+    auto profile = ConnectionProfile::fromYaml(node);
+    EXPECT_FALSE(profile.noDelay);
+    EXPECT_EQ(profile.receiveBufferBytes, 262144);
+    EXPECT_EQ(profile.sendBufferBytes, 0);
+    EXPECT_EQ(profile.busyPollMicros, 50);
+    EXPECT_TRUE(profile.quickAck);
+    EXPECT_TRUE(profile.rxTimestamps);
+
+    auto defaults = ConnectionProfile::fromYaml(YAML::Node());
+    EXPECT_TRUE(defaults.noDelay);
+    EXPECT_FALSE(defaults.quickAck);
+    EXPECT_FALSE(defaults.rxTimestamps);
+    EXPECT_FALSE(defaults.compression.enabled);
+}
+
+TEST(ConnectionProfileTest, CompressionFromYaml) {
+    YAML::Node node = YAML::Load(
+        "permessage_deflate:\n"
+        "  enabled: true\n"
+        "  server_max_window_bits: 8\n"
+        "  client_max_window_bits: 12\n"
+        "  client_no_context_takeover: true\n");
+    auto compression = ConnectionProfile::fromYaml(node).compression;
+    EXPECT_TRUE(compression.enabled);
+    EXPECT_EQ(compression.serverMaxWindowBits, 9);  // zlib cannot inflate with 8
+    EXPECT_EQ(compression.clientMaxWindowBits, 12);
+    EXPECT_FALSE(compression.serverNoContextTakeover);
+    EXPECT_TRUE(compression.clientNoContextTakeover);
+}
+
+TEST(ConnectionProfileTest, ReportsWhyAnOptionFailed) {
+    net::io_context ioc;
+    tcp::socket socket(ioc);  // Never opened, so asio refuses every option
+    std::ostringstream out;
+    spdlog::logger logger("profile", std::make_shared<spdlog::sinks::ostream_sink_mt>(out));
+    errno = 0;
+
+    EXPECT_FALSE(ConnectionProfile{}.apply(socket, logger));
+    const std::string reason = net::error::make_error_code(net::error::bad_descriptor).message();
+    EXPECT_NE(out.str().find("Could not set TCP_NODELAY: " + reason), std::string::npos)
+        << out.str();
+}
+
+#if defined(__linux__)
+TEST(ConnectionProfileTest, AppliesSocketOptions) {
+    net::io_context ioc;
+    tcp::socket socket(ioc);
+    socket.open(tcp::v4());
+
+    ConnectionProfile profile;
+    profile.receiveBufferBytes = 64 * 1024;
+    profile.sendBufferBytes = 64 * 1024;
+    profile.quickAck = true;
+    profile.rxTimestamps = true;
+    EXPECT_TRUE(profile.apply(socket, *spdlog::default_logger()));
+
+    EXPECT_EQ(intOption(socket, IPPROTO_TCP, TCP_NODELAY), 1);
+    // The kernel doubles the requested size for its own bookkeeping
+    EXPECT_GE(intOption(socket, SOL_SOCKET, SO_RCVBUF), 64 * 1024);
+    EXPECT_GE(intOption(socket, SOL_SOCKET, SO_SNDBUF), 64 * 1024);
+    EXPECT_EQ(intOption(socket, SOL_SOCKET, SO_TIMESTAMPING),
+              SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE);
+}
+
+TEST(ConnectionProfileTest, TunedStreamCapturesReceiveTimestamps) {
+    net::io_context ioc;
+    tcp::acceptor acceptor(ioc, {net::ip::make_address("127.0.0.1"), 0});
+
+    TunedStream stream(ioc.get_executor());
+    auto& socket = stream.lowest_layer();
+    socket.open(tcp::v4());
+    ConnectionProfile profile;
+    profile.quickAck = true;
+    profile.rxTimestamps = true;
+    ASSERT_TRUE(profile.apply(socket, *spdlog::default_logger()));
+    socket.connect(acceptor.local_endpoint());
+    tcp::socket peer = acceptor.accept();
+
+    stream.setQuickAck(true);
+    stream.setRxTimestamps(true);
+    EXPECT_EQ(stream.takeRxTimestamp(), 0);
+
+    // The kernel switches receive timestamping on lazily, so the first packets after the
+    // option is set may go unstamped
+    char data[5];
+    std::size_t received = 0;
+    boost::system::error_code readError;
+    int64_t rxNs = 0;
+    for (int attempt = 0; attempt < 100 && rxNs == 0; ++attempt) {
+        net::write(peer, net::buffer(std::string("hello")));
+        net::async_read(stream, net::buffer(data), [&](boost::system::error_code ec, std::size_t n) {
+            readError = ec;
+            received = n;
+        });
+        ioc.restart();
+        ioc.run();
+        ASSERT_FALSE(readError) << readError.message();
+        EXPECT_EQ(std::string(data, received), "hello");
+        rxNs = stream.takeRxTimestamp();
+        if (rxNs == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    // Software timestamps use CLOCK_REALTIME and precede the read
+    int64_t nowNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    EXPECT_GT(rxNs, 0);
+    EXPECT_LE(rxNs, nowNs);
+    EXPECT_LT(nowNs - rxNs, 1'000'000'000);
+    EXPECT_EQ(stream.takeRxTimestamp(), 0);
+
+    // The peer closing is reported as end of stream
+    peer.close();
+    ioc.restart();
+    net::async_read(stream, net::buffer(data), [&](boost::system::error_code ec, std::size_t) {
+        readError = ec;
+    });
+    ioc.run();
+    EXPECT_EQ(readError, net::error::eof);
+}
+#endif
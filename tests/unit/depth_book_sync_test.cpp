@@ -0,0 +1,145 @@
+#include "../../src/exchanges/BinanceAdapter.hpp"
+#include "../../src/exchanges/DepthBookSync.hpp"
+#include "LocalHttpsServer.hpp"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace crypto_hft;
+namespace net = boost::asio;
+
+namespace {
+
+OrderBookDelta delta(uint64_t first, uint64_t last, const std::string& symbol = "BTCUSDT") {
+    OrderBookDelta update;
+    update.symbol = symbol;
+    update.firstSequence = first;
+    update.sequence = last;
+    update.timestamp = static_cast<int64_t>(last);
+    return update;
+}
+
+OrderBookSnapshot snapshot(uint64_t lastUpdateId, const std::string& symbol = "BTCUSDT") {
+    OrderBookSnapshot book;
+    book.symbol = symbol;
+    book.sequence = lastUpdateId;
+    return book;
+}
+
+std::string depthUpdate(uint64_t first, uint64_t last) {
+    return R"({"stream":"btcusdt@depth@100ms","data":{"e":"depthUpdate","E":1,"s":"BTCUSDT",)"
+           R"("U":)" + std::to_string(first) + R"(,"u":)" + std::to_string(last) +
+           R"(,"b":[["100.5","1"]],"a":[]}})";
+}
+
+} // namespace
+
+TEST(DepthBookSyncTest, ReplaysBufferedDeltasAfterTheSnapshot) {
+    DepthBookSync sync;
+    EXPECT_EQ(sync.onDelta(delta(1, 3)), DepthBookSync::DeltaAction::Apply);  // Untracked
+
+    ASSERT_TRUE(sync.requestSnapshot("BTCUSDT"));
+    EXPECT_FALSE(sync.requestSnapshot("BTCUSDT"));
+    EXPECT_EQ(sync.onDelta(delta(10, 12)), DepthBookSync::DeltaAction::Buffer);
+    EXPECT_EQ(sync.onDelta(delta(13, 15)), DepthBookSync::DeltaAction::Buffer);
+    EXPECT_EQ(sync.onDelta(delta(16, 20)), DepthBookSync::DeltaAction::Buffer);
+    EXPECT_FALSE(sync.isLive("BTCUSDT"));
+
+    // The snapshot already contains everything up to 14
+    std::vector<OrderBookDelta> replay;
+    ASSERT_EQ(sync.onSnapshot(snapshot(14), replay), DepthBookSync::SnapshotResult::Live);
+    ASSERT_EQ(replay.size(), 2u);
+    EXPECT_EQ(replay[0].sequence, 15u);
+    EXPECT_EQ(replay[1].sequence, 20u);
+    EXPECT_TRUE(sync.isLive("BTCUSDT"));
+
+    EXPECT_EQ(sync.onDelta(delta(16, 20)), DepthBookSync::DeltaAction::Drop);
+    EXPECT_EQ(sync.onDelta(delta(21, 25)), DepthBookSync::DeltaAction::Apply);
+}
+
+TEST(DepthBookSyncTest, RefetchesWhenTheSnapshotOrStreamHasAHole) {
+    DepthBookSync sync;
+    ASSERT_TRUE(sync.requestSnapshot("BTCUSDT"));
+    sync.onDelta(delta(50, 60));
+
+    // Updates 11 to 49 are neither in the snapshot nor in the buffer
+    std::vector<OrderBookDelta> replay;
+    EXPECT_EQ(sync.onSnapshot(snapshot(10), replay), DepthBookSync::SnapshotResult::Stale);
+    EXPECT_TRUE(replay.empty());
+
+    ASSERT_TRUE(sync.requestSnapshot("BTCUSDT"));
+    ASSERT_EQ(sync.onSnapshot(snapshot(55), replay), DepthBookSync::SnapshotResult::Live);
+    ASSERT_EQ(replay.size(), 1u);
+
+    EXPECT_EQ(sync.onDelta(delta(70, 75)), DepthBookSync::DeltaAction::Gap);
+    EXPECT_EQ(sync.gaps(), 1u);
+    EXPECT_FALSE(sync.isLive("BTCUSDT"));
+    EXPECT_TRUE(sync.requestSnapshot("BTCUSDT"));
+    ASSERT_EQ(sync.onSnapshot(snapshot(72), replay), DepthBookSync::SnapshotResult::Live);
+    ASSERT_EQ(replay.size(), 1u);
+    EXPECT_EQ(replay[0].sequence, 75u);
+
+    sync.remove("BTCUSDT");
+    EXPECT_EQ(sync.onSnapshot(snapshot(80), replay), DepthBookSync::SnapshotResult::Untracked);
+}
+
+TEST(DepthBookSyncTest, BinanceAdapterSeedsBooksFromRestSnapshots) {
+    std::atomic<int> fetched{0};
+    LocalHttpsServer server([&](const LocalHttpsServer::Request& request) {
+        ++fetched;
+        return LocalHttpsServer::reply(request, 200,
+            R"({"lastUpdateId":104,"bids":[["100.4","2"]],"asks":[["100.9","3"]]})");
+    });
+
+    net::io_context ioc;
+    auto work = net::make_work_guard(ioc);
+    std::thread thread([&] { ioc.run(); });
+
+    HttpsClient::Options options;
+    options.host = "localhost";
+    options.port = server.port();
+    options.verifyPeer = false;
+    auto rest = HttpsClient::create(ioc, options, nullptr);
+
+    std::mutex mutex;
+    std::vector<std::string> events;
+    {
+        BinanceAdapter adapter;
+        adapter.setRestClient(rest);
+        adapter.setSnapshotBootstrap(true, 100);
+        adapter.registerOrderBookCallback([&](const OrderBookSnapshot& book) {
+            std::lock_guard<std::mutex> lock(mutex);
+            events.push_back(book.symbol + " snapshot " + std::to_string(book.sequence));
+        });
+        adapter.registerOrderBookDeltaCallback([&](const OrderBookDelta& update) {
+            std::lock_guard<std::mutex> lock(mutex);
+            events.push_back("depth " + std::to_string(update.sequence));
+        });
+
+        ASSERT_TRUE(adapter.requestOrderBookSnapshot("btcusdt"));
+        adapter.handle_frame(depthUpdate(100, 102));
+        adapter.handle_frame(depthUpdate(103, 106));
+
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (std::chrono::steady_clock::now() < deadline) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!events.empty()) {
+                    break;
+                }
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        adapter.handle_frame(depthUpdate(107, 110));
+    }
+    rest->shutdown();
+    work.reset();
+    thread.join();
+
+    EXPECT_EQ(fetched.load(), 1);
+    EXPECT_EQ(events,
+              (std::vector<std::string>{"BTCUSDT snapshot 104", "depth 106", "depth 110"}));
+}
@@ -0,0 +1,369 @@
+#include "../../src/sim/ExchangeSimulator.hpp"
+#include "../../src/exchanges/BinanceAdapter.hpp"
+#include "../../src/exchanges/KrakenAdapter.hpp"
+#include "../../src/exchanges/WsOrderEntry.hpp"
+#include "TestSupport.hpp"
+#include <gtest/gtest.h>
+#include <boost/beast/core.hpp>
+#include <boost/beast/websocket.hpp>
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+
+using namespace crypto_hft;
+namespace net = boost::asio;
+namespace ssl = boost::asio::ssl;
+namespace beast = boost::beast;
+namespace websocket = boost::beast::websocket;
+using json = nlohmann::json;
+
+namespace {
+
+using Side = MatchingEngine::Side;
+
+MatchingEngine::Order limit(Side side, MatchingEngine::Ticks price, MatchingEngine::Lots quantity,
+                            const std::string& clientOrderId = "") {
+    MatchingEngine::Order order;
+    order.symbol = "BTCUSDT";
+    order.side = side;
+    order.price = price;
+    order.quantity = quantity;
+    order.clientOrderId = clientOrderId;
+    return order;
+}
+
+ExchangeSimulator::Options simulatorOptions(const std::string& venue) {
+    ExchangeSimulator::Options options;
+    options.venue = venue;
+    options.updatesPerSecond = 2000.0;
+    return options;
+}
+
+// Counts what an adapter delivers, from its IO thread
+struct BookCounts {
+    std::atomic<uint64_t> snapshots{0};
+    std::atomic<uint64_t> deltas{0};
+
+    template <typename Adapter>
+    void attach(Adapter& adapter) {
+        adapter.registerOrderBookCallback([this](const OrderBookSnapshot&) { ++snapshots; });
+        adapter.registerOrderBookDeltaCallback([this](const OrderBookDelta&) { ++deltas; });
+    }
+};
+
+class OrderEntryTest : public IoContextTest {
+protected:
+    void SetUp() override {
+        clientCtx_.set_verify_mode(ssl::verify_none);
+        IoContextTest::SetUp();
+    }
+
+    static WsOrderEntry::Options options(const ExchangeSimulator& simulator) {
+        WsOrderEntry::Options options;
+        options.host = "localhost";
+        options.port = std::to_string(simulator.port());
+        options.backoffInitial = std::chrono::milliseconds(10);
+        return options;
+    }
+
+    ssl::context clientCtx_{ssl::context::tls_client};
+};
+
+} // namespace
+
+TEST(MatchingEngineTest, FillsByPriceThenTime) {
+    MatchingEngine engine;
+    engine.addSymbol("BTCUSDT");
+    auto first = engine.submit(limit(Side::Sell, 101, 5));
+    auto second = engine.submit(limit(Side::Sell, 100, 5));
+    auto third = engine.submit(limit(Side::Sell, 100, 5));
+    ASSERT_TRUE(first.accepted && second.accepted && third.accepted);
+
+    auto taker = engine.submit(limit(Side::Buy, 101, 12));
+    ASSERT_TRUE(taker.accepted);
+    EXPECT_EQ(taker.filled, 12);
+    EXPECT_EQ(taker.resting, 0);
+    ASSERT_EQ(taker.fills.size(), 3u);
+    EXPECT_EQ(taker.fills[0].makerOrderId, second.orderId);
+    EXPECT_EQ(taker.fills[1].makerOrderId, third.orderId);
+    EXPECT_EQ(taker.fills[2].makerOrderId, first.orderId);
+    EXPECT_EQ(taker.fills[2].price, 101);
+    EXPECT_EQ(taker.fills[2].quantity, 2);
+
+    auto asks = engine.levels("BTCUSDT", Side::Sell);
+    ASSERT_EQ(asks.size(), 1u);
+    EXPECT_EQ(asks[0], MatchingEngine::Level(101, 3));
+}
+
+TEST(MatchingEngineTest, RestsTheRemainderAndCancels) {
+    MatchingEngine engine;
+    engine.addSymbol("BTCUSDT");
+    engine.submit(limit(Side::Sell, 100, 4));
+    auto buy = engine.submit(limit(Side::Buy, 100, 10, "c1"));
+    EXPECT_EQ(buy.filled, 4);
+    EXPECT_EQ(buy.resting, 6);
+    EXPECT_EQ(engine.best("BTCUSDT", Side::Buy), 100);
+    EXPECT_FALSE(engine.best("BTCUSDT", Side::Sell));
+    EXPECT_EQ(engine.findByClientOrderId("BTCUSDT", "c1"), buy.orderId);
+
+    EXPECT_TRUE(engine.cancel("BTCUSDT", buy.orderId));
+    EXPECT_FALSE(engine.cancel("BTCUSDT", buy.orderId));
+    EXPECT_EQ(engine.levelCount("BTCUSDT", Side::Buy), 0u);
+
+    // One change per level touched, carrying its final total
+    std::vector<MatchingEngine::LevelChange> changes;
+    engine.takeChanges("BTCUSDT", changes);
+    ASSERT_EQ(changes.size(), 2u);
+    EXPECT_EQ(changes[0].side, Side::Sell);
+    EXPECT_EQ(changes[0].quantity, 0);
+    EXPECT_EQ(changes[1].side, Side::Buy);
+    EXPECT_EQ(changes[1].quantity, 0);
+    changes.clear();
+    engine.takeChanges("BTCUSDT", changes);
+    EXPECT_TRUE(changes.empty());
+}
+
+TEST(MatchingEngineTest, MarketOrdersSweepAndNeverRest) {
+    MatchingEngine engine;
+    engine.addSymbol("BTCUSDT");
+    engine.submit(limit(Side::Buy, 99, 3));
+    engine.submit(limit(Side::Buy, 98, 3));
+    auto order = limit(Side::Sell, 0, 10);
+    order.type = MatchingEngine::Type::Market;
+    auto sweep = engine.submit(order);
+    EXPECT_TRUE(sweep.accepted);
+    EXPECT_EQ(sweep.filled, 6);
+    EXPECT_EQ(sweep.resting, 0);
+    EXPECT_EQ(engine.levelCount("BTCUSDT", Side::Buy), 0u);
+    EXPECT_EQ(engine.levelCount("BTCUSDT", Side::Sell), 0u);
+
+    EXPECT_FALSE(engine.submit(limit(Side::Buy, 100, 0)).accepted);
+    auto unknown = limit(Side::Buy, 100, 1);
+    unknown.symbol = "NOPE";
+    EXPECT_EQ(engine.submit(unknown).reason, "Unknown symbol");
+}
+
+TEST(MatchingEngineTest, MakerQuotesKeepTheirPlaceAndNeverCross) {
+    MatchingEngine engine;
+    engine.addSymbol("BTCUSDT");
+    ASSERT_TRUE(engine.setMakerQuantity("BTCUSDT", Side::Sell, 100, 5));
+    auto client = engine.submit(limit(Side::Sell, 100, 5));
+    // Resizing the quote leaves it ahead of the client order
+    ASSERT_TRUE(engine.setMakerQuantity("BTCUSDT", Side::Sell, 100, 2));
+    auto taker = engine.submit(limit(Side::Buy, 100, 3));
+    ASSERT_EQ(taker.fills.size(), 2u);
+    EXPECT_EQ(taker.fills[0].quantity, 2);
+    EXPECT_EQ(taker.fills[1].makerOrderId, client.orderId);
+
+    EXPECT_FALSE(engine.setMakerQuantity("BTCUSDT", Side::Buy, 100, 1));
+    EXPECT_TRUE(engine.setMakerQuantity("BTCUSDT", Side::Buy, 99, 1));
+    const std::vector<MatchingEngine::Level> bids = {{99, 1}};
+    EXPECT_EQ(engine.levels("BTCUSDT", Side::Buy), bids);
+}
+
+TEST(ExchangeSimulatorTest, RejectsAnUnknownVenue) {
+    EXPECT_THROW(ExchangeSimulator(simulatorOptions("nasdaq")), std::invalid_argument);
+}
+
+TEST(ExchangeSimulatorTest, KrakenBooksStayInChecksum) {
+    ExchangeSimulator simulator(simulatorOptions("kraken"));
+    simulator.start();
+    ASSERT_FALSE(simulator.certificatePem().empty());
+
+    KrakenAdapter adapter;
+    BookCounts counts;
+    counts.attach(adapter);
+    adapter.setEndpoint("localhost", std::to_string(simulator.port()), false);
+    adapter.subscribe({"XBT/USD", "ETH/USD"});
+    ASSERT_TRUE(adapter.connect());
+
+    EXPECT_TRUE(eventually([&] { return counts.snapshots >= 2 && counts.deltas >= 200; }));
+    EXPECT_EQ(adapter.getChecksumFailures(), 0u);
+    adapter.disconnect();
+
+    auto stats = simulator.getStats();
+    EXPECT_EQ(stats.sessions, 1u);
+    EXPECT_GT(stats.bookUpdates, 0u);
+    EXPECT_GT(stats.framesSent, 200u);
+}
+
+TEST(ExchangeSimulatorTest, CoinbaseServesLevel2OverPlainTcp) {
+    auto options = simulatorOptions("coinbase");
+    options.tls = false;
+    ExchangeSimulator simulator(options);
+    simulator.start();
+    EXPECT_TRUE(simulator.certificatePem().empty());
+
+    net::io_context ioc;
+    websocket::stream<beast::tcp_stream> ws(ioc);
+    beast::get_lowest_layer(ws).connect(
+        {net::ip::make_address("127.0.0.1"), simulator.port()});
+    ws.handshake("localhost", "/");
+    ws.write(net::buffer(std::string(
+        R"({"type":"subscribe","product_ids":["BTC-USD"],"channel":"level2"})")));
+
+    // The subscriptions message, a snapshot and then updates, numbered in order
+    std::vector<json> messages;
+    while (messages.size() < 5) {
+        beast::flat_buffer buffer;
+        ws.read(buffer);
+        messages.push_back(json::parse(beast::buffers_to_string(buffer.data())));
+    }
+    EXPECT_EQ(messages[0]["channel"], "subscriptions");
+    EXPECT_EQ(messages[1]["channel"], "l2_data");
+    EXPECT_EQ(messages[1]["events"][0]["type"], "snapshot");
+    EXPECT_EQ(messages[1]["events"][0]["product_id"], "BTC-USD");
+    EXPECT_EQ(messages[4]["events"][0]["type"], "update");
+    for (std::size_t i = 0; i < messages.size(); ++i) {
+        EXPECT_EQ(messages[i]["sequence_num"], i);
+    }
+    beast::get_lowest_layer(ws).close();
+}
+
+TEST(ExchangeSimulatorTest, BinanceAdapterReceivesDepthUpdates) {
+    ExchangeSimulator simulator(simulatorOptions("binance"));
+    simulator.start();
+
+    BinanceAdapter adapter;
+    BookCounts counts;
+    counts.attach(adapter);
+    adapter.setEndpoint("localhost", std::to_string(simulator.port()), false);
+    adapter.subscribe({"BTCUSDT"});
+    ASSERT_TRUE(adapter.connect());
+
+    EXPECT_TRUE(eventually([&] { return counts.deltas >= 100; }));
+    adapter.disconnect();
+}
+
+TEST(ExchangeSimulatorTest, BinanceSymbolMovesWithoutRepeatingUpdates) {
+    auto options = simulatorOptions("binance");
+    const std::vector<std::string> symbols = {"AAAUSDT", "BBBUSDT", "CCCUSDT", "DDDUSDT"};
+    options.symbols.clear();
+    for (const auto& symbol : symbols) {
+        options.symbols.push_back({symbol, 100.0, 0.01});
+    }
+    ExchangeSimulator simulator(options);
+    simulator.start();
+
+    // AAAUSDT is expected to be busy and gets a connection to itself; the simulator publishes
+    // every symbol equally often, so the first rebalance moves one of the others over
+    SymbolSharder::Config sharding;
+    sharding.connections = 2;
+    sharding.rebalanceInterval = std::chrono::hours(1);  // Rebalanced by hand below
+    sharding.expectedRates = {{"AAAUSDT", 10.0}};
+
+    BinanceAdapter adapter;
+    adapter.setSharding(sharding);
+    std::mutex mutex;
+    std::unordered_map<std::string, uint64_t> lastUpdate;
+    std::unordered_map<std::string, uint64_t> deltas;
+    uint64_t repeated = 0;
+    adapter.registerOrderBookDeltaCallback([&](const OrderBookDelta& delta) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto [last, first] = lastUpdate.try_emplace(delta.symbol, delta.sequence);
+        if (!first && delta.sequence <= last->second) {
+            ++repeated;
+        }
+        last->second = std::max(last->second, delta.sequence);
+        ++deltas[delta.symbol];
+    });
+    auto delivered = [&](const std::string& symbol) {
+        std::lock_guard<std::mutex> lock(mutex);
+        return deltas[symbol];
+    };
+    adapter.setEndpoint("localhost", std::to_string(simulator.port()), false);
+    adapter.subscribe(symbols);
+    ASSERT_TRUE(adapter.connect());
+    ASSERT_TRUE(eventually([&] {
+        return std::all_of(symbols.begin(), symbols.end(),
+                           [&](const std::string& symbol) { return delivered(symbol) >= 20; });
+    }));
+
+    std::unordered_map<std::string, std::optional<std::size_t>> before;
+    for (const auto& symbol : symbols) {
+        before[symbol] = adapter.getShardOf(symbol);
+    }
+    adapter.rebalanceShards();
+    std::optional<std::string> moved;
+    for (const auto& symbol : symbols) {
+        if (adapter.getShardOf(symbol) != before[symbol]) {
+            moved = symbol;
+        }
+    }
+    ASSERT_TRUE(moved.has_value());
+    EXPECT_EQ(adapter.getShardOf(*moved), before["AAAUSDT"]);
+
+    // The new connection opens with the book as of the last update the old one delivered
+    const uint64_t seen = delivered(*moved);
+    EXPECT_TRUE(eventually([&] { return delivered(*moved) >= seen + 100; }));
+    adapter.disconnect();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    EXPECT_EQ(repeated, 0u);
+}
+
+TEST_F(OrderEntryTest, BinanceOrdersAreSignedMatchedAndCancelled) {
+    auto options = simulatorOptions("binance");
+    options.binanceSecret = "binance-secret";
+    ExchangeSimulator simulator(options);
+    simulator.start();
+
+    BinanceWsOrderEntry entry(ioc_, clientCtx_, {"binance-key", "binance-secret"},
+                              this->options(simulator));
+    entry.start();
+    ASSERT_TRUE(entry.waitForOpen(std::chrono::seconds(5)));
+
+    auto ack = entry.submit(limitBuy("BTCUSDT", "c1")).get();
+    ASSERT_TRUE(ack.ok()) << ack.message;
+    EXPECT_EQ(ack.clientOrderId, "c1");
+    ASSERT_FALSE(ack.orderId.empty());
+
+    auto cancel = entry.cancel("BTCUSDT", ack.orderId).get();
+    ASSERT_TRUE(cancel.ok()) << cancel.message;
+    auto again = entry.cancel("BTCUSDT", ack.orderId).get();
+    EXPECT_FALSE(again.ok());
+    EXPECT_EQ(again.message, "Unknown order sent.");
+
+    // A buy through the synthetic asks fills at once
+    auto taker = limitBuy("BTCUSDT", "c2");
+    taker.price = 50000.0;
+    auto filled = entry.submit(taker).get();
+    ASSERT_TRUE(filled.ok()) << filled.message;
+    EXPECT_TRUE(eventually([&] { return simulator.getStats().fills > 0; }));
+    EXPECT_EQ(simulator.getStats().orders, 2u);
+
+    // Signed with another key, the request is refused
+    BinanceWsOrderEntry forger(ioc_, clientCtx_, {"binance-key", "wrong-secret"},
+                               this->options(simulator));
+    forger.start();
+    ASSERT_TRUE(forger.waitForOpen(std::chrono::seconds(5)));
+    auto forged = forger.submit(limitBuy("BTCUSDT", "c3")).get();
+    EXPECT_FALSE(forged.ok());
+    forger.shutdown();
+    entry.shutdown();
+}
+
+TEST_F(OrderEntryTest, KrakenOrdersNeedATokenAndAreAcked) {
+    ExchangeSimulator simulator(simulatorOptions("kraken"));
+    simulator.start();
+
+    KrakenWsOrderEntry entry(ioc_, clientCtx_, options(simulator));
+    entry.start();
+    ASSERT_TRUE(entry.waitForOpen(std::chrono::seconds(5)));
+
+    auto refused = entry.submit(limitBuy("XBT/USD", "1")).get();
+    EXPECT_FALSE(refused.ok());
+
+    entry.setToken("ws-token");
+    auto ack = entry.submit(limitBuy("XBT/USD", "2")).get();
+    ASSERT_TRUE(ack.ok()) << ack.message;
+    EXPECT_EQ(ack.orderId.rfind("OSIM-", 0), 0u);
+
+    auto cancel = entry.cancel("XBT/USD", ack.orderId).get();
+    EXPECT_TRUE(cancel.ok()) << cancel.message;
+    entry.shutdown();
+}
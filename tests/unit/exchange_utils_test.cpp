@@ -0,0 +1,187 @@
+#include "../../src/exchanges/ExchangeUtils.hpp"
+#include <gtest/gtest.h>
+#include <openssl/hmac.h>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace crypto_hft;
+
+namespace {
+
+// Reference conversion: strtod is correctly rounded under glibc
+double reference(const std::string& text) {
+    return std::strtod(text.c_str(), nullptr);
+}
+
+bool sameBits(double a, double b) {
+    return std::memcmp(&a, &b, sizeof(double)) == 0;
+}
+
+} // namespace
+
+TEST(ExchangeUtilsTest, ParseDecimalTypicalFields) {
+    for (const char* text : {"0", "0.0", "1", "-1.5", "43000.10000000", "0.00012345",
+                             "4.00000200", "431.00000000", "0.1", "0.3", "99999.99",
+                             "123456789012.3456789", "-0.00000001", "00012.5000"}) {
+        double value = -1.0;
+        ASSERT_TRUE(ExchangeUtils::parse_decimal(text, value)) << text;
+        EXPECT_TRUE(sameBits(value, reference(text))) << text << " " << value;
+    }
+}
+
+TEST(ExchangeUtilsTest, ParseDecimalFallbacksAreExact) {
+    // Long mantissas, mantissas beyond 2^53 and exponents take the from_chars path
+    for (const char* text : {"0.1234567890123456789012345", "9007199254740993",
+                             "18446744073709551617.5", "1e5", "2.5E-3", "0.00000000000000000000000123"}) {
+        double value = 0.0;
+        ASSERT_TRUE(ExchangeUtils::parse_decimal(text, value)) << text;
+        EXPECT_TRUE(sameBits(value, reference(text))) << text;
+    }
+}
+
+TEST(ExchangeUtilsTest, ParseDecimalRandomFieldsMatchStrtod) {
+    std::mt19937_64 rng(7);
+    std::uniform_int_distribution<int> intDigits(0, 12);
+    std::uniform_int_distribution<int> fracDigits(0, 24);
+    std::uniform_int_distribution<int> digit(0, 9);
+
+    for (int i = 0; i < 200000; ++i) {
+        std::string text;
+        if (i % 7 == 0) {
+            text += '-';
+        }
+        int n = intDigits(rng);
+        text += n == 0 ? "0" : "";
+        for (int d = 0; d < n; ++d) {
+            text += static_cast<char>('0' + digit(rng));
+        }
+        int f = fracDigits(rng);
+        if (f > 0) {
+            text += '.';
+            for (int d = 0; d < f; ++d) {
+                text += static_cast<char>('0' + digit(rng));
+            }
+        }
+
+        double value = 0.0;
+        ASSERT_TRUE(ExchangeUtils::parse_decimal(text, value)) << text;
+        ASSERT_TRUE(sameBits(value, reference(text))) << text;
+    }
+}
+
+TEST(ExchangeUtilsTest, ParseDecimalRejectsMalformedInput) {
+    double value = 0.0;
+    for (const char* text : {"", "-", ".", "1.2.3", "abc", "1-", "12a", " 1", "1 ", "+1", "--1"}) {
+        EXPECT_FALSE(ExchangeUtils::parse_decimal(text, value)) << '"' << text << '"';
+    }
+}
+
+TEST(ExchangeUtilsTest, ParseFixedScalesExactly) {
+    int64_t units = 0;
+    ASSERT_TRUE(ExchangeUtils::parse_fixed("0.00100000", 8, units));
+    EXPECT_EQ(units, 100000);
+    ASSERT_TRUE(ExchangeUtils::parse_fixed("43000.1", 8, units));
+    EXPECT_EQ(units, 4300010000000);
+    ASSERT_TRUE(ExchangeUtils::parse_fixed("-2.5", 2, units));
+    EXPECT_EQ(units, -250);
+    ASSERT_TRUE(ExchangeUtils::parse_fixed("00012.50", 2, units));
+    EXPECT_EQ(units, 1250);
+    ASSERT_TRUE(ExchangeUtils::parse_fixed("7", 0, units));
+    EXPECT_EQ(units, 7);
+    EXPECT_FALSE(ExchangeUtils::parse_fixed("1.23456789012345678", 8, units));
+    ASSERT_TRUE(ExchangeUtils::parse_fixed("1.2300000000000000000", 2, units));
+    EXPECT_EQ(units, 123);
+
+    // Out of int64 range at the requested scale, or not a number
+    EXPECT_FALSE(ExchangeUtils::parse_fixed("12345678901", 8, units));
+    EXPECT_FALSE(ExchangeUtils::parse_fixed("1e5", 2, units));
+    EXPECT_FALSE(ExchangeUtils::parse_fixed("", 2, units));
+}
+
+TEST(ExchangeUtilsTest, HmacSignerMatchesRfc4231) {
+    using Digest = ExchangeUtils::HmacSigner::Digest;
+    const std::string data = "what do ya want for nothing?";
+    ExchangeUtils::HmacSigner sha256(Digest::SHA256, "Jefe");
+    ExchangeUtils::HmacSigner sha512(Digest::SHA512, "Jefe");
+    EXPECT_EQ(sha256.size(), 32u);
+    EXPECT_EQ(sha512.size(), 64u);
+
+    char out[ExchangeUtils::HmacSigner::kMaxHexSize];
+    EXPECT_EQ(std::string(out, sha256.sign_hex(data, out)),
+              "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843");
+    EXPECT_EQ(std::string(out, sha512.sign_hex(data, out)),
+              "164b7a7bfcf819e2e395fbe73b56e0a387bd64222e831fd610270cd7ea2505549758bf75"
+              "c05a994a6d034f65f8f0e6fdcaeab1a34d4a6b4b636e070a38bce737");
+    EXPECT_EQ(std::string(out, sha512.sign_base64(data, out)),
+              "Fkt6e/z4GeLjlfvnO1bgo4e9ZCIugx/WECcM1+olBVSXWL91wFqZSm0DT2X48Ob9"
+              "yuqxo01Ka0tjbgcKOLznNw==");
+    EXPECT_EQ(ExchangeUtils::generate_signature("Jefe", data, "sha256"),
+              "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843");
+}
+
+TEST(ExchangeUtilsTest, HmacSignerAgreesWithOneShotHmac) {
+    std::mt19937 rng(7);
+    for (std::size_t keySize : {0u, 1u, 32u, 64u, 65u, 128u, 200u}) {
+        std::string key(keySize, '\0');
+        for (auto& c : key) {
+            c = static_cast<char>(rng());
+        }
+        std::string data(rng() % 500, '\0');
+        for (auto& c : data) {
+            c = static_cast<char>(rng());
+        }
+        ExchangeUtils::HmacSigner signer(ExchangeUtils::HmacSigner::Digest::SHA512, key);
+
+        unsigned char expected[EVP_MAX_MD_SIZE];
+        unsigned int expectedSize = 0;
+        HMAC(EVP_sha512(), key.data(), static_cast<int>(key.size()),
+             reinterpret_cast<const unsigned char*>(data.data()), data.size(), expected,
+             &expectedSize);
+
+        // Signing again from the same keyed context, and over the data in pieces
+        for (int round = 0; round < 2; ++round) {
+            unsigned char mac[ExchangeUtils::HmacSigner::kMaxSize];
+            std::string_view whole(data);
+            std::size_t split = data.size() / 3;
+            ASSERT_EQ(signer.sign({whole.substr(0, split), whole.substr(split)}, mac),
+                      expectedSize);
+            EXPECT_EQ(std::memcmp(mac, expected, expectedSize), 0) << "key size " << keySize;
+        }
+    }
+}
+
+TEST(ExchangeUtilsTest, HmacSignerIsSharedAcrossThreads) {
+    ExchangeUtils::HmacSigner signer(ExchangeUtils::HmacSigner::Digest::SHA256, "secret");
+    const std::string expected = ExchangeUtils::generate_hmac_sha256("secret", "symbol=BTCUSDT");
+    std::vector<int> mismatches(4, 0);
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < mismatches.size(); ++t) {
+        threads.emplace_back([&, t] {
+            char out[ExchangeUtils::HmacSigner::kMaxHexSize];
+            for (int i = 0; i < 2000; ++i) {
+                if (std::string(out, signer.sign_hex("symbol=BTCUSDT", out)) != expected) {
+                    ++mismatches[t];
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (int count : mismatches) {
+        EXPECT_EQ(count, 0);
+    }
+}
+
+TEST(ExchangeUtilsTest, Base64RoundTrips) {
+    for (const std::string text : {"", "f", "fo", "foo", "foob", "fooba", "foobar"}) {
+        EXPECT_EQ(ExchangeUtils::base64_decode(ExchangeUtils::base64_encode(text)), text);
+    }
+    EXPECT_EQ(ExchangeUtils::base64_encode("foobar"), "Zm9vYmFy");
+    EXPECT_EQ(ExchangeUtils::base64_encode("fo"), "Zm8=");
+    EXPECT_THROW(ExchangeUtils::base64_decode("Zm9v!!!!"), std::invalid_argument);
+}
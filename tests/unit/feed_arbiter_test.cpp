@@ -0,0 +1,105 @@
+#include "../../src/exchanges/FeedArbiter.hpp"
+#include "../../src/exchanges/RedundantFeedAdapter.hpp"
+#include "MockExchangeAdapter.hpp"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace crypto_hft;
+
+TEST(FeedArbiterTest, FirstArrivalWinsAndDuplicatesAreDropped) {
+    FeedArbiter arbiter(2);
+    std::vector<uint64_t> delivered;
+    auto offer = [&](std::size_t session, uint64_t seq, int64_t ns) {
+        return arbiter.arbitrate(session, "BTCUSDT", seq, ns, [&]() { delivered.push_back(seq); });
+    };
+
+    EXPECT_TRUE(offer(0, 100, 1000));
+    EXPECT_FALSE(offer(1, 100, 1500));  // 500ns behind session 0
+    EXPECT_TRUE(offer(1, 101, 2000));
+    EXPECT_FALSE(offer(0, 101, 2100));  // 100ns behind session 1
+    EXPECT_FALSE(offer(0, 99, 2200));   // Stale
+
+    EXPECT_EQ(delivered, (std::vector<uint64_t>{100, 101}));
+
+    auto s0 = arbiter.getSessionStats(0);
+    auto s1 = arbiter.getSessionStats(1);
+    EXPECT_EQ(s0.wins, 1u);
+    EXPECT_EQ(s0.duplicates, 2u);
+    EXPECT_EQ(s1.wins, 1u);
+    EXPECT_EQ(s1.duplicates, 1u);
+    EXPECT_DOUBLE_EQ(s1.winRate, 0.5);
+    EXPECT_DOUBLE_EQ(s1.meanLagNs, 500.0);
+    EXPECT_EQ(s0.maxLagNs, 100);
+}
+
+TEST(FeedArbiterTest, SymbolsAreArbitratedIndependently) {
+    FeedArbiter arbiter(2);
+    int delivered = 0;
+    EXPECT_TRUE(arbiter.arbitrate(0, "BTCUSDT", 10, 0, [&]() { ++delivered; }));
+    EXPECT_TRUE(arbiter.arbitrate(1, "ETHUSDT", 10, 0, [&]() { ++delivered; }));
+    EXPECT_FALSE(arbiter.arbitrate(1, "BTCUSDT", 10, 0, [&]() { ++delivered; }));
+    EXPECT_EQ(delivered, 2);
+}
+
+TEST(FeedArbiterTest, UnsequencedUpdatesOnlyFromPrimary) {
+    FeedArbiter arbiter(2, 1);
+    int delivered = 0;
+    EXPECT_FALSE(arbiter.arbitrate(0, "BTC-USD", 0, 0, [&]() { ++delivered; }));
+    EXPECT_TRUE(arbiter.arbitrate(1, "BTC-USD", 0, 0, [&]() { ++delivered; }));
+    EXPECT_EQ(delivered, 1);
+}
+
+TEST(FeedArbiterTest, ConcurrentSessionsDeliverEachSequenceOnceInOrder) {
+    constexpr uint64_t kUpdates = 20000;
+    FeedArbiter arbiter(2);
+    std::vector<uint64_t> delivered;
+    delivered.reserve(kUpdates);
+
+    auto run = [&](std::size_t session) {
+        for (uint64_t seq = 1; seq <= kUpdates; ++seq) {
+            arbiter.arbitrate(session, "BTCUSDT", seq, FeedArbiter::nowNs(),
+                              [&]() { delivered.push_back(seq); });
+        }
+    };
+    std::thread a(run, 0);
+    std::thread b(run, 1);
+    a.join();
+    b.join();
+
+    ASSERT_EQ(delivered.size(), kUpdates);
+    for (uint64_t i = 0; i < kUpdates; ++i) {
+        ASSERT_EQ(delivered[i], i + 1);
+    }
+    EXPECT_EQ(arbiter.getSessionStats(0).wins + arbiter.getSessionStats(1).wins, kUpdates);
+}
+
+TEST(FeedArbiterTest, RedundantAdapterForwardsFirstArrivalOnly) {
+    auto primary = std::make_shared<MockExchangeAdapter>();
+    auto standby = std::make_shared<MockExchangeAdapter>();
+    RedundantFeedAdapter adapter({primary, standby});
+    ASSERT_TRUE(adapter.connect());
+
+    std::vector<uint64_t> sequences;
+    adapter.registerOrderBookDeltaCallback([&](const OrderBookDelta& delta) {
+        sequences.push_back(delta.sequence);
+    });
+
+    OrderBookDelta delta;
+    delta.symbol = "BTCUSDT";
+    delta.timestamp = 0;
+    delta.bidUpdates = {{50000.0, 1.0}};
+    for (uint64_t seq : {1, 2, 3}) {
+        delta.sequence = seq;
+        standby->feedOrderBookDelta(delta);
+        primary->feedOrderBookDelta(delta);
+    }
+
+    EXPECT_EQ(sequences, (std::vector<uint64_t>{1, 2, 3}));
+    EXPECT_EQ(adapter.getArbiter().getSessionStats(1).wins, 3u);
+    EXPECT_EQ(adapter.getArbiter().getSessionStats(0).duplicates, 3u);
+    adapter.disconnect();
+}
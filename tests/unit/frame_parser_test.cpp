@@ -0,0 +1,390 @@
+#include "../../src/exchanges/FrameParser.hpp"
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace crypto_hft;
+using json = nlohmann::json;
+
+namespace {
+
+std::vector<std::string> loadCorpus(const std::string& name) {
+    std::ifstream file(std::string(CORPUS_DIR) + "/" + name);
+    std::vector<std::string> frames;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty()) {
+            frames.push_back(line);
+        }
+    }
+    return frames;
+}
+
+std::vector<std::pair<double, double>> levels(const json& array) {
+    std::vector<std::pair<double, double>> out;
+    for (const auto& level : array) {
+        out.emplace_back(std::stod(level[0].get<std::string>()),
+                         std::stod(level[1].get<std::string>()));
+    }
+    return out;
+}
+
+} // namespace
+
+TEST(FrameParserTest, BinanceMatchesJsonReference) {
+    auto frames = loadCorpus("binance_book.jsonl");
+    ASSERT_FALSE(frames.empty());
+
+    OrderBookSnapshot snapshot;
+    OrderBookDelta delta;
+    std::size_t deltas = 0;
+    for (const auto& frame : frames) {
+        json data = json::parse(frame);
+        FrameType type = BinanceFrameParser::parse(frame, snapshot, delta);
+        if (data.contains("e")) {
+            ASSERT_EQ(type, FrameType::BookDelta) << frame;
+            EXPECT_EQ(delta.symbol, data["s"].get<std::string>());
+            EXPECT_EQ(delta.sequence, data["u"].get<uint64_t>());
+            EXPECT_EQ(delta.bidUpdates, levels(data["b"]));
+            EXPECT_EQ(delta.askUpdates, levels(data["a"]));
+            ++deltas;
+        } else {
+            EXPECT_EQ(type, FrameType::Control) << frame;
+        }
+    }
+    EXPECT_GT(deltas, 0u);
+}
+
+TEST(FrameParserTest, BinanceCombinedStreamAndSnapshot) {
+    OrderBookSnapshot snapshot;
+    OrderBookDelta delta;
+
+    std::string wrapped = R"({"stream":"btcusdt@depth@100ms","data":{"e":"depthUpdate","E":1,)"
+                          R"("s":"BTCUSDT","U":5,"u":7,"b":[["100.5","2"]],"a":[]}})";
+    ASSERT_EQ(BinanceFrameParser::parse(wrapped, snapshot, delta), FrameType::BookDelta);
+    EXPECT_EQ(delta.symbol, "BTCUSDT");
+    EXPECT_EQ(delta.sequence, 7u);
+    EXPECT_EQ(delta.firstSequence, 5u);
+    ASSERT_EQ(delta.bidUpdates.size(), 1u);
+    EXPECT_DOUBLE_EQ(delta.bidUpdates[0].first, 100.5);
+    EXPECT_TRUE(delta.askUpdates.empty());
+
+    std::string rest = R"({"lastUpdateId":1027024,"bids":[["4.00000000","431.00000000"]],)"
+                       R"("asks":[["4.00000200","12.00000000"]]})";
+    ASSERT_EQ(BinanceFrameParser::parse(rest, snapshot, delta), FrameType::BookSnapshot);
+    EXPECT_EQ(snapshot.sequence, 1027024u);
+    EXPECT_DOUBLE_EQ(snapshot.asks[0].first, 4.000002);
+}
+
+TEST(FrameParserTest, BinanceBookTicker) {
+    OrderBookSnapshot snapshot;
+    OrderBookDelta delta;
+    TopOfBookUpdate ticker;
+
+    std::string spot = R"({"u":400900217,"s":"BNBUSDT","b":"25.35190000","B":"31.21000000",)"
+                       R"("a":"25.36520000","A":"40.66000000"})";
+    ASSERT_EQ(BinanceFrameParser::parse(spot, snapshot, delta, ticker), FrameType::TopOfBook);
+    EXPECT_EQ(ticker.symbol, "BNBUSDT");
+    EXPECT_EQ(ticker.sequence, 400900217u);
+    EXPECT_DOUBLE_EQ(ticker.bidPrice, 25.3519);
+    EXPECT_DOUBLE_EQ(ticker.bidSize, 31.21);
+    EXPECT_DOUBLE_EQ(ticker.askPrice, 25.3652);
+    EXPECT_DOUBLE_EQ(ticker.askSize, 40.66);
+    // Callers without a ticker output leave it to the slow path
+    EXPECT_EQ(BinanceFrameParser::parse(spot, snapshot, delta), FrameType::Control);
+
+    std::string futures = R"({"stream":"btcusdt@bookTicker","data":{"e":"bookTicker","u":9,)"
+                          R"("s":"BTCUSDT","b":"100.1","B":"1","a":"100.2","A":"2"}})";
+    ASSERT_EQ(BinanceFrameParser::parse(futures, snapshot, delta, ticker), FrameType::TopOfBook);
+    EXPECT_EQ(ticker.symbol, "BTCUSDT");
+    EXPECT_DOUBLE_EQ(ticker.askSize, 2.0);
+
+    std::string broken = R"({"u":1,"s":"BTCUSDT","b":"x","B":"1","a":"2","A":"1"})";
+    EXPECT_EQ(BinanceFrameParser::parse(broken, snapshot, delta, ticker), FrameType::Malformed);
+}
+
+TEST(FrameParserTest, CoinbaseMatchesJsonReference) {
+    auto frames = loadCorpus("coinbase_book.jsonl");
+    ASSERT_FALSE(frames.empty());
+
+    OrderBookSnapshot snapshot;
+    OrderBookDelta delta;
+    for (const auto& frame : frames) {
+        json data = json::parse(frame);
+        FrameType type = CoinbaseFrameParser::parse(frame, snapshot, delta);
+        std::string messageType = data["type"];
+        if (messageType == "snapshot") {
+            ASSERT_EQ(type, FrameType::BookSnapshot);
+            EXPECT_EQ(snapshot.symbol, data["product_id"].get<std::string>());
+            EXPECT_EQ(snapshot.bids, levels(data["bids"]));
+            EXPECT_EQ(snapshot.asks, levels(data["asks"]));
+        } else if (messageType == "l2update") {
+            ASSERT_EQ(type, FrameType::BookDelta);
+            std::vector<std::pair<double, double>> bids;
+            std::vector<std::pair<double, double>> asks;
+            for (const auto& change : data["changes"]) {
+                auto level = std::make_pair(std::stod(change[1].get<std::string>()),
+                                            std::stod(change[2].get<std::string>()));
+                (change[0] == "buy" ? bids : asks).push_back(level);
+            }
+            EXPECT_EQ(delta.bidUpdates, bids);
+            EXPECT_EQ(delta.askUpdates, asks);
+        } else if (messageType == "heartbeat") {
+            EXPECT_EQ(type, FrameType::Heartbeat) << frame;
+        } else {
+            EXPECT_EQ(type, FrameType::Control) << frame;
+        }
+    }
+}
+
+TEST(FrameParserTest, CoinbaseAdvancedMatchesJsonReference) {
+    auto frames = loadCorpus("coinbase_advanced_book.jsonl");
+    ASSERT_FALSE(frames.empty());
+
+    CoinbaseBookBatch batch;
+    std::size_t multiProduct = 0;
+    for (const auto& frame : frames) {
+        json data = json::parse(frame);
+        FrameType type = CoinbaseFrameParser::parse(frame, batch);
+        ASSERT_TRUE(batch.hasSequence) << frame;
+        EXPECT_EQ(batch.sequence, data["sequence_num"].get<uint64_t>());
+        if (data["channel"] == "heartbeats") {
+            EXPECT_EQ(type, FrameType::Heartbeat) << frame;
+            continue;
+        }
+        if (data["channel"] != "l2_data") {
+            EXPECT_EQ(type, FrameType::Control) << frame;
+            continue;
+        }
+
+        // Every product's events merge, in order, into one entry per product
+        using Levels = std::vector<std::pair<double, double>>;
+        std::vector<std::string> products;
+        std::vector<std::pair<Levels, Levels>> sides;
+        bool isSnapshot = false;
+        for (const auto& event : data["events"]) {
+            isSnapshot = isSnapshot || event["type"] == "snapshot";
+            std::string product = event["product_id"];
+            auto it = std::find(products.begin(), products.end(), product);
+            if (it == products.end()) {
+                products.push_back(product);
+                sides.emplace_back();
+                it = products.end() - 1;
+            }
+            auto& [bids, asks] = sides[it - products.begin()];
+            for (const auto& update : event["updates"]) {
+                auto level = std::make_pair(std::stod(update["price_level"].get<std::string>()),
+                                            std::stod(update["new_quantity"].get<std::string>()));
+                (update["side"] == "bid" ? bids : asks).push_back(level);
+            }
+        }
+        multiProduct += products.size() > 1;
+
+        if (isSnapshot) {
+            ASSERT_EQ(type, FrameType::BookSnapshot);
+            ASSERT_EQ(batch.snapshotCount, products.size());
+            EXPECT_EQ(batch.deltaCount, 0u);
+            for (std::size_t i = 0; i < products.size(); ++i) {
+                EXPECT_EQ(batch.snapshots[i].symbol, products[i]);
+                EXPECT_EQ(batch.snapshots[i].sequence, 0u);
+                EXPECT_EQ(batch.snapshots[i].bids, sides[i].first);
+                EXPECT_EQ(batch.snapshots[i].asks, sides[i].second);
+            }
+        } else {
+            ASSERT_EQ(type, FrameType::BookDelta);
+            ASSERT_EQ(batch.deltaCount, products.size());
+            EXPECT_EQ(batch.snapshotCount, 0u);
+            for (std::size_t i = 0; i < products.size(); ++i) {
+                EXPECT_EQ(batch.deltas[i].symbol, products[i]);
+                EXPECT_EQ(batch.deltas[i].sequence, 0u);
+                EXPECT_EQ(batch.deltas[i].bidUpdates, sides[i].first);
+                EXPECT_EQ(batch.deltas[i].askUpdates, sides[i].second);
+            }
+        }
+    }
+    EXPECT_GT(multiProduct, 0u);
+}
+
+TEST(FrameParserTest, CoinbaseSingleProductOverloadRejectsBatches) {
+    OrderBookSnapshot snapshot;
+    OrderBookDelta delta;
+    std::string single = R"({"channel":"l2_data","sequence_num":7,"events":[)"
+                         R"({"type":"update","product_id":"BTC-USD","updates":[)"
+                         R"({"side":"bid","price_level":"100.5","new_quantity":"1"}]},)"
+                         R"({"type":"update","product_id":"BTC-USD","updates":[)"
+                         R"({"side":"offer","price_level":"100.7","new_quantity":"0"}]}]})";
+    ASSERT_EQ(CoinbaseFrameParser::parse(single, snapshot, delta), FrameType::BookDelta);
+    EXPECT_EQ(delta.symbol, "BTC-USD");
+    // A connection's message count, not a book id
+    EXPECT_EQ(delta.sequence, 0u);
+    EXPECT_EQ(delta.bidUpdates.size(), 1u);
+    EXPECT_EQ(delta.askUpdates.size(), 1u);
+
+    std::string both = R"({"channel":"l2_data","sequence_num":8,"events":[)"
+                       R"({"type":"update","product_id":"BTC-USD","updates":[]},)"
+                       R"({"type":"update","product_id":"ETH-USD","updates":[]}]})";
+    EXPECT_EQ(CoinbaseFrameParser::parse(both, snapshot, delta), FrameType::Malformed);
+
+    CoinbaseBookBatch batch;
+    ASSERT_EQ(CoinbaseFrameParser::parse(both, batch), FrameType::BookDelta);
+    EXPECT_EQ(batch.deltaCount, 2u);
+
+    std::string heartbeat = R"({"channel":"heartbeats","sequence_num":9,"events":[]})";
+    EXPECT_EQ(CoinbaseFrameParser::parse(heartbeat, batch), FrameType::Heartbeat);
+    EXPECT_EQ(batch.sequence, 9u);
+    EXPECT_EQ(batch.deltaCount, 0u);
+}
+
+TEST(FrameParserTest, KrakenMatchesJsonReference) {
+    auto frames = loadCorpus("kraken_book.jsonl");
+    ASSERT_FALSE(frames.empty());
+
+    OrderBookSnapshot snapshot;
+    OrderBookDelta delta;
+    for (const auto& frame : frames) {
+        json data = json::parse(frame);
+        FrameType type = KrakenFrameParser::parse(frame, snapshot, delta);
+        if (!data.is_array()) {
+            EXPECT_EQ(type, data["event"] == "heartbeat" ? FrameType::Heartbeat : FrameType::Control)
+                << frame;
+            continue;
+        }
+
+        std::vector<std::pair<double, double>> bids;
+        std::vector<std::pair<double, double>> asks;
+        bool isSnapshot = false;
+        for (const auto& element : data) {
+            if (!element.is_object()) {
+                continue;
+            }
+            for (const char* key : {"bs", "b"}) {
+                if (element.contains(key)) {
+                    auto parsed = levels(element[key]);
+                    bids.insert(bids.end(), parsed.begin(), parsed.end());
+                    isSnapshot |= std::string(key) == "bs";
+                }
+            }
+            for (const char* key : {"as", "a"}) {
+                if (element.contains(key)) {
+                    auto parsed = levels(element[key]);
+                    asks.insert(asks.end(), parsed.begin(), parsed.end());
+                }
+            }
+        }
+
+        const std::string pair = data.back().get<std::string>();
+        if (isSnapshot) {
+            ASSERT_EQ(type, FrameType::BookSnapshot);
+            EXPECT_EQ(snapshot.symbol, pair);
+            EXPECT_EQ(snapshot.bids, bids);
+            EXPECT_EQ(snapshot.asks, asks);
+        } else {
+            ASSERT_EQ(type, FrameType::BookDelta);
+            EXPECT_EQ(delta.symbol, pair);
+            EXPECT_EQ(delta.bidUpdates, bids);
+            EXPECT_EQ(delta.askUpdates, asks);
+        }
+    }
+}
+
+TEST(FrameParserTest, KrakenReportsChannelChecksumAndLevelText) {
+    OrderBookSnapshot snapshot;
+    OrderBookDelta delta;
+    KrakenBookFrame book;
+    const std::string frame =
+        R"([336,{"a":[["43000.70000","0.00000000","1700000000.1"]]},)"
+        R"({"b":[["42999.90000","1.50000000","1700000000.1","r"]],"c":"3996013957"},)"
+        R"("book-10","XBT/USD"])";
+    ASSERT_EQ(KrakenFrameParser::parse(frame, snapshot, delta, book), FrameType::BookDelta);
+    EXPECT_EQ(book.channelId, 336u);
+    EXPECT_TRUE(book.hasChecksum);
+    EXPECT_EQ(book.checksum, 3996013957u);
+    ASSERT_EQ(book.asks.size(), 1u);
+    EXPECT_EQ(book.asks[0].first, "43000.70000");
+    EXPECT_EQ(book.asks[0].second, "0.00000000");
+    ASSERT_EQ(book.bids.size(), 1u);
+    EXPECT_EQ(book.bids[0].second, "1.50000000");
+
+    EXPECT_EQ(KrakenFrameParser::parse(R"([336,{"b":[["1.0","1.0","1"]],"c":"4294967296"},)"
+                                       R"("book-10","XBT/USD"])",
+                                       snapshot, delta, book),
+              FrameType::Malformed);
+}
+
+TEST(FrameParserTest, ExchangeEventTimesInNanoseconds) {
+    OrderBookSnapshot snapshot;
+    OrderBookDelta delta;
+    TopOfBookUpdate ticker;
+
+    // Binance: "E", milliseconds
+    ASSERT_EQ(BinanceFrameParser::parse(
+                  R"({"e":"depthUpdate","E":1700000000090,"s":"BTCUSDT","U":1,"u":2,)"
+                  R"("b":[["1.0","1.0"]],"a":[]})",
+                  snapshot, delta),
+              FrameType::BookDelta);
+    EXPECT_EQ(delta.exchangeTime, 1700000000090000000);
+    EXPECT_EQ(delta.exchangeTimeLocal, 0);
+    // Spot bookTicker has none
+    ASSERT_EQ(BinanceFrameParser::parse(R"({"u":9,"s":"BTCUSDT","b":"1","B":"1","a":"2","A":"1"})",
+                                        snapshot, delta, ticker),
+              FrameType::TopOfBook);
+    EXPECT_EQ(ticker.exchangeTime, 0);
+
+    // Coinbase Advanced Trade: the message timestamp, to the nanosecond
+    CoinbaseBookBatch batch;
+    ASSERT_EQ(CoinbaseFrameParser::parse(
+                  R"({"channel":"l2_data","timestamp":"2023-02-09T20:32:50.714964855Z",)"
+                  R"("sequence_num":4,"events":[{"type":"update","product_id":"BTC-USD",)"
+                  R"("updates":[{"side":"bid","event_time":"2023-02-09T20:32:50.7Z",)"
+                  R"("price_level":"21921.73","new_quantity":"0.06317902"}]}]})",
+                  batch),
+              FrameType::BookDelta);
+    EXPECT_EQ(batch.deltas[0].exchangeTime, 1675974770714964855);
+    // Legacy feed: "time", here in milliseconds
+    ASSERT_EQ(CoinbaseFrameParser::parse(
+                  R"({"type":"l2update","product_id":"BTC-USD","time":"2019-08-14T20:42:27.265Z",)"
+                  R"("changes":[["buy","10101.80","0.16"]]})",
+                  snapshot, delta),
+              FrameType::BookDelta);
+    EXPECT_EQ(delta.exchangeTime, 1565815347265000000);
+    // An unreadable time is left out rather than failing the book data
+    ASSERT_EQ(CoinbaseFrameParser::parse(
+                  R"({"type":"l2update","product_id":"BTC-USD","time":"2019-02-30T00:00:00Z",)"
+                  R"("changes":[["buy","10101.80","0.16"]]})",
+                  snapshot, delta),
+              FrameType::BookDelta);
+    EXPECT_EQ(delta.exchangeTime, 0);
+
+    // Kraken: the latest level time of an update; snapshot levels may be of any age
+    ASSERT_EQ(KrakenFrameParser::parse(
+                  R"([336,{"a":[["43000.7","0.0","1700000000.250000"]]},)"
+                  R"({"b":[["42999.9","1.5","1700000000.125000","r"]],"c":"1"},"book-10","XBT/USD"])",
+                  snapshot, delta),
+              FrameType::BookDelta);
+    EXPECT_EQ(delta.exchangeTime, 1700000000250000000);
+    ASSERT_EQ(KrakenFrameParser::parse(
+                  R"([336,{"as":[["43000.7","1.0","1700000000.250000"]],)"
+                  R"("bs":[["42999.9","1.5","1700000000.125000"]]},"book-10","XBT/USD"])",
+                  snapshot, delta),
+              FrameType::BookSnapshot);
+    EXPECT_EQ(snapshot.exchangeTime, 0);
+}
+
+TEST(FrameParserTest, MalformedFramesAreRejected) {
+    OrderBookSnapshot snapshot;
+    OrderBookDelta delta;
+    EXPECT_EQ(BinanceFrameParser::parse(R"({"e":"depthUpdate","s":"BTCUSDT","b":[["1.0")",
+                                        snapshot, delta),
+              FrameType::Malformed);
+    EXPECT_EQ(BinanceFrameParser::parse(R"({"e":"depthUpdate","s":"X","b":[["abc","1"]],"a":[]})",
+                                        snapshot, delta),
+              FrameType::Malformed);
+    EXPECT_EQ(CoinbaseFrameParser::parse(R"({"type":"l2update","changes":[["buy"]]})",
+                                         snapshot, delta),
+              FrameType::Malformed);
+    EXPECT_EQ(KrakenFrameParser::parse(R"([336,"book-10","XBT/USD"])", snapshot, delta),
+              FrameType::Malformed);
+}
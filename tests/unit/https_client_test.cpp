@@ -0,0 +1,247 @@
+#include "../../src/exchanges/HttpsClient.hpp"
+#include "LocalHttpsServer.hpp"
+#include "TestSupport.hpp"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+using namespace crypto_hft;
+namespace net = boost::asio;
+namespace http = boost::beast::http;
+
+namespace {
+
+class HttpsClientTest : public IoContextTest {
+protected:
+    void TearDown() override {
+        if (client_) {
+            client_->shutdown();
+        }
+        IoContextTest::TearDown();
+    }
+
+    HttpsClient& makeClient(const std::string& port, std::size_t connections = 4,
+                            std::size_t pipelineDepth = 4) {
+        HttpsClient::Options options;
+        options.host = "localhost";
+        options.port = port;
+        options.connections = connections;
+        options.pipelineDepth = pipelineDepth;
+        options.timeout = std::chrono::seconds(2);
+        options.verifyPeer = false;
+        client_ = HttpsClient::create(ioc_, options, nullptr);
+        return *client_;
+    }
+
+    HttpsClient& makeClient(HttpsClient::Options options) {
+        options.verifyPeer = false;
+        client_ = HttpsClient::create(ioc_, options, nullptr);
+        return *client_;
+    }
+
+    // Sends count GETs of /n/<i> and records every response under i
+    void getAll(std::size_t count, double weight = 1.0) {
+        responses_.resize(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            client_->get("/n/" + std::to_string(i), [this, i](HttpsClient::Response response) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                responses_[i] = std::move(response);
+                ++completed_;
+            }, weight);
+        }
+    }
+
+    bool allCompleted() {
+        return eventually([this] { return completed_.load() == responses_.size(); },
+                          std::chrono::seconds(10));
+    }
+
+    static LocalHttpsServer::Response echo(const LocalHttpsServer::Request& request) {
+        return LocalHttpsServer::reply(request, 200, std::string(request.target()));
+    }
+
+    std::shared_ptr<HttpsClient> client_;
+    std::mutex mutex_;
+    std::vector<std::optional<HttpsClient::Response>> responses_;
+    std::atomic<std::size_t> completed_{0};
+};
+
+} // namespace
+
+TEST_F(HttpsClientTest, PipelinesRequestsOverPooledConnections) {
+    LocalHttpsServer server(echo);
+    auto& client = makeClient(server.port(), 2, 4);
+
+    getAll(50);
+    ASSERT_TRUE(allCompleted());
+    for (std::size_t i = 0; i < responses_.size(); ++i) {
+        ASSERT_TRUE(responses_[i]->ok()) << i;
+        EXPECT_EQ(responses_[i]->body, "/n/" + std::to_string(i));
+    }
+
+    // Both connections stay open for every request; the second resumes the first's session
+    EXPECT_LE(server.connections(), 2u);
+    EXPECT_EQ(server.requests(), 50u);
+    auto stats = client.getStats();
+    EXPECT_EQ(stats.responses, 50u);
+    EXPECT_LE(stats.connectionsOpened, 2u);
+    EXPECT_EQ(stats.retries, 0u);
+}
+
+TEST_F(HttpsClientTest, SpendsNoMoreThanTheWeightBudget) {
+    LocalHttpsServer server(echo);
+    HttpsClient::Options options;
+    options.host = "localhost";
+    options.port = server.port();
+    options.weightPerSecond = 100.0;
+    options.weightBurst = 5.0;
+    auto& client = makeClient(options);
+
+    // The burst covers the first request; the other ten wait 50 ms each for their weight
+    auto start = std::chrono::steady_clock::now();
+    getAll(11, 5.0);
+    ASSERT_TRUE(allCompleted());
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    EXPECT_GE(elapsed, std::chrono::milliseconds(450));
+    EXPECT_GT(client.getStats().throttled, 0u);
+}
+
+TEST_F(HttpsClientTest, WaitsOutRetryAfterOnTooManyRequests) {
+    std::atomic<int> served{0};
+    LocalHttpsServer server([&](const LocalHttpsServer::Request& request) {
+        if (served++ == 0) {
+            auto response = LocalHttpsServer::reply(request, 429, R"({"code":-1003})");
+            response.set(http::field::retry_after, "1");
+            return response;
+        }
+        return echo(request);
+    });
+    auto& client = makeClient(server.port());
+
+    auto start = std::chrono::steady_clock::now();
+    getAll(1);
+    ASSERT_TRUE(allCompleted());
+    EXPECT_TRUE(responses_[0]->ok());
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(900));
+    EXPECT_EQ(server.requests(), 2u);
+    EXPECT_EQ(client.getStats().retries, 1u);
+}
+
+TEST_F(HttpsClientTest, ResendsRequestsLeftOnAConnectionTheServerCloses) {
+    std::atomic<int> served{0};
+    LocalHttpsServer server([&](const LocalHttpsServer::Request& request) {
+        auto response = echo(request);
+        if (++served % 3 == 0) {
+            response.keep_alive(false);
+        }
+        return response;
+    });
+    makeClient(server.port(), 2, 4);
+
+    getAll(20);
+    ASSERT_TRUE(allCompleted());
+    for (std::size_t i = 0; i < responses_.size(); ++i) {
+        ASSERT_TRUE(responses_[i]->ok()) << i;
+        EXPECT_EQ(responses_[i]->body, "/n/" + std::to_string(i));
+    }
+    EXPECT_GT(server.connections(), 2u);
+}
+
+TEST_F(HttpsClientTest, FailsOnceRetriesAreExhausted) {
+    std::string port;
+    {
+        LocalHttpsServer server(echo);
+        port = server.port();
+    }
+    auto& client = makeClient(port);
+
+    getAll(1);
+    ASSERT_TRUE(allCompleted());
+    EXPECT_FALSE(responses_[0]->ok());
+    EXPECT_TRUE(responses_[0]->error);
+    EXPECT_EQ(client.getStats().connectionsOpened, 3u);
+}
+
+TEST_F(HttpsClientTest, ShutdownAbortsQueuedRequests) {
+    auto& client = makeClient("1");
+    client.shutdown();
+
+    getAll(1);
+    ASSERT_TRUE(allCompleted());
+    EXPECT_EQ(responses_[0]->error, net::error::operation_aborted);
+}
+
+TEST_F(HttpsClientTest, NeverResendsANonIdempotentRequest) {
+    std::atomic<int> served{0};
+    LocalHttpsServer server([&](const LocalHttpsServer::Request& request) {
+        if (served++ == 0) {
+            return LocalHttpsServer::hangUp();
+        }
+        return echo(request);
+    });
+    makeClient(server.port(), 1, 1);
+
+    std::promise<HttpsClient::Response> order;
+    client_->send({http::verb::post, "/order", 11},
+                  [&](HttpsClient::Response response) { order.set_value(std::move(response)); },
+                  1.0, false);
+    auto response = order.get_future().get();
+    EXPECT_TRUE(response.error);
+    EXPECT_EQ(server.requests(), 1u);
+
+    // Idempotent requests still go again after the same failure
+    served = 0;
+    getAll(1);
+    ASSERT_TRUE(allCompleted());
+    EXPECT_TRUE(responses_[0]->ok());
+    EXPECT_EQ(server.requests(), 3u);
+}
+
+TEST_F(HttpsClientTest, WarmUpOpensConnectionsBeforeTheFirstRequest) {
+    LocalHttpsServer server(echo);
+    HttpsClient::Options options;
+    options.host = "localhost";
+    options.port = server.port();
+    options.connections = 4;
+    options.warmConnections = 2;
+    options.maxIdle = std::chrono::seconds(1);
+    auto& client = makeClient(options);
+
+    client.warmUp();
+    ASSERT_TRUE(eventually([&] { return server.connections() == 2u; }));
+    EXPECT_EQ(server.requests(), 0u);
+
+    // Idle past maxIdle, both are replaced with fresh connections
+    ASSERT_TRUE(eventually([&] { return server.connections() >= 4u; }, std::chrono::seconds(5)));
+    EXPECT_GE(client.getStats().connectionsOpened, 4u);
+
+    getAll(1);
+    ASSERT_TRUE(allCompleted());
+    EXPECT_TRUE(responses_[0]->ok());
+}
+
+TEST(HttpsClientOptionsTest, FromYamlOverridesDefaults) {
+    HttpsClient::Options defaults;
+    defaults.host = "api.example.com";
+    defaults.weightPerSecond = 10.0;
+
+    auto node = YAML::Load("{connections: 2, pipeline_depth: 8, weight_burst: 50}");
+    auto options = HttpsClient::Options::fromYaml(node, defaults);
+    EXPECT_EQ(options.host, "api.example.com");
+    EXPECT_EQ(options.connections, 2u);
+    EXPECT_EQ(options.pipelineDepth, 8u);
+    EXPECT_DOUBLE_EQ(options.weightPerSecond, 10.0);
+    EXPECT_DOUBLE_EQ(options.weightBurst, 50.0);
+
+    auto warm = HttpsClient::Options::fromYaml(
+        YAML::Load("{connections: 2, warm_connections: 3, max_idle_s: 30}"), defaults);
+    EXPECT_EQ(warm.warmConnections, 2u);
+    EXPECT_EQ(warm.maxIdle, std::chrono::seconds(30));
+
+    auto missing = HttpsClient::Options::fromYaml(YAML::Load("{}")["rest"], defaults);
+    EXPECT_EQ(missing.host, "api.example.com");
+    EXPECT_EQ(missing.connections, 4u);
+}
@@ -0,0 +1,116 @@
+#include "../../src/exchanges/Crc32.hpp"
+#include "../../src/exchanges/KrakenAdapter.hpp"
+#include "../../src/exchanges/KrakenBook.hpp"
+#include <gtest/gtest.h>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace crypto_hft;
+
+namespace {
+
+std::vector<std::string> loadCorpus(const std::string& name) {
+    std::ifstream file(std::string(CORPUS_DIR) + "/" + name);
+    std::vector<std::string> frames;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty()) {
+            frames.push_back(line);
+        }
+    }
+    return frames;
+}
+
+} // namespace
+
+TEST(KrakenBookTest, Crc32MatchesZlib) {
+    EXPECT_EQ(Crc32::compute(""), 0u);
+    EXPECT_EQ(Crc32::compute("123456789"), 0xCBF43926u);
+
+    // Chained over pieces of every length around the eight-byte stride
+    const std::string text = "The quick brown fox jumps over the lazy dog";
+    EXPECT_EQ(Crc32::compute(text), 0x414FA339u);
+    for (std::size_t split = 0; split <= text.size(); ++split) {
+        uint32_t crc = Crc32::update(0, text.data(), split);
+        EXPECT_EQ(Crc32::update(crc, text.data() + split, text.size() - split), 0x414FA339u)
+            << split;
+    }
+}
+
+TEST(KrakenBookTest, ChecksumsFollowKrakensFormat) {
+    // From Kraken's checksum guide: "0.05005" "0.00000500" is checksummed as "5005" "500"
+    OrderBookSnapshot snapshot;
+    snapshot.asks = {{0.05005, 0.000005}, {0.05010, 0.00000500}};
+    snapshot.bids = {{0.05000, 0.00000500}};
+    KrakenBookFrame frame;
+    frame.asks = {{"0.05005", "0.00000500"}, {"0.05010", "0.00000500"}};
+    frame.bids = {{"0.05000", "0.00000500"}};
+
+    KrakenBook book;
+    ASSERT_TRUE(book.applySnapshot(snapshot, frame));
+    EXPECT_EQ(book.checksum(), Crc32::compute("5005500" "5010500" "5000500"));
+
+    // Removing the best ask and adding a bid below the others
+    OrderBookDelta delta;
+    delta.askUpdates = {{0.05005, 0.0}};
+    delta.bidUpdates = {{0.04995, 1.0}};
+    frame.asks = {{"0.05005", "0.00000000"}};
+    frame.bids = {{"0.04995", "1.00000000"}};
+    ASSERT_TRUE(book.applyDelta(delta, frame));
+    EXPECT_EQ(book.checksum(), Crc32::compute("5010500" "5000500" "4995100000000"));
+}
+
+TEST(KrakenBookTest, AdapterValidatesCorpusChecksums) {
+    auto frames = loadCorpus("kraken_book.jsonl");
+    ASSERT_FALSE(frames.empty());
+
+    KrakenAdapter adapter;
+    adapter.setFrameCaptureSampling(0);
+    std::size_t snapshots = 0;
+    std::size_t deltas = 0;
+    adapter.registerOrderBookCallback([&](const OrderBookSnapshot&) { ++snapshots; });
+    adapter.registerOrderBookDeltaCallback([&](const OrderBookDelta&) { ++deltas; });
+
+    std::size_t expectedDeltas = 0;
+    for (const auto& frame : frames) {
+        adapter.handle_frame(frame);
+        expectedDeltas += frame.find("\"c\":") != std::string::npos;
+    }
+    EXPECT_EQ(snapshots, 2u);
+    EXPECT_GT(expectedDeltas, 0u);
+    EXPECT_EQ(deltas, expectedDeltas);
+    EXPECT_EQ(adapter.getChecksumFailures(), 0u);
+}
+
+TEST(KrakenBookTest, ChecksumMismatchResyncsOnlyThatSymbol) {
+    auto frames = loadCorpus("kraken_book.jsonl");
+    ASSERT_FALSE(frames.empty());
+
+    // Corrupt the checksum of the first XBT/USD update
+    bool corrupted = false;
+    for (auto& frame : frames) {
+        auto pos = frame.find("\"c\":\"");
+        if (!corrupted && pos != std::string::npos && frame.find("XBT/USD") != std::string::npos) {
+            frame.replace(pos, 5, "\"c\":\"1");
+            corrupted = true;
+        }
+    }
+    ASSERT_TRUE(corrupted);
+
+    KrakenAdapter adapter;
+    adapter.setFrameCaptureSampling(0);
+    std::map<std::string, std::size_t> deltas;
+    adapter.registerOrderBookDeltaCallback([&](const OrderBookDelta& delta) {
+        ++deltas[delta.symbol];
+    });
+    for (const auto& frame : frames) {
+        adapter.handle_frame(frame);
+    }
+
+    // XBT/USD waits for a new snapshot; ETH/USD carries on
+    EXPECT_EQ(adapter.getChecksumFailures(), 1u);
+    EXPECT_EQ(deltas["XBT/USD"], 0u);
+    EXPECT_GT(deltas["ETH/USD"], 100u);
+}
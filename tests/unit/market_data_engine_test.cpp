@@ -0,0 +1,76 @@
+#include "../../src/core/MarketDataEngine.hpp"
+#include "MockExchangeAdapter.hpp"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+using namespace crypto_hft;
+
+namespace {
+
+OrderBookDelta bidDelta(double price) {
+    OrderBookDelta delta;
+    delta.symbol = "BTC-USD";
+    delta.bidUpdates.push_back({price, 1.0});
+    return delta;
+}
+
+} // namespace
+
+TEST(MarketDataEngineTest, BatchCallbackTakesPrecedenceAndBatchesStopAtTheCap) {
+    auto adapter = std::make_shared<MockExchangeAdapter>();
+    ASSERT_TRUE(adapter->connect());
+    MarketDataEngine engine({adapter});
+
+    std::atomic<int> perUpdate{0};
+    std::mutex mutex;
+    std::vector<std::size_t> batches;
+    std::vector<double> bids;
+    std::promise<void> fed;
+    std::shared_future<void> allFed = fed.get_future().share();
+    engine.registerCallback([&](const MarketUpdate&) { ++perUpdate; });
+    engine.registerBatchCallback([&](std::span<const MarketUpdate> batch) {
+        // Holds the dispatcher on its first batch so the rest queue up behind it
+        allFed.wait();
+        std::lock_guard<std::mutex> lock(mutex);
+        batches.push_back(batch.size());
+        for (const auto& update : batch) {
+            bids.push_back(update.bidPrice);
+        }
+    });
+    engine.setMaxBatchSize(8);
+    engine.initialize({"BTC-USD"});
+
+    constexpr int kUpdates = 50;
+    for (int i = 0; i < kUpdates; ++i) {
+        adapter->feedOrderBookDelta(bidDelta(100.0 + i));
+    }
+    fed.set_value();
+
+    auto delivered = [&] {
+        std::lock_guard<std::mutex> lock(mutex);
+        return std::accumulate(batches.begin(), batches.end(), std::size_t{0});
+    };
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (delivered() < kUpdates && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    engine.stop();
+
+    EXPECT_EQ(delivered(), static_cast<std::size_t>(kUpdates));
+    EXPECT_EQ(perUpdate.load(), 0);
+    ASSERT_FALSE(batches.empty());
+    EXPECT_LE(*std::max_element(batches.begin(), batches.end()), 8u);
+    // At most one update was drained before the dispatcher was held, so the other 49 or more
+    // came off the queue in full batches but for the last
+    EXPECT_GE(std::count(batches.begin(), batches.end(), 8u), 5);
+    // The best bid rises with every delta, in the order they were fed
+    EXPECT_TRUE(std::is_sorted(bids.begin(), bids.end()));
+    EXPECT_EQ(bids.back(), 100.0 + kUpdates - 1);
+}
@@ -0,0 +1,67 @@
+#include "../../src/exchanges/CoinbaseAdapter.hpp"
+#include "../../src/exchanges/RedundantFeedAdapter.hpp"
+#include "../../src/infra/MetricsReporter.hpp"
+#include <gtest/gtest.h>
+#include <memory>
+#include <optional>
+#include <string>
+
+using namespace crypto_hft;
+
+namespace {
+
+std::string l2Update(uint64_t sequence) {
+    return R"({"channel":"l2_data","timestamp":"2024-01-01T00:00:00Z","sequence_num":)" +
+           std::to_string(sequence) +
+           R"(,"events":[{"type":"update","product_id":"BTC-USD","updates":[)"
+           R"({"side":"bid","event_time":"2024-01-01T00:00:00Z","price_level":"100.0",)"
+           R"("new_quantity":"1"}]}]})";
+}
+
+} // namespace
+
+class MetricsReporterTest : public ::testing::Test {
+protected:
+    // The exposer may fail to bind here; gauges are kept in the registry regardless
+    void SetUp() override { MetricsReporter::getInstance().initialize("127.0.0.1", 0); }
+};
+
+TEST_F(MetricsReporterTest, AdaptersPublishThroughTheInterface) {
+    CoinbaseAdapter adapter;
+    adapter.handle_frame(l2Update(1));
+    adapter.handle_frame(l2Update(3));  // 2 was missed
+    ASSERT_EQ(adapter.getSequenceGaps(), 1u);
+
+    const IExchangeAdapter& generic = adapter;
+    generic.publishMetrics();
+    const std::optional<double> gaps =
+        MetricsReporter::getInstance().getGauge("sequence_gaps", {{"venue", "coinbase"}});
+    ASSERT_TRUE(gaps.has_value());
+    EXPECT_EQ(*gaps, 1.0);
+}
+
+TEST_F(MetricsReporterTest, RedundantAdapterPublishesTheArbiterAndItsSessions) {
+    auto primary = std::make_shared<CoinbaseAdapter>();
+    auto standby = std::make_shared<CoinbaseAdapter>();
+    RedundantFeedAdapter adapter({primary, standby});
+    adapter.registerOrderBookDeltaCallback([](const OrderBookDelta&) {});
+    primary->handle_frame(l2Update(1));
+    standby->handle_frame(l2Update(1));
+    standby->handle_frame(l2Update(3));  // only the standby misses 2
+
+    adapter.publishMetrics();
+    auto& reporter = MetricsReporter::getInstance();
+    const std::optional<double> wins =
+        reporter.getGauge("feed_arbiter_wins", {{"venue", "coinbase"}, {"session", "0"}});
+    ASSERT_TRUE(wins.has_value());
+    EXPECT_EQ(*wins, 1.0);
+    // Each session keeps its own series rather than the last one published
+    const std::optional<double> primaryGaps =
+        reporter.getGauge("sequence_gaps", {{"venue", "coinbase"}, {"session", "0"}});
+    const std::optional<double> standbyGaps =
+        reporter.getGauge("sequence_gaps", {{"venue", "coinbase"}, {"session", "1"}});
+    ASSERT_TRUE(primaryGaps.has_value());
+    ASSERT_TRUE(standbyGaps.has_value());
+    EXPECT_EQ(*primaryGaps, 0.0);
+    EXPECT_EQ(*standbyGaps, 1.0);
+}
@@ -0,0 +1,190 @@
+#include "../../src/exchanges/OrderTemplate.hpp"
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace crypto_hft;
+using json = nlohmann::json;
+
+namespace {
+
+const std::string kKey = "binance-key";
+const std::string kSecret = "binance-secret";
+
+OrderRequest order(std::string symbol, OrderRequest::Side side, OrderRequest::Type type,
+                   double price, double size, std::string clientOrderId) {
+    OrderRequest request;
+    request.symbol = std::move(symbol);
+    request.side = side;
+    request.type = type;
+    request.price = price;
+    request.size = size;
+    request.clientOrderId = std::move(clientOrderId);
+    return request;
+}
+
+// The frame Binance would get for payload, with its parameters already in name order
+std::string binanceFrame(uint64_t id, const std::string& method, const std::string& params,
+                         const std::string& payload) {
+    return "{\"id\":" + std::to_string(id) + ",\"method\":\"" + method + "\",\"params\":{" +
+           params + ",\"signature\":\"" + ExchangeUtils::generate_hmac_sha256(kSecret, payload) +
+           "\"}}";
+}
+
+} // namespace
+
+TEST(OrderTemplateTest, RendersSlotsAndLeavesOutEmptyOptionalOnes) {
+    using Slot = OrderTemplate::Slot;
+    using Format = OrderTemplate::Format;
+    OrderTemplate request;
+    request.text("{\"id\":")
+        .slot(Slot::Id)
+        .text(",\"price\":")
+        .slot(Slot::Price, Format::Quoted)
+        .text(",\"qty\":")
+        .slot(Slot::Quantity)
+        .optional(",\"cid\":", Slot::ClientOrderId, Format::Quoted)
+        .text("}");
+
+    OrderTemplate::Values values;
+    values.id = 7;
+    values.price = 42000.5;
+    values.quantity = 0.0015;
+    std::string out;
+    request.render(values, out);
+    EXPECT_EQ(out, R"({"id":7,"price":"42000.5","qty":0.0015})");
+
+    // Rendering appends; quoted text slots are escaped
+    values.clientOrderId = "a\"b\\c\n";
+    request.render(values, out);
+    EXPECT_EQ(out, R"({"id":7,"price":"42000.5","qty":0.0015})"
+                   R"({"id":7,"price":"42000.5","qty":0.0015,"cid":"a\"b\\c\u000a"})");
+    EXPECT_EQ(json::parse(out.substr(out.find("}{") + 1))["cid"], "a\"b\\c\n");
+}
+
+TEST(OrderTemplateTest, BinanceRequestsAreSignedOverTheirParametersInNameOrder) {
+    BinanceOrderMessages messages(kKey, kSecret, 5000);
+    const int64_t ts = 1700000000000;
+
+    std::string limit;
+    messages.place(1, order("BTCUSDT", OrderRequest::Side::BUY, OrderRequest::Type::LIMIT,
+                            42000.5, 0.0015, "c1"),
+                   ts, limit);
+    EXPECT_EQ(limit,
+              binanceFrame(1, "order.place",
+                           "\"apiKey\":\"binance-key\",\"newClientOrderId\":\"c1\","
+                           "\"newOrderRespType\":\"ACK\",\"price\":\"42000.5\","
+                           "\"quantity\":\"0.0015\",\"recvWindow\":5000,\"side\":\"BUY\","
+                           "\"symbol\":\"BTCUSDT\",\"timeInForce\":\"GTC\","
+                           "\"timestamp\":1700000000000,\"type\":\"LIMIT\"",
+                           "apiKey=binance-key&newClientOrderId=c1&newOrderRespType=ACK"
+                           "&price=42000.5&quantity=0.0015&recvWindow=5000&side=BUY"
+                           "&symbol=BTCUSDT&timeInForce=GTC&timestamp=1700000000000&type=LIMIT"));
+
+    // Without a client order id the venue assigns one
+    std::string market;
+    messages.place(2, order("BTCUSDT", OrderRequest::Side::SELL, OrderRequest::Type::MARKET, 0,
+                            3, ""),
+                   ts, market);
+    EXPECT_EQ(market,
+              binanceFrame(2, "order.place",
+                           "\"apiKey\":\"binance-key\",\"newOrderRespType\":\"ACK\","
+                           "\"quantity\":\"3\",\"recvWindow\":5000,\"side\":\"SELL\","
+                           "\"symbol\":\"BTCUSDT\",\"timestamp\":1700000000000,"
+                           "\"type\":\"MARKET\"",
+                           "apiKey=binance-key&newOrderRespType=ACK&quantity=3"
+                           "&recvWindow=5000&side=SELL&symbol=BTCUSDT&timestamp=1700000000000"
+                           "&type=MARKET"));
+
+    // Numeric ids are the venue's, sent as numbers; anything else is a client order id
+    std::string byId;
+    messages.cancel(3, "BTCUSDT", "28", ts, byId);
+    EXPECT_EQ(byId, binanceFrame(3, "order.cancel",
+                                 "\"apiKey\":\"binance-key\",\"orderId\":28,"
+                                 "\"recvWindow\":5000,\"symbol\":\"BTCUSDT\","
+                                 "\"timestamp\":1700000000000",
+                                 "apiKey=binance-key&orderId=28&recvWindow=5000"
+                                 "&symbol=BTCUSDT&timestamp=1700000000000"));
+    std::string byClientId;
+    messages.cancel(4, "BTCUSDT", "c1", ts, byClientId);
+    EXPECT_EQ(byClientId, binanceFrame(4, "order.cancel",
+                                       "\"apiKey\":\"binance-key\",\"origClientOrderId\":\"c1\","
+                                       "\"recvWindow\":5000,\"symbol\":\"BTCUSDT\","
+                                       "\"timestamp\":1700000000000",
+                                       "apiKey=binance-key&origClientOrderId=c1&recvWindow=5000"
+                                       "&symbol=BTCUSDT&timestamp=1700000000000"));
+
+    std::string replace;
+    messages.cancelReplace(5, "28", order("ETHUSDT", OrderRequest::Side::SELL,
+                                          OrderRequest::Type::LIMIT, 2500, 1.25, "c2"),
+                           ts, replace);
+    json request = json::parse(replace);
+    EXPECT_EQ(request["method"], "order.cancelReplace");
+    EXPECT_EQ(request["params"]["cancelOrderId"], 28);
+    EXPECT_EQ(request["params"]["cancelReplaceMode"], "STOP_ON_FAILURE");
+    EXPECT_EQ(request["params"]["symbol"], "ETHUSDT");
+    EXPECT_EQ(request["params"]["side"], "SELL");
+    EXPECT_EQ(request["params"]["price"], "2500");
+    EXPECT_EQ(request["params"]["newClientOrderId"], "c2");
+}
+
+TEST(OrderTemplateTest, KrakenRequestsCarryTheToken) {
+    KrakenOrderMessages messages;
+
+    std::string limit;
+    messages.place(1, order("XBT/USD", OrderRequest::Side::BUY, OrderRequest::Type::LIMIT,
+                            42000.5, 0.0015, ""),
+                   "ws-token", limit);
+    EXPECT_EQ(limit, R"({"event":"addOrder","token":"ws-token","reqid":1,"ordertype":"limit",)"
+                     R"("type":"buy","pair":"XBT/USD","volume":"0.0015","price":"42000.5"})");
+
+    std::string market;
+    messages.place(2, order("XBT/USD", OrderRequest::Side::SELL, OrderRequest::Type::MARKET, 0,
+                            2, ""),
+                   "ws-token", market);
+    EXPECT_EQ(market, R"({"event":"addOrder","token":"ws-token","reqid":2,"ordertype":"market",)"
+                      R"("type":"sell","pair":"XBT/USD","volume":"2"})");
+
+    std::string cancel;
+    messages.cancel(3, "OABC-123", "ws-token", cancel);
+    EXPECT_EQ(cancel,
+              R"({"event":"cancelOrder","token":"ws-token","reqid":3,"txid":["OABC-123"]})");
+
+    std::string edit;
+    messages.edit(4, "OABC-123", order("XBT/USD", OrderRequest::Side::BUY,
+                                       OrderRequest::Type::LIMIT, 41000, 0.5, ""),
+                  "ws-token", edit);
+    EXPECT_EQ(edit, R"({"event":"editOrder","token":"ws-token","reqid":4,"orderid":"OABC-123",)"
+                    R"("pair":"XBT/USD","price":"41000","volume":"0.5"})");
+}
+
+TEST(OrderTemplateTest, TemplatesAreBuiltOnceAndSharedAcrossThreads) {
+    BinanceOrderMessages messages(kKey, kSecret, 5000);
+    std::vector<std::string> symbols = {"BTCUSDT", "ETHUSDT", "SOLUSDT", "BNBUSDT"};
+    std::vector<std::string> last(symbols.size());
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < symbols.size(); ++t) {
+        threads.emplace_back([&, t] {
+            std::string buffer;
+            for (int i = 0; i < 500; ++i) {
+                // Every thread trades every symbol, so their templates are built concurrently
+                const std::string& symbol = symbols[(t + i) % symbols.size()];
+                buffer.clear();
+                messages.place(i, order(symbol, OrderRequest::Side::BUY,
+                                        OrderRequest::Type::LIMIT, 100, 1, "c"),
+                               1700000000000, buffer);
+            }
+            last[t] = buffer;
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (const auto& frame : last) {
+        json request = json::parse(frame);
+        EXPECT_EQ(request["id"], 499);
+        EXPECT_EQ(request["params"]["signature"].get<std::string>().size(), 64u);
+    }
+}
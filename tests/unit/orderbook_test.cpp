@@ -237,4 +237,35 @@ TEST_F(OrderBookTest, ThreadSafetyWithRandomDeltas) {
     double final_bid = orderBook->getBestBid();
     double final_ask = orderBook->getBestAsk();
     EXPECT_GE(final_ask, final_bid);
-} 
\ No newline at end of file
+} 
+
+TEST_F(OrderBookTest, TopOfBookQuoteLeadsUntilDepthCatchesUp) {
+    orderBook->setSnapshot(toMap({{100.0, 1.0}, {99.0, 2.0}}), toMap({{101.0, 1.0}}));
+    orderBook->setUpdateId(10);
+
+    // Quotes the levels already reflect are ignored
+    EXPECT_FALSE(orderBook->applyTopOfBook(100.5, 1.0, 101.0, 1.0, 10));
+    EXPECT_EQ(orderBook->getBestBid(), 100.0);
+
+    EXPECT_TRUE(orderBook->applyTopOfBook(100.5, 3.0, 100.8, 4.0, 12));
+    EXPECT_FALSE(orderBook->applyTopOfBook(100.4, 3.0, 100.8, 4.0, 11));  // Out of order
+    EXPECT_EQ(orderBook->getBestBid(), 100.5);
+    EXPECT_EQ(orderBook->getBestAsk(), 100.8);
+    auto top = orderBook->getTop();
+    EXPECT_TRUE(top.fromQuote);
+    EXPECT_EQ(top.bidSize, 3.0);
+
+    // A depth update short of the quote leaves it in front
+    orderBook->updateBid(100.2, 1.0);
+    orderBook->setUpdateId(11);
+    EXPECT_EQ(orderBook->getBestBid(), 100.5);
+
+    // Once depth reaches the quote's update id the levels are authoritative again
+    orderBook->updateBid(100.5, 3.0);
+    orderBook->setUpdateId(12);
+    top = orderBook->getTop();
+    EXPECT_FALSE(top.fromQuote);
+    EXPECT_EQ(top.bidPrice, 100.5);
+    EXPECT_EQ(top.bidSize, 3.0);
+    EXPECT_EQ(top.askPrice, 101.0);
+}
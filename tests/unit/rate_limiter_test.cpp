@@ -0,0 +1,116 @@
+#include "../../src/exchanges/RateLimiter.hpp"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace crypto_hft;
+using namespace std::chrono_literals;
+using Clock = RateLimiter::Clock;
+
+namespace {
+
+const Clock::time_point kStart = Clock::time_point() + 1h;
+
+} // namespace
+
+TEST(RateLimiterTest, BurstThenSteadyRate) {
+    RateLimiter limiter(100.0, 5.0);  // 10 ms per unit, 5 units at once
+    ASSERT_TRUE(limiter.limited());
+
+    EXPECT_EQ(limiter.tryAcquire(3.0, kStart), Clock::duration::zero());
+    EXPECT_EQ(limiter.tryAcquire(2.0, kStart), Clock::duration::zero());
+    EXPECT_EQ(limiter.tryAcquire(1.0, kStart), 10ms);
+    EXPECT_EQ(limiter.timeUntilAvailable(4.0, kStart), 40ms);
+
+    EXPECT_EQ(limiter.tryAcquire(1.0, kStart + 10ms), Clock::duration::zero());
+    // Refills continuously and never beyond the burst
+    EXPECT_EQ(limiter.timeUntilAvailable(5.0, kStart + 1h), Clock::duration::zero());
+    EXPECT_EQ(limiter.tryAcquire(6.0, kStart + 1h), Clock::duration::zero());
+    EXPECT_EQ(limiter.timeUntilAvailable(1.0, kStart + 1h), 10ms);
+}
+
+TEST(RateLimiterTest, HeavierThanTheLimitPassesOnceFull) {
+    RateLimiter limiter({{10.0, 1s}});
+    EXPECT_EQ(limiter.tryAcquire(50.0, kStart), Clock::duration::zero());
+    EXPECT_EQ(limiter.timeUntilAvailable(50.0, kStart), 1s);
+    EXPECT_EQ(limiter.tryAcquire(50.0, kStart + 1s), Clock::duration::zero());
+}
+
+TEST(RateLimiterTest, EveryWindowMustHaveRoom) {
+    // Binance-style: 10 per second, but only 20 per minute
+    RateLimiter limiter({{10.0, 1s}, {20.0, 1min}});
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_EQ(limiter.tryAcquire(1.0, kStart), Clock::duration::zero());
+    }
+    EXPECT_EQ(limiter.tryAcquire(1.0, kStart), 100ms);
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_EQ(limiter.tryAcquire(1.0, kStart + 1s), Clock::duration::zero());
+    }
+    // The second window is empty now and refills one unit every 3 s
+    EXPECT_EQ(limiter.timeUntilAvailable(1.0, kStart + 2s), 1s);
+    EXPECT_EQ(limiter.tryAcquire(1.0, kStart + 2s), 1s);
+    EXPECT_EQ(limiter.tryAcquire(1.0, kStart + 3s), Clock::duration::zero());
+    EXPECT_EQ(limiter.tryAcquire(1.0, kStart + 3s), 3s);
+}
+
+TEST(RateLimiterTest, RefusedRequestsSpendNothing) {
+    RateLimiter limiter({{2.0, 10s}, {1.0, 1s}});
+    EXPECT_EQ(limiter.tryAcquire(1.0, kStart), Clock::duration::zero());
+    // Fits the first window but not the second, so the first gets its share back
+    EXPECT_EQ(limiter.tryAcquire(1.0, kStart), 1s);
+    EXPECT_EQ(limiter.tryAcquire(1.0, kStart + 1s), Clock::duration::zero());
+}
+
+TEST(RateLimiterTest, PauseHoldsEverythingBack) {
+    RateLimiter unlimited;
+    EXPECT_FALSE(unlimited.limited());
+    EXPECT_EQ(unlimited.tryAcquire(1000.0, kStart), Clock::duration::zero());
+
+    unlimited.pauseUntil(kStart + 2s);
+    unlimited.pauseUntil(kStart + 1s);  // An earlier pause does not shorten it
+    EXPECT_EQ(unlimited.tryAcquire(1.0, kStart), 2s);
+    EXPECT_EQ(unlimited.tryAcquire(1.0, kStart + 2s), Clock::duration::zero());
+}
+
+TEST(RateLimiterTest, ConcurrentSendersNeverOverspend) {
+    RateLimiter limiter({{1000.0, 1h}, {2000.0, 24h}});
+    std::atomic<int> granted{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 1000; ++i) {
+                if (limiter.tryAcquire(1.0, kStart) == Clock::duration::zero()) {
+                    granted.fetch_add(1);
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(granted.load(), 1000);
+    EXPECT_GT(limiter.timeUntilAvailable(1.0, kStart), Clock::duration::zero());
+}
+
+TEST(RateLimiterTest, WindowsFromConfig) {
+    auto node = YAML::Load("{requests_per_second: 10, max_orders_per_second: 5, "
+                           "max_orders_per_day: 100}");
+    auto requests = RateLimiter::fromYaml(node, "requests");
+    auto orders = RateLimiter::fromYaml(node, "max_orders");
+    EXPECT_TRUE(requests->limited());
+    EXPECT_FALSE(RateLimiter::fromYaml(YAML::Node(), "requests")->limited());
+
+    for (int i = 0; i < 5; ++i) {
+        ASSERT_EQ(orders->tryAcquire(1.0, kStart), Clock::duration::zero());
+    }
+    EXPECT_EQ(orders->tryAcquire(1.0, kStart), 200ms);
+    // The daily window caps the total well below five a second
+    for (int s = 1; s <= 19; ++s) {
+        for (int i = 0; i < 5; ++i) {
+            ASSERT_EQ(orders->tryAcquire(1.0, kStart + std::chrono::seconds(s)),
+                      Clock::duration::zero());
+        }
+    }
+    EXPECT_GT(orders->timeUntilAvailable(1.0, kStart + 30s), 10min);
+}
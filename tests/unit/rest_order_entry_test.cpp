@@ -0,0 +1,268 @@
+#include "../../src/exchanges/RestOrderEntry.hpp"
+#include "LocalHttpsServer.hpp"
+#include "TestSupport.hpp"
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <openssl/sha.h>
+#include <algorithm>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+using namespace crypto_hft;
+namespace net = boost::asio;
+namespace http = boost::beast::http;
+using json = nlohmann::json;
+
+namespace {
+
+// Kraken's API-Sign, computed the way its documentation spells it out
+std::string krakenSign(const std::string& secret, const std::string& path,
+                       const std::string& nonce, const std::string& body) {
+    unsigned char hash[SHA256_DIGEST_LENGTH];
+    std::string noncedBody = nonce + body;
+    SHA256(reinterpret_cast<const unsigned char*>(noncedBody.data()), noncedBody.size(), hash);
+    std::string message = path + std::string(reinterpret_cast<const char*>(hash), sizeof(hash));
+
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    unsigned int length = 0;
+    HMAC(EVP_sha512(), secret.data(), static_cast<int>(secret.size()),
+         reinterpret_cast<const unsigned char*>(message.data()), message.size(), digest, &length);
+    std::string encoded(4 * ((length + 2) / 3), '\0');
+    EVP_EncodeBlock(reinterpret_cast<unsigned char*>(encoded.data()), digest,
+                    static_cast<int>(length));
+    return encoded;
+}
+
+// The value of key in a form or query string
+std::string param(const std::string& form, const std::string& key) {
+    std::size_t start = 0;
+    while (start < form.size()) {
+        std::size_t end = form.find('&', start);
+        end = end == std::string::npos ? form.size() : end;
+        std::string pair = form.substr(start, end - start);
+        if (pair.compare(0, key.size() + 1, key + "=") == 0) {
+            return pair.substr(key.size() + 1);
+        }
+        start = end + 1;
+    }
+    return {};
+}
+
+class RestOrderEntryTest : public IoContextTest {
+protected:
+    void TearDown() override {
+        if (client_) {
+            client_->shutdown();
+        }
+        IoContextTest::TearDown();
+    }
+
+    std::shared_ptr<HttpsClient> makeClient(const LocalHttpsServer& server,
+                                            std::size_t connections = 2) {
+        HttpsClient::Options options;
+        options.host = "localhost";
+        options.port = server.port();
+        options.connections = connections;
+        options.pipelineDepth = 8;
+        options.timeout = std::chrono::seconds(2);
+        options.verifyPeer = false;
+        client_ = HttpsClient::create(ioc_, options, nullptr);
+        return client_;
+    }
+
+    std::shared_ptr<HttpsClient> client_;
+};
+
+} // namespace
+
+TEST_F(RestOrderEntryTest, BinanceSignsEveryRequestAndParsesAcks) {
+    const std::string secret = "binance-secret";
+    std::vector<std::string> problems;
+    LocalHttpsServer server([&](const LocalHttpsServer::Request& request) {
+        std::string target(request.target());
+        std::string payload = request.method() == http::verb::delete_
+                                  ? target.substr(target.find('?') + 1)
+                                  : request.body();
+        std::string signedPart = payload.substr(0, payload.rfind("&signature="));
+        if (request["X-MBX-APIKEY"] != "binance-key" ||
+            param(payload, "signature") != hmacHex(EVP_sha256(), secret, signedPart)) {
+            problems.push_back(target);
+            return LocalHttpsServer::reply(request, 401, R"({"code":-1022,"msg":"bad"})");
+        }
+        if (param(payload, "quantity") == "9") {
+            return LocalHttpsServer::reply(request, 400,
+                R"({"code":-2010,"msg":"Account has insufficient balance."})");
+        }
+        if (request.method() == http::verb::delete_) {
+            return LocalHttpsServer::reply(request, 200,
+                R"({"symbol":"BTCUSDT","orderId":)" + param(payload, "orderId") +
+                R"(,"origClientOrderId":"c1","status":"CANCELED"})");
+        }
+        if (target == "/api/v3/order/cancelReplace") {
+            return LocalHttpsServer::reply(request, 200,
+                R"({"cancelResult":"SUCCESS","newOrderResult":"SUCCESS",)"
+                R"("newOrderResponse":{"orderId":29,"clientOrderId":"c2"}})");
+        }
+        EXPECT_EQ(param(payload, "price"), "42000.5");
+        EXPECT_EQ(param(payload, "quantity"), "0.0015");
+        return LocalHttpsServer::reply(request, 200,
+            R"({"symbol":"BTCUSDT","orderId":28,"clientOrderId":")" +
+            param(payload, "newClientOrderId") + R"(","transactTime":1})");
+    });
+    BinanceRestOrderEntry entry(makeClient(server), {"binance-key", secret});
+
+    auto ack = entry.submit(limitBuy("BTCUSDT", "c1")).get();
+    ASSERT_TRUE(ack.ok()) << ack.message;
+    EXPECT_EQ(ack.status, 200u);
+    EXPECT_EQ(ack.orderId, "28");
+    EXPECT_EQ(ack.clientOrderId, "c1");
+    EXPECT_GT(ack.latency.count(), 0);
+
+    auto cancel = entry.cancel("BTCUSDT", "28").get();
+    ASSERT_TRUE(cancel.ok()) << cancel.message;
+    EXPECT_EQ(cancel.orderId, "28");
+
+    auto modified = entry.modify("28", limitBuy("BTCUSDT", "c2")).get();
+    ASSERT_TRUE(modified.ok()) << modified.message;
+    EXPECT_EQ(modified.orderId, "29");
+
+    auto large = limitBuy("BTCUSDT", "c3");
+    large.size = 9;
+    auto rejected = entry.submit(large).get();
+    EXPECT_FALSE(rejected.ok());
+    EXPECT_FALSE(rejected.error);
+    EXPECT_EQ(rejected.status, 400u);
+    EXPECT_EQ(rejected.message, "Account has insufficient balance.");
+    EXPECT_TRUE(problems.empty());
+}
+
+TEST_F(RestOrderEntryTest, KrakenSignsWithIncreasingNonces) {
+    const std::string secret = "kraken-secret-bytes";
+    unsigned char encoded[64];
+    int length = EVP_EncodeBlock(encoded, reinterpret_cast<const unsigned char*>(secret.data()),
+                                 static_cast<int>(secret.size()));
+    std::string base64Secret(reinterpret_cast<const char*>(encoded), length);
+
+    std::mutex mutex;
+    std::vector<uint64_t> nonces;
+    LocalHttpsServer server([&](const LocalHttpsServer::Request& request) {
+        std::string path(request.target());
+        std::string nonce = param(request.body(), "nonce");
+        if (request["API-Key"] != "kraken-key" ||
+            request["API-Sign"] != krakenSign(secret, path, nonce, request.body())) {
+            return LocalHttpsServer::reply(request, 200, R"({"error":["EAPI:Invalid key"]})");
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            nonces.push_back(std::stoull(nonce));
+        }
+        if (path == "/0/private/CancelOrder") {
+            return LocalHttpsServer::reply(request, 200, R"({"error":[],"result":{"count":1}})");
+        }
+        if (param(request.body(), "volume") == "9") {
+            return LocalHttpsServer::reply(request, 200,
+                                           R"({"error":["EOrder:Insufficient funds"]})");
+        }
+        return LocalHttpsServer::reply(request, 200,
+            R"({"error":[],"result":{"descr":{"order":"buy"},"txid":["OUF4EM-FRGI2-MQMWZD"]}})");
+    });
+    KrakenRestOrderEntry entry(makeClient(server), {"kraken-key", base64Secret});
+
+    std::vector<std::future<OrderAck>> acks;
+    for (int i = 0; i < 5; ++i) {
+        acks.push_back(entry.submit(limitBuy("XBTUSD", "k" + std::to_string(i))));
+    }
+    for (auto& future : acks) {
+        auto ack = future.get();
+        ASSERT_TRUE(ack.ok()) << ack.message;
+        EXPECT_EQ(ack.orderId, "OUF4EM-FRGI2-MQMWZD");
+    }
+    EXPECT_TRUE(entry.cancel("XBTUSD", "OUF4EM-FRGI2-MQMWZD").get().ok());
+
+    auto large = limitBuy("XBTUSD", "k9");
+    large.size = 9;
+    auto rejected = entry.submit(large).get();
+    EXPECT_FALSE(rejected.ok());
+    EXPECT_EQ(rejected.status, 200u);
+    EXPECT_EQ(rejected.message, "EOrder:Insufficient funds");
+
+    std::lock_guard<std::mutex> lock(mutex);
+    ASSERT_EQ(nonces.size(), 7u);
+    std::sort(nonces.begin(), nonces.end());
+    EXPECT_EQ(std::adjacent_find(nonces.begin(), nonces.end()), nonces.end());
+}
+
+TEST_F(RestOrderEntryTest, CoinbaseSendsATokenPerRequest) {
+    LocalHttpsServer server([&](const LocalHttpsServer::Request& request) {
+        std::string path(request.target());
+        EXPECT_EQ(request[http::field::authorization], "Bearer token:POST " + path);
+        json body = json::parse(request.body());
+        if (path == "/api/v3/brokerage/orders/batch_cancel") {
+            return LocalHttpsServer::reply(request, 200,
+                R"({"results":[{"success":true,"failure_reason":"UNKNOWN_CANCEL_FAILURE_REASON",)"
+                R"("order_id":")" + body["order_ids"][0].get<std::string>() + R"("}]})");
+        }
+        EXPECT_EQ(body["order_configuration"]["limit_limit_gtc"]["limit_price"], "42000.5");
+        EXPECT_EQ(body["order_configuration"]["limit_limit_gtc"]["base_size"], "0.0015");
+        if (body["client_order_id"] == "dup") {
+            return LocalHttpsServer::reply(request, 200,
+                R"({"success":false,"error_response":{"error":"INVALID_CLIENT_ORDER_ID",)"
+                R"("message":"duplicate client order id"}})");
+        }
+        return LocalHttpsServer::reply(request, 200,
+            R"({"success":true,"success_response":{"order_id":"11111-00000",)"
+            R"("product_id":"BTC-USD","client_order_id":")" +
+            body["client_order_id"].get<std::string>() + R"("}})");
+    });
+    CoinbaseRestOrderEntry entry(makeClient(server), [](std::string_view method,
+                                                         std::string_view path) {
+        return "token:" + std::string(method) + " " + std::string(path);
+    });
+
+    auto ack = entry.submit(limitBuy("BTC-USD", "cb-1")).get();
+    ASSERT_TRUE(ack.ok()) << ack.message;
+    EXPECT_EQ(ack.orderId, "11111-00000");
+    EXPECT_EQ(ack.clientOrderId, "cb-1");
+
+    auto cancel = entry.cancel("BTC-USD", "11111-00000").get();
+    ASSERT_TRUE(cancel.ok()) << cancel.message;
+    EXPECT_EQ(cancel.orderId, "11111-00000");
+
+    auto duplicate = entry.submit(limitBuy("BTC-USD", "dup")).get();
+    EXPECT_FALSE(duplicate.ok());
+    EXPECT_EQ(duplicate.message, "duplicate client order id");
+}
+
+TEST_F(RestOrderEntryTest, PipelinesOrdersOverWarmConnections) {
+    LocalHttpsServer server([](const LocalHttpsServer::Request& request) {
+        return LocalHttpsServer::reply(request, 200,
+            R"({"orderId":1,"clientOrderId":")" + param(request.body(), "newClientOrderId") +
+            R"("})");
+    });
+    HttpsClient::Options options;
+    options.host = "localhost";
+    options.port = server.port();
+    options.connections = 2;
+    options.warmConnections = 2;
+    options.pipelineDepth = 8;
+    options.verifyPeer = false;
+    client_ = HttpsClient::create(ioc_, options, nullptr);
+    client_->warmUp();
+    BinanceRestOrderEntry entry(client_, {"key", "secret"});
+
+    std::vector<std::future<OrderAck>> acks;
+    for (int i = 0; i < 32; ++i) {
+        acks.push_back(entry.submit(limitBuy("BTCUSDT", "p" + std::to_string(i))));
+    }
+    for (int i = 0; i < 32; ++i) {
+        auto ack = acks[i].get();
+        ASSERT_TRUE(ack.ok()) << ack.message;
+        EXPECT_EQ(ack.clientOrderId, "p" + std::to_string(i));
+    }
+    EXPECT_EQ(server.requests(), 32u);
+    EXPECT_EQ(server.connections(), 2u);
+}
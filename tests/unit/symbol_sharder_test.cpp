@@ -0,0 +1,97 @@
+#include "../../src/exchanges/SymbolSharder.hpp"
+#include "../../src/exchanges/BinanceAdapter.hpp"
+#include <gtest/gtest.h>
+
+using namespace crypto_hft;
+
+namespace {
+
+SymbolSharder::Config shards(std::size_t connections) {
+    SymbolSharder::Config config;
+    config.connections = connections;
+    return config;
+}
+
+} // namespace
+
+TEST(SymbolSharderTest, ConfigFromYaml) {
+    YAML::Node node = YAML::Load(
+        "connections: 4\n"
+        "rebalance_interval_s: 30\n"
+        "tolerance: 0.5\n"
+        "expected_rates: {BTCUSDT: 40, ETHUSDT: 25}\n");
+    auto config = SymbolSharder::Config::fromYaml(node);
+    EXPECT_EQ(config.connections, 4u);
+    EXPECT_EQ(config.rebalanceInterval, std::chrono::seconds(30));
+    EXPECT_DOUBLE_EQ(config.tolerance, 0.5);
+    EXPECT_DOUBLE_EQ(config.defaultRate, 1.0);
+    EXPECT_DOUBLE_EQ(config.expectedRates.at("BTCUSDT"), 40.0);
+
+    auto defaults = SymbolSharder::Config::fromYaml(YAML::Node());
+    EXPECT_EQ(defaults.connections, 1u);
+    EXPECT_EQ(defaults.rebalanceInterval.count(), 0);
+}
+
+TEST(SymbolSharderTest, AssignsHeaviestSymbolsFirst) {
+    auto config = shards(2);
+    config.expectedRates = {{"BTCUSDT", 10.0}, {"ETHUSDT", 6.0}, {"SOLUSDT", 4.0}};
+    SymbolSharder sharder(config);
+
+    auto assigned = sharder.assign({"SOLUSDT", "ETHUSDT", "BTCUSDT", "XRPUSDT"});
+    // ETH and SOL together balance BTC; the default-rate XRP breaks the tie onto shard 0
+    EXPECT_EQ(assigned, (std::vector<std::size_t>{1, 1, 0, 0}));
+    EXPECT_DOUBLE_EQ(sharder.load(0), 11.0);
+    EXPECT_DOUBLE_EQ(sharder.load(1), 10.0);
+    EXPECT_EQ(sharder.symbolsOn(1), (std::vector<std::string>{"ETHUSDT", "SOLUSDT"}));
+
+    // Already assigned symbols keep their shard
+    EXPECT_EQ(sharder.assign({"ETHUSDT"}), (std::vector<std::size_t>{1}));
+    sharder.remove({"ETHUSDT"});
+    EXPECT_FALSE(sharder.shardOf("ETHUSDT"));
+    EXPECT_DOUBLE_EQ(sharder.load(1), 4.0);
+}
+
+TEST(SymbolSharderTest, RebalancesOnObservedRates) {
+    SymbolSharder sharder(shards(2));
+    sharder.assign({"A", "B", "C", "D"});
+    ASSERT_EQ(sharder.symbolsOn(0), (std::vector<std::string>{"A", "C"}));
+
+    // Both hot symbols ended up on shard 0
+    std::unordered_map<std::string, uint64_t> counts = {{"A", 1000}, {"C", 800}, {"D", 100}};
+    sharder.observe(counts, std::chrono::seconds(10));
+    EXPECT_NEAR(sharder.rate("A"), 0.3 * 100 + 0.7 * 1.0, 1e-9);
+    EXPECT_NEAR(sharder.rate("B"), 0.7, 1e-9);
+
+    auto moves = sharder.rebalance();
+    ASSERT_EQ(moves.size(), 1u);
+    EXPECT_EQ(moves[0].symbol, "C");
+    EXPECT_EQ(moves[0].from, 0u);
+    EXPECT_EQ(moves[0].to, 1u);
+    EXPECT_EQ(sharder.shardOf("C"), 1u);
+
+    // Balanced within tolerance: nothing more to do
+    EXPECT_TRUE(sharder.rebalance().empty());
+}
+
+TEST(SymbolSharderTest, LeavesASingleHotSymbolAlone) {
+    SymbolSharder sharder(shards(2));
+    sharder.assign({"A", "B"});
+    sharder.observe({{"A", 5000}, {"B", 10}}, std::chrono::seconds(1));
+    EXPECT_TRUE(sharder.rebalance().empty());
+    EXPECT_EQ(sharder.shardOf("A"), 0u);
+}
+
+TEST(SymbolSharderTest, BinanceAdapterKeepsAssignmentsAcrossReconfiguration) {
+    BinanceAdapter adapter;
+    adapter.subscribe({"btcusdt", "ETHUSDT", "SOLUSDT"});
+    EXPECT_EQ(adapter.getShardOf("BTCUSDT"), 0u);
+    EXPECT_EQ(adapter.getShardOf("ethusdt"), 0u);
+
+    adapter.setSharding(shards(3));
+    EXPECT_EQ(adapter.getShardOf("BTCUSDT"), 0u);
+    EXPECT_EQ(adapter.getShardOf("ETHUSDT"), 1u);
+    EXPECT_EQ(adapter.getShardOf("SOLUSDT"), 2u);
+
+    adapter.unsubscribe({"ETHUSDT"});
+    EXPECT_FALSE(adapter.getShardOf("ETHUSDT"));
+}
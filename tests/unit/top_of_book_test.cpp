@@ -0,0 +1,68 @@
+#include "../../src/exchanges/BinanceAdapter.hpp"
+#include "../../src/exchanges/TopOfBookTracker.hpp"
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+using namespace crypto_hft;
+
+namespace {
+
+std::string bookTicker(uint64_t updateId, const char* bid) {
+    return R"({"u":)" + std::to_string(updateId) + R"(,"s":"BTCUSDT","b":")" + bid +
+           R"(","B":"1.5","a":"100.9","A":"2.5"})";
+}
+
+std::string depthUpdate(uint64_t first, uint64_t last) {
+    return R"({"stream":"btcusdt@depth@100ms","data":{"e":"depthUpdate","E":1,"s":"BTCUSDT",)"
+           R"("U":)" + std::to_string(first) + R"(,"u":)" + std::to_string(last) +
+           R"(,"b":[["100.5","1"]],"a":[]}})";
+}
+
+} // namespace
+
+TEST(TopOfBookTrackerTest, ResolvesQuotesAsDepthCatchesUp) {
+    TopOfBookTracker tracker;
+    EXPECT_TRUE(tracker.onQuote(5, 1000));
+    EXPECT_TRUE(tracker.onQuote(8, 1500));
+    EXPECT_TRUE(tracker.onQuote(12, 1700));
+
+    std::vector<int64_t> leads;
+    tracker.onDepth(8, 2000, [&](int64_t leadNs) { leads.push_back(leadNs); });
+    EXPECT_EQ(leads, (std::vector<int64_t>{1000, 500}));
+    EXPECT_EQ(tracker.pending(), 1u);
+    EXPECT_EQ(tracker.depthUpdateId(), 8u);
+
+    // The depth stream is already past this quote
+    EXPECT_FALSE(tracker.onQuote(7, 2100));
+
+    for (uint64_t id = 13; id < 13 + TopOfBookTracker::kCapacity; ++id) {
+        tracker.onQuote(id, 3000);
+    }
+    EXPECT_EQ(tracker.pending(), TopOfBookTracker::kCapacity);
+    EXPECT_EQ(tracker.overflowed(), 1u);
+}
+
+TEST(TopOfBookTrackerTest, BinanceAdapterRoutesQuotesAheadOfDepth) {
+    BinanceAdapter adapter;
+    std::vector<std::string> events;
+    adapter.registerTopOfBookCallback([&](const TopOfBookUpdate& quote) {
+        events.push_back("quote " + std::to_string(quote.sequence));
+    });
+    adapter.registerOrderBookDeltaCallback([&](const OrderBookDelta& delta) {
+        events.push_back("depth " + std::to_string(delta.sequence));
+    });
+
+    adapter.handle_frame(bookTicker(101, "100.5"));
+    adapter.handle_frame(bookTicker(104, "100.6"));
+    adapter.handle_frame(depthUpdate(100, 104));
+    adapter.handle_frame(bookTicker(103, "100.4"));  // Depth already covers it
+    EXPECT_EQ(events, (std::vector<std::string>{"quote 101", "quote 104", "depth 104"}));
+
+    auto stats = adapter.getTopOfBookStats();
+    EXPECT_EQ(stats.quotes, 2u);
+    EXPECT_EQ(stats.staleQuotes, 1u);
+    EXPECT_EQ(stats.leadSamples, 2u);
+    EXPECT_GT(stats.maxLeadNs, 0);
+    EXPECT_GE(stats.maxLeadNs, stats.meanLeadNs);
+}
@@ -0,0 +1,250 @@
+#include "../../src/exchanges/WsConnection.hpp"
+#include "LocalWsServer.hpp"
+#include "TestSupport.hpp"
+#include <gtest/gtest.h>
+#include <boost/asio/post.hpp>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+using namespace crypto_hft;
+namespace beast = boost::beast;
+namespace websocket = beast::websocket;
+namespace net = boost::asio;
+namespace ssl = boost::asio::ssl;
+using tcp = net::ip::tcp;
+
+namespace {
+
+class WsConnectionTest : public IoContextTest {
+protected:
+    void SetUp() override {
+        clientCtx_.set_verify_mode(ssl::verify_none);
+        IoContextTest::SetUp();
+    }
+
+    std::shared_ptr<WsConnection> makeConnection(
+        const std::string& port, bool standby, bool deflate = false,
+        std::chrono::milliseconds pingInterval = std::chrono::milliseconds(0),
+        std::chrono::milliseconds maxRoundTrip = std::chrono::milliseconds(0)) {
+        WsConnection::Options options;
+        options.host = "localhost";
+        options.port = port;
+        options.standby = standby;
+        options.backoffInitial = std::chrono::milliseconds(10);
+        options.backoffMax = std::chrono::milliseconds(50);
+        options.profile.quickAck = true;
+        options.profile.rxTimestamps = true;
+        options.profile.compression.enabled = deflate;
+        options.pingInterval = pingInterval;
+        options.maxRoundTrip = maxRoundTrip;
+
+        auto connection = WsConnection::create(ioc_, clientCtx_, options, nullptr);
+        connection->setFrameHandler([this](std::string_view frame) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            frames_.emplace_back(frame);
+        });
+        connection->setOpenHandler([](WsConnection& c) { c.send("subscribe"); });
+        return connection;
+    }
+
+    std::vector<std::string> frames() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return frames_;
+    }
+
+    ssl::context clientCtx_{ssl::context::tls_client};
+    std::mutex mutex_;
+    std::vector<std::string> frames_;
+};
+
+} // namespace
+
+TEST_F(WsConnectionTest, ReconnectsAndReplaysSessionState) {
+    LocalWsServer server;
+    auto connection = makeConnection(server.port(), false);
+    connection->start();
+    ASSERT_TRUE(connection->waitForOpen(std::chrono::seconds(5)));
+    ASSERT_TRUE(eventually([&] { return server.received().size() == 1; }));
+
+    server.sendToAll("hello");
+    ASSERT_TRUE(eventually([&] { return frames().size() == 1; }));
+    EXPECT_EQ(frames()[0], "hello");
+
+    server.drop(false);
+    ASSERT_TRUE(eventually([&] { return connection->getStats().opens == 2; }));
+    EXPECT_TRUE(connection->isOpen());
+
+    // The open handler replayed its subscription onto the new session
+    ASSERT_TRUE(eventually([&] { return server.received().size() == 2; }));
+    EXPECT_EQ(server.received()[1], "subscribe");
+
+    auto stats = connection->getStats();
+    EXPECT_EQ(stats.resolves, 1u);
+    EXPECT_GE(stats.failures, 1u);
+    EXPECT_GE(stats.resumedHandshakes, 1u);
+
+    // Receive timestamps may take a few packets to start (see connection_profile_test)
+    EXPECT_TRUE(eventually([&] {
+        server.sendToAll("tick");
+        return connection->getStats().rxSamples > 0;
+    }));
+    EXPECT_GT(connection->getStats().maxRxLatencyNs, 0);
+
+    connection->shutdown();
+    EXPECT_EQ(connection->state(), WsConnection::State::Closed);
+}
+
+TEST_F(WsConnectionTest, PromotesStandbyOnFailure) {
+    LocalWsServer server;
+    auto connection = makeConnection(server.port(), true);
+    connection->start();
+    ASSERT_TRUE(connection->waitForOpen(std::chrono::seconds(5)));
+    ASSERT_TRUE(eventually([&] { return server.accepted() == 2; }));
+    ASSERT_TRUE(eventually([&] { return server.received().size() == 1; }));
+
+    // Only the active session delivers frames
+    server.sendToAll("book");
+    ASSERT_TRUE(eventually([&] { return frames().size() == 1; }));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(frames().size(), 1u);
+
+    server.drop(true);
+    ASSERT_TRUE(eventually([&] { return connection->getStats().promotions == 1; }));
+    EXPECT_TRUE(connection->isOpen());
+    ASSERT_TRUE(eventually([&] { return server.received().size() == 2; }));
+
+    // A replacement standby is handshaken in the background
+    EXPECT_TRUE(eventually([&] { return server.accepted() == 3; }));
+    connection->shutdown();
+}
+
+TEST_F(WsConnectionTest, TimesPingsOnTheActiveSession) {
+    LocalWsServer server;
+    auto connection = makeConnection(server.port(), false, false, std::chrono::milliseconds(20));
+    std::atomic<int> roundTrips{0};
+    std::atomic<int64_t> lastRoundTripNs{0};
+    connection->setRoundTripHandler([&](int64_t roundTripNs) {
+        lastRoundTripNs = roundTripNs;
+        ++roundTrips;
+    });
+    connection->start();
+    ASSERT_TRUE(connection->waitForOpen(std::chrono::seconds(5)));
+
+    ASSERT_TRUE(eventually([&] { return roundTrips.load() >= 3; }));
+    EXPECT_GT(lastRoundTripNs.load(), 0);
+    EXPECT_LT(lastRoundTripNs.load(), int64_t{1000000000});
+    auto stats = connection->getStats();
+    EXPECT_GE(stats.pongs, 3u);
+    EXPECT_GE(stats.pings, stats.pongs);
+    EXPECT_GT(stats.minRoundTripNs, 0);
+    EXPECT_GE(stats.maxLoopLagNs, 0);
+    EXPECT_EQ(stats.slowFailovers, 0u);
+    connection->shutdown();
+}
+
+TEST_F(WsConnectionTest, CountsFramesOfTheActiveSession) {
+    LocalWsServer server;
+    auto connection = makeConnection(server.port(), true);
+    connection->start();
+    ASSERT_TRUE(connection->waitForOpen(std::chrono::seconds(5)));
+    ASSERT_TRUE(eventually([&] { return server.accepted() == 2; }));
+    EXPECT_EQ(connection->getStats().lastFrameAgeNs, -1);
+
+    // The standby receives both too, and is not counted
+    server.sendToAll("hello");
+    ASSERT_TRUE(eventually([&] { return frames().size() == 1; }));
+    server.sendToAll("world!");
+    ASSERT_TRUE(eventually([&] { return frames().size() == 2; }));
+    auto stats = connection->getStats();
+    EXPECT_EQ(stats.frames, 2u);
+    EXPECT_EQ(stats.bytes, 11u);
+    EXPECT_GE(stats.lastFrameAgeNs, 0);
+    EXPECT_LT(stats.lastFrameAgeNs, int64_t{5000000000});
+    connection->shutdown();
+}
+
+TEST_F(WsConnectionTest, FailsOverToStandbyOnSlowRoundTrips) {
+    // Stalling the server thread holds back the pongs of every session on it
+    LocalWsServer server([](const std::string& message) {
+        if (message == "stall") {
+            std::this_thread::sleep_for(std::chrono::milliseconds(800));
+        }
+        return std::vector<std::string>{};
+    });
+    auto connection = makeConnection(server.port(), true, false, std::chrono::milliseconds(20),
+                                     std::chrono::milliseconds(100));
+    std::atomic<int> lost{0};
+    connection->setLostHandler([&](WsConnection&) { ++lost; });
+    connection->start();
+    ASSERT_TRUE(connection->waitForOpen(std::chrono::seconds(5)));
+    ASSERT_TRUE(eventually([&] { return server.accepted() == 2; }));
+    ASSERT_TRUE(eventually([&] { return connection->getStats().pongs >= 1; }));
+
+    connection->send("stall");
+    ASSERT_TRUE(eventually([&] { return connection->getStats().slowFailovers >= 1; }));
+    auto stats = connection->getStats();
+    EXPECT_EQ(stats.promotions, stats.slowFailovers);
+    EXPECT_GE(lost.load(), 1);
+    EXPECT_TRUE(connection->isOpen());
+
+    // The promoted session delivers frames and answers pings again once the venue recovers
+    const uint64_t pongs = stats.pongs;
+    server.sendToAll("after");
+    ASSERT_TRUE(eventually([&] {
+        auto received = frames();
+        return std::find(received.begin(), received.end(), "after") != received.end();
+    }));
+    EXPECT_TRUE(eventually([&] { return connection->getStats().pongs > pongs; }));
+    connection->shutdown();
+}
+
+TEST_F(WsConnectionTest, NegotiatesPermessageDeflate) {
+    LocalWsServer server(true);
+    auto connection = makeConnection(server.port(), false, true);
+    connection->start();
+    ASSERT_TRUE(connection->waitForOpen(std::chrono::seconds(5)));
+    EXPECT_EQ(connection->getStats().compressedSessions, 1u);
+
+    // Large, repetitive frames are inflated transparently before the handler sees them
+    std::string book = "{\"bids\":[";
+    for (int i = 0; i < 500; ++i) {
+        book += "[\"100." + std::to_string(i) + "\",\"1.5\"],";
+    }
+    book += "[\"99.0\",\"1\"]]}";
+    server.sendToAll(book);
+    ASSERT_TRUE(eventually([&] { return frames().size() == 1; }));
+    EXPECT_EQ(frames()[0], book);
+    ASSERT_TRUE(eventually([&] { return server.received().size() == 1; }));
+    EXPECT_EQ(server.received()[0], "subscribe");
+    connection->shutdown();
+}
+
+TEST_F(WsConnectionTest, CompressionNeedsVenueSupport) {
+    LocalWsServer server;
+    auto connection = makeConnection(server.port(), false, true);
+    connection->start();
+    ASSERT_TRUE(connection->waitForOpen(std::chrono::seconds(5)));
+    EXPECT_EQ(connection->getStats().compressedSessions, 0u);
+    connection->shutdown();
+}
+
+TEST_F(WsConnectionTest, BacksOffWhileVenueIsDown) {
+    std::string port;
+    {
+        net::io_context ioc;
+        tcp::acceptor acceptor(ioc, {net::ip::make_address("127.0.0.1"), 0});
+        port = std::to_string(acceptor.local_endpoint().port());
+    }
+
+    auto connection = makeConnection(port, false);
+    connection->start();
+    EXPECT_FALSE(connection->waitForOpen(std::chrono::milliseconds(300)));
+    EXPECT_GE(connection->getStats().failures, 2u);
+    EXPECT_NE(connection->state(), WsConnection::State::Open);
+
+    connection->shutdown();
+    EXPECT_EQ(connection->state(), WsConnection::State::Closed);
+    EXPECT_FALSE(connection->waitForOpen(std::chrono::milliseconds(10)));
+}
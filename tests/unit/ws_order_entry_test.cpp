@@ -0,0 +1,386 @@
+#include "../../src/exchanges/WsOrderEntry.hpp"
+#include "../../src/exchanges/BinanceAdapter.hpp"
+#include "LocalWsServer.hpp"
+#include "TestSupport.hpp"
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+#include <atomic>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+using namespace crypto_hft;
+namespace net = boost::asio;
+namespace ssl = boost::asio::ssl;
+using json = nlohmann::json;
+
+namespace {
+
+// Binance's WebSocket API signature: every other parameter in name order as key=value&...
+bool binanceSignatureValid(const json& params, const std::string& secret) {
+    std::string payload;
+    for (auto it = params.begin(); it != params.end(); ++it) {
+        if (it.key() == "signature") {
+            continue;
+        }
+        if (!payload.empty()) {
+            payload += '&';
+        }
+        payload += it.key() + "=" + (it->is_string() ? it->get<std::string>() : it->dump());
+    }
+    return params.value("signature", "") == hmacHex(EVP_sha256(), secret, payload);
+}
+
+// The ack Kraken sends for an addOrder, with txid
+std::string krakenAck(const json& request, const std::string& txid) {
+    return json{{"event", "addOrderStatus"}, {"reqid", request["reqid"]}, {"status", "ok"},
+                {"txid", txid}}.dump();
+}
+
+class WsOrderEntryTest : public IoContextTest {
+protected:
+    void SetUp() override {
+        clientCtx_.set_verify_mode(ssl::verify_none);
+        IoContextTest::SetUp();
+    }
+
+    static WsOrderEntry::Options options(const LocalWsServer& server,
+                                         std::size_t maxInFlight = 64) {
+        WsOrderEntry::Options options;
+        options.host = "localhost";
+        options.port = server.port();
+        options.maxInFlight = maxInFlight;
+        options.backoffInitial = std::chrono::milliseconds(10);
+        return options;
+    }
+
+    ssl::context clientCtx_{ssl::context::tls_client};
+};
+
+} // namespace
+
+TEST_F(WsOrderEntryTest, BinanceSignsEveryRequestAndCorrelatesResponses) {
+    const std::string secret = "binance-secret";
+    std::vector<std::string> problems;
+    LocalWsServer server([&](const std::string& message) -> std::vector<std::string> {
+        json request = json::parse(message);
+        const json& params = request["params"];
+        json response = {{"id", request["id"]}, {"status", 200}};
+        if (params.value("apiKey", "") != "binance-key" ||
+            !binanceSignatureValid(params, secret)) {
+            problems.push_back(message);
+            response["status"] = 401;
+            response["error"] = {{"code", -1022}, {"msg", "bad signature"}};
+        } else if (params.value("quantity", "") == "9") {
+            response["status"] = 400;
+            response["error"] = {{"code", -2010}, {"msg", "Account has insufficient balance."}};
+        } else if (request["method"] == "order.cancel") {
+            response["result"] = {{"orderId", params["orderId"]},
+                                  {"origClientOrderId", "c1"}, {"status", "CANCELED"}};
+        } else if (request["method"] == "order.cancelReplace") {
+            response["result"] = {{"cancelResult", "SUCCESS"}, {"newOrderResult", "SUCCESS"},
+                                  {"newOrderResponse", {{"orderId", 29},
+                                                        {"clientOrderId", "c2"}}}};
+        } else {
+            EXPECT_EQ(params["price"], "42000.5");
+            EXPECT_EQ(params["quantity"], "0.0015");
+            EXPECT_EQ(request["method"], "order.place");
+            response["result"] = {{"orderId", 28},
+                                  {"clientOrderId", params["newClientOrderId"]}};
+        }
+        return {response.dump()};
+    });
+    BinanceWsOrderEntry entry(ioc_, clientCtx_, {"binance-key", secret}, options(server));
+
+    // Nothing is queued for a session that is not there
+    auto early = entry.submit(limitBuy("BTCUSDT", "c0")).get();
+    EXPECT_EQ(early.error, net::error::not_connected);
+
+    entry.start();
+    ASSERT_TRUE(entry.waitForOpen(std::chrono::seconds(5)));
+
+    auto ack = entry.submit(limitBuy("BTCUSDT", "c1")).get();
+    ASSERT_TRUE(ack.ok()) << ack.message;
+    EXPECT_EQ(ack.status, 200u);
+    EXPECT_EQ(ack.orderId, "28");
+    EXPECT_EQ(ack.clientOrderId, "c1");
+    EXPECT_GT(ack.latency.count(), 0);
+
+    auto cancel = entry.cancel("BTCUSDT", "28").get();
+    ASSERT_TRUE(cancel.ok()) << cancel.message;
+    EXPECT_EQ(cancel.orderId, "28");
+
+    auto modified = entry.modify("28", limitBuy("BTCUSDT", "c2")).get();
+    ASSERT_TRUE(modified.ok()) << modified.message;
+    EXPECT_EQ(modified.orderId, "29");
+
+    auto large = limitBuy("BTCUSDT", "c3");
+    large.size = 9;
+    auto rejected = entry.submit(large).get();
+    EXPECT_FALSE(rejected.ok());
+    EXPECT_FALSE(rejected.error);
+    EXPECT_EQ(rejected.status, 400u);
+    EXPECT_EQ(rejected.message, "Account has insufficient balance.");
+
+    EXPECT_TRUE(problems.empty());
+    EXPECT_EQ(entry.inFlight(), 0u);
+    entry.shutdown();
+}
+
+TEST_F(WsOrderEntryTest, KrakenResponsesCompleteTheirOwnRequestsInAnyOrder) {
+    // Holds every other order and then answers the pair newest first
+    std::optional<json> held;
+    LocalWsServer server([&](const std::string& message) -> std::vector<std::string> {
+        json request = json::parse(message);
+        EXPECT_EQ(request["token"], "ws-token");
+        if (request["event"] != "addOrder") {
+            return {json{{"event", "cancelOrderStatus"}, {"reqid", request["reqid"]},
+                         {"status", "error"}, {"errorMessage", "EOrder:Unknown order"}}.dump()};
+        }
+        std::string txid = "O-" + request["volume"].get<std::string>();
+        if (!held) {
+            held = request;
+            return {R"({"event":"heartbeat"})"};
+        }
+        std::vector<std::string> replies = {
+            krakenAck(request, txid),
+            krakenAck(*held, "O-" + (*held)["volume"].get<std::string>())};
+        held.reset();
+        return replies;
+    });
+    KrakenWsOrderEntry entry(ioc_, clientCtx_, options(server));
+    entry.setToken("ws-token");
+    entry.start();
+    ASSERT_TRUE(entry.waitForOpen(std::chrono::seconds(5)));
+
+    std::vector<std::future<OrderAck>> acks;
+    for (int i = 1; i <= 6; ++i) {
+        auto order = limitBuy("XBT/USD", "");
+        order.size = i;
+        acks.push_back(entry.submit(order));
+    }
+    for (int i = 1; i <= 6; ++i) {
+        auto ack = acks[i - 1].get();
+        ASSERT_TRUE(ack.ok()) << ack.message;
+        EXPECT_EQ(ack.orderId, "O-" + std::to_string(i));
+    }
+
+    auto cancel = entry.cancel("", "O-unknown").get();
+    EXPECT_FALSE(cancel.ok());
+    EXPECT_EQ(cancel.message, "EOrder:Unknown order");
+    entry.shutdown();
+}
+
+TEST_F(WsOrderEntryTest, FullTableFailsFastAndShutdownAbortsTheRest) {
+    LocalWsServer server([](const std::string&) { return std::vector<std::string>{}; });
+    BinanceWsOrderEntry entry(ioc_, clientCtx_, {"key", "secret"}, options(server, 2));
+    entry.start();
+    ASSERT_TRUE(entry.waitForOpen(std::chrono::seconds(5)));
+
+    auto first = entry.submit(limitBuy("BTCUSDT", "a"));
+    auto second = entry.submit(limitBuy("BTCUSDT", "b"));
+    auto third = entry.submit(limitBuy("BTCUSDT", "c"));
+    ASSERT_EQ(third.wait_for(std::chrono::seconds(0)), std::future_status::ready);
+    EXPECT_EQ(third.get().error, net::error::no_buffer_space);
+    EXPECT_EQ(entry.inFlight(), 2u);
+
+    entry.shutdown();
+    EXPECT_EQ(first.get().error, net::error::operation_aborted);
+    EXPECT_EQ(second.get().error, net::error::operation_aborted);
+    EXPECT_EQ(entry.inFlight(), 0u);
+}
+
+TEST_F(WsOrderEntryTest, UnansweredRequestsTimeOutWithoutBlockingTheTable) {
+    // Answers everything but order "a"
+    LocalWsServer server([](const std::string& message) -> std::vector<std::string> {
+        json request = json::parse(message);
+        if (request["params"]["newClientOrderId"] == "a") {
+            return {};
+        }
+        return {json{{"id", request["id"]}, {"status", 200},
+                     {"result", {{"orderId", 1}}}}.dump()};
+    });
+    auto opts = options(server, 2);
+    opts.responseTimeout = std::chrono::milliseconds(200);
+    BinanceWsOrderEntry entry(ioc_, clientCtx_, {"key", "secret"}, opts);
+    entry.start();
+    ASSERT_TRUE(entry.waitForOpen(std::chrono::seconds(5)));
+
+    // Ids wrap onto the slot "a" holds and skip past it
+    auto unanswered = entry.submit(limitBuy("BTCUSDT", "a"));
+    for (const char* id : {"b", "c", "d"}) {
+        auto ack = entry.submit(limitBuy("BTCUSDT", id)).get();
+        EXPECT_TRUE(ack.ok()) << id << ": " << ack.error.message();
+    }
+    EXPECT_EQ(unanswered.wait_for(std::chrono::seconds(0)), std::future_status::timeout);
+    EXPECT_EQ(entry.inFlight(), 1u);
+
+    EXPECT_EQ(unanswered.get().error, net::error::timed_out);
+    EXPECT_EQ(entry.inFlight(), 0u);
+    entry.shutdown();
+}
+
+TEST_F(WsOrderEntryTest, OrderRateLimitFailsFastButNeverHoldsBackCancels) {
+    LocalWsServer server([](const std::string&) { return std::vector<std::string>{}; });
+    auto opts = options(server);
+    opts.limiter = std::make_shared<RateLimiter>(
+        std::initializer_list<RateLimiter::Window>{{2.0, std::chrono::minutes(1)}});
+    BinanceWsOrderEntry entry(ioc_, clientCtx_, {"key", "secret"}, opts);
+    entry.start();
+    ASSERT_TRUE(entry.waitForOpen(std::chrono::seconds(5)));
+
+    auto first = entry.submit(limitBuy("BTCUSDT", "a"));
+    auto second = entry.submit(limitBuy("BTCUSDT", "b"));
+    auto third = entry.submit(limitBuy("BTCUSDT", "c"));
+    auto replace = entry.modify("1", limitBuy("BTCUSDT", "d"));
+    ASSERT_EQ(third.wait_for(std::chrono::seconds(0)), std::future_status::ready);
+    EXPECT_EQ(third.get().error, net::error::try_again);
+    ASSERT_EQ(replace.wait_for(std::chrono::seconds(0)), std::future_status::ready);
+    EXPECT_EQ(replace.get().error, net::error::try_again);
+
+    auto cancel = entry.cancel("BTCUSDT", "1");
+    EXPECT_EQ(entry.inFlight(), 3u);
+    EXPECT_GT(opts.limiter->timeUntilAvailable(1.0), std::chrono::seconds(20));
+
+    entry.shutdown();
+    EXPECT_EQ(cancel.get().error, net::error::operation_aborted);
+}
+
+TEST_F(WsOrderEntryTest, RequestsLostWithTheSessionFailAndAreNeverResent) {
+    std::atomic<bool> answer{false};
+    LocalWsServer server([&](const std::string& message) -> std::vector<std::string> {
+        if (!answer) {
+            return {};
+        }
+        return {krakenAck(json::parse(message), "O-1")};
+    });
+    KrakenWsOrderEntry entry(ioc_, clientCtx_, options(server));
+    entry.start();
+    ASSERT_TRUE(entry.waitForOpen(std::chrono::seconds(5)));
+
+    auto first = entry.submit(limitBuy("XBT/USD", ""));
+    auto second = entry.submit(limitBuy("XBT/USD", ""));
+    ASSERT_TRUE(eventually([&] { return server.received().size() == 2; }));
+
+    server.drop(false);
+    EXPECT_EQ(first.get().error, net::error::connection_aborted);
+    EXPECT_EQ(second.get().error, net::error::connection_aborted);
+    ASSERT_TRUE(eventually([&] { return entry.getConnectionStats().opens == 2; }));
+
+    answer = true;
+    auto ack = entry.submit(limitBuy("XBT/USD", "")).get();
+    ASSERT_TRUE(ack.ok()) << ack.error.message() << ack.message;
+    EXPECT_EQ(server.received().size(), 3u);
+    entry.shutdown();
+}
+
+TEST_F(WsOrderEntryTest, TrackedOrdersAreBoundedAndUnknownOnesForgotten) {
+    // Acks every order but "lost"
+    LocalWsServer server([](const std::string& message) -> std::vector<std::string> {
+        json request = json::parse(message);
+        const json& id = request["params"]["newClientOrderId"];
+        if (id == "lost") {
+            return {};
+        }
+        return {json{{"id", request["id"]}, {"status", 200},
+                     {"result", {{"orderId", 1}, {"clientOrderId", id}}}}.dump()};
+    });
+    auto opts = options(server);
+    opts.maxOpenOrders = 2;
+    opts.responseTimeout = std::chrono::milliseconds(100);
+    BinanceWsOrderEntry entry(ioc_, clientCtx_, {"key", "secret"}, opts);
+    std::atomic<int> accepted{0};
+    entry.setExecutionHandler([&](const OrderResponse& response) {
+        if (response.status == utils::OrderStatus::NEW) {
+            ++accepted;
+        }
+    });
+    entry.start();
+    ASSERT_TRUE(entry.waitForOpen(std::chrono::seconds(5)));
+
+    // Nothing reports fills, so the oldest acked order makes room for the newest
+    for (const char* id : {"a", "b", "c"}) {
+        EXPECT_EQ(entry.submitOrder(limitBuy("BTCUSDT", id)), id);
+    }
+    ASSERT_TRUE(eventually([&] { return accepted == 3; }));
+    EXPECT_EQ(entry.openOrders(), 2u);
+    EXPECT_FALSE(entry.cancelOrder("a"));
+
+    // An order whose fate is unknown is dropped once its request times out
+    EXPECT_EQ(entry.submitOrder(limitBuy("BTCUSDT", "lost")), "lost");
+    EXPECT_EQ(entry.openOrders(), 2u);
+    EXPECT_TRUE(eventually([&] { return entry.openOrders() == 1; }));
+    EXPECT_EQ(entry.inFlight(), 0u);
+    entry.shutdown();
+}
+
+TEST_F(WsOrderEntryTest, AdapterOrdersAreTrackedAndReported) {
+    LocalWsServer server([](const std::string& message) -> std::vector<std::string> {
+        json request = json::parse(message);
+        const json& params = request["params"];
+        json response = {{"id", request["id"]}, {"status", 200}};
+        if (params.value("quantity", "") == "9") {
+            response["status"] = 400;
+            response["error"] = {{"code", -2010}, {"msg", "insufficient balance"}};
+        } else if (request["method"] == "order.cancel") {
+            response["result"] = {{"orderId", params["orderId"]}};
+        } else if (request["method"] == "order.cancelReplace") {
+            response["result"] = {{"newOrderResponse", {{"orderId", 8}}}};
+        } else {
+            response["result"] = {{"orderId", 7},
+                                  {"clientOrderId", params["newClientOrderId"]}};
+        }
+        return {response.dump()};
+    });
+    auto entry = std::make_shared<BinanceWsOrderEntry>(ioc_, clientCtx_,
+        WsOrderEntry::Credentials{"key", "secret"}, options(server));
+
+    std::mutex mutex;
+    std::vector<OrderResponse> reports;
+    BinanceAdapter adapter;
+    adapter.setOrderEntry(entry);
+    adapter.registerExecutionCallback([&](const OrderResponse& response) {
+        std::lock_guard<std::mutex> lock(mutex);
+        reports.push_back(response);
+    });
+    auto reported = [&] {
+        std::lock_guard<std::mutex> lock(mutex);
+        return reports.size();
+    };
+
+    EXPECT_EQ(adapter.submitOrder(limitBuy("BTCUSDT", "")), "");
+    entry->start();
+    ASSERT_TRUE(entry->waitForOpen(std::chrono::seconds(5)));
+
+    std::string id = adapter.submitOrder(limitBuy("BTCUSDT", ""));
+    ASSERT_FALSE(id.empty());
+    ASSERT_TRUE(eventually([&] { return reported() == 1; }));
+    EXPECT_EQ(reports[0].clientOrderId, id);
+    EXPECT_EQ(reports[0].orderId, "7");
+    EXPECT_EQ(reports[0].status, utils::OrderStatus::NEW);
+
+    ASSERT_TRUE(adapter.modifyOrder(id, 42001.0, 0.002));
+    ASSERT_TRUE(eventually([&] { return reported() == 2; }));
+    EXPECT_EQ(reports[1].orderId, "8");
+    EXPECT_EQ(reports[1].status, utils::OrderStatus::NEW);
+
+    ASSERT_TRUE(adapter.cancelOrder(id));
+    ASSERT_TRUE(eventually([&] { return reported() == 3; }));
+    EXPECT_EQ(reports[2].orderId, "8");
+    EXPECT_EQ(reports[2].status, utils::OrderStatus::CANCELED);
+    EXPECT_FALSE(adapter.cancelOrder(id));
+
+    auto large = limitBuy("BTCUSDT", "big");
+    large.size = 9;
+    EXPECT_EQ(adapter.submitOrder(large), "big");
+    ASSERT_TRUE(eventually([&] { return reported() == 4; }));
+    EXPECT_EQ(reports[3].clientOrderId, "big");
+    EXPECT_EQ(reports[3].status, utils::OrderStatus::REJECTED);
+    EXPECT_FALSE(adapter.cancelOrder("big"));
+
+    // Each request carried the made-up client order id it was submitted under
+    auto first = json::parse(server.received()[0]);
+    EXPECT_EQ(first["params"]["newClientOrderId"], id);
+    entry->shutdown();
+}